@@ -15,18 +15,83 @@
 #include "general.h"  /* must always come first */
 
 #include <string.h>
+
 #include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_PROJECT, K_TARGET
+} antKind;
+
+static kindOption AntKinds [] = {
+	{ TRUE, 'p', "project", "projects"},
+	{ TRUE, 't', "target",  "targets"}
+};
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static void installAntRegex (const langType language)
+static void findAntTags (void)
 {
-	addTagRegex (language,
-		"^[ \t]*<[ \t]*project[^>]+name=\"([^\"]+)\".*", "\\1", "p,project,projects", NULL);
-	addTagRegex (language,
-		"^[ \t]*<[ \t]*target[^>]+name=\"([^\"]+)\".*", "\\1", "t,target,targets", NULL);
+	vString *name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		const char *cp = (const char *) line;
+		const char *attribute = NULL;
+		const char *limit;
+		const char *quote;
+		const char *close;
+		const char *p;
+		antKind kind;
+
+		while (*cp == ' '  ||  *cp == '\t')
+			++cp;
+		if (*cp != '<')
+			continue;
+		++cp;
+		while (*cp == ' '  ||  *cp == '\t')
+			++cp;
+		if (strncmp (cp, "project", (size_t) 7) == 0)
+		{
+			kind = K_PROJECT;
+			cp += 7;
+		}
+		else if (strncmp (cp, "target", (size_t) 6) == 0)
+		{
+			kind = K_TARGET;
+			cp += 6;
+		}
+		else
+			continue;
+		if (*cp == '\0')
+			continue;
+
+		/*  Take the last name="..." appearing before the closing '>' and
+		 *  separated from the element name by at least one character, as
+		 *  the greedy regular expressions this scanner replaces did.
+		 */
+		limit = strchr (cp, '>');
+		for (p = strstr (cp + 1, "name=\"")  ;
+			 p != NULL  &&  (limit == NULL  ||  p < limit)  ;
+			 p = strstr (p + 1, "name=\""))
+			attribute = p;
+		if (attribute == NULL)
+			continue;
+		quote = attribute + 6;
+		close = strchr (quote, '"');
+		if (close == NULL  ||  close == quote)
+			continue;
+		vStringNCopyS (name, quote, (size_t) (close - quote));
+		makeSimpleTag (name, AntKinds, kind);
+	}
+	vStringDelete (name);
 }
 
 extern parserDefinition* AntParser ()
@@ -34,8 +99,9 @@ extern parserDefinition* AntParser ()
 	static const char *const extensions [] = { "build.xml", NULL };
 	parserDefinition* const def = parserNew ("Ant");
 	def->extensions = extensions;
-	def->initialize = installAntRegex;
-	def->regex      = TRUE;
+	def->kinds      = AntKinds;
+	def->kindCount  = KIND_COUNT (AntKinds);
+	def->parser     = findAntTags;
 	return def;
 }
 
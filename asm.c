@@ -120,6 +120,7 @@ static void buildAsmKeywordHash (void)
 {
 	const size_t count = sizeof (AsmKeywords) / sizeof (AsmKeywords [0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_asm);
 	for (i = 0  ;  i < count  ;  ++i)
 	{
 		const asmKeyword* const p = AsmKeywords + i;
@@ -129,13 +130,7 @@ static void buildAsmKeywordHash (void)
 
 static opKeyword analyzeOperator (const vString *const op)
 {
-	vString *keyword = vStringNew ();
-	opKeyword result;
-
-	vStringCopyToLower (keyword, op);
-	result = (opKeyword) lookupKeyword (vStringValue (keyword), Lang_asm);
-	vStringDelete (keyword);
-	return result;
+	return (opKeyword) lookupKeyword (vStringValue (op), Lang_asm);
 }
 
 static boolean isInitialSymbolCharacter (int c)
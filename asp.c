@@ -63,10 +63,35 @@ static void findAspTags (void)
 					cp++;
 			}
 
-			/* jump over comments */ 
+			/* jump over comments */
 			else if (*cp == '\'')
 				break;
-			
+
+			/* end of a script block: markup cannot contain declarations,
+			   so stride to the next one */
+			else if (*cp == '%'  &&  cp [1] == '>')
+			{
+				const char *open = strstr ((const char *) cp + 2, "<%");
+				if (open == NULL)
+				{
+					line = fileSkipLinesUntilString ("<%");
+					if (line == NULL)
+						break;
+					open = strstr ((const char *) line, "<%");
+				}
+				cp = (const unsigned char *) open + 2;
+			}
+
+			/* words starting with any other letter cannot open a
+			   declaration; skip them in one go */
+			else if (isalpha ((int) *cp)  &&
+					 strchr ("cdefps", tolower ((int) *cp)) == NULL)
+			{
+				do
+					++cp;
+				while (isalnum ((int) *cp)  ||  *cp == '_');
+			}
+
 			/* jump over end function/sub lines */
 			else if (strncasecmp ((const char*) cp, "end", (size_t) 3)== 0)
 			{
@@ -40,10 +40,13 @@ static void findAwkTags (void)
 	vString *name = vStringNew ();
 	const unsigned char *line;
 
-	while ((line = fileReadLine ()) != NULL)
+	/*  Function definitions are only legal at the top level and start in
+	 *  the first column, so the reader strides from one candidate line to
+	 *  the next; the lines of rule bodies are never inspected.
+	 */
+	while ((line = fileSkipLinesUntilPrefix ("function")) != NULL)
 	{
-		if (strncmp ((const char*) line, "function", (size_t) 8) == 0  &&
-			isspace ((int) line [8]))
+		if (isspace ((int) line [8]))
 		{
 			const unsigned char *cp = line + 8;
 
@@ -52,6 +52,8 @@ static kindOption BasicKinds[] = {
 	{TRUE, 'g', "enum", "enumerations"}
 };
 
+static vString *Name;
+
 static KeyWord blitzbasic_keywords[] = {
 	{"const", K_CONST, 0},
 	{"global", K_VARIABLE, 0},
@@ -71,11 +73,14 @@ static KeyWord purebasic_keywords[] = {
 	{NULL, 0, 0}
 };
 
+/*  Keywords sharing an initial letter must be adjacent, so that the
+ *  dispatch table below can hand the scanner a contiguous run to try.
+ */
 static KeyWord freebasic_keywords[] = {
 	{"const", K_CONST, 0},
+	{"common", K_VARIABLE, 0},
 	{"dim as", K_VARIABLE, 1},
 	{"dim", K_VARIABLE, 0},
-	{"common", K_VARIABLE, 0},
 	{"function", K_FUNCTION, 0},
 	{"sub", K_FUNCTION, 0},
 	{"private sub", K_FUNCTION, 0},
@@ -94,34 +99,33 @@ static KeyWord freebasic_keywords[] = {
 /* Match the name of a tag (function, variable, type, ...) starting at pos. */
 static char const *extract_name (char const *pos, vString * name)
 {
+	char const *start;
 	while (isspace (*pos))
 		pos++;
+	start = pos;
+	while (*pos && !isspace (*pos) && *pos != '(' && *pos != ',')
+		pos++;
 	vStringClear (name);
-	for (; *pos && !isspace (*pos) && *pos != '(' && *pos != ','; pos++)
-		vStringPut (name, *pos);
-	vStringTerminate (name);
+	vStringNCatS (name, start, pos - start);
 	return pos;
 }
 
 /* Match a keyword starting at p (case insensitive). */
 static int match_keyword (const char *p, KeyWord const *kw)
 {
-	vString *name;
 	size_t i;
 	int j;
-	for (i = 0; i < strlen (kw->token); i++)
+	for (i = 0; kw->token[i]; i++)
 	{
 		if (tolower (p[i]) != kw->token[i])
 			return 0;
 	}
-	name = vStringNew ();
 	p += i;
 	for (j = 0; j < 1 + kw->skip; j++)
 	{
-		p = extract_name (p, name);
-	}	
-	makeSimpleTag (name, BasicKinds, kw->kind);
-	vStringDelete (name);
+		p = extract_name (p, Name);
+	}
+	makeSimpleTag (Name, BasicKinds, kw->kind);
 	return 1;
 }
 
@@ -133,10 +137,9 @@ static void match_colon_label (char const *p)
 		end--;
 	if (*end == ':')
 	{
-		vString *name = vStringNew ();
-		vStringNCatS (name, p, end - p);
-		makeSimpleTag (name, BasicKinds, K_LABEL);
-		vStringDelete (name);
+		vStringClear (Name);
+		vStringNCatS (Name, p, end - p);
+		makeSimpleTag (Name, BasicKinds, K_LABEL);
 	}
 }
 
@@ -145,10 +148,26 @@ static void match_dot_label (char const *p)
 {
 	if (*p == '.')
 	{
-		vString *name = vStringNew ();
-		extract_name (p + 1, name);
-		makeSimpleTag (name, BasicKinds, K_LABEL);
-		vStringDelete (name);
+		extract_name (p + 1, Name);
+		makeSimpleTag (Name, BasicKinds, K_LABEL);
+	}
+}
+
+/*  Fills "dispatch" with, for each letter, the first keyword beginning with
+ *  that letter, or NULL when the dialect has none; keywords sharing an
+ *  initial are adjacent in the dialect tables, so a line need only be
+ *  compared against the short run its first letter selects.
+ */
+static void build_dispatch (KeyWord const *kw, KeyWord const **dispatch)
+{
+	unsigned int i;
+	for (i = 0; i < 26; i++)
+		dispatch [i] = NULL;
+	for ( ; kw->token != NULL; kw++)
+	{
+		i = kw->token [0] - 'a';
+		if (dispatch [i] == NULL)
+			dispatch [i] = kw;
 	}
 }
 
@@ -157,6 +176,7 @@ static void findBasicTags (void)
 	const char *line;
 	const char *extension = fileExtension (vStringValue (File.name));
 	KeyWord *keywords;
+	KeyWord const *dispatch [26];
 
 	if (strcmp (extension, "bb") == 0)
 		keywords = blitzbasic_keywords;
@@ -164,11 +184,13 @@ static void findBasicTags (void)
 		keywords = purebasic_keywords;
 	else
 		keywords = freebasic_keywords;
+	build_dispatch (keywords, dispatch);
 
+	Name = vStringNew ();
 	while ((line = (const char *) fileReadLine ()) != NULL)
 	{
 		const char *p = line;
-		KeyWord const *kw;
+		int first;
 
 		while (isspace (*p))
 			p++;
@@ -176,10 +198,18 @@ static void findBasicTags (void)
 		/* Empty line? */
 		if (!*p)
 			continue;
-
-		/* In Basic, keywords always are at the start of the line. */
-		for (kw = keywords; kw->token; kw++)
-			if (match_keyword (p, kw)) break;
+		first = tolower (*p);
+
+		/* In Basic, keywords always are at the start of the line; most
+		 * lines start with a letter no keyword begins with and are
+		 * dismissed by the dispatch table alone. */
+		if (first >= 'a' && first <= 'z')
+		{
+			KeyWord const *kw = dispatch [first - 'a'];
+			if (kw != NULL)
+				for ( ; kw->token != NULL && kw->token [0] == first; kw++)
+					if (match_keyword (p, kw)) break;
+		}
 
 		/* Is it a label? */
 		if (strcmp (extension, "bb") == 0)
@@ -187,6 +217,8 @@ static void findBasicTags (void)
 		else
 			match_colon_label (p);
 	}
+	vStringDelete (Name);
+	Name = NULL;
 }
 
 parserDefinition *BasicParser (void)
@@ -0,0 +1,375 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2009, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Microbenchmarks for the primitives on the parsing hot path: keyword
+*   lookup, token string building, the preprocessor character reader and
+*   the tag line comparators. Build with "make bench". Each benchmark
+*   reports nanoseconds per operation, so that a regression in one
+*   primitive shows up in isolation instead of inside the minutes of
+*   noise in an end-to-end run.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_GETTIMEOFDAY
+# include <sys/time.h>
+#endif
+
+#include "entry.h"
+#include "get.h"
+#include "keyword.h"
+#include "main.h"
+#include "options.h"
+#include "parse.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/*  Real C keywords for the lookup hit stream; the miss stream uses
+ *  ordinary identifiers, which is what a parser feeds lookupKeyword for
+ *  every token which turns out not to be a keyword.
+ */
+static const char *const CKeywords [] = {
+	"auto", "break", "case", "char", "const", "continue", "default", "do",
+	"double", "else", "enum", "extern", "float", "for", "goto", "if",
+	"int", "long", "register", "return", "short", "signed", "sizeof",
+	"static", "struct", "switch", "typedef", "union", "unsigned", "void",
+	"volatile", "while"
+};
+
+static const char *const Identifiers [] = {
+	"result", "buffer", "length", "offset", "status", "context", "index",
+	"count", "value", "entry", "name", "line", "file", "token", "state",
+	"parseIdentifier", "makeTagEntry", "vStringDelete", "processLine",
+	"initializeTable", "lookupSymbol", "readNextCharacter", "tagPosition"
+};
+
+/*  A representative C body for the preprocessor reader: code, comments
+ *  of both kinds, string and character literals and conditional
+ *  directives all take different paths through cppGetc ().
+ */
+static const char CppBody [] =
+	"/*\n"
+	" *  A representative source body for the reader benchmark.\n"
+	" */\n"
+	"#include <stdio.h>\n"
+	"#define BUFFER_SIZE  1024  /* block size */\n"
+	"\n"
+	"static const char Message [] = \"a string /* not a comment */ here\";\n"
+	"\n"
+	"static int processBuffer (const char *const buffer, const int length)\n"
+	"{\n"
+	"\tint i, total = 0;  /* running sum */\n"
+	"\n"
+	"\tfor (i = 0  ;  i < length  ;  ++i)\n"
+	"\t{\n"
+	"\t\tconst char c = buffer [i];\n"
+	"\n"
+	"\t\tif (c == '\\\\'  ||  c == '\"')\n"
+	"\t\t\tcontinue;  // escaped or quoting\n"
+	"#if 0\n"
+	"\t\ttotal -= c;  /* dead code, skipped by the reader */\n"
+	"#else\n"
+	"\t\ttotal += c;\n"
+	"#endif\n"
+	"\t}\n"
+	"\treturn total;\n"
+	"}\n";
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/*  Stubs for the services main.c provides to the linked modules; the
+ *  benchmarks have no totals to accumulate and no phases to time.
+ */
+extern void addTotals (
+		const unsigned int files __ctags_unused__,
+		const long unsigned int lines __ctags_unused__,
+		const long unsigned int bytes __ctags_unused__)
+{
+}
+
+extern timedPhase beginPhase (const timedPhase phase)
+{
+	return phase;
+}
+
+extern boolean isDestinationStdout (void)
+{
+	return FALSE;
+}
+
+static double benchClock (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (double) tv.tv_sec + (double) tv.tv_usec / 1000000.0;
+#else
+	return (double) clock () / (double) CLOCKS_PER_SEC;
+#endif
+}
+
+static void report (
+		const char *const name, const unsigned long ops, const double seconds)
+{
+	printf ("%-28s %12lu ops  %8.1f ns/op\n",
+			name, ops, seconds * 1e9 / (double) ops);
+	fflush (stdout);
+}
+
+/*  Accumulates results so that no benchmarked call can be optimized
+ *  away as unused.
+ */
+static volatile long Sink = 0;
+
+static void benchKeywordLookup (const langType language)
+{
+	const unsigned long rounds = 100000;
+	unsigned long i, ops;
+	size_t j;
+	double started;
+
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+		for (j = 0  ;  j < sizeof (CKeywords) / sizeof (CKeywords [0])  ;  ++j, ++ops)
+			Sink += lookupKeyword (CKeywords [j], language);
+	report ("lookupKeyword hits", ops, benchClock () - started);
+
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+		for (j = 0  ;  j < sizeof (Identifiers) / sizeof (Identifiers [0])  ;  ++j, ++ops)
+			Sink += lookupKeyword (Identifiers [j], language);
+	report ("lookupKeyword misses", ops, benchClock () - started);
+
+	/*  The hashed entry point is fed the rolling hash a lexer accumulates
+	 *  while scanning the identifier; the per-character feed is charged
+	 *  here too, standing in for the scan loop it would share.
+	 */
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+		for (j = 0  ;  j < sizeof (CKeywords) / sizeof (CKeywords [0])  ;  ++j, ++ops)
+		{
+			const char *p;
+			unsigned long hash = KEYWORD_HASH_INIT;
+			for (p = CKeywords [j]  ;  *p != '\0'  ;  ++p)
+				keywordHashFeed (hash, (unsigned char) *p);
+			Sink += lookupKeywordHashed (CKeywords [j], hash, language);
+		}
+	report ("lookupKeywordHashed hits", ops, benchClock () - started);
+}
+
+static void benchVString (void)
+{
+	const unsigned long rounds = 500000;
+	const char token [] = "representative_name";
+	vString *const string = vStringNew ();
+	unsigned long i, ops;
+	size_t j;
+	double started;
+
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+	{
+		vStringClear (string);
+		for (j = 0  ;  j < sizeof token - 1  ;  ++j, ++ops)
+			vStringPut (string, token [j]);
+	}
+	report ("vStringPut", ops, benchClock () - started);
+
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+	{
+		vStringClear (string);
+		for (j = 0  ;  j < 8  ;  ++j, ++ops)
+			vStringCatS (string, token);
+	}
+	report ("vStringCatS", ops, benchClock () - started);
+
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+	{
+		vStringClear (string);
+		for (j = 0  ;  j < 8  ;  ++j, ++ops)
+			vStringCatSpan (string, token, sizeof token - 1);
+	}
+	report ("vStringCatSpan", ops, benchClock () - started);
+
+	vStringDelete (string);
+}
+
+/*  Tags made while the reader handles #define directives are discarded
+ *  through the entry callback rather than written anywhere.
+ */
+static void discardTag (
+		const struct sTagEntryInfo *const tag __ctags_unused__,
+		void *const clientData __ctags_unused__)
+{
+}
+
+static void benchCppGetc (const langType language)
+{
+	const unsigned long rounds = 2000;
+	unsigned char *const body = xMalloc (sizeof CppBody, unsigned char);
+	unsigned long i, ops;
+	double started;
+
+	setTagEntryFunction (discardTag, NULL);
+	started = benchClock ();
+	ops = 0;
+	for (i = 0  ;  i < rounds  ;  ++i)
+	{
+		int c;
+
+		/*  The reader consumes the buffer in place, so each pass works
+		 *  on a fresh copy, as parseBuffer () does for rescans.
+		 */
+		memcpy (body, CppBody, sizeof CppBody);
+		bufferOpen ("bench.c", language, body, sizeof CppBody - 1);
+		cppInit (FALSE, FALSE);
+		while ((c = cppGetc ()) != EOF)
+		{
+			Sink += c;
+			++ops;
+		}
+		cppTerminate ();
+		bufferClose ();
+	}
+	report ("cppGetc", ops, benchClock () - started);
+	setTagEntryFunction (NULL, NULL);
+	eFree (body);
+}
+
+/*  The number of comparisons made by qsort below, so that the cost is
+ *  reported per comparison rather than per line sorted.
+ */
+static unsigned long Comparisons = 0;
+
+/*  These mirror compareTags () and compareTagsFolded () in sort.c, which
+ *  compare the captured lines themselves; the fold key optimization
+ *  there is not reproduced here.
+ */
+static int compareLines (const void *const one, const void *const two)
+{
+	++Comparisons;
+	return strcmp (*(const char *const *) one, *(const char *const *) two);
+}
+
+static int compareLinesFolded (const void *const one, const void *const two)
+{
+	++Comparisons;
+	return struppercmp (*(const char *const *) one, *(const char *const *) two);
+}
+
+static void benchCompareTags (void)
+{
+	const unsigned long count = 20000;
+	const unsigned long rounds = 20;
+	char **const lines = xMalloc (count, char *);
+	char line [128];
+	unsigned long i, seed, round;
+	double started;
+
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		sprintf (line, "name%05lu\tsrc/module%02lu.c\t"
+				"/^static int name%05lu (void)$/;\"\tf",
+				i, i % 97, i);
+		lines [i] = eStrdup (line);
+	}
+
+	started = benchClock ();
+	Comparisons = 0;
+	for (round = 0  ;  round < rounds  ;  ++round)
+	{
+		/*  Shuffle with a small linear congruential sequence so every
+		 *  round sorts the same disorder.
+		 */
+		seed = 42;
+		for (i = count - 1  ;  i > 0  ;  --i)
+		{
+			unsigned long j;
+
+			seed = seed * 1103515245UL + 12345UL;
+			j = (seed >> 8) % (i + 1);
+			if (i != j)
+			{
+				char *const tmp = lines [i];
+				lines [i] = lines [j];
+				lines [j] = tmp;
+			}
+		}
+		qsort (lines, count, sizeof (*lines), compareLines);
+	}
+	report ("compareTags", Comparisons, benchClock () - started);
+
+	started = benchClock ();
+	Comparisons = 0;
+	for (round = 0  ;  round < rounds  ;  ++round)
+	{
+		seed = 42;
+		for (i = count - 1  ;  i > 0  ;  --i)
+		{
+			unsigned long j;
+
+			seed = seed * 1103515245UL + 12345UL;
+			j = (seed >> 8) % (i + 1);
+			if (i != j)
+			{
+				char *const tmp = lines [i];
+				lines [i] = lines [j];
+				lines [j] = tmp;
+			}
+		}
+		qsort (lines, count, sizeof (*lines), compareLinesFolded);
+	}
+	report ("compareTagsFolded", Comparisons, benchClock () - started);
+
+	for (i = 0  ;  i < count  ;  ++i)
+		eFree (lines [i]);
+	eFree (lines);
+}
+
+extern int main (int argc __ctags_unused__, char **argv)
+{
+	langType language;
+
+	setExecutableName (*argv);
+	initializeParsing ();
+	language = getNamedLanguage ("C");
+	if (language == LANG_IGNORE)
+		error (FATAL, "C parser not available");
+	initializeParser (language);
+
+	benchKeywordLookup (language);
+	benchVString ();
+	benchCppGetc (language);
+	benchCompareTags ();
+
+	return 0;
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -1,7 +1,7 @@
 /*
 *   $Id$
 *
-*   Copyright (c) 1999-2000, Mj�lner Informatics
+*   Copyright (c) 1999-2000, Mj�lner Informatics
 *
 *   Written by Erik Corry <corry@mjolner.dk>
 *
@@ -29,6 +29,7 @@
 *   MACROS
 */
 #define isbident(c) (identarray [(unsigned char) (c)])
+#define ismarker(c) (markerarray [(unsigned char) (c)])
 
 /*
 *   DATA DEFINITIONS
@@ -63,6 +64,26 @@ static const char identarray [256] = {
 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}; /* -255  */
 
+/* ['({:<] - the characters the program text scan acts on; every other
+   character costs one table load */
+static const char markerarray [256] = {
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 0-15  */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 16-31 */
+0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0,  /* 32-47    !"#$%&'()*+'-./ */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0,  /* 48-63   0123456789:;<=>? */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 64-79   @ABCDEFGHIJKLMNO */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 80-95   PQRSTUVWXYZ [\]^_ */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 96-111  `abcdefghijklmno */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0,  /* 112-127  pqrstuvwxyz{|}~ */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  /* 128-  */
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}; /* -255  */
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -82,25 +103,21 @@ static void makeBetaTag (const char* const name, const betaKind kind)
 static void findBetaTags (void)
 {
 	vString *line = vStringNew ();
+	const unsigned char *cp;
 	boolean incomment = FALSE;
 	boolean inquote = FALSE;
 	boolean dovirtuals = BetaKinds [K_VIRTUAL].enabled;
 	boolean dopatterns = BetaKinds [K_PATTERN].enabled;
 
-	do
+	while ((cp = fileReadLine ()) != NULL)
 	{
 		boolean foundfragmenthere = FALSE;
 		/* find fragment definition (line that starts and ends with --) */
 		int last;
 		int first;
-		int c;
 
-		vStringClear (line);
-
-		while ((c = fileGetc ()) != EOF && c != '\n' && c != '\r')
-			vStringPut (line, c);
-
-		vStringTerminate (line);
+		/* the scan pokes NUL terminators into the line, so work on a copy */
+		vStringCopyS (line, (const char *) cp);
 
 		last = vStringLength (line) - 1;
 		first = 0;
@@ -148,6 +165,8 @@ static void findBetaTags (void)
 		programtext:
 			for ( ; pos < len; pos++)
 			{
+				if (! ismarker (vStringChar (line, pos)))
+					continue;
 				if (vStringChar (line, pos) == '\'')
 				{
 					pos++;
@@ -303,7 +322,7 @@ static void findBetaTags (void)
 		}
 		endofline:
 		inquote = FALSE;  /* This shouldn't really make a difference */
-	} while (!feof (File.fp));
+	}
 	vStringDelete (line);
 }
 
@@ -18,6 +18,7 @@
 #include <string.h>
 #include <setjmp.h>
 
+#include "cache.h"
 #include "debug.h"
 #include "entry.h"
 #include "get.h"
@@ -174,7 +175,8 @@ typedef struct sTokenInfo {
 	keywordId     keyword;
 	vString*      name;          /* the name of the token */
 	unsigned long lineNumber;    /* line number of tag */
-	fpos_t        filePosition;  /* file position of line containing name */
+	filePos       filePosition;  /* file position of line containing name */
+	struct sTokenInfo *next;     /* next token in the free list */
 } tokenInfo;
 
 typedef enum eImplementation {
@@ -205,6 +207,8 @@ typedef struct sStatementInfo {
 	tokenInfo*	blockName;      /* name of current block */
 	memberInfo	member;         /* information regarding parent class/struct */
 	vString*	parentClasses;  /* parent classes */
+	vString*	nestedScope;    /* scope prefix supplied to nested statements */
+	boolean		nestedScopeValid;  /* is nestedScope up to date? */
 	struct sStatementInfo *parent;  /* statement we are nested within */
 } statementInfo;
 
@@ -524,10 +528,22 @@ static void retardToken (statementInfo *const st)
 	setToken (st, TOKEN_NONE);
 }
 
+/*  Deleted tokens are kept on a free list and recycled by newToken (),
+ *  retaining their name strings (cleared by initToken ()) so that a busy
+ *  parse settles into a steady state with no further heap traffic.
+ */
+static tokenInfo *FreeTokens = NULL;
+
 static tokenInfo *newToken (void)
 {
-	tokenInfo *const token = xMalloc (1, tokenInfo);
-	token->name = vStringNew ();
+	tokenInfo *token = FreeTokens;
+	if (token == NULL)
+	{
+		token = xMalloc (1, tokenInfo);
+		token->name = vStringNew ();
+	}
+	else
+		FreeTokens = token->next;
 	initToken (token);
 	return token;
 }
@@ -536,8 +552,8 @@ static void deleteToken (tokenInfo *const token)
 {
 	if (token != NULL)
 	{
-		vStringDelete (token->name);
-		eFree (token);
+		token->next = FreeTokens;
+		FreeTokens = token;
 	}
 }
 
@@ -619,7 +635,7 @@ static const char *keywordString (const keywordId keyword)
 	return name;
 }
 
-static void __unused__ pt (tokenInfo *const token)
+static void __ctags_unused__ pt (tokenInfo *const token)
 {
 	if (isType (token, TOKEN_NAME))
 		printf ("type: %-12s: %-13s   line: %lu\n",
@@ -634,7 +650,7 @@ static void __unused__ pt (tokenInfo *const token)
 			tokenString (token->type), token->lineNumber);
 }
 
-static void __unused__ ps (statementInfo *const st)
+static void __ctags_unused__ ps (statementInfo *const st)
 {
 	unsigned int i;
 	printf ("scope: %s   decl: %s   gotName: %s   gotParenName: %s\n",
@@ -763,6 +779,7 @@ static void reinitStatement (statementInfo *const st, const boolean partial)
 	st->gotName			= FALSE;
 	st->haveQualifyingName = FALSE;
 	st->tokenIndex		= 0;
+	st->nestedScopeValid = FALSE;
 
 	if (st->parent != NULL)
 		st->inFunction = st->parent->inFunction;
@@ -912,20 +929,37 @@ static int tagLetter (const tagType type)
 	return result;
 }
 
+/*  Which tag types are enabled for the current language, filled lazily as
+ *  types are queried (only valid type/language pairs ever reach the kind
+ *  mapping) and flushed per run since the language may change per file.
+ */
+static boolean EnabledKinds [TAG_COUNT];
+static boolean EnabledKindsValid [TAG_COUNT];
+
+static void flushEnabledKinds (void)
+{
+	memset (EnabledKindsValid, 0, sizeof EnabledKindsValid);
+}
+
 static boolean includeTag (const tagType type, const boolean isFileScope)
 {
-	boolean result;
 	if (isFileScope  &&  ! Option.include.fileScope)
-		result = FALSE;
-	else if (isLanguage (Lang_csharp))
-		result = CsharpKinds [csharpTagKind (type)].enabled;
-	else if (isLanguage (Lang_java))
-		result = JavaKinds [javaTagKind (type)].enabled;
-	else if (isLanguage (Lang_vera))
-		result = VeraKinds [veraTagKind (type)].enabled;
-	else
-		result = CKinds [cTagKind (type)].enabled;
-	return result;
+		return FALSE;
+	if (! EnabledKindsValid [type])
+	{
+		boolean enabled;
+		if (isLanguage (Lang_csharp))
+			enabled = CsharpKinds [csharpTagKind (type)].enabled;
+		else if (isLanguage (Lang_java))
+			enabled = JavaKinds [javaTagKind (type)].enabled;
+		else if (isLanguage (Lang_vera))
+			enabled = VeraKinds [veraTagKind (type)].enabled;
+		else
+			enabled = CKinds [cTagKind (type)].enabled;
+		EnabledKinds [type] = enabled;
+		EnabledKindsValid [type] = TRUE;
+	}
+	return EnabledKinds [type];
 }
 
 static tagType declToTagType (const declType declaration)
@@ -1060,38 +1094,64 @@ static void addOtherFields (tagEntryInfo* const tag, const tagType type,
 	}
 }
 
-static void findScopeHierarchy (vString *const string,
-								const statementInfo *const st)
+/*  Returns the scope prefix which the given statement supplies to the
+ *  statements nested within it. The prefix is materialized at most once per
+ *  block, so a class with hundreds of members concatenates its qualified
+ *  name once rather than once per tag; reinitStatement () invalidates the
+ *  cache when the block changes.
+ */
+static const vString *nestedScope (statementInfo *const st)
 {
-	vStringClear (string);
-	if (isType (st->context, TOKEN_NAME))
-		vStringCopy (string, st->context->name);
-	if (st->parent != NULL)
+	if (! st->nestedScopeValid)
 	{
-		vString *temp = vStringNew ();
-		const statementInfo *s;
-		for (s = st->parent  ;  s != NULL  ;  s = s->parent)
+		vStringClear (st->nestedScope);
+		if (st->parent != NULL)
+		{
+			const vString *const above = nestedScope (st->parent);
+
+			if (vStringLength (above) > 0)
+				vStringCopy (st->nestedScope, above);
+		}
+		if (isContextualStatement (st) ||
+			st->declaration == DECL_NAMESPACE ||
+			st->declaration == DECL_PROGRAM)
 		{
-			if (isContextualStatement (s) ||
-				s->declaration == DECL_NAMESPACE ||
-				s->declaration == DECL_PROGRAM)
+			Assert (isType (st->blockName, TOKEN_NAME));
+			if (vStringLength (st->nestedScope) > 0)
+				addContextSeparator (st->nestedScope);
+			if (isType (st->context, TOKEN_NAME) &&
+				vStringLength (st->context->name) > 0)
 			{
-				vStringCopy (temp, string);
-				vStringClear (string);
-				Assert (isType (s->blockName, TOKEN_NAME));
-				if (isType (s->context, TOKEN_NAME) &&
-					vStringLength (s->context->name) > 0)
-				{
-					vStringCat (string, s->context->name);
-					addContextSeparator (string);
-				}
-				vStringCat (string, s->blockName->name);
-				if (vStringLength (temp) > 0)
-					addContextSeparator (string);
-				vStringCat (string, temp);
+				vStringCat (st->nestedScope, st->context->name);
+				addContextSeparator (st->nestedScope);
 			}
+			vStringCat (st->nestedScope, st->blockName->name);
 		}
-		vStringDelete (temp);
+		st->nestedScopeValid = TRUE;
+	}
+	return st->nestedScope;
+}
+
+static void findScopeHierarchy (vString *const string,
+								const statementInfo *const st)
+{
+	vStringClear (string);
+	if (st->parent != NULL)
+	{
+		/*  The parent chain is suspended while this statement is parsed, so
+		 *  its cached scope prefix is current.
+		 */
+		const vString *const above = nestedScope (st->parent);
+
+		if (vStringLength (above) > 0)
+			vStringCopy (string, above);
+	}
+	if (isType (st->context, TOKEN_NAME)  &&
+		vStringLength (st->context->name) > 0)
+	{
+		if (vStringLength (string) > 0)
+			addContextSeparator (string);
+		vStringCat (string, st->context->name);
 	}
 }
 
@@ -1139,13 +1199,24 @@ static void makeTag (const tokenInfo *const token,
 	if (isType (token, TOKEN_NAME)  &&  vStringLength (token->name) > 0  &&
 		includeTag (type, isFileScope))
 	{
-		vString *scope = vStringNew ();
+		/*  These buffers are rebuilt for every tag; keep them across calls
+		 *  rather than reallocating identical scope strings each time.
+		 */
+		static vString *scope = NULL;
 		/* Use "typeRef" to store the typename from addOtherFields() until
 		 * it's used in makeTagEntry().
 		 */
-		vString *typeRef = vStringNew ();
+		static vString *typeRef = NULL;
 		tagEntryInfo e;
 
+		if (scope == NULL)
+		{
+			scope = vStringNew ();
+			typeRef = vStringNew ();
+		}
+		vStringClear (scope);
+		vStringClear (typeRef);
+
 		initTagEntry (&e, vStringValue (token->name));
 
 		e.lineNumber	= token->lineNumber;
@@ -1159,8 +1230,6 @@ static void makeTag (const tokenInfo *const token,
 
 		makeTagEntry (&e);
 		makeExtraTagEntry (type, &e, scope);
-		vStringDelete (scope);
-		vStringDelete (typeRef);
 	}
 }
 
@@ -1395,6 +1464,14 @@ static void skipToMatch (const char *const pair)
 				break;
 			}
 		}
+		else if (! CollectingSignature)
+		{
+			/*  An ordinary character inside the span; the text up to the
+			 *  next delimiter, comment, string or line end is equally
+			 *  ordinary and can be skipped in bulk.
+			 */
+			cppSkipPlainText (begin, end);
+		}
 	}
 	if (c == EOF)
 	{
@@ -1433,7 +1510,11 @@ static keywordId analyzeKeyword (const char *const name)
 	return id;
 }
 
-static void analyzeIdentifier (tokenInfo *const token)
+/*  hash is the rolling keyword hash readIdentifier () accumulated while
+ *  scanning the token, sparing the lookup a second walk of the name.
+ */
+static void analyzeIdentifier (tokenInfo *const token,
+							   const unsigned long hash)
 {
 	char *const name = vStringValue (token->name);
 	const char *replacement = NULL;
@@ -1445,7 +1526,8 @@ static void analyzeIdentifier (tokenInfo *const token)
 		if (replacement != NULL)
 			token->keyword = analyzeKeyword (replacement);
 		else
-			token->keyword = analyzeKeyword (vStringValue (token->name));
+			token->keyword = (keywordId) lookupKeywordHashed (
+					vStringValue (token->name), hash, getSourceLanguage ());
 
 		if (token->keyword == KEYWORD_NONE)
 			token->type = TOKEN_NAME;
@@ -1470,6 +1552,7 @@ static void readIdentifier (tokenInfo *const token, const int firstChar)
 	vString *const name = token->name;
 	int c = firstChar;
 	boolean first = TRUE;
+	unsigned long hash = KEYWORD_HASH_INIT;
 
 	initToken (token);
 
@@ -1478,12 +1561,14 @@ static void readIdentifier (tokenInfo *const token, const int firstChar)
 	if (isLanguage (Lang_cpp) && firstChar == '~')
 	{
 		vStringPut (name, c);
+		keywordHashFeed (hash, c);
 		c = skipToNonWhite ();
 	}
 
 	do
 	{
 		vStringPut (name, c);
+		keywordHashFeed (hash, c);
 		if (CollectingSignature)
 		{
 			if (!first)
@@ -1495,7 +1580,7 @@ static void readIdentifier (tokenInfo *const token, const int firstChar)
 	vStringTerminate (name);
 	cppUngetc (c);        /* unget non-identifier character */
 
-	analyzeIdentifier (token);
+	analyzeIdentifier (token, hash);
 }
 
 static void readPackageName (tokenInfo *const token, const int firstChar)
@@ -2558,17 +2643,32 @@ static void nextToken (statementInfo *const st)
 
 static statementInfo *CurrentStatement = NULL;
 
+/*  Deleted statements are kept on a free list, chained through their parent
+ *  pointers, and recycled complete with their tokens and strings, which
+ *  initStatement () reinitializes; one statement is otherwise allocated and
+ *  freed per block nesting level.
+ */
+static statementInfo *FreeStatements = NULL;
+
 static statementInfo *newStatement (statementInfo *const parent)
 {
-	statementInfo *const st = xMalloc (1, statementInfo);
-	unsigned int i;
+	statementInfo *st = FreeStatements;
 
-	for (i = 0  ;  i < (unsigned int) NumTokens  ;  ++i)
-		st->token [i] = newToken ();
+	if (st == NULL)
+	{
+		unsigned int i;
+		st = xMalloc (1, statementInfo);
 
-	st->context = newToken ();
-	st->blockName = newToken ();
-	st->parentClasses = vStringNew ();
+		for (i = 0  ;  i < (unsigned int) NumTokens  ;  ++i)
+			st->token [i] = newToken ();
+
+		st->context = newToken ();
+		st->blockName = newToken ();
+		st->parentClasses = vStringNew ();
+		st->nestedScope = vStringNew ();
+	}
+	else
+		FreeStatements = st->parent;
 
 	initStatement (st, parent);
 	CurrentStatement = st;
@@ -2580,16 +2680,9 @@ static void deleteStatement (void)
 {
 	statementInfo *const st = CurrentStatement;
 	statementInfo *const parent = st->parent;
-	unsigned int i;
 
-	for (i = 0  ;  i < (unsigned int) NumTokens  ;  ++i)
-	{
-		deleteToken (st->token [i]);       st->token [i] = NULL;
-	}
-	deleteToken (st->blockName);           st->blockName = NULL;
-	deleteToken (st->context);             st->context = NULL;
-	vStringDelete (st->parentClasses);     st->parentClasses = NULL;
-	eFree (st);
+	st->parent = FreeStatements;
+	FreeStatements = st;
 	CurrentStatement = parent;
 }
 
@@ -2618,6 +2711,24 @@ static boolean isStatementEnd (const statementInfo *const st)
 	return isEnd;
 }
 
+/*  Offers the point just past a completed top-level statement as a restart
+ *  checkpoint. The reader is advanced to the first character of the next
+ *  statement, so that the checkpoint can fall on a line boundary, and the
+ *  character is given back afterward; the token stream is unchanged.
+ */
+static void offerParseCheckpoint (void)
+{
+	int c;
+
+	if (! cacheCheckpointWanted ()  ||  ! cppUngetBufferEmpty ())
+		return;
+	c = skipToNonWhite ();
+	if (c != EOF  &&  getDirectiveNestLevel () == 0  &&
+		cppUngetBufferEmpty ())
+		cacheParseCheckpoint (c);
+	cppUngetc (c);
+}
+
 static void checkStatementEnd (statementInfo *const st)
 {
 	const tokenInfo *const token = activeToken (st);
@@ -2629,6 +2740,8 @@ static void checkStatementEnd (statementInfo *const st)
 		DebugStatement ( if (debug (DEBUG_PARSE)) printf ("<ES>"); )
 		reinitStatement (st, FALSE);
 		cppEndStatement ();
+		if (st->parent == NULL)
+			offerParseCheckpoint ();
 	}
 	else
 	{
@@ -2641,8 +2754,17 @@ static void nest (statementInfo *const st, const unsigned int nestLevel)
 {
 	switch (st->declaration)
 	{
-		case DECL_CLASS:
 		case DECL_ENUM:
+			/*  An enum body can yield nothing but enumerator tags, except
+			 *  in Java where enums may also declare members.
+			 */
+			if (isLanguage (Lang_java)  ||  includeTag (TAG_ENUMERATOR, FALSE))
+				createTags (nestLevel, st);
+			else
+				skipToMatch ("{}");
+			break;
+
+		case DECL_CLASS:
 		case DECL_INTERFACE:
 		case DECL_NAMESPACE:
 		case DECL_NOMANGLE:
@@ -2785,7 +2907,13 @@ static void createTags (const unsigned int nestLevel,
 		{
 			tagCheck (st);
 			if (isType (token, TOKEN_BRACE_OPEN))
+			{
+				/*  tagCheck () just named this block, so any scope prefix
+				 *  cached for an earlier block of the statement is stale.
+				 */
+				st->nestedScopeValid = FALSE;
 				nest (st, nestLevel + 1);
+			}
 			checkStatementEnd (st);
 		}
 	}
@@ -2800,6 +2928,7 @@ static rescanReason findCTags (const unsigned int passCount)
 
 	Assert (passCount < 3);
 	cppInit ((boolean) (passCount > 1), isLanguage (Lang_csharp));
+	flushEnabledKinds ();
 	Signature = vStringNew ();
 
 	exception = (exception_t) setjmp (Exception);
@@ -0,0 +1,769 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains an on-disk cache of the tag records each source
+*   file produced, so that an unchanged file can be replayed into the tag
+*   file without being parsed again. Entries are keyed by a hash of the
+*   file contents, the file name, the language, the program version and
+*   the options given on the command line, so a change to any of these
+*   simply misses the cache and the file is parsed as usual.
+*
+*   The same content hashes also feed an optional in-memory layer
+*   (--dedup) which recognizes identical copies of one file within a
+*   single run, parses the first and re-emits its records for the others
+*   with each copy's path substituted.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cache.h"
+#include "ctags.h"
+#include "entry.h"
+#include "options.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define CACHE_HEADER_PREFIX  "!_TAG_CACHE\t"
+#define DUPLICATE_TABLE_SIZE  256
+#define REPARSE_TABLE_SIZE  64
+#define CHECKPOINT_SPACING  1024
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  One file content already seen this run, with the records its first
+ *  copy produced.
+ */
+typedef struct sDuplicateEntry {
+	unsigned long h1, h2;          /* content key */
+	unsigned long size;
+	char *tagPath;                 /* path written for the first copy */
+	char *records;                 /* its tag lines, newline separated */
+	struct sDuplicateEntry *next;
+} duplicateEntry;
+
+/*  One point during a parse at which no parser, preprocessor or reader
+ *  state was pending: a fresh top-level statement beginning at the start
+ *  of a line. A later parse of the same file whose content up to "offset"
+ *  hashes the same may replay the records captured up to "captured" and
+ *  resume reading at the recorded line instead of starting over.
+ */
+typedef struct sParseCheckpoint {
+	size_t offset;                 /* byte offset of the restart line */
+	unsigned long lineNumber;      /* its one-based line number */
+	size_t captured;               /* capture length before the line */
+	unsigned long h1, h2;          /* hash of content bytes [0, offset) */
+} parseCheckpoint;
+
+/*  The checkpoints and captured records of the last parse of one file,
+ *  kept (in watch mode) so that a subsequent parse of the edited file can
+ *  restart from the last checkpoint its new content still agrees with.
+ */
+typedef struct sReparseEntry {
+	char *fileName;
+	parseCheckpoint *checkpoints;
+	unsigned int checkpointCount;
+	char *records;                 /* captured tag lines of the last parse */
+	struct sReparseEntry *next;
+} reparseEntry;
+
+/*
+*   DATA DEFINITIONS
+*/
+static vString *OptionSignature;  /* options seen on the command line */
+static vString *EntryPath;        /* cache entry for the current file */
+static vString *EntryFileName;    /* source file the entry belongs to */
+static vString *CaptureBuffer;
+static size_t CaptureMark;
+static boolean Capturing;
+static unsigned long KeyH1, KeyH2, KeySize;  /* content key of current file */
+static boolean KeyValid;
+static duplicateEntry *DuplicateTable [DUPLICATE_TABLE_SIZE];
+static reparseEntry *ReparseTable [REPARSE_TABLE_SIZE];
+static parseCheckpoint *CheckpointList;  /* checkpoints of the current parse */
+static unsigned int CheckpointCount;
+static unsigned int CheckpointSlots;
+static boolean CheckpointTracking;
+static size_t CaptureAtLine;     /* capture length when the current line
+                                  * was fetched, before any tag it makes */
+static unsigned long CheckH1, CheckH2;  /* running hash of the input buffer */
+static size_t HashedOffset;             /* number of buffer bytes hashed */
+static reparseEntry *RestartEntry;      /* restart point chosen by */
+static unsigned int RestartIndex;       /* cacheRestartPoint () */
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static boolean cacheUsable (void)
+{
+	/*  Etags output is grouped into per-file sections with byte counts and
+	 *  xref lines carry source text; neither round-trips through the line
+	 *  oriented records stored here, so only regular output is cached.
+	 */
+	return (boolean) (Option.cacheDir != NULL  &&
+					  ! Option.etags  &&  ! Option.xref);
+}
+
+static boolean dedupUsable (void)
+{
+	/*  File name tags (--extra=+f) carry the file's own base name as the
+	 *  tag name, which path substitution alone cannot repair.
+	 */
+	return (boolean) (Option.dedup  &&
+					  ! Option.etags  &&  ! Option.xref  &&
+					  ! Option.include.fileNames);
+}
+
+static boolean reparseUsable (void)
+{
+	/*  Only watch mode parses one file repeatedly within a process. Etags
+	 *  and xref output do not round-trip through captured records, and
+	 *  #line directives carry source positions a restarted read would not
+	 *  reconstruct.
+	 */
+	return (boolean) (Option.watch  &&
+					  ! Option.etags  &&  ! Option.xref  &&
+					  ! Option.lineDirectives);
+}
+
+/*  Feeds "bytes" into two independent running hashes so that the cache
+ *  entry name carries 64 bits of key.
+ */
+static void hashBytes (
+		const char *const bytes, const size_t count,
+		unsigned long *const h1, unsigned long *const h2)
+{
+	size_t i;
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		const unsigned long c = (unsigned long) (unsigned char) bytes [i];
+		*h1 = ((*h1 ^ c) * 16777619UL) & 0xffffffffUL;  /* FNV-1a */
+		*h2 = ((*h2 * 33UL) + c) & 0xffffffffUL;
+	}
+}
+
+static void hashString (
+		const char *const string, unsigned long *const h1, unsigned long *const h2)
+{
+	hashBytes (string, strlen (string) + 1, h1, h2);
+}
+
+/*  Computes the content key for "fileName", hashing the file contents and
+ *  everything else its tag records could depend on apart from the file's
+ *  own path, and derives the cache entry path from it. Returns FALSE if
+ *  the file cannot be read.
+ */
+static boolean computeFileKey (
+		const char *const fileName, const langType language)
+{
+	unsigned long h1 = 2166136261UL;
+	unsigned long h2 = 5381UL;
+	unsigned long size = 0;
+	FILE *const fp = fopen (fileName, "rb");
+	char buffer [4096];
+	size_t count;
+
+	KeyValid = FALSE;
+	if (EntryPath != NULL)
+	{
+		vStringDelete (EntryPath);
+		EntryPath = NULL;
+	}
+	if (fp == NULL)
+		return FALSE;
+	hashString (PROGRAM_VERSION, &h1, &h2);
+	hashString (getLanguageName (language), &h1, &h2);
+	if (OptionSignature != NULL)
+		hashString (vStringValue (OptionSignature), &h1, &h2);
+	while ((count = fread (buffer, (size_t) 1, sizeof buffer, fp)) > 0)
+	{
+		hashBytes (buffer, count, &h1, &h2);
+		size += (unsigned long) count;
+	}
+	fclose (fp);
+	KeyH1 = h1;
+	KeyH2 = h2;
+	KeySize = size;
+	KeyValid = TRUE;
+	if (EntryFileName == NULL)
+		EntryFileName = vStringNew ();
+	vStringCopyS (EntryFileName, fileName);
+
+	if (cacheUsable ())
+	{
+		char tail [20];
+
+		hashString (fileName, &h1, &h2);
+		if (Option.tagRelative  &&  TagFile.directory != NULL)
+			hashString (TagFile.directory, &h1, &h2);
+		sprintf (tail, "%08lx%08lx", h1, h2);
+		EntryPath = combinePathAndFile (Option.cacheDir, tail);
+	}
+	return TRUE;
+}
+
+/*  The path a tag record written for "fileName" names as its source file;
+ *  mirrors setSourceFileParameters (). The result must be eFree'd.
+ */
+static char *writtenTagPath (const char *const fileName)
+{
+	if (Option.tagRelative  &&  ! isAbsolutePath (fileName))
+		return relativeFilename (fileName, TagFile.directory);
+	return eStrdup (fileName);
+}
+
+static duplicateEntry *lookupDuplicate (void)
+{
+	duplicateEntry *entry;
+
+	for (entry = DuplicateTable [KeyH1 % DUPLICATE_TABLE_SIZE]  ;
+		 entry != NULL  ;  entry = entry->next)
+		if (entry->h1 == KeyH1  &&  entry->h2 == KeyH2  &&
+			entry->size == KeySize)
+			break;
+	return entry;
+}
+
+/*  Remembers the records of the file just produced under its content key
+ *  so that an identical copy seen later in the run can reuse them.
+ */
+static void registerDuplicate (const char *const records)
+{
+	duplicateEntry *const entry = xMalloc (1, duplicateEntry);
+
+	entry->h1      = KeyH1;
+	entry->h2      = KeyH2;
+	entry->size    = KeySize;
+	entry->tagPath = writtenTagPath (vStringValue (EntryFileName));
+	entry->records = eStrdup (records);
+	entry->next    = DuplicateTable [KeyH1 % DUPLICATE_TABLE_SIZE];
+	DuplicateTable [KeyH1 % DUPLICATE_TABLE_SIZE] = entry;
+}
+
+/*  Re-emits the records of the first copy with this copy's path put into
+ *  the file field. The pattern field can contain tabs of its own, so only
+ *  the first two fields are split off.
+ */
+static void replayDuplicateRecords (
+		const duplicateEntry *const entry, const char *const fileName)
+{
+	char *const tagPath = writtenTagPath (fileName);
+	const size_t oldLength = strlen (entry->tagPath);
+	vString *const line = vStringNew ();
+	const char *p = entry->records;
+
+	while (*p != '\0')
+	{
+		const char *eol = strchr (p, '\n');
+		const char *tab1, *tab2;
+
+		if (eol == NULL)
+			eol = p + strlen (p);
+		tab1 = memchr (p, '\t', (size_t) (eol - p));
+		tab2 = (tab1 == NULL) ? NULL :
+				memchr (tab1 + 1, '\t', (size_t) (eol - (tab1 + 1)));
+		vStringClear (line);
+		if (tab2 != NULL  &&
+			(size_t) (tab2 - (tab1 + 1)) == oldLength  &&
+			strncmp (tab1 + 1, entry->tagPath, oldLength) == 0)
+		{
+			vStringNCatS (line, p, (size_t) (tab1 + 1 - p));
+			vStringCatS (line, tagPath);
+			vStringNCatS (line, tab2, (size_t) (eol - tab2));
+		}
+		else
+			vStringNCatS (line, p, (size_t) (eol - p));
+		writeCachedTagLine (vStringValue (line));
+		p = (*eol == '\n') ? eol + 1 : eol;
+	}
+	vStringDelete (line);
+	eFree (tagPath);
+}
+
+static reparseEntry *lookupReparseEntry (const char *const fileName)
+{
+	unsigned long h1 = 2166136261UL;
+	unsigned long h2 = 5381UL;
+	reparseEntry *entry;
+
+	hashString (fileName, &h1, &h2);
+	for (entry = ReparseTable [h1 % REPARSE_TABLE_SIZE]  ;
+		 entry != NULL  ;  entry = entry->next)
+		if (strcmp (entry->fileName, fileName) == 0)
+			break;
+	return entry;
+}
+
+/*  Stores the checkpoints and captured records of the parse just finished
+ *  under the file's name, replacing whatever an earlier parse left there.
+ */
+static void registerReparseState (void)
+{
+	const char *const fileName = vStringValue (EntryFileName);
+	reparseEntry *entry = lookupReparseEntry (fileName);
+
+	if (entry == NULL)
+	{
+		unsigned long h1 = 2166136261UL;
+		unsigned long h2 = 5381UL;
+
+		hashString (fileName, &h1, &h2);
+		entry = xMalloc (1, reparseEntry);
+		entry->fileName = eStrdup (fileName);
+		entry->next = ReparseTable [h1 % REPARSE_TABLE_SIZE];
+		ReparseTable [h1 % REPARSE_TABLE_SIZE] = entry;
+	}
+	else
+	{
+		eFree (entry->checkpoints);
+		eFree (entry->records);
+	}
+	entry->checkpoints = xMalloc (CheckpointCount, parseCheckpoint);
+	memcpy (entry->checkpoints, CheckpointList,
+			CheckpointCount * sizeof (parseCheckpoint));
+	entry->checkpointCount = CheckpointCount;
+	entry->records = eStrdup (vStringValue (CaptureBuffer));
+}
+
+/*  Remembers an option so that the cache key reflects the prevailing
+ *  configuration. Options which cannot change what a file's tag records
+ *  look like are left out so that toggling them preserves cache hits.
+ */
+extern void cacheRecordOption (
+		const char *const option, const char *const parameter)
+{
+	/*  The tag file name ("-o", "-f") and the file list ("-L") are left out
+	 *  so that writing to a different location still hits; the output can
+	 *  depend on where the tag file lives only under --tag-relative, which
+	 *  the entry path hash covers separately.
+	 */
+	static const char *const irrelevant [] = {
+		"L", "V", "cache-dir", "checkpoint", "f", "o",
+		"progress", "resume", "stats", "totals", "verbose"
+	};
+	unsigned int i;
+
+	for (i = 0  ;  i < sizeof irrelevant / sizeof irrelevant [0]  ;  ++i)
+		if (strcmp (option, irrelevant [i]) == 0)
+			return;
+	if (OptionSignature == NULL)
+		OptionSignature = vStringNew ();
+	vStringCatS (OptionSignature, option);
+	vStringPut (OptionSignature, '=');
+	if (parameter != NULL)
+		vStringCatS (OptionSignature, parameter);
+	vStringPut (OptionSignature, '\n');
+}
+
+/*  Appends the cached tag records for "fileName" to the tag file, if an
+ *  earlier run cached them or an identical copy was already seen in this
+ *  one. Returns TRUE on a hit. On a miss the content key is left behind
+ *  for a subsequent capture of the parser's output.
+ */
+extern boolean cacheReplayTags (
+		const char *const fileName, const langType language)
+{
+	boolean replayed = FALSE;
+	FILE *fp;
+
+	if (reparseUsable ())
+	{
+		/*  Even without the cache proper, capture runs so that the file can
+		 *  later be reparsed from a checkpoint; remember whose records the
+		 *  capture will hold.
+		 */
+		if (EntryFileName == NULL)
+			EntryFileName = vStringNew ();
+		vStringCopyS (EntryFileName, fileName);
+	}
+	if (! cacheUsable ()  &&  ! dedupUsable ())
+		return FALSE;
+	if (! computeFileKey (fileName, language))
+		return FALSE;
+	fp = (EntryPath == NULL) ? NULL : fopen (vStringValue (EntryPath), "r");
+	if (fp != NULL)
+	{
+		vString *const vLine = vStringNew ();
+		const char *line = readLine (vLine, fp);
+		const size_t prefixLength = strlen (CACHE_HEADER_PREFIX);
+		const size_t nameLength = strlen (fileName);
+
+		/*  The header names the source file, guarding against the remote
+		 *  chance of two files hashing to the same entry. The line carries
+		 *  its newline.
+		 */
+		if (line != NULL  &&
+			strncmp (line, CACHE_HEADER_PREFIX, prefixLength) == 0  &&
+			strncmp (line + prefixLength, fileName, nameLength) == 0  &&
+			line [prefixLength + nameLength] == '\n')
+		{
+			/*  Collect the replayed records too, so that in-run copies of
+			 *  this file need not find their own disk entries.
+			 */
+			const boolean collect =
+					(boolean) (dedupUsable ()  &&  lookupDuplicate () == NULL);
+
+			verbose ("replaying cached tags for %s\n", fileName);
+			if (collect)
+				cacheBeginCapture ();
+			while ((line = readLine (vLine, fp)) != NULL)
+				writeCachedTagLine (line);
+			if (collect)
+			{
+				registerDuplicate (vStringValue (CaptureBuffer));
+				Capturing = FALSE;
+			}
+			replayed = TRUE;
+		}
+		vStringDelete (vLine);
+		fclose (fp);
+	}
+	if (! replayed  &&  dedupUsable ())
+	{
+		const duplicateEntry *const duplicate = lookupDuplicate ();
+
+		if (duplicate != NULL)
+		{
+			verbose ("reusing tags of %s for identical %s\n",
+					duplicate->tagPath, fileName);
+			replayDuplicateRecords (duplicate, fileName);
+			replayed = TRUE;
+		}
+	}
+	return replayed;
+}
+
+extern void cacheBeginCapture (void)
+{
+	CheckpointTracking = reparseUsable ();
+	CheckpointCount = 0;
+	CaptureAtLine = 0;
+	CheckH1 = 2166136261UL;
+	CheckH2 = 5381UL;
+	HashedOffset = 0;
+	if (EntryPath == NULL  &&  ! CheckpointTracking  &&
+		! (dedupUsable ()  &&  KeyValid  &&  lookupDuplicate () == NULL))
+		return;
+	if (CaptureBuffer == NULL)
+		CaptureBuffer = vStringNew ();
+	vStringClear (CaptureBuffer);
+	CaptureMark = 0;
+	Capturing = TRUE;
+}
+
+extern void cacheCaptureTagLine (const char *const line)
+{
+	if (Capturing)
+		vStringCatS (CaptureBuffer, line);
+}
+
+/*  The two functions below shadow the fgetpos ()/fsetpos () pair with which
+ *  the tag file is rewound when a multi-pass parser asks for another pass:
+ *  records discarded from the tag file must leave the capture too.
+ */
+extern void cacheMarkCapture (void)
+{
+	if (Capturing)
+		CaptureMark = vStringLength (CaptureBuffer);
+	/*  A parse that needs more than one pass cannot be resumed from the
+	 *  middle with first-pass semantics; keep no checkpoints for it.
+	 */
+	CheckpointTracking = FALSE;
+	CheckpointCount = 0;
+}
+
+extern void cacheRewindCapture (void)
+{
+	if (Capturing)
+	{
+		CaptureBuffer->length = CaptureMark;
+		vStringTerminate (CaptureBuffer);
+	}
+	CheckpointTracking = FALSE;
+	CheckpointCount = 0;
+}
+
+/*  Discards the capture without registering anything: the record stream of
+ *  a parse that was cut short (per-file time budget) must not stand in for
+ *  the file's full tags in the cache, the duplicate table or the reparse
+ *  state.
+ */
+extern void cacheAbandonCapture (void)
+{
+	Capturing = FALSE;
+	CheckpointTracking = FALSE;
+	CheckpointCount = 0;
+}
+
+/*  Stores the captured records under the entry path computed when the cache
+ *  was consulted. The entry is built in a temporary file and renamed into
+ *  place so that an interrupted run cannot leave a partial entry behind.
+ */
+extern void cacheEndCapture (void)
+{
+	vString *tempName;
+	FILE *fp;
+
+	if (! Capturing)
+		return;
+	Capturing = FALSE;
+	if (CheckpointTracking  &&  CheckpointCount > 0)
+		registerReparseState ();
+	CheckpointTracking = FALSE;
+	if (dedupUsable ()  &&  KeyValid  &&  lookupDuplicate () == NULL)
+		registerDuplicate (vStringValue (CaptureBuffer));
+	if (EntryPath == NULL)
+		return;
+	tempName = vStringNewCopy (EntryPath);
+	vStringCatS (tempName, ".tmp");
+	fp = fopen (vStringValue (tempName), "w");
+	if (fp != NULL)
+	{
+		boolean wrote =
+			(boolean) (fprintf (fp, "%s%s\n", CACHE_HEADER_PREFIX,
+								vStringValue (EntryFileName)) > 0);
+		if (vStringLength (CaptureBuffer) > 0)
+			wrote = (boolean) (wrote  &&
+				fwrite (vStringValue (CaptureBuffer), (size_t) 1,
+						vStringLength (CaptureBuffer), fp)
+					== vStringLength (CaptureBuffer));
+		if (fclose (fp) != 0)
+			wrote = FALSE;
+		if (! wrote  ||
+			rename (vStringValue (tempName), vStringValue (EntryPath)) != 0)
+		{
+			error (WARNING | PERROR, "cannot write cache entry for \"%s\"",
+					vStringValue (EntryFileName));
+			remove (vStringValue (tempName));
+		}
+	}
+	else
+		error (WARNING | PERROR, "cannot write cache entry for \"%s\"",
+				vStringValue (EntryFileName));
+	vStringDelete (tempName);
+}
+
+/*  Notes the start of each fetched input line: the capture length at that
+ *  moment precedes any record the line produces, which is where a
+ *  checkpoint falling on the line must cut the captured records.
+ */
+extern void cacheNoteFetchedLine (void)
+{
+	if (Capturing  &&  CheckpointTracking)
+		CaptureAtLine = vStringLength (CaptureBuffer);
+}
+
+/*  Whether the current parse is recording checkpoints, letting a parser
+ *  skip the lookahead which finding a safe point costs when it is not.
+ */
+extern boolean cacheCheckpointWanted (void)
+{
+	return (boolean) (Capturing  &&  CheckpointTracking);
+}
+
+static void appendCheckpoint (const parseCheckpoint *const cp)
+{
+	if (CheckpointCount == CheckpointSlots)
+	{
+		CheckpointSlots = (CheckpointSlots == 0) ? 16 : 2 * CheckpointSlots;
+		CheckpointList = xRealloc (CheckpointList, CheckpointSlots,
+				parseCheckpoint);
+	}
+	CheckpointList [CheckpointCount++] = *cp;
+}
+
+/*  Records a parse checkpoint at the line holding the character "c": the
+ *  first code character of a fresh top-level statement, just consumed from
+ *  the input buffer and about to be given back to it. The checkpoint is
+ *  declined unless the statement is all the line holds so far, so that
+ *  resuming at the start of the line re-reads nothing already parsed.
+ */
+extern void cacheParseCheckpoint (const int c)
+{
+	const unsigned char *lineStart;
+	const unsigned char *p;
+	parseCheckpoint checkpoint;
+	size_t offset;
+
+	if (! Capturing  ||  ! CheckpointTracking)
+		return;
+	if (File.line == NULL  ||  File.currentLine == NULL)
+		return;
+	lineStart = (const unsigned char *) vStringValue (File.line);
+	if (File.currentLine <= lineStart  ||  File.currentLine [-1] != c)
+		return;
+	for (p = lineStart  ;  p < File.currentLine - 1  ;  ++p)
+		if (! isspace ((int) *p))
+			return;
+	offset = (size_t) File.filePosition;
+	if (offset > File.bufferSize  ||  offset < HashedOffset)
+		return;
+	if (CheckpointCount > 0  &&
+		offset - CheckpointList [CheckpointCount - 1].offset
+			< CHECKPOINT_SPACING)
+		return;
+	hashBytes ((const char *) File.buffer + HashedOffset,
+			offset - HashedOffset, &CheckH1, &CheckH2);
+	HashedOffset = offset;
+	checkpoint.offset     = offset;
+	checkpoint.lineNumber = File.lineNumber;
+	checkpoint.captured   = CaptureAtLine;
+	checkpoint.h1         = CheckH1;
+	checkpoint.h2         = CheckH2;
+	appendCheckpoint (&checkpoint);
+}
+
+/*  Whether an earlier parse of "fileName" left checkpoints to resume from.
+ */
+extern boolean cacheHasReparseState (const char *const fileName)
+{
+	return (boolean) (reparseUsable ()  &&
+					  lookupReparseEntry (fileName) != NULL);
+}
+
+/*  Chooses the last checkpoint of the previous parse of "fileName" still
+ *  valid for the content now in the input buffer, i.e. whose prefix hash
+ *  the new content reproduces. Returns FALSE when none survives; on
+ *  success the restart line is handed back and the chosen checkpoint is
+ *  held for cacheReplayPrefix ().
+ */
+extern boolean cacheRestartPoint (const char *const fileName,
+		filePos *const offset, unsigned long *const lineNumber)
+{
+	reparseEntry *const entry = lookupReparseEntry (fileName);
+	unsigned long h1 = 2166136261UL;
+	unsigned long h2 = 5381UL;
+	size_t hashed = 0;
+	long best = -1;
+	unsigned int i;
+
+	RestartEntry = NULL;
+	if (entry == NULL  ||  ! reparseUsable ())
+		return FALSE;
+	for (i = 0  ;  i < entry->checkpointCount  ;  ++i)
+	{
+		const parseCheckpoint *const cp = &entry->checkpoints [i];
+
+		if (cp->offset > File.bufferSize)
+			break;
+		hashBytes ((const char *) File.buffer + hashed,
+				cp->offset - hashed, &h1, &h2);
+		hashed = cp->offset;
+		if (h1 != cp->h1  ||  h2 != cp->h2)
+			break;  /* content differs before this point, so also after */
+		best = (long) i;
+	}
+	if (best < 0)
+		return FALSE;
+	RestartEntry = entry;
+	RestartIndex = (unsigned int) best;
+	*offset = (filePos) entry->checkpoints [RestartIndex].offset;
+	*lineNumber = entry->checkpoints [RestartIndex].lineNumber;
+	return TRUE;
+}
+
+/*  Re-emits the records captured before the chosen checkpoint. The writer
+ *  feeds each line back through the capture, so the new capture stays
+ *  aligned with the checkpoints carried over from the old one.
+ */
+extern void cacheReplayPrefix (void)
+{
+	const parseCheckpoint *const cp =
+			&RestartEntry->checkpoints [RestartIndex];
+	vString *const line = vStringNew ();
+	const char *p = RestartEntry->records;
+	const char *const end = p + cp->captured;
+	unsigned int i;
+
+	while (p < end)
+	{
+		const char *eol = memchr (p, '\n', (size_t) (end - p));
+
+		if (eol == NULL)
+			eol = end;
+		vStringClear (line);
+		vStringNCatS (line, p, (size_t) (eol - p));
+		writeCachedTagLine (vStringValue (line));
+		p = (eol < end) ? eol + 1 : end;
+	}
+	vStringDelete (line);
+
+	/*  The checkpoints up to the restart remain valid for the content just
+	 *  opened; carry them over so that a later edit further up the file
+	 *  can still restart early.
+	 */
+	for (i = 0  ;  i <= RestartIndex  ;  ++i)
+		appendCheckpoint (&RestartEntry->checkpoints [i]);
+	CheckH1 = cp->h1;
+	CheckH2 = cp->h2;
+	HashedOffset = cp->offset;
+	RestartEntry = NULL;
+}
+
+extern void freeCacheResources (void)
+{
+	unsigned int i;
+
+	if (OptionSignature != NULL)
+		vStringDelete (OptionSignature);
+	OptionSignature = NULL;
+	if (EntryPath != NULL)
+		vStringDelete (EntryPath);
+	EntryPath = NULL;
+	if (EntryFileName != NULL)
+		vStringDelete (EntryFileName);
+	EntryFileName = NULL;
+	if (CaptureBuffer != NULL)
+		vStringDelete (CaptureBuffer);
+	CaptureBuffer = NULL;
+	for (i = 0  ;  i < DUPLICATE_TABLE_SIZE  ;  ++i)
+	{
+		while (DuplicateTable [i] != NULL)
+		{
+			duplicateEntry *const entry = DuplicateTable [i];
+
+			DuplicateTable [i] = entry->next;
+			eFree (entry->tagPath);
+			eFree (entry->records);
+			eFree (entry);
+		}
+	}
+	for (i = 0  ;  i < REPARSE_TABLE_SIZE  ;  ++i)
+	{
+		while (ReparseTable [i] != NULL)
+		{
+			reparseEntry *const entry = ReparseTable [i];
+
+			ReparseTable [i] = entry->next;
+			eFree (entry->fileName);
+			eFree (entry->checkpoints);
+			eFree (entry->records);
+			eFree (entry);
+		}
+	}
+	if (CheckpointList != NULL)
+		eFree (CheckpointList);
+	CheckpointList = NULL;
+	CheckpointSlots = 0;
+	CheckpointCount = 0;
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -0,0 +1,43 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to cache.c
+*/
+#ifndef _CACHE_H
+#define _CACHE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "parse.h"  /* to declare langType */
+#include "read.h"   /* to declare filePos */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void cacheRecordOption (const char *const option, const char *const parameter);
+extern boolean cacheReplayTags (const char *const fileName, const langType language);
+extern void cacheBeginCapture (void);
+extern void cacheCaptureTagLine (const char *const line);
+extern void cacheMarkCapture (void);
+extern void cacheRewindCapture (void);
+extern void cacheAbandonCapture (void);
+extern void cacheEndCapture (void);
+extern void cacheNoteFetchedLine (void);
+extern boolean cacheCheckpointWanted (void);
+extern void cacheParseCheckpoint (const int c);
+extern boolean cacheHasReparseState (const char *const fileName);
+extern boolean cacheRestartPoint (const char *const fileName, filePos *const offset, unsigned long *const lineNumber);
+extern void cacheReplayPrefix (void);
+extern void freeCacheResources (void);
+
+#endif  /* _CACHE_H */
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -14,36 +14,184 @@
 *   INCLUDE FILES
 */
 #include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <ctype.h>
+
 #include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_DATA,
+	K_FILE,
+	K_GROUP,
+	K_PARAGRAPH,
+	K_PROGRAM,
+	K_SECTION
+} cobolKind;
+
+static kindOption CobolKinds [] = {
+	{ TRUE, 'd', "data",      "data items" },
+	{ TRUE, 'f', "file",      "file descriptions (FD, SD, RD)" },
+	{ TRUE, 'g', "group",     "group items" },
+	{ TRUE, 'p', "paragraph", "paragraphs" },
+	{ TRUE, 'P', "program",   "program ids" },
+	{ TRUE, 's', "section",   "sections" }
+};
+
+/*  The clauses which mark a level-numbered entry as an elementary data
+ *  item; a prefix match suffices (e.g. "PICTURE" begins with "PIC").
+ */
+static const char *const DataClauses [] = {
+	"BLANK", "OCCURS", "IS", "JUST", "PIC", "REDEFINES", "RENAMES",
+	"SIGN", "SYNC", "USAGE", "VALUE"
+};
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static void installCobolRegex (const langType language)
+static boolean isNameChar (const int c)
+{
+	return (boolean) (isalnum (c)  ||  c == '-');
+}
+
+static boolean isBlank (const int c)
+{
+	return (boolean) (c == ' '  ||  c == '\t');
+}
+
+static const unsigned char *skipBlanks (const unsigned char *cp)
 {
-   addTagRegex (language, "^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)[ \t]+(BLANK|OCCURS|IS|JUST|PIC|REDEFINES|RENAMES|SIGN|SYNC|USAGE|VALUE)",
-		"\\1", "d,data,data items", "i");
-	addTagRegex (language, "^[ \t]*[FSR]D[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
-		"\\1", "f,file,file descriptions (FD, SD, RD)", "i");
-	addTagRegex (language, "^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
-		"\\1", "g,group,group items", "i");
-	addTagRegex (language, "^[ \t]*([A-Z0-9][A-Z0-9-]*)\\.",
-		"\\1", "p,paragraph,paragraphs", "i");
-	addTagRegex (language, "^[ \t]*PROGRAM-ID\\.[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
-		"\\1", "P,program,program ids", "i");
-	addTagRegex (language, "^[ \t]*([A-Z0-9][A-Z0-9-]*)[ \t]+SECTION\\.",
-		"\\1", "s,section,sections", "i");
+	while (isBlank ((int) *cp))
+		++cp;
+	return cp;
+}
+
+/*  Reads a COBOL word (alphanumeric start, then alphanumerics and '-')
+ *  into "name", returning the position just past it.
+ */
+static const unsigned char *readName (
+		const unsigned char *cp, vString *const name)
+{
+	vStringClear (name);
+	if (isalnum ((int) *cp))
+	{
+		do
+		{
+			vStringPut (name, (int) *cp);
+			++cp;
+		} while (isNameChar ((int) *cp));
+	}
+	vStringTerminate (name);
+	return cp;
+}
+
+static boolean isDataClause (const unsigned char *cp)
+{
+	unsigned int i;
+	for (i = 0  ;  i < sizeof DataClauses / sizeof DataClauses [0]  ;  ++i)
+	{
+		if (strncasecmp ((const char *) cp, DataClauses [i],
+						 strlen (DataClauses [i])) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void findCobolTags (void)
+{
+	vString *const name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		const unsigned char *const cp = skipBlanks (line);
+		const unsigned char *p;
+
+		/*  A level number introduces either an elementary data item (a
+		 *  clause keyword follows the name) or a group item (a period
+		 *  follows directly).
+		 */
+		if (isdigit ((int) *cp))
+		{
+			p = cp;
+			do
+				++p;
+			while (isdigit ((int) *p));
+			if (isBlank ((int) *p))
+			{
+				const unsigned char *const past = readName (skipBlanks (p), name);
+				if (vStringLength (name) > 0)
+				{
+					if (isBlank ((int) *past)  &&
+						isDataClause (skipBlanks (past)))
+						makeSimpleTag (name, CobolKinds, K_DATA);
+					else if (*past == '.')
+						makeSimpleTag (name, CobolKinds, K_GROUP);
+				}
+			}
+		}
+
+		/*  File descriptions: FD, SD or RD followed by a name and period.
+		 */
+		if ((toupper ((int) cp [0]) == 'F'  ||  toupper ((int) cp [0]) == 'S'
+			 ||  toupper ((int) cp [0]) == 'R')  &&
+			toupper ((int) cp [1]) == 'D'  &&  isBlank ((int) cp [2]))
+		{
+			p = readName (skipBlanks (cp + 2), name);
+			if (vStringLength (name) > 0  &&  *p == '.')
+				makeSimpleTag (name, CobolKinds, K_FILE);
+		}
+
+		/*  A word at the start of the area followed directly by a period
+		 *  is a paragraph; this deliberately also fires on lines like
+		 *  "PROGRAM-ID.", as the old pattern did.
+		 */
+		p = readName (cp, name);
+		if (vStringLength (name) > 0)
+		{
+			if (*p == '.')
+			{
+				makeSimpleTag (name, CobolKinds, K_PARAGRAPH);
+				if (strcasecmp (vStringValue (name), "PROGRAM-ID") == 0)
+				{
+					const unsigned char *after = p + 1;
+					if (isBlank ((int) *after))
+					{
+						after = readName (skipBlanks (after), name);
+						if (vStringLength (name) > 0  &&  *after == '.')
+							makeSimpleTag (name, CobolKinds, K_PROGRAM);
+					}
+				}
+			}
+			else if (isBlank ((int) *p))
+			{
+				/*  Sections: a word, then the SECTION keyword and period.
+				 */
+				p = skipBlanks (p);
+				if (strncasecmp ((const char *) p, "SECTION", (size_t) 7) == 0
+					&&  p [7] == '.')
+					makeSimpleTag (name, CobolKinds, K_SECTION);
+			}
+		}
+	}
+	vStringDelete (name);
 }
 
-extern parserDefinition* CobolParser ()
+extern parserDefinition* CobolParser (void)
 {
 	static const char *const extensions [] = {
 			"cbl", "cob", "CBL", "COB", NULL };
 	parserDefinition* def = parserNew ("Cobol");
+	def->kinds      = CobolKinds;
+	def->kindCount  = KIND_COUNT (CobolKinds);
 	def->extensions = extensions;
-	def->initialize = installCobolRegex;
-	def->regex      = TRUE;
+	def->parser     = findCobolTags;
 	return def;
 }
 
@@ -0,0 +1,72 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for creating and switching parser
+*   contexts, each bundling the input file and tag file state that was
+*   previously held in process-wide variables.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "context.h"
+#include "debug.h"
+#include "routines.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/*  The context most recently activated, or NULL while the built-in
+ *  default state in read.c and entry.c is in effect.
+ */
+static parserContext *ActiveContext = NULL;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern parserContext *newParserContext (void)
+{
+	parserContext *const context = xMalloc (1, parserContext);
+
+	memset (context, 0, sizeof (parserContext));
+	return context;
+}
+
+/*  The context must not be active, and any resources held by its members
+ *  (open streams, allocated buffers) must already have been released
+ *  through the usual close and free routines while it was active.
+ */
+extern void deleteParserContext (parserContext *const context)
+{
+	Assert (context != ActiveContext);
+	eFree (context);
+}
+
+/*  Makes the given context the one read and written through "File" and
+ *  "TagFile", returning the previously active context (NULL if it was
+ *  the built-in default, which a NULL argument restores).  Contexts may
+ *  only be switched between files; state private to the reader and the
+ *  individual parsers is not carried by the context.
+ */
+extern parserContext *activateParserContext (parserContext *const context)
+{
+	parserContext *const previous = ActiveContext;
+
+	setInputContext ((context != NULL) ? &context->input : NULL);
+	setTagContext ((context != NULL) ? &context->output : NULL);
+	ActiveContext = context;
+	return previous;
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -0,0 +1,46 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to context.c
+*/
+#ifndef _CONTEXT_H
+#define _CONTEXT_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "entry.h"  /* to define tagFile */
+#include "read.h"   /* to define inputFile */
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Bundles the state of one parser instance: the source file being read
+ *  and the tag file being written.  The modules keep naming the active
+ *  state "File" and "TagFile"; those names now resolve through context
+ *  pointers, so several instances can coexist in one process and be
+ *  switched between files.
+ */
+typedef struct sParserContext {
+	inputFile input;  /* state of the source file being read */
+	tagFile output;   /* state of the tag file being written */
+} parserContext;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern parserContext *newParserContext (void);
+extern void deleteParserContext (parserContext *const context);
+extern parserContext *activateParserContext (parserContext *const context);
+
+#endif  /* _CONTEXT_H */
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -150,49 +150,83 @@ static CssParserState parseCssLine( const unsigned char *line, CssParserState st
           state = P_STATE_IN_COMMENT;
       break;
       case P_STATE_IN_COMMENT:
-        if( *line == '/' && *(line-1) == '*')
-          state = P_STATE_NONE;
+      {
+        // jump to the comment terminator instead of looking at every char
+        const unsigned char *p = (const unsigned char *)
+            strchr( (const char *) line, '/' );
+        while( p != NULL && *(p-1) != '*' )
+          p = (const unsigned char *) strchr( (const char *) p + 1, '/' );
+        if( p == NULL )
+          return state;
+        line = p;
+        state = P_STATE_NONE;
+      }
       break;
-      case  P_STATE_IN_SINGLE_STRING: 
-        if( *line == '\'' && *(line-1) != '\\' )
-          state = P_STATE_IN_DEFINITION; // PAGE, FONTFACE and DEFINITION are treated the same way
+      case  P_STATE_IN_SINGLE_STRING:
+      {
+        const unsigned char *p = (const unsigned char *)
+            strchr( (const char *) line, '\'' );
+        while( p != NULL && *(p-1) == '\\' )
+          p = (const unsigned char *) strchr( (const char *) p + 1, '\'' );
+        if( p == NULL )
+          return state;
+        line = p;
+        state = P_STATE_IN_DEFINITION; // PAGE, FONTFACE and DEFINITION are treated the same way
+      }
       break;
       case  P_STATE_IN_DOUBLE_STRING:
-        if( *line=='"' && *(line-1) != '\\' )
-          state = P_STATE_IN_DEFINITION; // PAGE, FONTFACE and DEFINITION are treated the same way
+      {
+        const unsigned char *p = (const unsigned char *)
+            strchr( (const char *) line, '"' );
+        while( p != NULL && *(p-1) == '\\' )
+          p = (const unsigned char *) strchr( (const char *) p + 1, '"' );
+        if( p == NULL )
+          return state;
+        line = p;
+        state = P_STATE_IN_DEFINITION; // PAGE, FONTFACE and DEFINITION are treated the same way
+      }
       break;
       case  P_STATE_IN_MEDIA:
+      {
         // skip to start of media body or line end
-        while( *line != '{' )
-        {
-          if( *line == '\0' )
-            break;
-          ++line;
-        }
-        if( *line == '{' )
-            state = P_STATE_NONE;
+        const unsigned char *p = (const unsigned char *)
+            strchr( (const char *) line, '{' );
+        if( p == NULL )
+          return state;
+        line = p;
+        state = P_STATE_NONE;
+      }
       break;
       case  P_STATE_IN_IMPORT:
       case  P_STATE_IN_NAMESPACE:
+      {
         // skip to end of declaration or line end
-        while( *line != ';' )
-        {
-          if( *line == '\0' )
-            break;
-          ++line;
-        }
-        if( *line == ';' )
-          state = P_STATE_NONE;
+        const unsigned char *p = (const unsigned char *)
+            strchr( (const char *) line, ';' );
+        if( p == NULL )
+          return state;
+        line = p;
+        state = P_STATE_NONE;
+      }
       break;
       case P_STATE_IN_PAGE:
       case P_STATE_IN_FONTFACE:
       case P_STATE_IN_DEFINITION:
+      {
+        // nothing inside a declaration body matters until the closing
+        // brace or a quote; jump there wholesale
+        const unsigned char *p = (const unsigned char *)
+            strpbrk( (const char *) line, "}'\"" );
+        if( p == NULL )
+          return state;
+        line = p;
         if( *line == '}' )
           state = P_STATE_NONE;
         else if( *line == '\'' )
           state = P_STATE_IN_SINGLE_STRING;
-        else if( *line == '"' )
+        else // '"'
           state = P_STATE_IN_DOUBLE_STRING;
+      }
       break;
       case P_STATE_AT_END:
         return state;
@@ -16,15 +16,104 @@
 
 #include <ctype.h>
 #include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_GETTIMEOFDAY
+# include <sys/time.h>
+#endif
 
 #include "debug.h"
 #include "options.h"
 #include "read.h"
 
+/*
+*   MACROS
+*/
+#define TRACE_RING_SIZE    512  /* events retained; must be a power of two */
+#define TRACE_DETAIL_SIZE  60
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/*  One recorded trace event. The detail is copied rather than referenced,
+ *  since the strings traced (file names, mostly) are freed long before
+ *  any dump is taken.
+ */
+typedef struct sTraceRecord {
+	enum eTraceEvents event;
+	unsigned long sec, usec;  /* wall clock when the event was recorded */
+	unsigned long value;
+	char detail [TRACE_DETAIL_SIZE];
+} traceRecord;
+
+static traceRecord TraceRing [TRACE_RING_SIZE];
+static volatile unsigned long TraceCount = 0;  /* events recorded so far */
+
 /*
 *   FUNCTION DEFINITIONS
 */
 
+/*  Records one event in the trace ring, overwriting the oldest once the
+ *  ring is full. The count is advanced only after the record is complete,
+ *  so a dump taken from a signal handler never formats the half-written
+ *  newest record (though the oldest may be mid-overwrite once wrapped).
+ */
+extern void traceEvent (
+		const enum eTraceEvents event, const char *const detail,
+		const unsigned long value)
+{
+	traceRecord *const record = &TraceRing [TraceCount % TRACE_RING_SIZE];
+
+	record->event = event;
+	record->value = value;
+#ifdef HAVE_GETTIMEOFDAY
+	{
+		struct timeval tv;
+		gettimeofday (&tv, NULL);
+		record->sec  = (unsigned long) tv.tv_sec;
+		record->usec = (unsigned long) tv.tv_usec;
+	}
+#else
+	record->sec  = (unsigned long) time (NULL);
+	record->usec = 0;
+#endif
+	if (detail == NULL)
+		record->detail [0] = '\0';
+	else
+	{
+		strncpy (record->detail, detail, sizeof record->detail - 1);
+		record->detail [sizeof record->detail - 1] = '\0';
+	}
+	++TraceCount;
+}
+
+/*  Formats the retained events, oldest first. Safe to call from a signal
+ *  handler interrupting a stalled run: it reads the ring without
+ *  modifying it.
+ */
+extern void traceDump (FILE *const fp)
+{
+	static const char *const eventNames [] = {
+		"open", "begin", "end", "slow"
+	};
+	const unsigned long count = TraceCount;
+	unsigned long i = (count > TRACE_RING_SIZE) ? count - TRACE_RING_SIZE : 0;
+
+	fprintf (fp, "trace: %lu events recorded, newest last\n", count);
+	for ( ;  i < count  ;  ++i)
+	{
+		const traceRecord *const record = &TraceRing [i % TRACE_RING_SIZE];
+
+		fprintf (fp, "  %lu.%06lu %-5s %s", record->sec, record->usec,
+				eventNames [record->event], record->detail);
+		if (record->event == TRACE_PARSER_END)
+			fprintf (fp, " (%lu tags)", record->value);
+		fputc ('\n', fp);
+	}
+	fflush (fp);
+}
+
 #ifdef DEBUG
 
 extern void lineBreak (void) {}  /* provides a line-specified break point */
@@ -54,9 +54,23 @@ enum eDebugLevels {
 	DEBUG_RAW    = 0x20   /* echo raw (filtered) characters */
 };
 
+/*  Events recorded in the trace ring. Unlike the debugging levels above,
+ *  tracing is compiled into every build: recording an event is a handful
+ *  of stores into a fixed ring, cheap enough to leave on in production
+ *  and read back only when a run needs diagnosing.
+ */
+enum eTraceEvents {
+	TRACE_FILE_OPENED,   /* a source file was opened for reading */
+	TRACE_PARSER_BEGIN,  /* a language parser started on the file */
+	TRACE_PARSER_END,    /* the parser finished; value is tags made */
+	TRACE_SLOW_PATH      /* an expensive fallback was taken */
+};
+
 /*
 *   Function prototypes
 */
+extern void traceEvent (const enum eTraceEvents event, const char *const detail, const unsigned long value);
+extern void traceDump (FILE *const fp);
 extern void lineBreak (void);
 extern void debugPrintf (const enum eDebugLevels level, const char *const format, ...) __printf__ (2, 3);
 extern void debugPutc (const int level, const int c);
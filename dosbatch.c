@@ -1,42 +1,108 @@
-/*
-*   $Id$
-*
-*   Copyright (c) 2009, David Fishburn
-*
-*   This source code is released for free distribution under the terms of the
-*   GNU General Public License.
-*
-*   This module contains functions for generating tags for DOS Batch language files.
-*/
-
-/*
-*   INCLUDE FILES
-*/
-#include "general.h"  /* must always come first */
-
-#include <string.h>
-#include "parse.h"
-
-/*
-*   FUNCTION DEFINITIONS
-*/
-
-static void installDosBatchRegex (const langType language)
-{
-	addTagRegex (language,
-		"^:([A-Za-z_0-9]+)", "\\1", "l,label,labels", NULL);
-	addTagRegex (language,
-		"set[ \t]+([A-Za-z_0-9]+)[ \t]*=", "\\1", "v,variable,variables", NULL);
-}
-
-extern parserDefinition* DosBatchParser ()
-{
-	static const char *const extensions [] = { "bat", "cmd", NULL };
-	parserDefinition* const def = parserNew ("DosBatch");
-	def->extensions = extensions;
-	def->initialize = installDosBatchRegex;
-	def->regex      = TRUE;
-	return def;
-}
-
-/* vi:set tabstop=4 shiftwidth=4: */
+/*
+*   $Id$
+*
+*   Copyright (c) 2009, David Fishburn
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for generating tags for DOS Batch language files.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_LABEL, K_VARIABLE
+} dosBatchKind;
+
+static kindOption DosBatchKinds [] = {
+	{ TRUE, 'l', "label",    "labels"},
+	{ TRUE, 'v', "variable", "variables"}
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static boolean isIdentChar (const int c)
+{
+	return (boolean) (isalnum (c)  ||  c == '_');
+}
+
+static void findDosBatchTags (void)
+{
+	vString *name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		const char *cp = (const char *) line;
+		const char *p;
+
+		if (*cp == ':')
+		{
+			const char *const start = cp + 1;
+			for (p = start  ;  isIdentChar ((unsigned char) *p)  ;  ++p)
+				;
+			if (p > start)
+			{
+				vStringNCopyS (name, start, (size_t) (p - start));
+				makeSimpleTag (name, DosBatchKinds, K_LABEL);
+			}
+		}
+
+		/*  A "set" anywhere on the line, as with the unanchored pattern
+		 *  this replaces (so it also fires inside words like "offset").
+		 */
+		for (p = strstr (cp, "set")  ;  p != NULL  ;  p = strstr (p + 1, "set"))
+		{
+			const char *start = p + 3;
+			const char *end;
+			const char *rest;
+
+			if (*start != ' '  &&  *start != '\t')
+				continue;
+			while (*start == ' '  ||  *start == '\t')
+				++start;
+			for (end = start  ;  isIdentChar ((unsigned char) *end)  ;  ++end)
+				;
+			if (end == start)
+				continue;
+			rest = end;
+			while (*rest == ' '  ||  *rest == '\t')
+				++rest;
+			if (*rest == '=')
+			{
+				vStringNCopyS (name, start, (size_t) (end - start));
+				makeSimpleTag (name, DosBatchKinds, K_VARIABLE);
+				break;  /* one leftmost match per line, as before */
+			}
+		}
+	}
+	vStringDelete (name);
+}
+
+extern parserDefinition* DosBatchParser ()
+{
+	static const char *const extensions [] = { "bat", "cmd", NULL };
+	parserDefinition* const def = parserNew ("DosBatch");
+	def->extensions = extensions;
+	def->kinds      = DosBatchKinds;
+	def->kindCount  = KIND_COUNT (DosBatchKinds);
+	def->parser     = findDosBatchTags;
+	return def;
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
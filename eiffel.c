@@ -223,6 +223,7 @@ static void buildEiffelKeywordHash (void)
 	const size_t count = sizeof (EiffelKeywordTable) /
 						 sizeof (EiffelKeywordTable [0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_eiffel);
 	for (i = 0  ;  i < count  ;  ++i)
 	{
 		const keywordDesc* const p = &EiffelKeywordTable [i];
@@ -372,14 +373,7 @@ static void makeEiffelLocalTag (tokenInfo *const token)
 
 static int skipToCharacter (const int c)
 {
-	int d;
-
-	do
-	{
-		d = fileGetc ();
-	} while (d != EOF  &&  d != c);
-
-	return d;
+	return fileSkipToCharacter (c);
 }
 
 /*  If a numeric is passed in 'c', this is used as the first digit of the
@@ -807,7 +801,7 @@ static void findKeyword (tokenInfo *const token, const keywordId keyword)
 
 static boolean parseType (tokenInfo *const token);
 
-static void parseGeneric (tokenInfo *const token, boolean declaration __unused__)
+static void parseGeneric (tokenInfo *const token, boolean declaration __ctags_unused__)
 {
 	unsigned int depth = 0;
 #ifdef TYPE_REFERENCE_TOOL
@@ -38,9 +38,19 @@
 # include <io.h>
 #endif
 
+#ifdef HAVE_ZLIB_H
+# include <zlib.h>        /* to compress tag file blocks (--compress) */
+#endif
+
+#ifdef HAVE_SQLITE3_H
+# include <sqlite3.h>     /* to write tags into a database (--database) */
+#endif
+
+#include "cache.h"
 #include "debug.h"
 #include "ctags.h"
 #include "entry.h"
+#include "journal.h"
 #include "main.h"
 #include "options.h"
 #include "read.h"
@@ -48,10 +58,31 @@
 #include "sort.h"
 #include "strlist.h"
 
+/*  These are provided by the readtags library (see readtags.c). Its header
+ *  cannot be included here because it reuses the identifiers sortType and
+ *  tagFile for its own purposes.
+ */
+extern int tagsWriteIndex (const char *const tagFilePath);
+extern void tagsRemoveIndex (const char *const tagFilePath);
+extern int tagsWriteTrigramIndex (const char *const tagFilePath);
+extern void tagsRemoveTrigramIndex (const char *const tagFilePath);
+extern int tagsWriteFileMap (const char *const tagFilePath);
+extern void tagsRemoveFileMap (const char *const tagFilePath);
+
 /*
 *   MACROS
 */
 #define PSEUDO_TAG_PREFIX       "!_"
+#define MTIME_PSEUDO_TAG        "TAG_FILE_MTIME"
+#define JOURNAL_PSEUDO_TAG      "TAG_JOURNAL_FILE"
+#define BLOCK_PSEUDO_TAG        "TAG_BLOCK"
+#define COMPRESSED_PSEUDO_TAG   "TAG_COMPRESSED"
+
+/*  Uncompressed bytes gathered into each compressed block (--compress). */
+#define TAGS_BLOCK_SIZE         0x10000
+
+/*  Size of the stdio buffer placed on the tag output stream. */
+#define TAG_OUTPUT_BUFFER_SIZE  0x10000
 
 #define includeExtensionFlags()         (Option.tagFileFormat > 1)
 
@@ -75,18 +106,132 @@
 *   DATA DEFINITIONS
 */
 
-tagFile TagFile = {
+/*  The built-in tag file state, in effect until a parser context is
+ *  activated.  All access goes through CurrentTagFile (as "TagFile").
+ */
+static tagFile DefaultTagFile = {
     NULL,               /* tag file name */
     NULL,               /* tag file directory (absolute) */
     NULL,               /* file pointer */
     { 0, 0 },           /* numTags */
     { 0, 0, 0 },        /* max */
-    { NULL, NULL, 0 },  /* etags */
+    { NULL, 0 },        /* etags */
     NULL                /* vLine */
 };
 
+tagFile *CurrentTagFile = &DefaultTagFile;
+
 static boolean TagsToStdout = FALSE;
 
+/*  Set when tags are written straight to stdout with no spool file; this
+ *  happens whenever the destination is stdout and sorting is disabled, so
+ *  that pipeline consumers see entries as they are made and memory use
+ *  stays constant.
+ */
+static boolean StreamingTags = FALSE;
+
+/*  Buffer in which each ctags-format entry is assembled before being
+ *  written to the tag file in a single call.
+ */
+static vString *TagEntryBuffer = NULL;
+
+/*  Source files recorded in the previous tag file which are unchanged on
+ *  disk; their old entries are carried over and they are not reparsed.
+ */
+static stringList *UnchangedFiles = NULL;
+
+/*  When set, completed tag entries are handed to this function instead of
+ *  being formatted into the tag file (see parseBuffer ()).
+ */
+static tagEntryFunction EntryFunction = NULL;
+static void *EntryClientData = NULL;
+
+/*  Tag lines already written for the current source file, kept while
+ *  --unique is on.  A bloom filter answers most probes without any lookup;
+ *  hash chains over stored copies give the exact answer when the filter
+ *  cannot rule a line out.
+ */
+#define UNIQUE_BLOOM_SIZE 0x4000    /* bytes of filter; 8 bits each */
+#define UNIQUE_HASH_SIZE  1024
+
+typedef struct sUniqueEntry {
+	struct sUniqueEntry *next;
+	char *line;
+} uniqueEntry;
+
+static unsigned char *UniqueBloom = NULL;
+static uniqueEntry *UniqueTable [UNIQUE_HASH_SIZE];
+
+/*  State for merging tags appended to an already sorted file: where the
+ *  appended region begins, and which source files were tagged during this
+ *  run so that their old entries can be dropped.
+ */
+static struct sAppendMerge {
+	boolean possible;      /* existing file sorted in the requested order? */
+	long offset;           /* file offset where appended tags begin */
+	stringList *files;     /* source files tagged during this run */
+	const char *lastFile;  /* most recently recorded name (interned) */
+} AppendMerge = { FALSE, 0L, NULL, NULL };
+
+/*  Number of source files recorded as completed in the checkpoint file of
+ *  an interrupted run being continued with --resume.
+ */
+static unsigned long ResumedFiles = 0;
+
+#ifdef HAVE_SQLITE3_H
+
+/*  Open handle of the tag database written by --database, and the insert
+ *  statement prepared once and rebound for every entry.
+ */
+static sqlite3 *Database = NULL;
+static sqlite3_stmt *DatabaseInsert = NULL;
+
+/*  Highest row present when the current source file began, so that rows
+ *  made by a failed parsing pass can be discarded before the rescan.
+ */
+static sqlite3_int64 DatabaseMark = 0;
+
+#endif
+
+/*  Identifier assigned to the source file most recently named in the
+ *  binary output stream, and the name it was assigned for.
+ */
+static unsigned long BinaryPathCount = 0;
+static vString *BinaryLastPath = NULL;
+
+/*  Output state remembered by markTagOutput () so that a failed parsing
+ *  pass can be unwound before the file is rescanned.
+ */
+static fpos_t OutputFileMark;
+static unsigned long BinaryPathMark = 0;
+
+#ifdef PIPED_SORT_SUPPORTED
+
+/*  When the sorted tag file is produced by streaming records into a sort
+ *  process (see openTagFile), SortPipe feeds that process and TagFile.fp
+ *  is a small spool rewound after every source file, so that a failed
+ *  parsing pass can still be unwound by file position.
+ */
+static FILE *SortPipe = NULL;
+static char *SpoolName = NULL;
+
+#endif
+
+/*  Output streams for --split-output=by-language.  Each receives copies
+ *  of the formatted tag lines of one language alongside the combined tag
+ *  file, and is sorted independently when the tag file is closed.
+ */
+typedef struct sSplitStream {
+	char *name;              /* name of this tag file: "<tags>-<language>" */
+	char *language;          /* language whose tags it receives */
+	FILE *fp;
+	fpos_t mark;             /* position restored by rewindTagOutput () */
+	struct sSplitStream *next;
+} splitStream;
+
+static splitStream *SplitStreams = NULL;
+static splitStream *CurrentSplit = NULL;
+
 /*
 *   FUNCTION PROTOTYPES
 */
@@ -94,6 +239,15 @@ static boolean TagsToStdout = FALSE;
 extern int truncate (const char *path, off_t length);
 #endif
 
+static void resizeTagFile (const char *const name, const long newSize);
+static void freeFieldFragments (void);
+#ifdef HAVE_SQLITE3_H
+static void openDatabaseFile (void);
+static void closeDatabaseFile (void);
+#endif
+static void writeBinaryHeader (void);
+static void writeBinaryEnd (void);
+
 #ifdef NEED_PROTO_FTRUNCATE
 extern int ftruncate (int fd, off_t length);
 #endif
@@ -102,11 +256,37 @@ extern int ftruncate (int fd, off_t length);
 *   FUNCTION DEFINITIONS
 */
 
+/*  Makes the given tag file state the one accessed through "TagFile",
+ *  returning the previous one.  A NULL argument restores the built-in
+ *  default state.  Module state outside the structure (the entry buffer,
+ *  the streaming flags) is shared by all contexts.
+ */
+extern tagFile *setTagContext (tagFile *const context)
+{
+	tagFile *const previous = CurrentTagFile;
+
+	CurrentTagFile = (context != NULL) ? context : &DefaultTagFile;
+	return previous;
+}
+
 extern void freeTagFileResources (void)
 {
 	if (TagFile.directory != NULL)
 		eFree (TagFile.directory);
 	vStringDelete (TagFile.vLine);
+	vStringDelete (TagEntryBuffer);
+	vStringDelete (TagFile.etags.buffer);
+	freeFieldFragments ();
+	clearDuplicateTagLines ();
+	if (UniqueBloom != NULL)
+	{
+		eFree (UniqueBloom);
+		UniqueBloom = NULL;
+	}
+	if (UnchangedFiles != NULL)
+		stringListDelete (UnchangedFiles);
+	if (AppendMerge.files != NULL)
+		stringListDelete (AppendMerge.files);
 }
 
 extern const char *tagFileName (void)
@@ -132,11 +312,30 @@ static void writePseudoTag (
 		const char *const fileName,
 		const char *const pattern)
 {
-	const int length = fprintf (
-			TagFile.fp, "%s%s\t%s\t/%s/\n",
-			PSEUDO_TAG_PREFIX, tagName, fileName, pattern);
+	vString *buffer;
+
+	if (TagEntryBuffer == NULL)
+		TagEntryBuffer = vStringNew ();
+	buffer = TagEntryBuffer;
+	vStringClear (buffer);
+
+	vStringCatS (buffer, PSEUDO_TAG_PREFIX);
+	vStringCatS (buffer, tagName);
+	vStringPut (buffer, TAB);
+	vStringCatS (buffer, fileName);
+	vStringCatS (buffer, "\t/");
+	vStringCatS (buffer, pattern);
+	vStringCatS (buffer, "/\n");
+
+	if (fwrite (vStringValue (buffer), 1, vStringLength (buffer), TagFile.fp)
+			< vStringLength (buffer))
+		error (FATAL | PERROR, "cannot write tag file");
+#ifndef EXTERNAL_SORT
+	if (Option.sorted != SO_UNSORTED  &&  ! Option.append)
+		rememberTagLine (vStringValue (buffer));
+#endif
 	++TagFile.numTags.added;
-	rememberMaxLengths (strlen (tagName), (size_t) length);
+	rememberMaxLengths (strlen (tagName), vStringLength (buffer));
 }
 
 static void addPseudoTags (void)
@@ -166,6 +365,358 @@ static void addPseudoTags (void)
 	}
 }
 
+/*
+*   Split output support
+*/
+
+/*  Directs copies of subsequently written tag lines to the output file of
+ *  the named language, opening the file on first use.  Does nothing unless
+ *  --split-output is in effect.
+ */
+extern void selectSplitStream (const char *const language)
+{
+	splitStream *stream;
+
+	if (! Option.splitByLanguage)
+		return;
+	if (CurrentSplit != NULL  &&
+		strcmp (CurrentSplit->language, language) == 0)
+		return;
+	for (stream = SplitStreams  ;  stream != NULL  ;  stream = stream->next)
+		if (strcmp (stream->language, language) == 0)
+			break;
+	if (stream == NULL)
+	{
+		stream = xMalloc (1, splitStream);
+		stream->name = xMalloc (
+				strlen (TagFile.name) + strlen (language) + 2, char);
+		sprintf (stream->name, "%s-%s", TagFile.name, language);
+		stream->language = eStrdup (language);
+		stream->fp = fopen (stream->name, "w");
+		if (stream->fp == NULL)
+			error (FATAL | PERROR, "cannot open split tag file \"%s\"",
+				   stream->name);
+
+		/*  Readers consult only the format and sort order pseudo tags;
+		 *  the program identification stays in the combined file.
+		 */
+		fprintf (stream->fp, "%sTAG_FILE_FORMAT\t%u\t//\n",
+				 PSEUDO_TAG_PREFIX, Option.tagFileFormat);
+		fprintf (stream->fp, "%sTAG_FILE_SORTED\t%s\t/0=unsorted, 1=sorted, 2=foldcase/\n",
+				 PSEUDO_TAG_PREFIX,
+				 Option.sorted == SO_FOLDSORTED ? "2" :
+				 (Option.sorted == SO_SORTED ? "1" : "0"));
+		fgetpos (stream->fp, &stream->mark);
+		stream->next = SplitStreams;
+		SplitStreams = stream;
+	}
+	CurrentSplit = stream;
+}
+
+/*  Appends an already formatted tag line to the split output file of the
+ *  current source language.
+ */
+static void writeSplitTagLine (const char *const line, const size_t length)
+{
+	if (CurrentSplit != NULL  &&
+		fwrite (line, 1, length, CurrentSplit->fp) < length)
+		error (FATAL | PERROR, "cannot write split tag file \"%s\"",
+			   CurrentSplit->name);
+}
+
+/*  Closes the per-language output files and sorts each of them, running
+ *  the sorts concurrently where the platform allows.
+ */
+static void closeSplitStreams (void)
+{
+	splitStream *stream;
+	unsigned int count = 0;
+
+	if (SplitStreams == NULL)
+		return;
+	for (stream = SplitStreams  ;  stream != NULL  ;  stream = stream->next)
+	{
+		/*  As with the combined file, a rewound final pass may have left
+		 *  stale bytes beyond the write position; cut them off before the
+		 *  file is sorted or delivered.
+		 */
+		const long desiredSize = ftell (stream->fp);
+		long size;
+
+		fseek (stream->fp, 0L, SEEK_END);
+		size = ftell (stream->fp);
+		fclose (stream->fp);
+		stream->fp = NULL;
+		if (desiredSize < size)
+			resizeTagFile (stream->name, desiredSize);
+		++count;
+	}
+	if (Option.sorted != SO_UNSORTED)
+	{
+		const timedPhase phase = beginPhase (PHASE_SORT);
+		const char **const names = xMalloc (count, const char *);
+		unsigned int i = 0;
+
+		for (stream = SplitStreams  ;  stream != NULL  ;  stream = stream->next)
+			names [i++] = stream->name;
+		verbose ("sorting split tag files\n");
+		sortTagFilesInParallel (names, count);
+		eFree (names);
+		beginPhase (phase);
+	}
+	while (SplitStreams != NULL)
+	{
+		stream = SplitStreams;
+		SplitStreams = stream->next;
+		eFree (stream->name);
+		eFree (stream->language);
+		eFree (stream);
+	}
+	CurrentSplit = NULL;
+}
+
+/*
+*   Incremental mode support
+*/
+
+/*  Records the modification time and size of a parsed source file in a
+ *  pseudo tag so that a later incremental run can recognize the file as
+ *  unchanged.
+ */
+extern void writeSourceMtimeTag (const char *const fileName)
+{
+	if (Option.incremental  &&  ! TagsToStdout)
+	{
+		fileStatus *status = eStat (fileName);
+
+		if (status->exists)
+		{
+			char pattern [45];
+
+			sprintf (pattern, "%lu,%lu", status->mtime, status->size);
+			writePseudoTag (MTIME_PSEUDO_TAG, fileName, pattern);
+		}
+	}
+}
+
+/*  Records in the journal segment being written that it covers the named
+ *  source file, so that readers and compaction suppress the file's older
+ *  entries. Written even for a file which yielded no tags; the record
+ *  alone then erases the stale ones.
+ */
+extern void writeJournalFileTag (const char *const fileName)
+{
+	if (journalActive ()  &&  ! TagsToStdout)
+		writePseudoTag (JOURNAL_PSEUDO_TAG, fileName, "");
+}
+
+extern boolean isSourceFileUnchanged (const char *const fileName)
+{
+	return (boolean) (UnchangedFiles != NULL  &&
+					  stringListHas (UnchangedFiles, fileName));
+}
+
+/*  If "line" holds a mtime pseudo tag whose source file is unchanged since
+ *  it was recorded, remembers the file so that its entries are carried over.
+ */
+static void collectUnchangedFile (const char *const line)
+{
+	const char *const prefix = PSEUDO_TAG_PREFIX MTIME_PSEUDO_TAG "\t";
+	const size_t prefixLength = strlen (prefix);
+
+	if (strncmp (line, prefix, prefixLength) == 0)
+	{
+		const char *const name = line + prefixLength;
+		const char *const tab = strrchr (name, '\t');
+		unsigned long mtime, size;
+
+		if (tab != NULL  &&  tab != name  &&
+			sscanf (tab + 1, "/%lu,%lu/", &mtime, &size) == 2)
+		{
+			vString *const fileName = vStringNew ();
+			fileStatus *status;
+
+			vStringNCopyS (fileName, name, tab - name);
+			status = eStat (vStringValue (fileName));
+			if (status->exists  &&  status->isNormalFile  &&
+				status->mtime == mtime  &&  status->size == size)
+			{
+				if (UnchangedFiles == NULL)
+					UnchangedFiles = stringListNew ();
+				stringListAdd (UnchangedFiles, fileName);
+			}
+			else
+				vStringDelete (fileName);
+		}
+	}
+}
+
+/*  Is "line" a regular ctags line whose source file field names one of the
+ *  unchanged files?
+ */
+static boolean isCarriedOverLine (const char *const line)
+{
+	boolean carried = FALSE;
+
+	if (strncmp (line, PSEUDO_TAG_PREFIX, 2) != 0)
+	{
+		const char *const tab1 = strchr (line, '\t');
+
+		if (tab1 != NULL)
+		{
+			const char *const tab2 = strchr (tab1 + 1, '\t');
+
+			if (tab2 != NULL)
+			{
+				vString *const fileName = vStringNew ();
+
+				vStringNCopyS (fileName, tab1 + 1, tab2 - (tab1 + 1));
+				carried = stringListHas (
+					UnchangedFiles, vStringValue (fileName));
+				vStringDelete (fileName);
+			}
+		}
+	}
+	return carried;
+}
+
+/*  Copies the current tag file to a temporary file so that its contents
+ *  remain readable after the tag file is truncated for writing. Returns
+ *  the temporary file, open for reading, or NULL if there is nothing to
+ *  stash.
+ */
+static FILE *stashTagFile (char **const tempName)
+{
+	FILE *const old = fopen (TagFile.name, "rb");
+	FILE *temp = NULL;
+
+	if (old != NULL)
+	{
+		long size;
+
+		temp = tempFile ("w+b", tempName);
+		fseek (old, 0L, SEEK_END);
+		size = ftell (old);
+		rewind (old);
+		copyBytes (old, temp, size);
+		fclose (old);
+		rewind (temp);
+	}
+	return temp;
+}
+
+/*  Replays into the new tag file all entries of the previous run whose
+ *  source files are unchanged, along with fresh mtime pseudo tags for
+ *  them; entries of modified or deleted files are dropped.
+ */
+static void carryOverTags (FILE *const stash)
+{
+	const char *line;
+
+	if (UnchangedFiles != NULL)
+	{
+		/*  Left over from an earlier pass (watch mode reopens the tag file
+		 *  for every batch of changes); what was unchanged then may not be
+		 *  unchanged now.
+		 */
+		stringListDelete (UnchangedFiles);
+		UnchangedFiles = NULL;
+	}
+	while ((line = readLine (TagFile.vLine, stash)) != NULL)
+		collectUnchangedFile (line);
+
+	if (UnchangedFiles != NULL)
+	{
+		vString *buffer;
+		unsigned int i;
+
+		for (i = 0  ;  i < stringListCount (UnchangedFiles)  ;  ++i)
+			writeSourceMtimeTag (
+				vStringValue (stringListItem (UnchangedFiles, i)));
+
+		if (TagEntryBuffer == NULL)
+			TagEntryBuffer = vStringNew ();
+		buffer = TagEntryBuffer;
+
+		rewind (stash);
+		while ((line = readLine (TagFile.vLine, stash)) != NULL)
+		{
+			if (isCarriedOverLine (line))
+			{
+				vStringCopyS (buffer, line);
+				if (vStringLast (buffer) != '\n')
+					vStringPut (buffer, '\n');
+				if (fwrite (vStringValue (buffer), 1, vStringLength (buffer),
+							TagFile.fp) < vStringLength (buffer))
+					error (FATAL | PERROR, "cannot write tag file");
+#ifndef EXTERNAL_SORT
+				if (Option.sorted != SO_UNSORTED  &&  ! Option.append)
+					rememberTagLine (vStringValue (buffer));
+#endif
+				++TagFile.numTags.added;
+			}
+		}
+	}
+}
+
+/*
+*   Checkpoint support
+*/
+
+/*  Records in the checkpoint file how many source files have been fully
+ *  processed and how many bytes of tag file they produced, so that an
+ *  interrupted run can be continued with --resume. The file is replaced
+ *  atomically; an interruption cannot leave a torn checkpoint behind.
+ */
+extern void writeCheckpoint (const unsigned long filesCompleted)
+{
+	if (Option.checkpointFile != NULL  &&  ! TagsToStdout)
+	{
+		long offset;
+
+		if (fflush (TagFile.fp) != 0)
+			return;
+		offset = ftell (TagFile.fp);
+		if (offset != -1L)
+		{
+			vString *const tempName = vStringNewInit (Option.checkpointFile);
+			FILE *fp;
+
+			vStringCatS (tempName, ".tmp");
+			fp = fopen (vStringValue (tempName), "w");
+			if (fp != NULL)
+			{
+				fprintf (fp, "%lu %ld\n", filesCompleted, offset);
+				if (fclose (fp) == 0)
+					rename (vStringValue (tempName), Option.checkpointFile);
+				else
+					remove (vStringValue (tempName));
+			}
+			vStringDelete (tempName);
+		}
+	}
+}
+
+static boolean readCheckpoint (
+		unsigned long *const files, long *const offset)
+{
+	boolean result = FALSE;
+	FILE *const fp = fopen (Option.checkpointFile, "r");
+
+	if (fp != NULL)
+	{
+		if (fscanf (fp, "%lu %ld", files, offset) == 2  &&  *offset >= 0L)
+			result = TRUE;
+		fclose (fp);
+	}
+	return result;
+}
+
+extern unsigned long resumedFileCount (void)
+{
+	return ResumedFiles;
+}
+
 static void updateSortedFlag (
 		const char *const line, FILE *const fp, fpos_t startOfLine)
 {
@@ -175,7 +726,8 @@ static void updateSortedFlag (
 	{
 		const long boolOffset = tab - line + 1;  /* where it should be */
 
-		if (line [boolOffset] == '0'  ||  line [boolOffset] == '1')
+		if (line [boolOffset] == '0'  ||  line [boolOffset] == '1'  ||
+			line [boolOffset] == '2')
 		{
 			fpos_t nextLine;
 
@@ -191,12 +743,21 @@ static void updateSortedFlag (
 				while (c != '\t'  &&  c != '\n');
 				fgetpos (fp, &flagLocation);
 				d = fgetc (fp);
-				if (c == '\t'  &&  (d == '0'  ||  d == '1')  &&
-					d != (int) Option.sorted)
+				if (c == '\t'  &&  (d == '0'  ||  d == '1'  ||  d == '2'))
 				{
-					fsetpos (fp, &flagLocation);
-					fputc (Option.sorted == SO_FOLDSORTED ? '2' :
-						(Option.sorted == SO_SORTED ? '1' : '0'), fp);
+					/*  When the existing records are already in the order
+					 *  requested, the appended tags can be merged in rather
+					 *  than re-sorting the whole file.
+					 */
+					AppendMerge.possible = (boolean)
+						(d - '0' == (int) Option.sorted  &&
+						 Option.sorted != SO_UNSORTED);
+					if (d - '0' != (int) Option.sorted)
+					{
+						fsetpos (fp, &flagLocation);
+						fputc (Option.sorted == SO_FOLDSORTED ? '2' :
+							(Option.sorted == SO_SORTED ? '1' : '0'), fp);
+					}
 				}
 				fsetpos (fp, &nextLine);
 			}
@@ -239,10 +800,27 @@ static long unsigned int updatePseudoTags (FILE *const fp)
 		}
 		line = readLine (TagFile.vLine, fp);
 	}
-	while (line != NULL)  /* skip to end of file */
+	if (line != NULL)
 	{
-		++linesRead;
-		line = readLine (TagFile.vLine, fp);
+		/*  Count the remaining lines with block-sized reads; the tag
+		 *  records themselves need no inspection.
+		 */
+		enum { BufferSize = 0x4000 };
+		char *const buffer = xMalloc (BufferSize, char);
+		int lastByte = '\n';
+		size_t numRead, i;
+
+		++linesRead;  /* the line which ended the pseudo tag header */
+		while ((numRead = fread (buffer, 1, (size_t) BufferSize, fp)) > 0)
+		{
+			for (i = 0  ;  i < numRead  ;  ++i)
+				if (buffer [i] == '\n')
+					++linesRead;
+			lastByte = buffer [numRead - 1];
+		}
+		if (lastByte != '\n')
+			++linesRead;  /* final line lacks a newline */
+		eFree (buffer);
 	}
 	return linesRead;
 }
@@ -330,7 +908,8 @@ static boolean isTagFile (const char *const filename)
 		if (line == NULL)
 			ok = TRUE;
 		else
-			ok = (boolean) (isCtagsLine (line) || isEtagsLine (line));
+			ok = (boolean) (isCtagsLine (line)  ||  isEtagsLine (line)  ||
+							strncmp (line, "CTB1", 4) == 0);
 		fclose (fp);
 	}
 	return ok;
@@ -338,7 +917,7 @@ static boolean isTagFile (const char *const filename)
 
 extern void copyBytes (FILE* const fromFp, FILE* const toFp, const long size)
 {
-	enum { BufferSize = 1000 };
+	enum { BufferSize = 0x4000 };
 	long toRead, numRead;
 	char* buffer = xMalloc (BufferSize, char);
 	long remaining = size;
@@ -374,6 +953,17 @@ extern void copyFile (const char *const from, const char *const to, const long s
 	}
 }
 
+/*  Fully buffers tag output in large blocks so that tag formatting and the
+ *  operating system's writes overlap; the parser then stalls on a slow file
+ *  system (network mounts especially) once per block rather than at every
+ *  small stdio flush. Must be called before anything is written.
+ */
+static void bufferTagOutput (FILE *const fp)
+{
+	if (fp != NULL)
+		setvbuf (fp, NULL, _IOFBF, TAG_OUTPUT_BUFFER_SIZE);
+}
+
 extern void openTagFile (void)
 {
 	setDefaultTagFileName ();
@@ -381,14 +971,54 @@ extern void openTagFile (void)
 
 	if (TagFile.vLine == NULL)
 		TagFile.vLine = vStringNew ();
+	if (TagFile.name != NULL)  /* reopened by filter or watch mode */
+		eFree (TagFile.name);
+	if (TagFile.directory != NULL)
+		eFree (TagFile.directory);
+
+	ResumedFiles = 0;
+	AppendMerge.possible = FALSE;
+	AppendMerge.offset = 0L;
+	AppendMerge.lastFile = NULL;
+	if (AppendMerge.files != NULL)
+	{
+		stringListDelete (AppendMerge.files);
+		AppendMerge.files = NULL;
+	}
 
 	/*  Open the tags file.
 	 */
+#ifdef HAVE_SQLITE3_H
+	if (Option.databaseFile != NULL)
+	{
+		openDatabaseFile ();
+		TagFile.name = eStrdup (Option.databaseFile);
+		TagsToStdout = FALSE;
+	}
+	else
+#endif
 	if (TagsToStdout)
-		TagFile.fp = tempFile ("w", &TagFile.name);
+	{
+		StreamingTags = (boolean) (Option.sorted == SO_UNSORTED);
+		if (StreamingTags)
+		{
+			/*  Unsorted output need not be spooled through a temporary file
+			 *  and re-read at exit; write each entry directly.
+			 */
+			TagFile.name = eStrdup ("");
+			TagFile.fp = stdout;
+		}
+		else
+		{
+			TagFile.fp = tempFile ("w", &TagFile.name);
+			bufferTagOutput (TagFile.fp);
+		}
+	}
 	else
 	{
 		boolean fileExists;
+		unsigned long checkpointFiles = 0;
+		long checkpointOffset = 0L;
 
 		setDefaultTagFileName ();
 		TagFile.name = eStrdup (Option.tagFileName);
@@ -404,24 +1034,87 @@ extern void openTagFile (void)
 				TagFile.fp = fopen (TagFile.name, "a+b");
 			else
 				TagFile.fp = fopen (TagFile.name, "w+b");
+			bufferTagOutput (TagFile.fp);
 		}
 		else
 		{
-			if (Option.append  &&  fileExists)
+			if (Option.resume  &&  fileExists  &&
+				Option.checkpointFile != NULL  &&
+				readCheckpoint (&checkpointFiles, &checkpointOffset))
 			{
+				verbose ("resuming after %lu completed files\n",
+						checkpointFiles);
+				resizeTagFile (TagFile.name, checkpointOffset);
 				TagFile.fp = fopen (TagFile.name, "r+");
 				if (TagFile.fp != NULL)
 				{
 					TagFile.numTags.prev = updatePseudoTags (TagFile.fp);
 					fclose (TagFile.fp);
 					TagFile.fp = fopen (TagFile.name, "a+");
+					bufferTagOutput (TagFile.fp);
+					/*  The interrupted run never got to sort its output,
+					 *  whatever the sorted pseudo tag written at its start
+					 *  may claim; the whole file must be sorted at exit.
+					 */
+					AppendMerge.possible = FALSE;
+					ResumedFiles = checkpointFiles;
 				}
 			}
-			else
+			else if (Option.append  &&  fileExists)
 			{
-				TagFile.fp = fopen (TagFile.name, "w");
+				TagFile.fp = fopen (TagFile.name, "r+");
 				if (TagFile.fp != NULL)
+				{
+					TagFile.numTags.prev = updatePseudoTags (TagFile.fp);
+					fclose (TagFile.fp);
+					TagFile.fp = fopen (TagFile.name, "a+");
+					bufferTagOutput (TagFile.fp);
+					if (AppendMerge.possible  &&  TagFile.fp != NULL)
+					{
+						fseek (TagFile.fp, 0L, SEEK_END);
+						AppendMerge.offset = ftell (TagFile.fp);
+					}
+				}
+			}
+			else
+			{
+				FILE *stash = NULL;
+				char *stashName = NULL;
+
+				if (Option.journal  &&  fileExists)
+				{
+					/*  The existing file stays untouched as the base of
+					 *  the journal; this run's output becomes a new
+					 *  segment layered over it.
+					 */
+					eFree (TagFile.name);
+					TagFile.name = journalSegmentName ();
+				}
+				if (Option.incremental  &&  fileExists)
+					stash = stashTagFile (&stashName);
+#ifdef PIPED_SORT_SUPPORTED
+				if (Option.sorted != SO_UNSORTED  &&  ! Option.binaryOutput)
+					SortPipe = openSortPipe (TagFile.name);
+				if (SortPipe != NULL)
+					TagFile.fp = tempFile ("w+", &SpoolName);
+				else
+#endif
+				TagFile.fp = fopen (TagFile.name,
+						Option.binaryOutput ? "wb" : "w");
+				bufferTagOutput (TagFile.fp);
+				if (TagFile.fp != NULL  &&  ! Option.binaryOutput)
+				{
 					addPseudoTags ();
+					if (stash != NULL)
+						carryOverTags (stash);
+					flushTagOutput ();
+				}
+				if (stash != NULL)
+				{
+					fclose (stash);
+					remove (stashName);
+					eFree (stashName);
+				}
 			}
 		}
 		if (TagFile.fp == NULL)
@@ -430,6 +1123,8 @@ extern void openTagFile (void)
 			exit (1);
 		}
 	}
+	if (Option.binaryOutput  &&  TagFile.fp != NULL)
+		writeBinaryHeader ();
 	if (TagsToStdout)
 		TagFile.directory = eStrdup (CurrentDirectory);
 	else
@@ -455,47 +1150,209 @@ static int replacementTruncate (const char *const name, const long size)
 
 #endif
 
+/*  Records that tags for the named source file are being generated during
+ *  this run, so that a merging append can drop the file's old entries. The
+ *  name is interned, so a pointer comparison filters the common case of
+ *  repeated calls for the same file.
+ */
+extern void recordReplacedSourceFile (const char *const tagPath)
+{
+	if (AppendMerge.possible  &&  tagPath != AppendMerge.lastFile)
+	{
+		if (AppendMerge.files == NULL)
+			AppendMerge.files = stringListNew ();
+		if (! stringListHas (AppendMerge.files, tagPath))
+			stringListAdd (AppendMerge.files, vStringNewInit (tagPath));
+		AppendMerge.lastFile = tagPath;
+	}
+}
+
 static void sortTagFile (void)
 {
+	const timedPhase phase = beginPhase (PHASE_SORT);
 	if (TagFile.numTags.added > 0L)
 	{
 		if (Option.sorted != SO_UNSORTED)
 		{
-			verbose ("sorting tag file\n");
+			boolean merged = FALSE;
+
+			/*  When appending to a file already sorted in the requested
+			 *  order, the new tags are merged into the old ones in a single
+			 *  linear pass instead of re-sorting the whole file.
+			 */
+			if (AppendMerge.possible  &&  ! TagsToStdout  &&  ! Option.xref)
+				merged = mergeAppendedTags (AppendMerge.offset,
+											AppendMerge.files);
+			if (! merged)
+			{
+				verbose ("sorting tag file\n");
 #ifdef EXTERNAL_SORT
-			externalSortTags (TagsToStdout);
+				externalSortTags (TagsToStdout);
 #else
-			internalSortTags (TagsToStdout);
+				internalSortTags (TagsToStdout);
 #endif
+			}
 		}
 		else if (TagsToStdout)
 			catFile (tagFileName ());
 	}
 	if (TagsToStdout)
 		remove (tagFileName ());  /* remove temporary file */
+	beginPhase (phase);
 }
 
-static void resizeTagFile (const long newSize)
+#ifdef HAVE_ZLIB_H
+
+typedef struct sTagBlock {
+	char *key;                     /* name of the first tag in the block */
+	unsigned long compressedSize;  /* bytes occupied by the compressed frame */
+	unsigned long size;            /* bytes when uncompressed */
+} tagBlock;
+
+static void flushTagBlock (
+		FILE *const frames, const char *const input, const size_t used,
+		Bytef *const output, const uLong outputSize, tagBlock *const block)
 {
-	int result;
+	uLongf compressedSize = outputSize;
+
+	if (compress2 (output, &compressedSize, (const Bytef *) input,
+				   (uLong) used, Z_DEFAULT_COMPRESSION) != Z_OK)
+		error (FATAL, "cannot compress tag file block");
+	if (fwrite (output, 1, (size_t) compressedSize, frames) !=
+			(size_t) compressedSize)
+		error (FATAL | PERROR, "cannot write compressed block");
+	block->compressedSize = (unsigned long) compressedSize;
+	block->size = (unsigned long) used;
+}
 
-#ifdef USE_REPLACEMENT_TRUNCATE
-	result = replacementTruncate (TagFile.name, newSize);
-#else
-# ifdef HAVE_TRUNCATE
-	result = truncate (TagFile.name, (off_t) newSize);
-# else
-	const int fd = open (TagFile.name, O_RDWR);
+/*  Rewrites the sorted tag file with its tag records gathered into
+ *  line-aligned blocks of up to TAGS_BLOCK_SIZE bytes, each compressed
+ *  independently. The pseudo tags stay uncompressed at the head of the file,
+ *  followed by one block pseudo tag per block naming its first tag and its
+ *  sizes, and finally the compressed frames themselves. Readers binary
+ *  search the block names and need inflate only one frame per lookup.
+ */
+static void compressTagFile (void)
+{
+	FILE *const in = fopen (tagFileName (), "r");
+	FILE *frames;
+	FILE *out;
+	char *framesName = NULL;
+	vString *const header = vStringNew ();
+	tagBlock *blocks = NULL;
+	unsigned long blockCount = 0, blockSlots = 0, i;
+	size_t capacity = TAGS_BLOCK_SIZE;
+	char *input = xMalloc (capacity, char);
+	Bytef *output = xMalloc (compressBound ((uLong) capacity), Bytef);
+	size_t used = 0;
+	boolean inHeader = TRUE;
+	long framesSize;
+	const char *line;
 
-	if (fd == -1)
-		result = -1;
-	else
+	if (in == NULL)
+		error (FATAL | PERROR, "cannot reopen tag file");
+	verbose ("compressing tag file\n");
+	frames = tempFile ("w+b", &framesName);
+	while ((line = readLine (TagFile.vLine, in)) != NULL)
 	{
-#  ifdef HAVE_FTRUNCATE
-		result = ftruncate (fd, (off_t) newSize);
-#  else
-#   ifdef HAVE_CHSIZE
-		result = chsize (fd, newSize);
+		const size_t length = strlen (line);
+
+		if (inHeader  &&  strncmp (line, PSEUDO_TAG_PREFIX,
+								   strlen (PSEUDO_TAG_PREFIX)) == 0)
+		{
+			vStringCatS (header, line);
+			continue;
+		}
+		inHeader = FALSE;
+		if (used > 0  &&  used + length > capacity)
+		{
+			flushTagBlock (frames, input, used, output,
+						   compressBound ((uLong) capacity),
+						   &blocks [blockCount - 1]);
+			used = 0;
+		}
+		if (length > capacity)  /* a single record larger than a block */
+		{
+			capacity = length;
+			input = xRealloc (input, capacity, char);
+			output = xRealloc (output, compressBound ((uLong) capacity), Bytef);
+		}
+		if (used == 0)
+		{
+			/*  The name of the first record keys the block index. */
+			const char *const tab = strchr (line, '\t');
+			const size_t keyLength =
+					(tab != NULL) ? (size_t) (tab - line) : length;
+
+			if (blockCount == blockSlots)
+			{
+				blockSlots = (blockSlots == 0) ? 16 : 2 * blockSlots;
+				blocks = xRealloc (blocks, blockSlots, tagBlock);
+			}
+			blocks [blockCount].key = xMalloc (keyLength + 1, char);
+			strncpy (blocks [blockCount].key, line, keyLength);
+			blocks [blockCount].key [keyLength] = '\0';
+			++blockCount;
+		}
+		memcpy (input + used, line, length);
+		used += length;
+	}
+	if (used > 0)
+		flushTagBlock (frames, input, used, output,
+					   compressBound ((uLong) capacity),
+					   &blocks [blockCount - 1]);
+	fclose (in);
+
+	out = fopen (tagFileName (), "w");
+	if (out == NULL)
+		error (FATAL | PERROR, "cannot rewrite tag file");
+	fputs (vStringValue (header), out);
+	for (i = 0  ;  i < blockCount  ;  ++i)
+		fprintf (out, "%s%s\t%s\t%lu,%lu\n", PSEUDO_TAG_PREFIX,
+				 BLOCK_PSEUDO_TAG, blocks [i].key,
+				 blocks [i].compressedSize, blocks [i].size);
+	fprintf (out, "%s%s\tzlib\t/compressed frames follow this line/\n",
+			 PSEUDO_TAG_PREFIX, COMPRESSED_PSEUDO_TAG);
+	framesSize = ftell (frames);
+	rewind (frames);
+	copyBytes (frames, out, framesSize);
+	fclose (out);
+	fclose (frames);
+	remove (framesName);
+	eFree (framesName);
+
+	for (i = 0  ;  i < blockCount  ;  ++i)
+		eFree (blocks [i].key);
+	if (blocks != NULL)
+		eFree (blocks);
+	eFree (input);
+	eFree (output);
+	vStringDelete (header);
+}
+
+#endif
+
+static void resizeTagFile (const char *const name, const long newSize)
+{
+	int result;
+
+#ifdef USE_REPLACEMENT_TRUNCATE
+	result = replacementTruncate (name, newSize);
+#else
+# ifdef HAVE_TRUNCATE
+	result = truncate (name, (off_t) newSize);
+# else
+	const int fd = open (name, O_RDWR);
+
+	if (fd == -1)
+		result = -1;
+	else
+	{
+#  ifdef HAVE_FTRUNCATE
+		result = ftruncate (fd, (off_t) newSize);
+#  else
+#   ifdef HAVE_CHSIZE
+		result = chsize (fd, newSize);
 #   endif
 #  endif
 		close (fd);
@@ -519,49 +1376,181 @@ static void writeEtagsIncludes (FILE *const fp)
 	}
 }
 
+/*  Forwards everything spooled since the last call to the sort process,
+ *  then rewinds the spool for the next source file. Called at the end of
+ *  every parsed file, so only records whose parsing passes have settled
+ *  reach the sort; a no-op when no sort process is running.
+ */
+extern void flushTagOutput (void)
+{
+#ifdef PIPED_SORT_SUPPORTED
+	if (SortPipe != NULL)
+	{
+		long remaining = ftell (TagFile.fp);
+
+		if (remaining > 0)
+		{
+			char buffer [BUFSIZ * 8];
+
+			rewind (TagFile.fp);
+			while (remaining > 0)
+			{
+				const size_t chunk = (remaining > (long) sizeof buffer)
+						? sizeof buffer : (size_t) remaining;
+				const size_t count = fread (buffer, 1, chunk, TagFile.fp);
+
+				if (count == 0  ||
+					fwrite (buffer, 1, count, SortPipe) < count)
+					error (FATAL | PERROR, "cannot write to sort process");
+				remaining -= (long) count;
+			}
+			rewind (TagFile.fp);
+			if (fflush (SortPipe) == EOF)
+				error (FATAL | PERROR, "cannot write to sort process");
+		}
+	}
+#endif
+}
+
+#ifdef PIPED_SORT_SUPPORTED
+
+/*  Disconnects a forked worker process from the sort pipe inherited from
+ *  its parent. Only the descriptor is closed: the buffered bytes belong to
+ *  the parent, which flushes them itself.
+ */
+extern void abandonSortStream (void)
+{
+	if (SortPipe != NULL)
+	{
+		close (fileno (SortPipe));
+		SortPipe = NULL;
+	}
+}
+
+#endif
+
 extern void closeTagFile (const boolean resize)
 {
 	long desiredSize, size;
 
+#ifdef HAVE_SQLITE3_H
+	if (Database != NULL)
+	{
+		closeDatabaseFile ();
+		eFree (TagFile.name);
+		TagFile.name = NULL;
+		return;
+	}
+#endif
+	if (Option.binaryOutput)
+		writeBinaryEnd ();
 	if (Option.etags)
 		writeEtagsIncludes (TagFile.fp);
-	desiredSize = ftell (TagFile.fp);
-	fseek (TagFile.fp, 0L, SEEK_END);
-	size = ftell (TagFile.fp);
-	fclose (TagFile.fp);
-	if (resize  &&  desiredSize < size)
-	{
-		DebugStatement (
-			debugPrintf (DEBUG_STATUS, "shrinking %s from %ld to %ld bytes\n",
-				TagFile.name, size, desiredSize); )
-		resizeTagFile (desiredSize);
-	}
-	sortTagFile ();
+	if (StreamingTags)
+	{
+		/*  Entries went straight to stdout; there is nothing to resize,
+		 *  sort or remove, and stdout must stay open for filter mode.
+		 */
+		fflush (TagFile.fp);
+		StreamingTags = FALSE;
+	}
+#ifdef PIPED_SORT_SUPPORTED
+	else if (SortPipe != NULL)
+	{
+		/*  The sort process has been fed every record already; close the
+		 *  pipe and wait for it to deliver the sorted tag file.
+		 */
+		const timedPhase phase = beginPhase (PHASE_SORT);
+
+		flushTagOutput ();
+		fclose (TagFile.fp);
+		remove (SpoolName);
+		eFree (SpoolName);
+		SpoolName = NULL;
+		if (! closeSortPipe (SortPipe))
+			error (FATAL, "cannot sort tag file");
+		SortPipe = NULL;
+		beginPhase (phase);
+	}
+#endif
+	else
+	{
+		desiredSize = ftell (TagFile.fp);
+		fseek (TagFile.fp, 0L, SEEK_END);
+		size = ftell (TagFile.fp);
+		fclose (TagFile.fp);
+		if (resize  &&  desiredSize < size)
+		{
+			DebugStatement (
+				debugPrintf (DEBUG_STATUS, "shrinking %s from %ld to %ld bytes\n",
+					TagFile.name, size, desiredSize); )
+			resizeTagFile (TagFile.name, desiredSize);
+		}
+		sortTagFile ();
+	}
+	closeSplitStreams ();
+#ifdef HAVE_ZLIB_H
+	if (Option.compress  &&  ! TagsToStdout)
+		compressTagFile ();
+#endif
+	if (! TagsToStdout)
+	{
+		if (Option.tagIndex)
+		{
+			verbose ("writing tag index files\n");
+			if (! tagsWriteIndex (tagFileName ()))
+				error (WARNING, "cannot create tag index file");
+			if (! tagsWriteTrigramIndex (tagFileName ()))
+				error (WARNING, "cannot create trigram index file");
+			if (! tagsWriteFileMap (tagFileName ()))
+				error (WARNING, "cannot create file map");
+		}
+		else
+		{
+			tagsRemoveIndex (tagFileName ());
+			tagsRemoveTrigramIndex (tagFileName ());
+			tagsRemoveFileMap (tagFileName ());
+		}
+		if (Option.checkpointFile != NULL)
+			remove (Option.checkpointFile);
+#ifdef HAVE_POSIX_FADVISE
+		{
+			/*  This process will not read the finished tag file again;
+			 *  advise the kernel that its pages may be evicted so that
+			 *  whole-tree runs do not crowd the page cache of the host.
+			 */
+			const int fd = open (TagFile.name, O_RDONLY);
+			if (fd != -1)
+			{
+				posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+				close (fd);
+			}
+		}
+#endif
+	}
 	eFree (TagFile.name);
 	TagFile.name = NULL;
 }
 
 extern void beginEtagsFile (void)
 {
-	TagFile.etags.fp = tempFile ("w+b", &TagFile.etags.name);
+	if (TagFile.etags.buffer == NULL)
+		TagFile.etags.buffer = vStringNew ();
+	vStringClear (TagFile.etags.buffer);
 	TagFile.etags.byteCount = 0;
 }
 
 extern void endEtagsFile (const char *const name)
 {
-	const char *line;
+	vString *const buffer = TagFile.etags.buffer;
 
 	fprintf (TagFile.fp, "\f\n%s,%ld\n", name, (long) TagFile.etags.byteCount);
-	if (TagFile.etags.fp != NULL)
+	if (buffer != NULL  &&  vStringLength (buffer) > 0)
 	{
-		rewind (TagFile.etags.fp);
-		while ((line = readLine (TagFile.vLine, TagFile.etags.fp)) != NULL)
-			fputs (line, TagFile.fp);
-		fclose (TagFile.etags.fp);
-		remove (TagFile.etags.name);
-		eFree (TagFile.etags.name);
-		TagFile.etags.fp = NULL;
-		TagFile.etags.name = NULL;
+		if (fwrite (vStringValue (buffer), 1, vStringLength (buffer),
+					TagFile.fp) < vStringLength (buffer))
+			error (FATAL | PERROR, "cannot write tag file");
+		vStringClear (buffer);
 	}
 }
 
@@ -569,50 +1558,88 @@ extern void endEtagsFile (const char *const name)
  *  Tag entry management
  */
 
-/*  This function copies the current line out to a specified file. It has no
+/*  This function copies the current line into the entry buffer. It has no
  *  effect on the fileGetc () function.  During copying, any '\' characters
  *  are doubled and a leading '^' or trailing '$' is also quoted. End of line
  *  characters (line feed or carriage return) are dropped.
  */
-static size_t writeSourceLine (FILE *const fp, const char *const line)
+/*  Appends a block of bytes which is known to contain nothing needing
+ *  quoting or conversion, so it can be moved with a single memcpy.
+ */
+static void catBytes (
+		vString *const buffer, const char *const bytes, const size_t count)
 {
-	size_t length = 0;
-	const char *p;
+	while (vStringSize (buffer) < vStringLength (buffer) + count + 1)
+		if (! vStringAutoResize (buffer))
+			error (FATAL | PERROR, "tag line too big; out of memory");
+	memcpy (vStringValue (buffer) + vStringLength (buffer), bytes, count);
+	buffer->length += count;
+}
 
-	/*  Write everything up to, but not including, a line end character.
+static void catSourceLine (vString *const buffer, const char *const line)
+{
+	const char searchChar = Option.backward ? '?' : '/';
+	const char *p = line;
+	char stop [6];
+
+	/*  Copy everything up to, but not including, a line end character,
+	 *  quoting '\', the search delimiter and a terminal '$'. Runs free of
+	 *  those are located with strcspn and copied whole.
 	 */
-	for (p = line  ;  *p != '\0'  ;  ++p)
+	stop [0] = BACKSLASH;
+	stop [1] = searchChar;
+	stop [2] = '$';
+	stop [3] = CRETURN;
+	stop [4] = NEWLINE;
+	stop [5] = '\0';
+
+	while (*p != '\0')
 	{
-		const int next = *(p + 1);
-		const int c = *p;
+		const size_t span = strcspn (p, stop);
+		const int c = p [span];
 
-		if (c == CRETURN  ||  c == NEWLINE)
+		catBytes (buffer, p, span);
+		p += span;
+		if (c == '\0'  ||  c == CRETURN  ||  c == NEWLINE)
 			break;
-
-		/*  If character is '\', or a terminal '$', then quote it.
-		 */
-		if (c == BACKSLASH  ||  c == (Option.backward ? '?' : '/')  ||
-			(c == '$'  &&  (next == NEWLINE  ||  next == CRETURN)))
+		if (c == '$'  &&  p [1] != NEWLINE  &&  p [1] != CRETURN)
+			vStringPut (buffer, c);  /* only a terminal '$' is quoted */
+		else
 		{
-			putc (BACKSLASH, fp);
-			++length;
+			vStringPut (buffer, BACKSLASH);
+			vStringPut (buffer, c);
 		}
-		putc (c, fp);
-		++length;
+		++p;
 	}
-	return length;
+	vStringTerminate (buffer);
+}
+
+/*  Formats the number by hand, since at millions of tags the time printf
+ *  spends parsing "%lu" alone is measurable.
+ */
+static void catNumber (vString *const buffer, const unsigned long number)
+{
+	char digits [32];
+	char *p = digits + sizeof digits;
+	unsigned long n = number;
+
+	do
+	{
+		*--p = (char) ('0' + (n % 10));
+		n /= 10;
+	} while (n > 0);
+	vStringNCatS (buffer, p, (size_t) (digits + sizeof digits - p));
 }
 
-/*  Writes "line", stripping leading and duplicate white space.
+/*  Appends "line", stripping leading and duplicate white space.
  */
-static size_t writeCompactSourceLine (FILE *const fp, const char *const line)
+static void catCompactSourceLine (vString *const buffer, const char *const line)
 {
 	boolean lineStarted = FALSE;
-	size_t  length = 0;
 	const char *p;
 	int c;
 
-	/*  Write everything up to, but not including, the newline.
+	/*  Append everything up to, but not including, the newline.
 	 */
 	for (p = line, c = *p  ;  c != NEWLINE  &&  c != '\0'  ;  c = *++p)
 	{
@@ -630,33 +1657,72 @@ static size_t writeCompactSourceLine (FILE *const fp, const char *const line)
 				c = ' ';  /* force space character for any white space */
 			}
 			if (c != CRETURN  ||  *(p + 1) != NEWLINE)
-			{
-				putc (c, fp);
-				++length;
-			}
+				vStringPut (buffer, c);
 		}
 	}
-	return length;
+}
+
+/*  Mimics printf "%-*s": pads the text on the right to the field width.
+ */
+static void catLeftJustified (
+		vString *const buffer, const char *const text, size_t width)
+{
+	size_t length = strlen (text);
+
+	catBytes (buffer, text, length);
+	while (length++ < width)
+		vStringPut (buffer, ' ');
+}
+
+/*  Mimics printf "%*lu": pads the number on the left to the field width.
+ */
+static void catRightJustified (
+		vString *const buffer, const unsigned long number, size_t width)
+{
+	size_t digits = 1;
+	unsigned long n = number;
+
+	while (n >= 10)
+	{
+		n /= 10;
+		++digits;
+	}
+	while (width-- > digits)
+		vStringPut (buffer, ' ');
+	catNumber (buffer, number);
 }
 
 static int writeXrefEntry (const tagEntryInfo *const tag)
 {
 	const char *const line =
 			readSourceLine (TagFile.vLine, tag->filePosition, NULL);
-	int length;
+	vString *buffer;
 
-	if (Option.tagFileFormat == 1)
-		length = fprintf (TagFile.fp, "%-16s %4lu %-16s ", tag->name,
-				tag->lineNumber, tag->sourceFileName);
-	else
-		length = fprintf (TagFile.fp, "%-16s %-10s %4lu %-16s ", tag->name,
-				tag->kindName, tag->lineNumber, tag->sourceFileName);
-
-	length += writeCompactSourceLine (TagFile.fp, line);
-	putc (NEWLINE, TagFile.fp);
-	++length;
+	if (TagEntryBuffer == NULL)
+		TagEntryBuffer = vStringNew ();
+	buffer = TagEntryBuffer;
+	vStringClear (buffer);
 
-	return length;
+	catLeftJustified (buffer, tag->name, 16);
+	vStringPut (buffer, ' ');
+	if (Option.tagFileFormat != 1)
+	{
+		catLeftJustified (buffer, tag->kindName, 10);
+		vStringPut (buffer, ' ');
+	}
+	catRightJustified (buffer, tag->lineNumber, 4);
+	vStringPut (buffer, ' ');
+	catLeftJustified (buffer, tag->sourceFileName, 16);
+	vStringPut (buffer, ' ');
+	catCompactSourceLine (buffer, line);
+	vStringPut (buffer, NEWLINE);
+	vStringTerminate (buffer);
+
+	if (fwrite (vStringValue (buffer), 1, vStringLength (buffer), TagFile.fp)
+			< vStringLength (buffer))
+		error (FATAL | PERROR, "cannot write tag file");
+
+	return (int) vStringLength (buffer);
 }
 
 /*  Truncates the text line containing the tag at the character following the
@@ -678,11 +1744,18 @@ static void truncateTagLine (
 
 static int writeEtagsEntry (const tagEntryInfo *const tag)
 {
-	int length;
+	vString *const buffer = TagFile.etags.buffer;
+	const size_t start = vStringLength (buffer);
+	size_t length;
 
 	if (tag->isFileEntry)
-		length = fprintf (TagFile.etags.fp, "\177%s\001%lu,0\n",
-				tag->name, tag->lineNumber);
+	{
+		vStringPut (buffer, '\177');
+		vStringCatS (buffer, tag->name);
+		vStringPut (buffer, '\001');
+		catNumber (buffer, tag->lineNumber);
+		vStringCatS (buffer, ",0\n");
+	}
 	else
 	{
 		long seekValue;
@@ -694,83 +1767,211 @@ static int writeEtagsEntry (const tagEntryInfo *const tag)
 		else
 			line [strlen (line) - 1] = '\0';
 
-		length = fprintf (TagFile.etags.fp, "%s\177%s\001%lu,%ld\n", line,
-				tag->name, tag->lineNumber, seekValue);
+		vStringCatS (buffer, line);
+		vStringPut (buffer, '\177');
+		vStringCatS (buffer, tag->name);
+		vStringPut (buffer, '\001');
+		catNumber (buffer, tag->lineNumber);
+		vStringPut (buffer, ',');
+		catNumber (buffer, (unsigned long) seekValue);
+		vStringPut (buffer, '\n');
 	}
+	length = vStringLength (buffer) - start;
 	TagFile.etags.byteCount += length;
 
-	return length;
+	return (int) length;
+}
+
+/*  Several extension fields repeat identically over runs of consecutive
+ *  tags: the kind field for each tag of one kind, the language field for
+ *  every tag of a file, and the scope field for every member of a scope.
+ *  Each such fragment is formatted once and appended ready-made until the
+ *  value it was built from changes.
+ */
+static struct sFieldFragments {
+	vString *kind;
+	const char *kindName;   /* kind fragment source (parser-owned) */
+	char kindLetter;        /* kind fragment source */
+	vString *language;
+	const char *languageName;  /* language fragment source (parser-owned) */
+	vString *scope;
+	vString *scopeKind;     /* scope fragment sources (copied, since the */
+	vString *scopeName;     /* parser reuses its scope strings) */
+} Fragments;
+
+static void catFragment (vString *const buffer, const vString *const fragment)
+{
+	vStringCatSpan (buffer, vStringValue (fragment), vStringLength (fragment));
+}
+
+static void catKindField (vString *const buffer, const tagEntryInfo *const tag)
+{
+	if (Fragments.kind == NULL)
+		Fragments.kind = vStringNew ();
+	if (tag->kindName != Fragments.kindName  ||
+		tag->kind != Fragments.kindLetter  ||
+		vStringLength (Fragments.kind) == 0)
+	{
+		vStringClear (Fragments.kind);
+		vStringPut (Fragments.kind, TAB);
+		if (Option.extensionFields.kindKey)
+			vStringCatS (Fragments.kind, "kind:");
+		if (tag->kindName != NULL && (Option.extensionFields.kindLong  ||
+			 (Option.extensionFields.kind  && tag->kind == '\0')))
+			vStringCatS (Fragments.kind, tag->kindName);
+		else
+			vStringPut (Fragments.kind, tag->kind);
+		Fragments.kindName = tag->kindName;
+		Fragments.kindLetter = tag->kind;
+	}
+	catFragment (buffer, Fragments.kind);
+}
+
+static void catLanguageField (vString *const buffer, const tagEntryInfo *const tag)
+{
+	if (Fragments.language == NULL)
+		Fragments.language = vStringNew ();
+	if (tag->language != Fragments.languageName  ||
+		vStringLength (Fragments.language) == 0)
+	{
+		vStringClear (Fragments.language);
+		vStringCatS (Fragments.language, "\tlanguage:");
+		vStringCatS (Fragments.language, tag->language);
+		Fragments.languageName = tag->language;
+	}
+	catFragment (buffer, Fragments.language);
+}
+
+static void catScopeField (vString *const buffer, const tagEntryInfo *const tag)
+{
+	const char *const scopeKind = tag->extensionFields.scope [0];
+	const char *const scopeName = tag->extensionFields.scope [1];
+
+	if (Fragments.scope == NULL)
+	{
+		Fragments.scope     = vStringNew ();
+		Fragments.scopeKind = vStringNew ();
+		Fragments.scopeName = vStringNew ();
+	}
+	if (strcmp (scopeKind, vStringValue (Fragments.scopeKind)) != 0  ||
+		strcmp (scopeName, vStringValue (Fragments.scopeName)) != 0  ||
+		vStringLength (Fragments.scope) == 0)
+	{
+		vStringCopyS (Fragments.scopeKind, scopeKind);
+		vStringCopyS (Fragments.scopeName, scopeName);
+		vStringClear (Fragments.scope);
+		vStringPut (Fragments.scope, TAB);
+		vStringCatS (Fragments.scope, scopeKind);
+		vStringPut (Fragments.scope, ':');
+		vStringCatS (Fragments.scope, scopeName);
+	}
+	catFragment (buffer, Fragments.scope);
+}
+
+static void freeFieldFragments (void)
+{
+	vStringDelete (Fragments.kind);
+	vStringDelete (Fragments.language);
+	vStringDelete (Fragments.scope);
+	vStringDelete (Fragments.scopeKind);
+	vStringDelete (Fragments.scopeName);
+	memset (&Fragments, 0, sizeof (Fragments));
 }
 
-static int addExtensionFields (const tagEntryInfo *const tag)
+static void catExtensionFields (
+		vString *const buffer, const tagEntryInfo *const tag)
 {
-	const char* const kindKey = Option.extensionFields.kindKey ? "kind:" : "";
 	boolean first = TRUE;
 	const char* separator = ";\"";
 	const char* const empty = "";
-	int length = 0;
 /* "sep" returns a value only the first time it is evaluated */
 #define sep (first ? (first = FALSE, separator) : empty)
 
-	if (tag->kindName != NULL && (Option.extensionFields.kindLong  ||
-		 (Option.extensionFields.kind  && tag->kind == '\0')))
-		length += fprintf (TagFile.fp,"%s\t%s%s", sep, kindKey, tag->kindName);
-	else if (tag->kind != '\0'  && (Option.extensionFields.kind  ||
-			(Option.extensionFields.kindLong  &&  tag->kindName == NULL)))
-		length += fprintf (TagFile.fp, "%s\t%s%c", sep, kindKey, tag->kind);
+	if ((tag->kindName != NULL && (Option.extensionFields.kindLong  ||
+		 (Option.extensionFields.kind  && tag->kind == '\0')))  ||
+		(tag->kind != '\0'  && (Option.extensionFields.kind  ||
+			(Option.extensionFields.kindLong  &&  tag->kindName == NULL))))
+	{
+		vStringCatS (buffer, sep);
+		catKindField (buffer, tag);
+	}
 
 	if (Option.extensionFields.lineNumber)
-		length += fprintf (TagFile.fp, "%s\tline:%ld", sep, tag->lineNumber);
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\tline:");
+		catNumber (buffer, tag->lineNumber);
+	}
 
 	if (Option.extensionFields.language  &&  tag->language != NULL)
-		length += fprintf (TagFile.fp, "%s\tlanguage:%s", sep, tag->language);
+	{
+		vStringCatS (buffer, sep);
+		catLanguageField (buffer, tag);
+	}
 
 	if (Option.extensionFields.scope  &&
 			tag->extensionFields.scope [0] != NULL  &&
 			tag->extensionFields.scope [1] != NULL)
-		length += fprintf (TagFile.fp, "%s\t%s:%s", sep,
-				tag->extensionFields.scope [0],
-				tag->extensionFields.scope [1]);
+	{
+		vStringCatS (buffer, sep);
+		catScopeField (buffer, tag);
+	}
 
 	if (Option.extensionFields.typeRef  &&
 			tag->extensionFields.typeRef [0] != NULL  &&
 			tag->extensionFields.typeRef [1] != NULL)
-		length += fprintf (TagFile.fp, "%s\ttyperef:%s:%s", sep,
-				tag->extensionFields.typeRef [0],
-				tag->extensionFields.typeRef [1]);
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\ttyperef:");
+		vStringCatS (buffer, tag->extensionFields.typeRef [0]);
+		vStringPut (buffer, ':');
+		vStringCatS (buffer, tag->extensionFields.typeRef [1]);
+	}
 
 	if (Option.extensionFields.fileScope  &&  tag->isFileScope)
-		length += fprintf (TagFile.fp, "%s\tfile:", sep);
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\tfile:");
+	}
 
 	if (Option.extensionFields.inheritance  &&
 			tag->extensionFields.inheritance != NULL)
-		length += fprintf (TagFile.fp, "%s\tinherits:%s", sep,
-				tag->extensionFields.inheritance);
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\tinherits:");
+		vStringCatS (buffer, tag->extensionFields.inheritance);
+	}
 
 	if (Option.extensionFields.access  &&  tag->extensionFields.access != NULL)
-		length += fprintf (TagFile.fp, "%s\taccess:%s", sep,
-				tag->extensionFields.access);
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\taccess:");
+		vStringCatS (buffer, tag->extensionFields.access);
+	}
 
 	if (Option.extensionFields.implementation  &&
 			tag->extensionFields.implementation != NULL)
-		length += fprintf (TagFile.fp, "%s\timplementation:%s", sep,
-				tag->extensionFields.implementation);
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\timplementation:");
+		vStringCatS (buffer, tag->extensionFields.implementation);
+	}
 
 	if (Option.extensionFields.signature  &&
 			tag->extensionFields.signature != NULL)
-		length += fprintf (TagFile.fp, "%s\tsignature:%s", sep,
-				tag->extensionFields.signature);
-
-	return length;
+	{
+		vStringCatS (buffer, sep);
+		vStringCatS (buffer, "\tsignature:");
+		vStringCatS (buffer, tag->extensionFields.signature);
+	}
 #undef sep
 }
 
-static int writePatternEntry (const tagEntryInfo *const tag)
+static void catPatternEntry (vString *const buffer, const tagEntryInfo *const tag)
 {
 	char *const line = readSourceLine (TagFile.vLine, tag->filePosition, NULL);
 	const int searchChar = Option.backward ? '?' : '/';
 	boolean newlineTerminated;
-	int length = 0;
 
 	if (line == NULL)
 		error (FATAL, "bad tag in %s", vStringValue (File.name));
@@ -778,34 +1979,451 @@ static int writePatternEntry (const tagEntryInfo *const tag)
 		truncateTagLine (line, tag->name, FALSE);
 	newlineTerminated = (boolean) (line [strlen (line) - 1] == '\n');
 
-	length += fprintf (TagFile.fp, "%c^", searchChar);
-	length += writeSourceLine (TagFile.fp, line);
-	length += fprintf (TagFile.fp, "%s%c", newlineTerminated ? "$":"", searchChar);
+	vStringPut (buffer, searchChar);
+	vStringPut (buffer, '^');
+	catSourceLine (buffer, line);
+	if (newlineTerminated)
+		vStringPut (buffer, '$');
+	vStringPut (buffer, searchChar);
+}
+
+#ifdef HAVE_SQLITE3_H
+
+/*  Executes a self-contained SQL statement on the tag database.
+ */
+static void execDatabase (const char *const sql)
+{
+	char *message = NULL;
+
+	if (sqlite3_exec (Database, sql, NULL, NULL, &message) != SQLITE_OK)
+		error (FATAL, "cannot write tag database: %s", message);
+}
+
+static void writeDatabaseMeta (const char *const name, const char *const value)
+{
+	char *const sql = sqlite3_mprintf (
+			"INSERT OR REPLACE INTO meta VALUES (%Q, %Q)", name, value);
+
+	execDatabase (sql);
+	sqlite3_free (sql);
+}
+
+static void openDatabaseFile (void)
+{
+	if (! Option.append)
+		remove (Option.databaseFile);
+	if (sqlite3_open (Option.databaseFile, &Database) != SQLITE_OK)
+		error (FATAL, "cannot open tag database \"%s\": %s",
+				Option.databaseFile, sqlite3_errmsg (Database));
+
+	/*  The database is rebuilt from scratch after a failed run anyway, so
+	 *  durability guarantees are traded for insert speed.
+	 */
+	execDatabase ("PRAGMA journal_mode=OFF");
+	execDatabase ("PRAGMA synchronous=OFF");
+	execDatabase (
+		"CREATE TABLE IF NOT EXISTS tags ("
+			" name TEXT NOT NULL, file TEXT NOT NULL,"
+			" pattern TEXT, line INTEGER NOT NULL,"
+			" kind TEXT, language TEXT,"
+			" scope_kind TEXT, scope_name TEXT,"
+			" typeref_type TEXT, typeref_name TEXT,"
+			" inherits TEXT, access TEXT, implementation TEXT,"
+			" signature TEXT, file_scope INTEGER NOT NULL)");
+	execDatabase (
+		"CREATE TABLE IF NOT EXISTS meta (name TEXT PRIMARY KEY, value TEXT)");
+	writeDatabaseMeta ("TAG_PROGRAM_AUTHOR",  AUTHOR_NAME);
+	writeDatabaseMeta ("TAG_PROGRAM_NAME",    PROGRAM_NAME);
+	writeDatabaseMeta ("TAG_PROGRAM_URL",     PROGRAM_URL);
+	writeDatabaseMeta ("TAG_PROGRAM_VERSION", PROGRAM_VERSION);
+	if (sqlite3_prepare_v2 (Database,
+			"INSERT INTO tags VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?,?)",
+			-1, &DatabaseInsert, NULL) != SQLITE_OK)
+		error (FATAL, "cannot write tag database: %s",
+				sqlite3_errmsg (Database));
+	execDatabase ("BEGIN");
+}
+
+/*  Binds a possibly absent string to the insert statement. Every value
+ *  outlives the sqlite3_step () call, so no private copies are needed.
+ */
+static void bindDatabaseText (const int column, const char *const value)
+{
+	if (value == NULL)
+		sqlite3_bind_null (DatabaseInsert, column);
+	else
+		sqlite3_bind_text (DatabaseInsert, column, value, -1, SQLITE_STATIC);
+}
+
+static int writeDatabaseEntry (const tagEntryInfo *const tag)
+{
+	vString *buffer;
+	char kindChar [2];
+	const char *kind = tag->kindName;
+
+	if (TagEntryBuffer == NULL)
+		TagEntryBuffer = vStringNew ();
+	buffer = TagEntryBuffer;
+	vStringClear (buffer);
 
-	return length;
+	if (kind == NULL  &&  tag->kind != '\0')
+	{
+		kindChar [0] = tag->kind;
+		kindChar [1] = '\0';
+		kind = kindChar;
+	}
+	bindDatabaseText (1, tag->name);
+	bindDatabaseText (2, tag->sourceFileName);
+	if (tag->lineNumberEntry)
+		sqlite3_bind_null (DatabaseInsert, 3);
+	else
+	{
+		catPatternEntry (buffer, tag);
+		bindDatabaseText (3, vStringValue (buffer));
+	}
+	sqlite3_bind_int64 (DatabaseInsert, 4, (sqlite3_int64) tag->lineNumber);
+	bindDatabaseText (5, kind);
+	bindDatabaseText (6, tag->language);
+	bindDatabaseText (7, tag->extensionFields.scope [0]);
+	bindDatabaseText (8, tag->extensionFields.scope [1]);
+	bindDatabaseText (9, tag->extensionFields.typeRef [0]);
+	bindDatabaseText (10, tag->extensionFields.typeRef [1]);
+	bindDatabaseText (11, tag->extensionFields.inheritance);
+	bindDatabaseText (12, tag->extensionFields.access);
+	bindDatabaseText (13, tag->extensionFields.implementation);
+	bindDatabaseText (14, tag->extensionFields.signature);
+	sqlite3_bind_int (DatabaseInsert, 15, tag->isFileScope ? 1 : 0);
+
+	if (sqlite3_step (DatabaseInsert) != SQLITE_DONE)
+		error (FATAL, "cannot write tag database: %s",
+				sqlite3_errmsg (Database));
+	sqlite3_reset (DatabaseInsert);
+
+	return (int) vStringLength (buffer);
 }
 
-static int writeLineNumberEntry (const tagEntryInfo *const tag)
+static sqlite3_int64 databaseMaxRowid (void)
 {
-	return fprintf (TagFile.fp, "%lu", tag->lineNumber);
+	sqlite3_stmt *stmt;
+	sqlite3_int64 result = 0;
+
+	if (sqlite3_prepare_v2 (Database, "SELECT max(rowid) FROM tags",
+			-1, &stmt, NULL) == SQLITE_OK)
+	{
+		if (sqlite3_step (stmt) == SQLITE_ROW)
+			result = sqlite3_column_int64 (stmt, 0);
+		sqlite3_finalize (stmt);
+	}
+	return result;
+}
+
+/*  Builds the indexes in one pass over the loaded table, which is cheaper
+ *  than updating them a row at a time during the inserts, and commits.
+ */
+static void closeDatabaseFile (void)
+{
+	sqlite3_finalize (DatabaseInsert);
+	DatabaseInsert = NULL;
+	execDatabase ("CREATE INDEX IF NOT EXISTS tags_name ON tags (name)");
+	execDatabase ("CREATE INDEX IF NOT EXISTS tags_file ON tags (file)");
+	execDatabase ("COMMIT");
+	sqlite3_close (Database);
+	Database = NULL;
+}
+
+#endif
+
+/*  Remembers and restores the state of the active output backend around a
+ *  parsing pass, so that entries made by a pass which fails are discarded
+ *  before the file is rescanned: the write position of a text or binary
+ *  file, the path table state of the binary stream, and the rows of the
+ *  tag database.
+ */
+extern void markTagOutput (void)
+{
+	splitStream *stream;
+
+	if (TagFile.fp != NULL)
+		fgetpos (TagFile.fp, &OutputFileMark);
+	for (stream = SplitStreams  ;  stream != NULL  ;  stream = stream->next)
+		fgetpos (stream->fp, &stream->mark);
+	BinaryPathMark = BinaryPathCount;
+#ifdef HAVE_SQLITE3_H
+	if (Database != NULL)
+		DatabaseMark = databaseMaxRowid ();
+#endif
+}
+
+extern void rewindTagOutput (void)
+{
+	splitStream *stream;
+
+	if (TagFile.fp != NULL)
+		fsetpos (TagFile.fp, &OutputFileMark);
+	for (stream = SplitStreams  ;  stream != NULL  ;  stream = stream->next)
+		fsetpos (stream->fp, &stream->mark);
+	if (Option.binaryOutput)
+	{
+		BinaryPathCount = BinaryPathMark;
+		if (BinaryLastPath != NULL)
+			vStringClear (BinaryLastPath);
+	}
+#ifdef HAVE_SQLITE3_H
+	if (Database != NULL)
+	{
+		char *const sql = sqlite3_mprintf (
+				"DELETE FROM tags WHERE rowid > %lld", DatabaseMark);
+
+		execDatabase (sql);
+		sqlite3_free (sql);
+	}
+#endif
+}
+
+/*  Binary output (--output-format=binary) streams length-prefixed records
+ *  which consumers can ingest without tokenizing or unescaping anything.
+ *  All integers are little endian. The stream opens with the magic bytes
+ *  "CTB1" and ends with a single 'E' byte; an 'F' record (u32 identifier,
+ *  u16-counted path) names a source file, and a 'T' record (u16-counted tag
+ *  name, u32 file identifier, u32 line number, kind byte, u16-counted
+ *  scope) describes one tag in the most recently numbered file.
+ */
+
+/*  vStringPut () treats NUL as a terminator, so the integer fields are
+ *  spelled out into a byte array and appended with catBytes ().
+ */
+static void catU16 (vString *const buffer, const unsigned int value)
+{
+	char bytes [2];
+
+	bytes [0] = (char) (value & 0xff);
+	bytes [1] = (char) ((value >> 8) & 0xff);
+	catBytes (buffer, bytes, 2);
+}
+
+static void catU32 (vString *const buffer, const unsigned long value)
+{
+	char bytes [4];
+
+	bytes [0] = (char) (value & 0xff);
+	bytes [1] = (char) ((value >> 8) & 0xff);
+	bytes [2] = (char) ((value >> 16) & 0xff);
+	bytes [3] = (char) ((value >> 24) & 0xff);
+	catBytes (buffer, bytes, 4);
+}
+
+static void catCounted (vString *const buffer, const char *const string)
+{
+	size_t length = strlen (string);
+
+	if (length > 0xffff)
+		length = 0xffff;
+	catU16 (buffer, (unsigned int) length);
+	catBytes (buffer, string, length);
+}
+
+static void writeBinaryHeader (void)
+{
+	BinaryPathCount = 0;
+	if (fwrite ("CTB1", 1, 4, TagFile.fp) < 4)
+		error (FATAL | PERROR, "cannot write tag file");
+}
+
+static void writeBinaryEnd (void)
+{
+	if (fputc ('E', TagFile.fp) == EOF)
+		error (FATAL | PERROR, "cannot write tag file");
+}
+
+static int writeBinaryEntry (const tagEntryInfo *const tag)
+{
+	vString *buffer;
+	char kind = tag->kind;
+
+	if (TagEntryBuffer == NULL)
+		TagEntryBuffer = vStringNew ();
+	buffer = TagEntryBuffer;
+	vStringClear (buffer);
+
+	if (BinaryLastPath == NULL)
+		BinaryLastPath = vStringNew ();
+	if (BinaryPathCount == 0  ||
+		strcmp (vStringValue (BinaryLastPath), tag->sourceFileName) != 0)
+	{
+		vStringCopyS (BinaryLastPath, tag->sourceFileName);
+		++BinaryPathCount;
+		vStringPut (buffer, 'F');
+		catU32 (buffer, BinaryPathCount);
+		catCounted (buffer, tag->sourceFileName);
+	}
+	if (kind == '\0'  &&  tag->kindName != NULL)
+		kind = tag->kindName [0];
+	vStringPut (buffer, 'T');
+	catCounted (buffer, tag->name);
+	catU32 (buffer, BinaryPathCount);
+	catU32 (buffer, tag->lineNumber);
+	catBytes (buffer, &kind, 1);  /* may be a NUL byte */
+	if (tag->extensionFields.scope [0] != NULL  &&
+		tag->extensionFields.scope [1] != NULL)
+	{
+		catU16 (buffer, (unsigned int)
+				(strlen (tag->extensionFields.scope [0]) + 1 +
+				 strlen (tag->extensionFields.scope [1])));
+		catBytes (buffer, tag->extensionFields.scope [0],
+				strlen (tag->extensionFields.scope [0]));
+		vStringPut (buffer, ':');
+		catBytes (buffer, tag->extensionFields.scope [1],
+				strlen (tag->extensionFields.scope [1]));
+	}
+	else
+		catU16 (buffer, 0);
+
+	if (fwrite (vStringValue (buffer), 1, vStringLength (buffer), TagFile.fp)
+			< vStringLength (buffer))
+		error (FATAL | PERROR, "cannot write tag file");
+
+	return (int) vStringLength (buffer);
+}
+
+/*  The entire entry is assembled in a reused buffer and written with a
+ *  single call, rather than issuing a stream write per field.
+ */
+/*  Was an identical tag line already written for the current source file?
+ *  A line never seen before is recorded as it is asked about.
+ */
+static boolean isDuplicateTagLine (const char *const line)
+{
+	unsigned long h1 = 5381;
+	unsigned long h2 = 0;
+	unsigned long bit1, bit2;
+	const char *p;
+	uniqueEntry *entry;
+	boolean maybe;
+
+	for (p = line  ;  *p != '\0'  ;  ++p)
+	{
+		h1 = h1 * 33 + (unsigned char) *p;
+		h2 = (unsigned char) *p + (h2 << 6) + (h2 << 16) - h2;
+	}
+	if (UniqueBloom == NULL)
+	{
+		UniqueBloom = xMalloc (UNIQUE_BLOOM_SIZE, unsigned char);
+		memset (UniqueBloom, 0, UNIQUE_BLOOM_SIZE);
+	}
+	bit1 = h1 % (UNIQUE_BLOOM_SIZE * 8);
+	bit2 = h2 % (UNIQUE_BLOOM_SIZE * 8);
+	maybe = (boolean) (
+			(UniqueBloom [bit1 / 8] & (1 << (bit1 % 8))) != 0  &&
+			(UniqueBloom [bit2 / 8] & (1 << (bit2 % 8))) != 0);
+	if (maybe)
+		for (entry = UniqueTable [h1 % UNIQUE_HASH_SIZE]  ;  entry != NULL  ;
+			 entry = entry->next)
+			if (strcmp (entry->line, line) == 0)
+				return TRUE;
+	UniqueBloom [bit1 / 8] |= 1 << (bit1 % 8);
+	UniqueBloom [bit2 / 8] |= 1 << (bit2 % 8);
+	entry = xMalloc (1, uniqueEntry);
+	entry->line = eStrdup (line);
+	entry->next = UniqueTable [h1 % UNIQUE_HASH_SIZE];
+	UniqueTable [h1 % UNIQUE_HASH_SIZE] = entry;
+	return FALSE;
+}
+
+/*  Forgets the tag lines recorded for duplicate suppression; called as each
+ *  parsing pass over a source file begins.
+ */
+extern void clearDuplicateTagLines (void)
+{
+	unsigned int i;
+
+	for (i = 0  ;  i < UNIQUE_HASH_SIZE  ;  ++i)
+	{
+		uniqueEntry *entry = UniqueTable [i];
+		while (entry != NULL)
+		{
+			uniqueEntry *const next = entry->next;
+			eFree (entry->line);
+			eFree (entry);
+			entry = next;
+		}
+		UniqueTable [i] = NULL;
+	}
+	if (UniqueBloom != NULL)
+		memset (UniqueBloom, 0, UNIQUE_BLOOM_SIZE);
 }
 
 static int writeCtagsEntry (const tagEntryInfo *const tag)
 {
-	int length = fprintf (TagFile.fp, "%s\t%s\t",
-		tag->name, tag->sourceFileName);
+	vString *buffer;
+
+	if (TagEntryBuffer == NULL)
+		TagEntryBuffer = vStringNew ();
+	buffer = TagEntryBuffer;
+	vStringClear (buffer);
+
+	vStringCatS (buffer, tag->name);
+	vStringPut (buffer, TAB);
+	vStringCatS (buffer, tag->sourceFileName);
+	vStringPut (buffer, TAB);
 
 	if (tag->lineNumberEntry)
-		length += writeLineNumberEntry (tag);
+		catNumber (buffer, tag->lineNumber);
 	else
-		length += writePatternEntry (tag);
+		catPatternEntry (buffer, tag);
 
 	if (includeExtensionFlags ())
-		length += addExtensionFields (tag);
+		catExtensionFields (buffer, tag);
+
+	vStringPut (buffer, NEWLINE);
 
-	length += fprintf (TagFile.fp, "\n");
+	if (Option.unique  &&  isDuplicateTagLine (vStringValue (buffer)))
+		return 0;
 
-	return length;
+	if (fwrite (vStringValue (buffer), 1, vStringLength (buffer), TagFile.fp)
+			< vStringLength (buffer))
+		error (FATAL | PERROR, "cannot write tag file");
+	if (Option.splitByLanguage)
+		writeSplitTagLine (vStringValue (buffer), vStringLength (buffer));
+#ifndef EXTERNAL_SORT
+	if (Option.sorted != SO_UNSORTED  &&  ! Option.append)
+		rememberTagLine (vStringValue (buffer));
+#endif
+	cacheCaptureTagLine (vStringValue (buffer));
+
+	return (int) vStringLength (buffer);
+}
+
+/*  Appends a tag line replayed from the parse cache, with the same
+ *  bookkeeping as a freshly generated entry.
+ */
+extern void writeCachedTagLine (const char *const line)
+{
+	vString *buffer;
+	const char *tab;
+
+	if (TagEntryBuffer == NULL)
+		TagEntryBuffer = vStringNew ();
+	buffer = TagEntryBuffer;
+	vStringCopyS (buffer, line);
+	if (vStringLength (buffer) == 0)
+		return;
+	if (vStringLast (buffer) != '\n')
+		vStringPut (buffer, '\n');
+	if (fwrite (vStringValue (buffer), 1, vStringLength (buffer), TagFile.fp)
+			< vStringLength (buffer))
+		error (FATAL | PERROR, "cannot write tag file");
+	if (Option.splitByLanguage)
+		writeSplitTagLine (vStringValue (buffer), vStringLength (buffer));
+#ifndef EXTERNAL_SORT
+	if (Option.sorted != SO_UNSORTED  &&  ! Option.append)
+		rememberTagLine (vStringValue (buffer));
+#endif
+	cacheCaptureTagLine (vStringValue (buffer));
+	++TagFile.numTags.added;
+	tab = strchr (line, '\t');
+	rememberMaxLengths (
+		(tab == NULL) ? vStringLength (buffer) - 1 : (size_t) (tab - line),
+		vStringLength (buffer));
 }
 
 extern void makeTagEntry (const tagEntryInfo *const tag)
@@ -818,7 +2436,20 @@ extern void makeTagEntry (const tagEntryInfo *const tag)
 		int length = 0;
 
 		DebugStatement ( debugEntry (tag); )
-		if (Option.xref)
+		if (EntryFunction != NULL)
+		{
+			(*EntryFunction) (tag, EntryClientData);
+			++TagFile.numTags.added;
+			return;
+		}
+#ifdef HAVE_SQLITE3_H
+		if (Database != NULL)
+			length = writeDatabaseEntry (tag);
+		else
+#endif
+		if (Option.binaryOutput)
+			length = writeBinaryEntry (tag);
+		else if (Option.xref)
 		{
 			if (! tag->isFileEntry)
 				length = writeXrefEntry (tag);
@@ -834,6 +2465,15 @@ extern void makeTagEntry (const tagEntryInfo *const tag)
 	}
 }
 
+/*  Diverts completed tag entries to the given function; a NULL function
+ *  restores formatting into the tag file.
+ */
+extern void setTagEntryFunction (const tagEntryFunction func, void *const clientData)
+{
+	EntryFunction = func;
+	EntryClientData = clientData;
+}
+
 extern void initTagEntry (tagEntryInfo *const e, const char *const name)
 {
 	Assert (File.source.name != NULL);
@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 
+#include "read.h"
 #include "vstring.h"
 
 /*
@@ -38,8 +39,7 @@ typedef struct eTagFile {
 	struct sNumTags { unsigned long added, prev; } numTags;
 	struct sMax { size_t line, tag, file; } max;
 	struct sEtags {
-		char *name;
-		FILE *fp;
+		vString *buffer;  /* per-file section, appended when the file ends */
 		size_t byteCount;
 	} etags;
 	vString *vLine;
@@ -56,7 +56,7 @@ typedef struct sTagFields {
 typedef struct sTagEntryInfo {
 	boolean     lineNumberEntry;  /* pattern or line number entry */
 	unsigned long lineNumber;     /* line number of tag */
-	fpos_t      filePosition;     /* file position of line containing tag */
+	filePos     filePosition;     /* file position of line containing tag */
 	const char* language;         /* language of source file */
 	boolean     isFileScope;      /* is tag visibile only within source file? */
 	boolean     isFileEntry;      /* is this just an entry for a file name? */
@@ -82,20 +82,41 @@ typedef struct sTagEntryInfo {
 /*
 *   GLOBAL VARIABLES
 */
-extern tagFile TagFile;
+extern tagFile *CurrentTagFile;
+
+/*  Compatibility shim: the writer modules continue to name the active tag
+ *  file "TagFile"; it now resolves through a context pointer so that more
+ *  than one output state can exist in a process.
+ */
+#define TagFile (*CurrentTagFile)
 
 /*
 *   FUNCTION PROTOTYPES
 */
+extern tagFile *setTagContext (tagFile *const context);
+extern void setTagEntryFunction (const tagEntryFunction func, void *const clientData);
+extern void clearDuplicateTagLines (void);
 extern void freeTagFileResources (void);
 extern const char *tagFileName (void);
 extern void copyBytes (FILE* const fromFp, FILE* const toFp, const long size);
 extern void copyFile (const char *const from, const char *const to, const long size);
+extern void writeSourceMtimeTag (const char *const fileName);
+extern void writeJournalFileTag (const char *const fileName);
+extern void recordReplacedSourceFile (const char *const tagPath);
+extern boolean isSourceFileUnchanged (const char *const fileName);
+extern void writeCheckpoint (const unsigned long filesCompleted);
+extern unsigned long resumedFileCount (void);
+extern void markTagOutput (void);
+extern void rewindTagOutput (void);
 extern void openTagFile (void);
+extern void flushTagOutput (void);
+extern void selectSplitStream (const char *const language);
+extern void abandonSortStream (void);
 extern void closeTagFile (const boolean resize);
 extern void beginEtagsFile (void);
 extern void endEtagsFile (const char *const name);
 extern void makeTagEntry (const tagEntryInfo *const tag);
+extern void writeCachedTagLine (const char *const line);
 extern void initTagEntry (tagEntryInfo *const e, const char *const name);
 
 #endif  /* _ENTRY_H */
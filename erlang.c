@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include "entry.h"
+#include "keyword.h"
 #include "options.h"
 #include "read.h"
 #include "routines.h"
@@ -38,6 +39,28 @@ static kindOption ErlangKinds[] = {
 	{TRUE, 't', "type",     "type definitions"},
 };
 
+/*  The directives carrying tags, classified through the keyword table
+ *  rather than a string comparison per candidate.
+ */
+typedef enum {
+	DIRECTIVE_NONE = -1,
+	DIRECTIVE_DEFINE, DIRECTIVE_MODULE, DIRECTIVE_OPAQUE,
+	DIRECTIVE_RECORD, DIRECTIVE_TYPE
+} erlangDirective;
+
+static const struct sDirectiveDesc {
+	const char *name;
+	erlangDirective id;
+} ErlangDirectiveTable [] = {
+	{ "define", DIRECTIVE_DEFINE },
+	{ "module", DIRECTIVE_MODULE },
+	{ "opaque", DIRECTIVE_OPAQUE },
+	{ "record", DIRECTIVE_RECORD },
+	{ "type",   DIRECTIVE_TYPE }
+};
+
+static int Lang_erlang;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -136,27 +159,37 @@ static void parseDirective (const unsigned char *cp, vString *const module)
 	 * Record definitions are handled separately
 	 */
 	vString *const directive = vStringNew ();
-	const char *const drtv = vStringValue (directive);
 	cp = parseIdentifier (cp, directive);
 	cp = skipSpace (cp);
 	if (*cp == '(')
 		++cp;
 
-	if (strcmp (drtv, "record") == 0)
-		parseSimpleTag (cp, K_RECORD);
-	else if (strcmp (drtv, "define") == 0)
-		parseSimpleTag (cp, K_MACRO);
-	else if (strcmp (drtv, "type") == 0)
-		parseSimpleTag (cp, K_TYPE);
-	else if (strcmp (drtv, "opaque") == 0)
-		parseSimpleTag (cp, K_TYPE);
-	else if (strcmp (drtv, "module") == 0)
-		parseModuleTag (cp, module);
-	/* Otherwise, it was an import, export, etc. */
-	
+	switch (lookupKeyword (vStringValue (directive), Lang_erlang))
+	{
+		case DIRECTIVE_RECORD:  parseSimpleTag (cp, K_RECORD);    break;
+		case DIRECTIVE_DEFINE:  parseSimpleTag (cp, K_MACRO);     break;
+		case DIRECTIVE_TYPE:
+		case DIRECTIVE_OPAQUE:  parseSimpleTag (cp, K_TYPE);      break;
+		case DIRECTIVE_MODULE:  parseModuleTag (cp, module);      break;
+		default: break;  /* import, export, etc. */
+	}
+
 	vStringDelete (directive);
 }
 
+static void initialize (const langType language)
+{
+	size_t i;
+	const size_t count =
+		sizeof (ErlangDirectiveTable) / sizeof (ErlangDirectiveTable [0]);
+	Lang_erlang = language;
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		const struct sDirectiveDesc *const p = &ErlangDirectiveTable [i];
+		addKeyword (p->name, language, (int) p->id);
+	}
+}
+
 static void findErlangTags (void)
 {
 	vString *const module = vStringNew ();
@@ -190,6 +223,7 @@ extern parserDefinition *ErlangParser (void)
 	def->kindCount = KIND_COUNT (ErlangKinds);
 	def->extensions = extensions;
 	def->parser = findErlangTags;
+	def->initialize = initialize;
 	return def;
 }
 
@@ -53,10 +53,26 @@ static const char *skipSpace (const char *cp)
 {
     while (isspace ((int) *cp))
         ++cp;
-        
+
     return cp;
 }
 
+// Tag the identifier following a matched keyword, appended to the reused
+// name buffer as one span rather than character by character.
+static void tagIdentifier (const unsigned char *cp, vString *const name,
+                           const falconKind kind)
+{
+    const unsigned char *start;
+
+    cp = (const unsigned char *) skipSpace ((const char *) cp);
+    start = cp;
+    while (isIdentifierChar ((int) *cp))
+        ++cp;
+    vStringClear (name);
+    vStringNCatS (name, (const char *) start, cp - start);
+    makeSimpleTag (name, FalconKinds, kind);
+}
+
 /*
  * Main parsing function
  */
@@ -76,61 +92,13 @@ static void findFalconTags (void)
             continue;
 
         if (strncmp ((const char*) cp, "function", (size_t) 8) == 0)
-        {
-            cp += 8;
-            cp = skipSpace (cp);
-            
-            while (isIdentifierChar ((int) *cp))
-            {
-                vStringPut (name, (int) *cp);
-                ++cp;
-            }
-            vStringTerminate (name);
-            makeSimpleTag (name, FalconKinds, K_FUNCTION);
-            vStringClear (name);
-        }
+            tagIdentifier (cp + 8, name, K_FUNCTION);
         else if (strncmp ((const char*) cp, "class", (size_t) 5) == 0)
-        {
-            cp += 5;
-            cp = skipSpace (cp);
-            
-            while (isIdentifierChar ((int) *cp))
-            {
-                vStringPut (name, (int) *cp);
-                ++cp;
-            }
-            vStringTerminate (name);
-            makeSimpleTag (name, FalconKinds, K_CLASS);
-            vStringClear (name);
-        }
+            tagIdentifier (cp + 5, name, K_CLASS);
         else if (strncmp ((const char*) cp, "load", (size_t) 4) == 0)
-        {
-            cp += 4;
-            cp = skipSpace (cp);
-            
-            while (isIdentifierChar ((int) *cp))
-            {
-                vStringPut (name, (int) *cp);
-                ++cp;
-            }
-            vStringTerminate (name);
-            makeSimpleTag (name, FalconKinds, K_NAMESPACE);
-            vStringClear (name);
-        }
+            tagIdentifier (cp + 4, name, K_NAMESPACE);
         else if (strncmp ((const char*) cp, "import from", (size_t) 11) == 0)
-        {
-            cp += 12;
-            cp = skipSpace (cp);
-            
-            while (isIdentifierChar ((int) *cp))
-            {
-                vStringPut (name, (int) *cp);
-                ++cp;
-            }
-            vStringTerminate (name);
-            makeSimpleTag (name, FalconKinds, K_NAMESPACE);
-            vStringClear (name);
-        }
+            tagIdentifier (cp + 12, name, K_NAMESPACE);
     }
     vStringDelete (name);
 }
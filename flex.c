@@ -129,7 +129,7 @@ typedef struct sTokenInfo {
 	vString *		string;
 	vString *		scope;
 	unsigned long 	lineNumber;
-	fpos_t 			filePosition;
+	filePos 			filePosition;
 	int				nestLevel;
 	boolean			ignoreTag;
 	boolean			isClass;
@@ -207,9 +207,7 @@ static boolean parseMXML (tokenInfo *const token);
 
 static boolean isIdentChar (const int c)
 {
-	return (boolean)
-		(isalpha (c) || isdigit (c) || c == '$' || 
-		 c == '@' || c == '_' || c == '#');
+	return (boolean) (charTest (c, CHAR_AT_IDENTIFIER) != 0);
 }
 
 static void buildFlexKeywordHash (void)
@@ -217,6 +215,7 @@ static void buildFlexKeywordHash (void)
 	const size_t count = sizeof (FlexKeywordTable) /
 		sizeof (FlexKeywordTable [0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_js);
 	for (i = 0	;  i < count  ;  ++i)
 	{
 		const keywordDesc* const p = &FlexKeywordTable [i];
@@ -224,14 +223,36 @@ static void buildFlexKeywordHash (void)
 	}
 }
 
+/* Tokens are recycled through a small fixed pool. The parser routines
+ * allocate and release them in strict LIFO order, so a few slots cover
+ * the whole parse and the per-statement heap traffic of creating and
+ * destroying the tokens (and their vStrings) disappears; anything beyond
+ * the pool falls back to the heap.
+ */
+#define TOKEN_POOL_SIZE 8
+
+static tokenInfo *TokenPool [TOKEN_POOL_SIZE];
+static unsigned int TokenPoolCount = 0;
+
 static tokenInfo *newToken (void)
 {
-	tokenInfo *const token = xMalloc (1, tokenInfo);
+	tokenInfo *token;
+
+	if (TokenPoolCount > 0)
+	{
+		token = TokenPool [--TokenPoolCount];
+		vStringClear (token->string);
+		vStringClear (token->scope);
+	}
+	else
+	{
+		token = xMalloc (1, tokenInfo);
+		token->string = vStringNew ();
+		token->scope  = vStringNew ();
+	}
 
 	token->type			= TOKEN_UNDEFINED;
 	token->keyword		= KEYWORD_NONE;
-	token->string		= vStringNew ();
-	token->scope		= vStringNew ();
 	token->nestLevel	= 0;
 	token->isClass		= FALSE;
 	token->ignoreTag	= FALSE;
@@ -243,9 +264,14 @@ static tokenInfo *newToken (void)
 
 static void deleteToken (tokenInfo *const token)
 {
-	vStringDelete (token->string);
-	vStringDelete (token->scope);
-	eFree (token);
+	if (TokenPoolCount < TOKEN_POOL_SIZE)
+		TokenPool [TokenPoolCount++] = token;
+	else
+	{
+		vStringDelete (token->string);
+		vStringDelete (token->scope);
+		eFree (token);
+	}
 }
 
 /*
@@ -32,7 +32,7 @@
 /*
 *   MACROS
 */
-#define isident(c)              (isalnum(c) || (c) == '_')
+#define isident(c)              charTest (c, CHAR_IDENTIFIER)
 #define isBlank(c)              (boolean) (c == ' ' || c == '\t')
 #define isType(token,t)         (boolean) ((token)->type == (t))
 #define isKeyword(token,k)      (boolean) ((token)->keyword == (k))
@@ -183,7 +183,7 @@ typedef struct sTokenInfo {
 	vString* string;
 	struct sTokenInfo *secondary;
 	unsigned long lineNumber;
-	fpos_t filePosition;
+	filePos filePosition;
 } tokenInfo;
 
 /*
@@ -195,6 +195,9 @@ static jmp_buf Exception;
 static int Ungetc;
 static unsigned int Column;
 static boolean FreeSourceForm;
+static const unsigned char *FixedLineChar;
+static int FixedUngetc;
+static boolean FixedEof;
 static boolean ParsingString;
 static tokenInfo *Parent;
 
@@ -399,6 +402,7 @@ static void buildFortranKeywordHash (void)
 	const size_t count =
 			sizeof (FortranKeywordTable) / sizeof (FortranKeywordTable [0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_fortran);
 	for (i = 0  ;  i < count  ;  ++i)
 	{
 		const keywordDesc* const p = &FortranKeywordTable [i];
@@ -499,13 +503,63 @@ static void makeFortranTag (tokenInfo *const token, tagType tag)
 */
 
 static int skipLine (void)
+{
+	return fileSkipToCharacter ('\n');
+}
+
+/*  Fixed source form is read a whole line at a time through fileReadLine(),
+ *  which hands back the input file's own line buffer, and the characters are
+ *  then doled out of that buffer. This permits the margin columns of each
+ *  line to be classified in place rather than fetched one file read at a
+ *  time, which matters because fixed form revisits the margin on every line.
+ *  Free source form reads through fileGetc() as before; the two must not be
+ *  mixed for the same file, but the source form is fixed for each pass.
+ */
+static const unsigned char *fixedReadLine (void)
+{
+	if (FixedLineChar == NULL  &&  ! FixedEof)
+	{
+		FixedLineChar = fileReadLine ();
+		if (FixedLineChar == NULL)
+			FixedEof = TRUE;
+	}
+	return FixedLineChar;
+}
+
+static int fixedGetc (void)
 {
 	int c;
 
-	do
-		c = fileGetc ();
-	while (c != EOF  &&  c != '\n');
+	if (FixedUngetc != '\0')
+	{
+		c = FixedUngetc;
+		FixedUngetc = '\0';
+	}
+	else if (fixedReadLine () == NULL)
+		c = EOF;
+	else if (*FixedLineChar == '\0')  /* end of line buffer */
+	{
+		FixedLineChar = NULL;
+		c = '\n';
+	}
+	else
+		c = *FixedLineChar++;
+	return c;
+}
+
+static void fixedUngetc (const int c)
+{
+	FixedUngetc = c;
+}
+
+static int skipFixedLine (void)
+{
+	int c = '\n';
 
+	FixedUngetc = '\0';
+	if (fixedReadLine () == NULL)
+		c = EOF;
+	FixedLineChar = NULL;  /* discard the remainder of the line */
 	return c;
 }
 
@@ -520,13 +574,31 @@ static void makeLabelTag (vString *const label)
 
 static lineType getLineType (void)
 {
-	vString *label = vStringNew ();
+	static vString *label = NULL;
+	const unsigned char *line;
+	unsigned int i = 0;
+	boolean lineDone = FALSE;
 	int column = 0;
 	lineType type = LTYPE_UNDETERMINED;
 
-	do  /* read in first 6 "margin" characters */
+	if (label == NULL)
+		label = vStringNew ();
+	vStringClear (label);
+
+	line = fixedReadLine ();
+	if (line == NULL)
+		type = LTYPE_EOF;
+	else do  /* classify the first 6 "margin" characters in place */
 	{
-		int c = fileGetc ();
+		int c;
+
+		if (line [i] == '\0')
+		{
+			c = '\n';
+			lineDone = TRUE;
+		}
+		else
+			c = line [i];
 
 		/* 3.2.1  Comment_Line.  A comment line is any line that contains
 		 * a C or an asterisk in column 1, or contains only blank characters
@@ -569,8 +641,6 @@ static lineType getLineType (void)
 		}
 		else if (c == ' ')
 			;
-		else if (c == EOF)
-			type = LTYPE_EOF;
 		else if (c == '\n')
 			type = LTYPE_SHORT;
 		else if (isdigit (c))
@@ -579,16 +649,19 @@ static lineType getLineType (void)
 			type = LTYPE_INVALID;
 
 		++column;
+		++i;
 	} while (column < 6  &&  type == LTYPE_UNDETERMINED);
 
 	Assert (type != LTYPE_UNDETERMINED);
 
+	if (line != NULL)
+		FixedLineChar = lineDone ? NULL : line + i;
+
 	if (vStringLength (label) > 0)
 	{
 		vStringTerminate (label);
 		makeLabelTag (label);
 	}
-	vStringDelete (label);
 	return type;
 }
 
@@ -604,11 +677,11 @@ static int getFixedFormChar (void)
 		/*  EXCEPTION! Some compilers permit more than 72 characters per line.
 		 */
 		if (Column > 71)
-			c = skipLine ();
+			c = skipFixedLine ();
 		else
 #endif
 		{
-			c = fileGetc ();
+			c = fixedGetc ();
 			++Column;
 		}
 		if (c == '\n')
@@ -618,17 +691,17 @@ static int getFixedFormChar (void)
 		}
 		else if (c == '!'  &&  ! ParsingString)
 		{
-			c = skipLine ();
+			c = skipFixedLine ();
 			newline = TRUE;  /* need to check for continuation line */
 			Column = 0;
 		}
 		else if (c == '&')  /* check for free source form */
 		{
-			const int c2 = fileGetc ();
+			const int c2 = fixedGetc ();
 			if (c2 == '\n')
 				longjmp (Exception, (int) ExceptionFixedFormat);
 			else
-				fileUngetc (c2);
+				fixedUngetc (c2);
 		}
 	}
 	while (Column == 0)
@@ -642,7 +715,7 @@ static int getFixedFormChar (void)
 				break;
 
 			case LTYPE_SHORT: break;
-			case LTYPE_COMMENT: skipLine (); break;
+			case LTYPE_COMMENT: skipFixedLine (); break;
 
 			case LTYPE_EOF:
 				Column = 6;
@@ -664,14 +737,14 @@ static int getFixedFormChar (void)
 				Column = 5;
 				do
 				{
-					c = fileGetc ();
+					c = fixedGetc ();
 					++Column;
 				} while (isBlank (c));
 				if (c == '\n')
 					Column = 0;
 				else if (Column > 6)
 				{
-					fileUngetc (c);
+					fixedUngetc (c);
 					c = ' ';
 				}
 				break;
@@ -973,7 +1046,7 @@ getNextChar:
 			}
 			else
 			{
-				skipLine ();
+				skipFixedLine ();
 				Column = 0;
 			}
 			/* fall through to newline case */
@@ -2149,6 +2222,9 @@ static rescanReason findFortranTags (const unsigned int passCount)
 	token = newToken ();
 	FreeSourceForm = (boolean) (passCount > 1);
 	Column = 0;
+	FixedLineChar = NULL;
+	FixedUngetc = '\0';
+	FixedEof = FALSE;
 	exception = (exception_t) setjmp (Exception);
 	if (exception == ExceptionEOF)
 		rescan = RESCAN_NONE;
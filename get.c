@@ -108,6 +108,16 @@ extern unsigned int getDirectiveNestLevel (void)
 	return Cpp.directive.nestLevel;
 }
 
+/*  TRUE when no ungotten character is pending at either the directive layer
+ *  or the raw reader, i.e. the next character comes straight from the input
+ *  buffer. A parse checkpoint is only meaningful at such a point.
+ */
+extern boolean cppUngetBufferEmpty (void)
+{
+	return (boolean) (Cpp.ungetch == '\0'  &&  Cpp.ungetch2 == '\0'  &&
+					  File.ungetch == '\0');
+}
+
 extern void cppInit (const boolean state, const boolean hasAtLiteralStrings)
 {
 	BraceFormat = state;
@@ -439,24 +449,19 @@ static Comment isComment (void)
  */
 int skipOverCComment (void)
 {
-	int c = fileGetc ();
+	int c = fileSkipToCharacter ('*');
 
 	while (c != EOF)
 	{
-		if (c != '*')
-			c = fileGetc ();
-		else
-		{
-			const int next = fileGetc ();
+		const int next = fileGetc ();
 
-			if (next != '/')
-				c = next;
-			else
-			{
-				c = SPACE;  /* replace comment with space */
-				break;
-			}
+		if (next == '/')
+		{
+			c = SPACE;  /* replace comment with space */
+			break;
 		}
+		else if (next != '*')  /* a second star may be the closing one */
+			c = fileSkipToCharacter ('*');
 	}
 	return c;
 }
@@ -467,11 +472,11 @@ static int skipOverCplusComment (void)
 {
 	int c;
 
-	while ((c = fileGetc ()) != EOF)
+	while ((c = fileSkipToCharacters ("\\\n")) != EOF)
 	{
 		if (c == BACKSLASH)
 			fileGetc ();  /* throw away next character, too */
-		else if (c == NEWLINE)
+		else  /* c == NEWLINE */
 			break;
 	}
 	return c;
@@ -484,11 +489,11 @@ static int skipToEndOfString (boolean ignoreBackslash)
 {
 	int c;
 
-	while ((c = fileGetc ()) != EOF)
+	while ((c = fileSkipToCharacters (ignoreBackslash ? "\"" : "\\\"")) != EOF)
 	{
-		if (c == BACKSLASH && ! ignoreBackslash)
+		if (c == BACKSLASH)
 			fileGetc ();  /* throw away next character, too */
-		else if (c == DOUBLE_QUOTE)
+		else  /* c == DOUBLE_QUOTE */
 			break;
 	}
 	return STRING_SYMBOL;  /* symbolic representation of string */
@@ -526,6 +531,99 @@ static int skipToEndOfChar (void)
 	return CHAR_SYMBOL;  /* symbolic representation of character */
 }
 
+/*  Skips over the body of an ignored conditional branch in bulk: each
+ *  line is tested for a leading '#' (blanks permitted before it) and
+ *  otherwise discarded with a single scan to its newline, with just
+ *  enough comment tracking that a conditional directive buried in a
+ *  block comment cannot terminate the branch early. Only lines opening
+ *  with '#' re-enter the full directive machinery. Returns that '#', or
+ *  EOF when the file ends inside the branch.
+ */
+static int skipIgnoredBranch (void)
+{
+	boolean inComment = FALSE;
+	int c;
+
+	while ((c = fileGetc ()) != EOF)
+	{
+		int prev;
+		const char *rest;
+
+		if (! inComment)
+		{
+			while (c == SPACE  ||  c == TAB)
+				c = fileGetc ();
+			if (c == '#')
+			{
+				Cpp.directive.accept = TRUE;
+				return c;
+			}
+		}
+		if (c == NEWLINE  ||  c == EOF)
+			continue;
+
+		/*  Track block comment delimiters across the rest of the line.
+		 */
+		prev = c;
+		rest = fileCurrentLine ();
+		for ( ;  rest != NULL  &&  *rest != '\0'  ;  ++rest)
+		{
+			const int next = *rest;
+			if (inComment)
+			{
+				if (prev == '*'  &&  next == '/')
+				{
+					inComment = FALSE;
+					prev = '\0';
+				}
+				else
+					prev = next;
+			}
+			else if (prev == '/'  &&  next == '*')
+			{
+				inComment = TRUE;
+				prev = '\0';
+			}
+			else if (prev == '/'  &&  next == '/')
+				break;  /* the rest of the line is a comment */
+			else
+				prev = next;
+		}
+		fileSkipToCharacter (NEWLINE);
+	}
+	return c;
+}
+
+/*  Bulk-skips plain text inside a balanced span. Safe only immediately
+ *  after cppGetc () has returned an ordinary character, when no
+ *  directive can be pending on the current line: everything the
+ *  preprocessor would hand back unchanged is consumed with one
+ *  vectorized scan per segment, and the first byte that could matter -
+ *  the span delimiters, a comment, string, character or trigraph
+ *  starter, a continuation backslash or the end of the line - is pushed
+ *  back to be read through cppGetc () as usual.
+ */
+extern void cppSkipPlainText (const int begin, const int end)
+{
+	char set [10];
+	int n = 0;
+
+	if (Cpp.ungetch != '\0')
+		return;  /* an already-processed character is pending */
+	set [n++] = (char) begin;
+	set [n++] = (char) end;
+	set [n++] = '/';
+	set [n++] = DOUBLE_QUOTE;
+	set [n++] = SINGLE_QUOTE;
+	set [n++] = BACKSLASH;
+	set [n++] = '?';
+	set [n++] = NEWLINE;
+	if (Cpp.hasAtLiteralStrings)
+		set [n++] = '@';
+	set [n] = '\0';
+	fileUngetc (fileSkipToCharacters (set));
+}
+
 /*  This function returns the next character, stripping out comments,
  *  C pre-processor directives, and the contents of single and double
  *  quoted strings. In short, strip anything which places a burden upon
@@ -563,6 +661,15 @@ process:
 				if (directive  &&  ! ignore)
 					directive = FALSE;
 				Cpp.directive.accept = TRUE;
+				if (ignore)
+				{
+					/*  The branch is dead until a conditional directive
+					 *  revives it; skip its lines wholesale rather than
+					 *  through the state machine.
+					 */
+					c = skipIgnoredBranch ();
+					goto process;
+				}
 				break;
 
 			case DOUBLE_QUOTE:
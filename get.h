@@ -17,6 +17,7 @@
 #include "general.h"  /* must always come first */
 
 #include "ctags.h"  /* to define langType */
+#include "routines.h"  /* to define character classes */
 
 /*
 *   MACROS
@@ -24,25 +25,27 @@
 /*  Is the character valid as a character of a C identifier?
  *  VMS allows '$' in identifiers.
  */
-#define isident(c)  (isalnum(c) || (c) == '_' || (c) == '$')
+#define isident(c)  charTest (c, CHAR_C_IDENTIFIER)
 
 /*  Is the character valid as the first character of a C identifier?
  *  C++ allows '~' in destructors.
  *  VMS allows '$' in identifiers.
  */
-#define isident1(c)  (isalpha(c) || (c) == '_' || (c) == '~' || (c) == '$')
+#define isident1(c)  charTest (c, CHAR_C_IDENTIFIER1)
 
 /*
 *   FUNCTION PROTOTYPES
 */
 extern boolean isBraceFormat (void);
 extern unsigned int getDirectiveNestLevel (void);
+extern boolean cppUngetBufferEmpty (void);
 extern void cppInit (const boolean state, const boolean hasAtLiteralStrings);
 extern void cppTerminate (void);
 extern void cppBeginStatement (void);
 extern void cppEndStatement (void);
 extern void cppUngetc (const int c);
 extern int cppGetc (void);
+extern void cppSkipPlainText (const int begin, const int end);
 extern int skipOverCComment (void);
 
 #endif  /* _GET_H */
@@ -73,7 +73,7 @@ typedef struct sTokenInfo {
 	keywordId keyword;
 	vString *string;		/* the name of the token */
 	unsigned long lineNumber;	/* line number of tag */
-	fpos_t filePosition;		/* file position of line containing name */
+	filePos filePosition;		/* file position of line containing name */
 } tokenInfo;
 
 /*
@@ -139,12 +139,30 @@ static void initialize (const langType language)
 	}
 }
 
+// Each declaration parsed creates and destroys a name token, so spent
+// tokens are kept in a small pool for reuse instead of being allocated
+// and freed every time.
+#define TOKEN_POOL_SIZE 8
+
+static tokenInfo *TokenPool [TOKEN_POOL_SIZE];
+static unsigned int TokenPoolCount = 0;
+
 static tokenInfo *newToken (void)
 {
-	tokenInfo *const token = xMalloc (1, tokenInfo);
+	tokenInfo *token;
+
+	if (TokenPoolCount > 0)
+	{
+		token = TokenPool [--TokenPoolCount];
+		vStringClear (token->string);
+	}
+	else
+	{
+		token = xMalloc (1, tokenInfo);
+		token->string = vStringNew ();
+	}
 	token->type = TOKEN_NONE;
 	token->keyword = KEYWORD_NONE;
-	token->string = vStringNew ();
 	token->lineNumber = getSourceLineNumber ();
 	token->filePosition = getInputFilePosition ();
 	return token;
@@ -154,8 +172,13 @@ static void deleteToken (tokenInfo * const token)
 {
 	if (token != NULL)
 	{
-		vStringDelete (token->string);
-		eFree (token);
+		if (TokenPoolCount < TOKEN_POOL_SIZE)
+			TokenPool [TokenPoolCount++] = token;
+		else
+		{
+			vStringDelete (token->string);
+			eFree (token);
+		}
 	}
 }
 
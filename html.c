@@ -14,25 +14,142 @@
 *   INCLUDE FILES
 */
 #include "general.h"  /* must always come first */
+
+#include <string.h>
+#include <ctype.h>
+
 #include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_ANCHOR,
+	K_FUNCTION
+} htmlKind;
+
+static kindOption HtmlKinds [] = {
+	{ TRUE, 'a', "anchor",   "named anchors" },
+	{ TRUE, 'f', "function", "JavaScript functions" }
+};
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static void installHtmlRegex (const langType language)
+static boolean isIdentChar (const int c)
+{
+	return (boolean) (isalnum (c)  ||  c == '_');
+}
+
+static const unsigned char *skipBlanks (const unsigned char *cp)
+{
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	return cp;
+}
+
+/*  Parses the attribute list of an anchor element beginning at "cp" (just
+ *  past "<a"), capturing the value of its "name" attribute. Attribute names
+ *  are alphabetic, values optionally double-quoted; anything else, or a
+ *  missing closing '>', rejects the element, as the old pattern did.
+ */
+static boolean parseAnchorElement (
+		const unsigned char *cp, vString *const name)
+{
+	boolean foundName = FALSE;
+
+	if (*cp != ' '  &&  *cp != '\t')
+		return FALSE;
+	while (*cp == ' '  ||  *cp == '\t')
+	{
+		const unsigned char *attribute = cp = skipBlanks (cp);
+		boolean isNameAttribute;
+		boolean quoted;
+
+		if (! isalpha ((int) *cp))
+			break;
+		do
+			++cp;
+		while (isalpha ((int) *cp));
+		isNameAttribute = (boolean)
+			((cp - attribute) == 4  &&
+			 strncasecmp ((const char *) attribute, "name", (size_t) 4) == 0);
+		if (*cp != '=')
+			return FALSE;
+		++cp;
+		quoted = (boolean) (*cp == '"');
+		if (quoted)
+			++cp;
+		if (isNameAttribute)
+			vStringClear (name);
+		while (*cp != '\0'  &&  *cp != '"'  &&  *cp != '>'  &&
+			   (quoted  ||  (*cp != ' '  &&  *cp != '\t')))
+		{
+			if (isNameAttribute)
+				vStringPut (name, (int) *cp);
+			++cp;
+		}
+		if (isNameAttribute)
+		{
+			vStringTerminate (name);
+			foundName = (boolean) (vStringLength (name) > 0);
+		}
+		if (*cp == '"')
+			++cp;
+	}
+	cp = skipBlanks (cp);
+	return (boolean) (foundName  &&  *cp == '>');
+}
+
+static void findAnchorTag (const unsigned char *line, vString *const name)
 {
-#define POSSIBLE_ATTRIBUTES "([ \t]+[a-z]+=\"?[^>\"]*\"?)*"
-	addTagRegex (language,
-		"<a"
-		POSSIBLE_ATTRIBUTES
-		"[ \t]+name=\"?([^>\"]+)\"?"
-		POSSIBLE_ATTRIBUTES
-		"[ \t]*>",
-		"\\2", "a,anchor,named anchors", "i");
-
-	addTagRegex (language, "^[ \t]*function[ \t]*([A-Za-z0-9_]+)[ \t]*\\(",
-		"\\1", "f,function,JavaScript functions", NULL);
+	const char *cp = (const char *) line;
+
+	while ((cp = strchr (cp, '<')) != NULL)
+	{
+		++cp;
+		if (tolower ((int) *cp) == 'a'  &&
+			parseAnchorElement ((const unsigned char *) cp + 1, name))
+		{
+			makeSimpleTag (name, HtmlKinds, K_ANCHOR);
+			break;  /* one anchor per line, as with the old pattern */
+		}
+	}
+}
+
+static void findFunctionTag (const unsigned char *line, vString *const name)
+{
+	const unsigned char *cp = skipBlanks (line);
+
+	if (strncmp ((const char *) cp, "function", (size_t) 8) != 0)
+		return;
+	cp = skipBlanks (cp + 8);
+	vStringClear (name);
+	while (isIdentChar ((int) *cp))
+	{
+		vStringPut (name, (int) *cp);
+		++cp;
+	}
+	vStringTerminate (name);
+	cp = skipBlanks (cp);
+	if (vStringLength (name) > 0  &&  *cp == '(')
+		makeSimpleTag (name, HtmlKinds, K_FUNCTION);
+}
+
+static void findHtmlTags (void)
+{
+	vString *const name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		findAnchorTag (line, name);
+		findFunctionTag (line, name);
+	}
+	vStringDelete (name);
 }
 
 /* Create parser definition stucture */
@@ -40,9 +157,10 @@ extern parserDefinition* HtmlParser (void)
 {
 	static const char *const extensions [] = { "htm", "html", NULL };
 	parserDefinition *const def = parserNew ("HTML");
+	def->kinds      = HtmlKinds;
+	def->kindCount  = KIND_COUNT (HtmlKinds);
 	def->extensions = extensions;
-	def->initialize = installHtmlRegex;
-	def->regex      = TRUE;
+	def->parser     = findHtmlTags;
 	return def;
 }
 
@@ -0,0 +1,139 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Manages a table of interned strings. Interning hands out one stable,
+*   shared copy of each distinct string, so values which recur many times
+*   over a run (source file paths, scope names) are stored only once and
+*   may thereafter be compared by pointer.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "debug.h"
+#include "intern.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#define HASH_EXPONENT 12  /* must be less than 17 */
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sInternEntry {
+	struct sInternEntry *next;
+	char *string;
+} internEntry;
+
+/*
+*   DATA DEFINITIONS
+*/
+static const unsigned int TableSize = 1 << HASH_EXPONENT;
+static internEntry **HashTable = NULL;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static internEntry **getHashTable (void)
+{
+	static boolean allocated = FALSE;
+
+	if (! allocated)
+	{
+		unsigned int i;
+
+		HashTable = xMalloc (TableSize, internEntry*);
+
+		for (i = 0  ;  i < TableSize  ;  ++i)
+			HashTable [i] = NULL;
+
+		allocated = TRUE;
+	}
+	return HashTable;
+}
+
+static unsigned long hashValue (const char *const string)
+{
+	unsigned long value = 0;
+	const unsigned char *p;
+
+	Assert (string != NULL);
+
+	/*  We combine the various words of the multiword key using the method
+	 *  described on page 512 of Vol. 3 of "The Art of Computer Programming".
+	 */
+	for (p = (const unsigned char *) string  ;  *p != '\0'  ;  ++p)
+	{
+		value <<= 1;
+		if (value & 0x00000100L)
+			value = (value & 0x000000ffL) + 1L;
+		value ^= *p;
+	}
+	/*  Algorithm from page 509 of Vol. 3 of "The Art of Computer Programming"
+	 *  Treats "value" as a 16-bit integer plus 16-bit fraction.
+	 */
+	value *= 40503L;               /* = 2^16 * 0.6180339887 ("golden ratio") */
+	value &= 0x0000ffffL;          /* keep fractional part */
+	value >>= 16 - HASH_EXPONENT;  /* scale up by hash size and move down */
+
+	return value;
+}
+
+/*  Returns the shared copy of "string", creating it on first sight. The
+ *  result remains valid until freeInternTable() is called at exit; callers
+ *  must not modify or free it.
+ */
+extern const char *internString (const char *const string)
+{
+	internEntry **const table = getHashTable ();
+	const unsigned long hashedValue = hashValue (string);
+	internEntry *entry = table [hashedValue];
+
+	while (entry != NULL  &&  strcmp (string, entry->string) != 0)
+		entry = entry->next;
+	if (entry == NULL)
+	{
+		entry = xMalloc (1, internEntry);
+		entry->string = eStrdup (string);
+		entry->next = table [hashedValue];
+		table [hashedValue] = entry;
+	}
+	return entry->string;
+}
+
+extern void freeInternTable (void)
+{
+	if (HashTable != NULL)
+	{
+		unsigned int i;
+
+		for (i = 0  ;  i < TableSize  ;  ++i)
+		{
+			internEntry *entry = HashTable [i];
+
+			while (entry != NULL)
+			{
+				internEntry *next = entry->next;
+				eFree (entry->string);
+				eFree (entry);
+				entry = next;
+			}
+		}
+		eFree (HashTable);
+		HashTable = NULL;
+	}
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -0,0 +1,27 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to intern.c
+*/
+#ifndef _INTERN_H
+#define _INTERN_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern const char *internString (const char *const string);
+extern void freeInternTable (void);
+
+#endif  /* _INTERN_H */
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -0,0 +1,361 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Support for the journaled tag store written under --journal. Updating a
+*   large tag file ordinarily rewrites all of it, however few source files
+*   changed. In journal mode the existing file is left untouched as the base
+*   of the store and each run writes its output as a numbered segment
+*   "<tags>.jnlN" beside it: an ordinary tag file which additionally names
+*   every source file it covers in !_TAG_JOURNAL_FILE pseudo tags. Readers
+*   (see readtags.c) consult the segments newest first and suppress older
+*   entries of the covered files, so an update costs only the changed files'
+*   tags. compactJournal() folds the segments back into the base file, by
+*   itself under --journal-compact or automatically once enough segments
+*   accumulate.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "journal.h"
+#include "options.h"
+#include "read.h"
+#include "routines.h"
+#include "sort.h"
+#include "strlist.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+
+/*  Number of segments at which a run compacts the journal on its way out.
+ *  Every segment adds a probe to each lookup, so they are folded into the
+ *  base file before the lookup cost becomes noticeable.
+ */
+#define JOURNAL_COMPACT_THRESHOLD 8
+
+/*  Line prefix of the pseudo tags naming the source files a segment
+ *  covers, including the separating tab.
+ */
+#define JOURNAL_TAG_PREFIX "!_TAG_JOURNAL_FILE\t"
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  One input of a compaction: the base tag file or one segment, read a
+ *  line at a time with the lines it no longer contributes filtered out.
+ */
+typedef struct sJournalSource {
+	FILE *fp;               /* open stream, NULL once exhausted */
+	vString *line;          /* current contributed line */
+	const char **covered;   /* files replaced by newer segments, sorted */
+	size_t coveredCount;
+	boolean base;           /* is this the base tag file? */
+} journalSource;
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/*  Is the current run writing its output as a journal segment?
+ */
+static boolean WritingSegment = FALSE;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static char *segmentFileName (const unsigned int number)
+{
+	const char *const base = Option.tagFileName;
+	char *const name = xMalloc (strlen (base) + 16, char);
+
+	sprintf (name, "%s.jnl%u", base, number);
+	return name;
+}
+
+/*  Counts the segments currently beside the tag file. Segments are
+ *  numbered from 1 without gaps, so probing upward from there finds them
+ *  all.
+ */
+static unsigned int segmentCount (void)
+{
+	unsigned int count = 0;
+
+	while (TRUE)
+	{
+		char *const name = segmentFileName (count + 1);
+		const boolean exists = doesFileExist (name);
+
+		eFree (name);
+		if (! exists)
+			break;
+		++count;
+	}
+	return count;
+}
+
+extern boolean journalActive (void)
+{
+	return WritingSegment;
+}
+
+/*  Returns the name under which the current run's output is to be written
+ *  as the newest segment of the journal. The caller owns the buffer.
+ */
+extern char *journalSegmentName (void)
+{
+	char *const name = segmentFileName (segmentCount () + 1);
+
+	WritingSegment = TRUE;
+	verbose ("writing journal segment \"%s\"\n", name);
+	return name;
+}
+
+/*  Collects from a segment the names of the source files it covers, as
+ *  recorded in its !_TAG_JOURNAL_FILE pseudo tags. Unsorted segments
+ *  scatter them between the tag lines, so the whole segment is scanned;
+ *  segments hold only one run's output and stay small.
+ */
+static stringList *readCoveredFiles (const char *const segmentName)
+{
+	stringList *const result = stringListNew ();
+	FILE *const fp = fopen (segmentName, "r");
+
+	if (fp != NULL)
+	{
+		vString *const vLine = vStringNew ();
+		const size_t prefixLength = strlen (JOURNAL_TAG_PREFIX);
+		const char *line;
+
+		while ((line = readLine (vLine, fp)) != NULL)
+		{
+			if (strncmp (line, JOURNAL_TAG_PREFIX, prefixLength) == 0)
+			{
+				const char *const start = line + prefixLength;
+				const char *const tab = strchr (start, '\t');
+
+				if (tab != NULL)
+				{
+					vString *const name = vStringNew ();
+
+					vStringNCopyS (name, start, tab - start);
+					if (! stringListHas (result, vStringValue (name)))
+						stringListAdd (result, name);
+					else
+						vStringDelete (name);
+				}
+			}
+		}
+		vStringDelete (vLine);
+		fclose (fp);
+	}
+	return result;
+}
+
+static int compareNamePointers (const void *const one, const void *const two)
+{
+	return strcmp (*(const char *const *) one, *(const char *const *) two);
+}
+
+/*  Advances a compaction source to the next line it contributes, closing
+ *  it at end of file. The replaced-file records drop out, as do the
+ *  pseudo-tag headers of the segments (the base file's header carries
+ *  over) and every tag line whose source file a newer segment covers.
+ */
+static void advanceJournalSource (journalSource *const source)
+{
+	while (source->fp != NULL)
+	{
+		if (readLine (source->line, source->fp) == NULL)
+		{
+			fclose (source->fp);
+			source->fp = NULL;
+		}
+		else
+		{
+			const char *const line = vStringValue (source->line);
+
+			if (strncmp (line, "!_", 2) == 0)
+			{
+				if (! source->base  ||
+					strncmp (line, JOURNAL_TAG_PREFIX,
+							 strlen (JOURNAL_TAG_PREFIX)) == 0)
+					continue;
+			}
+			else if (source->coveredCount > 0  &&
+					 fileFieldMatches (line, source->covered,
+									   source->coveredCount))
+				continue;
+			break;
+		}
+	}
+}
+
+/*  Merges the journal segments into the base tag file and removes them.
+ *  Each source contributes only the lines not superseded by a newer
+ *  segment; sorted stores are combined in one linear merge pass, unsorted
+ *  ones by concatenation in age order. The merged file replaces the base
+ *  atomically, so a reader sees either the old layering or the compacted
+ *  file, never a torn state.
+ */
+extern void compactJournal (void)
+{
+	const unsigned int count = segmentCount ();
+	stringList **covered;
+	journalSource *sources;
+	vString *const previous = vStringNew ();
+	boolean havePrevious = FALSE;
+	char *tempName;
+	FILE *dest;
+	unsigned int i, j;
+
+	if (count == 0)
+	{
+		verbose ("no journal segments to compact\n");
+		vStringDelete (previous);
+		return;
+	}
+	verbose ("compacting %u journal segment(s) into \"%s\"\n",
+			 count, Option.tagFileName);
+
+	covered = xMalloc (count, stringList*);
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		char *const name = segmentFileName (i + 1);
+
+		covered [i] = readCoveredFiles (name);
+		eFree (name);
+	}
+
+	/*  Source 0 is the base file; source i is segment i. The files a
+	 *  source no longer speaks for are those covered by any newer
+	 *  segment, i.e. by the lists from index i onward.
+	 */
+	sources = xMalloc (count + 1, journalSource);
+	for (i = 0  ;  i <= count  ;  ++i)
+	{
+		journalSource *const source = &sources [i];
+		char *const name = (i == 0) ?
+				eStrdup (Option.tagFileName) : segmentFileName (i);
+		size_t total = 0;
+
+		source->base = (boolean) (i == 0);
+		source->line = vStringNew ();
+		source->fp = fopen (name, "r");
+		eFree (name);
+
+		for (j = i  ;  j < count  ;  ++j)
+			total += stringListCount (covered [j]);
+		source->coveredCount = total;
+		source->covered = (total == 0) ? NULL :
+				xMalloc (total, const char*);
+		total = 0;
+		for (j = i  ;  j < count  ;  ++j)
+		{
+			unsigned int k;
+
+			for (k = 0  ;  k < stringListCount (covered [j])  ;  ++k)
+				source->covered [total++] =
+					vStringValue (stringListItem (covered [j], k));
+		}
+		if (source->coveredCount > 0)
+			qsort (source->covered, source->coveredCount,
+				   sizeof (*source->covered), compareNamePointers);
+		if (source->fp != NULL)
+			advanceJournalSource (source);
+	}
+
+	tempName = xMalloc (strlen (Option.tagFileName) + 16, char);
+	sprintf (tempName, "%s.jnltmp", Option.tagFileName);
+	dest = fopen (tempName, "w");
+	if (dest == NULL)
+		error (FATAL | PERROR, "cannot open tag file \"%s\"", tempName);
+
+	if (Option.sorted == SO_UNSORTED)
+	{
+		for (i = 0  ;  i <= count  ;  ++i)
+			while (sources [i].fp != NULL)
+			{
+				if (fputs (vStringValue (sources [i].line), dest) == EOF)
+					error (FATAL | PERROR, "cannot write tag file");
+				advanceJournalSource (&sources [i]);
+			}
+	}
+	else do
+	{
+		journalSource *smallest = NULL;
+
+		for (i = 0  ;  i <= count  ;  ++i)
+		{
+			if (sources [i].fp != NULL  &&
+				(smallest == NULL  ||
+				 compareTagLine (vStringValue (sources [i].line),
+								 vStringValue (smallest->line)) < 0))
+				smallest = &sources [i];
+		}
+		if (smallest == NULL)
+			break;
+		havePrevious = putMergedLine (
+				dest, vStringValue (smallest->line), previous, havePrevious);
+		advanceJournalSource (smallest);
+	} while (TRUE);
+
+	if (fclose (dest) != 0)
+		error (FATAL | PERROR, "cannot write tag file");
+	if (rename (tempName, Option.tagFileName) != 0)
+		error (FATAL | PERROR, "cannot replace tag file \"%s\"",
+			   Option.tagFileName);
+	eFree (tempName);
+
+	/*  Removing segment 1 first keeps the remaining layering readable:
+	 *  a reader probes upward from 1 and simply stops early.
+	 */
+	for (i = 1  ;  i <= count  ;  ++i)
+	{
+		char *const name = segmentFileName (i);
+
+		remove (name);
+		eFree (name);
+	}
+
+	for (i = 0  ;  i <= count  ;  ++i)
+	{
+		vStringDelete (sources [i].line);
+		if (sources [i].covered != NULL)
+			eFree ((char **) sources [i].covered);
+	}
+	eFree (sources);
+	for (i = 0  ;  i < count  ;  ++i)
+		stringListDelete (covered [i]);
+	eFree (covered);
+	vStringDelete (previous);
+}
+
+/*  Compacts the journal at the end of a run which grew it past the
+ *  threshold.
+ */
+extern void journalMaybeCompact (void)
+{
+	if (WritingSegment)
+	{
+		WritingSegment = FALSE;
+		if (segmentCount () >= JOURNAL_COMPACT_THRESHOLD)
+			compactJournal ();
+	}
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -0,0 +1,29 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to journal.c
+*/
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern boolean journalActive (void);
+extern char *journalSegmentName (void);
+extern void compactJournal (void);
+extern void journalMaybeCompact (void);
+
+#endif  /* _JOURNAL_H */
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -109,7 +109,7 @@ typedef struct sTokenInfo {
 	vString *		string;
 	vString *		scope;
 	unsigned long 	lineNumber;
-	fpos_t 			filePosition;
+	filePos 			filePosition;
 	int				nestLevel;
 	boolean			ignoreTag;
 } tokenInfo;
@@ -171,9 +171,7 @@ static boolean parseLine (tokenInfo *const token, boolean is_inside_class);
 
 static boolean isIdentChar (const int c)
 {
-	return (boolean)
-		(isalpha (c) || isdigit (c) || c == '$' || 
-		 c == '@' || c == '_' || c == '#');
+	return (boolean) (charTest (c, CHAR_AT_IDENTIFIER) != 0);
 }
 
 static void buildJsKeywordHash (void)
@@ -181,6 +179,7 @@ static void buildJsKeywordHash (void)
 	const size_t count = sizeof (JsKeywordTable) /
 		sizeof (JsKeywordTable [0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_js);
 	for (i = 0	;  i < count  ;  ++i)
 	{
 		const keywordDesc* const p = &JsKeywordTable [i];
@@ -188,14 +187,35 @@ static void buildJsKeywordHash (void)
 	}
 }
 
+/* Released tokens are kept in a small pool for reuse rather than being
+ * freed, since the parser creates and destroys several per statement;
+ * recycling one costs two vStringClear calls instead of three frees and
+ * three allocations.
+ */
+#define TOKEN_POOL_SIZE 8
+
+static tokenInfo *TokenPool [TOKEN_POOL_SIZE];
+static unsigned int TokenPoolCount = 0;
+
 static tokenInfo *newToken (void)
 {
-	tokenInfo *const token = xMalloc (1, tokenInfo);
+	tokenInfo *token;
+
+	if (TokenPoolCount > 0)
+	{
+		token = TokenPool [--TokenPoolCount];
+		vStringClear (token->string);
+		vStringClear (token->scope);
+	}
+	else
+	{
+		token = xMalloc (1, tokenInfo);
+		token->string = vStringNew ();
+		token->scope  = vStringNew ();
+	}
 
 	token->type			= TOKEN_UNDEFINED;
 	token->keyword		= KEYWORD_NONE;
-	token->string		= vStringNew ();
-	token->scope		= vStringNew ();
 	token->nestLevel	= 0;
 	token->ignoreTag	= FALSE;
 	token->lineNumber   = getSourceLineNumber ();
@@ -206,9 +226,14 @@ static tokenInfo *newToken (void)
 
 static void deleteToken (tokenInfo *const token)
 {
-	vStringDelete (token->string);
-	vStringDelete (token->scope);
-	eFree (token);
+	if (TokenPoolCount < TOKEN_POOL_SIZE)
+		TokenPool [TokenPoolCount++] = token;
+	else
+	{
+		vStringDelete (token->string);
+		vStringDelete (token->scope);
+		eFree (token);
+	}
 }
 
 /*
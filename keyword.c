@@ -7,6 +7,10 @@
 *   GNU General Public License.
 *
 *   Manages a keyword hash.
+*
+*   Each language owns a flat, open-addressed table sized to its keyword
+*   count, so a lookup probes one or two adjacent entries instead of chasing
+*   list nodes shared with every other language's keywords.
 */
 
 /*
@@ -15,6 +19,7 @@
 #include "general.h"  /* must always come first */
 
 #include <string.h>
+#include <ctype.h>
 
 #include "debug.h"
 #include "keyword.h"
@@ -24,233 +29,308 @@
 /*
 *   MACROS
 */
-#define HASH_EXPONENT 7  /* must be less than 17 */
+#define INITIAL_EXPONENT 7  /* must be less than 17 */
 
 /*
 *   DATA DECLARATIONS
 */
-typedef struct sHashEntry {
-	struct sHashEntry *next;
-	const char *string;
-	langType language;
+typedef struct sKeywordEntry {
+	const char *string;  /* NULL when the slot is empty */
 	int value;
-} hashEntry;
+} keywordEntry;
+
+typedef struct sKeywordTable {
+	keywordEntry *entries;   /* 1 << exponent slots */
+	unsigned int exponent;
+	unsigned int count;      /* number of occupied slots */
+	boolean folding;         /* case-insensitive hashing and comparison */
+} keywordTable;
 
 /*
 *   DATA DEFINITIONS
 */
-static const unsigned int TableSize = 1 << HASH_EXPONENT;
-static hashEntry **HashTable = NULL;
+static keywordTable *Tables = NULL;
+static unsigned int TableCount = 0;
+
+/* Scratch buffer reused by analyzeToken() */
+static vString *AnalyzedToken = NULL;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static hashEntry **getHashTable (void)
+static keywordEntry *newSlots (const unsigned int exponent)
 {
-	static boolean allocated = FALSE;
+	const unsigned int size = 1 << exponent;
+	keywordEntry *const entries = xMalloc (size, keywordEntry);
+	unsigned int i;
 
-	if (! allocated)
+	for (i = 0  ;  i < size  ;  ++i)
 	{
-		unsigned int i;
-
-		HashTable = xMalloc (TableSize, hashEntry*);
+		entries [i].string = NULL;
+		entries [i].value = 0;
+	}
+	return entries;
+}
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
-			HashTable [i] = NULL;
+static keywordTable *getKeywordTable (const langType language)
+{
+	if ((unsigned int) language >= TableCount)
+	{
+		const unsigned int count = (unsigned int) language + 1;
+		unsigned int i;
 
-		allocated = TRUE;
+		Tables = xRealloc (Tables, count, keywordTable);
+		for (i = TableCount  ;  i < count  ;  ++i)
+		{
+			Tables [i].entries = NULL;
+			Tables [i].exponent = 0;
+			Tables [i].count = 0;
+			Tables [i].folding = FALSE;
+		}
+		TableCount = count;
 	}
-	return HashTable;
+	if (Tables [language].entries == NULL)
+	{
+		Tables [language].exponent = INITIAL_EXPONENT;
+		Tables [language].entries = newSlots (INITIAL_EXPONENT);
+	}
+	return Tables + language;
 }
 
-static hashEntry *getHashTableEntry (unsigned long hashedValue)
+/*  Maps an accumulated hash to a slot of a table of the given size.
+ *  Algorithm from page 509 of Vol. 3 of "The Art of Computer Programming";
+ *  treats "value" as a 16-bit integer plus 16-bit fraction.
+ */
+static unsigned long scaleHashValue (
+		unsigned long value, const unsigned int exponent)
 {
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry;
+	value *= 40503L;           /* = 2^16 * 0.6180339887 ("golden ratio") */
+	value &= 0x0000ffffL;      /* keep fractional part */
+	value >>= 16 - exponent;   /* scale up by hash size and move down */
 
-	Assert (hashedValue < TableSize);
-	entry = table [hashedValue];
-
-	return entry;
+	return value;
 }
 
-static unsigned long hashValue (const char *const string)
+static unsigned long hashValue (
+		const char *const string, const unsigned int exponent,
+		const boolean folding)
 {
-	unsigned long value = 0;
+	unsigned long value = KEYWORD_HASH_INIT;
 	const unsigned char *p;
 
 	Assert (string != NULL);
 
 	/*  We combine the various words of the multiword key using the method
 	 *  described on page 512 of Vol. 3 of "The Art of Computer Programming".
+	 *  keywordHashFeed () lets a lexer run the same accumulation while it
+	 *  scans the identifier.
 	 */
 	for (p = (const unsigned char *) string  ;  *p != '\0'  ;  ++p)
+		keywordHashFeed (value, folding ? tolower ((int) *p) : (int) *p);
+
+	return scaleHashValue (value, exponent);
+}
+
+/*  Compares a candidate token against a stored keyword, folding the case of
+ *  the candidate when the table is case-insensitive; keywords are stored in
+ *  lower case already.
+ */
+static boolean stringsMatch (
+		const char *const string, const char *const keyword,
+		const boolean folding)
+{
+	boolean result;
+
+	if (! folding)
+		result = (boolean) (strcmp (string, keyword) == 0);
+	else
 	{
-		value <<= 1;
-		if (value & 0x00000100L)
-			value = (value & 0x000000ffL) + 1L;
-		value ^= *p;
-	}
-	/*  Algorithm from page 509 of Vol. 3 of "The Art of Computer Programming"
-	 *  Treats "value" as a 16-bit integer plus 16-bit fraction.
-	 */
-	value *= 40503L;               /* = 2^16 * 0.6180339887 ("golden ratio") */
-	value &= 0x0000ffffL;          /* keep fractional part */
-	value >>= 16 - HASH_EXPONENT;  /* scale up by hash size and move down */
+		const unsigned char *s = (const unsigned char *) string;
+		const unsigned char *k = (const unsigned char *) keyword;
 
-	return value;
+		while (*k != '\0'  &&  tolower ((int) *s) == (int) *k)
+			++s, ++k;
+		result = (boolean) (*k == '\0'  &&  *s == '\0');
+	}
+	return result;
 }
 
-static hashEntry *newEntry (
-		const char *const string, langType language, int value)
+static void insertEntry (
+		keywordTable *const table, const char *const string, const int value)
 {
-	hashEntry *const entry = xMalloc (1, hashEntry);
+	const unsigned long mask = (1 << table->exponent) - 1;
+	unsigned long slot = hashValue (string, table->exponent, table->folding);
 
-	entry->next     = NULL;
-	entry->string   = string;
-	entry->language = language;
-	entry->value    = value;
+	while (table->entries [slot].string != NULL)
+	{
+		Assert (strcmp (string, table->entries [slot].string) != 0);
+		slot = (slot + 1) & mask;
+	}
+	table->entries [slot].string = string;
+	table->entries [slot].value = value;
+	++table->count;
+}
 
-	return entry;
+static void growKeywordTable (keywordTable *const table)
+{
+	keywordEntry *const old = table->entries;
+	const unsigned int oldSize = 1 << table->exponent;
+	unsigned int i;
+
+	++table->exponent;
+	table->entries = newSlots (table->exponent);
+	table->count = 0;
+	for (i = 0  ;  i < oldSize  ;  ++i)
+		if (old [i].string != NULL)
+			insertEntry (table, old [i].string, old [i].value);
+	eFree (old);
 }
 
 /*  Note that it is assumed that a "value" of zero means an undefined keyword
  *  and clients of this function should observe this. Also, all keywords added
  *  should be added in lower case. If we encounter a case-sensitive language
- *  whose keywords are in upper case, we will need to redesign this.
+ *  whose keywords are in upper case, we will need to redesign this. The
+ *  string is not copied; parsers pass static keyword lists.
  */
 extern void addKeyword (const char *const string, langType language, int value)
 {
-	const unsigned long hashedValue = hashValue (string);
-	hashEntry *entry = getHashTableEntry (hashedValue);
+	keywordTable *const table = getKeywordTable (language);
 
-	if (entry == NULL)
-	{
-		hashEntry **const table = getHashTable ();
-		table [hashedValue] = newEntry (string, language, value);
-	}
-	else
-	{
-		hashEntry *prev = NULL;
+	/*  Keep the table at most three quarters full so probe runs stay short.
+	 */
+	if (4 * (table->count + 1) > 3 * (1u << table->exponent))
+		growKeywordTable (table);
+	insertEntry (table, string, value);
+}
 
-		while (entry != NULL)
-		{
-			if (language == entry->language  &&
-				strcmp (string, entry->string) == 0)
-			{
-				Assert (("Already in table" == NULL));
-			}
-			prev = entry;
-			entry = entry->next;
-		}
-		if (entry == NULL)
-		{
-			Assert (prev != NULL);
-			prev->next = newEntry (string, language, value);
-		}
-	}
+/*  Declares the keyword table of "language" case-insensitive: tokens are
+ *  matched against its (lower case) keywords without regard to case. Must be
+ *  called before any keyword is added for the language.
+ */
+extern void setKeywordCaseFolding (const langType language)
+{
+	keywordTable *const table = getKeywordTable (language);
+
+	Assert (table->count == 0);
+	table->folding = TRUE;
 }
 
-extern int lookupKeyword (const char *const string, langType language)
+static int probeTable (
+		const keywordTable *const table, const char *const string,
+		unsigned long slot)
 {
-	const unsigned long hashedValue = hashValue (string);
-	hashEntry *entry = getHashTableEntry (hashedValue);
+	const unsigned long mask = (1 << table->exponent) - 1;
 	int result = -1;
 
-	while (entry != NULL)
+	while (table->entries [slot].string != NULL)
 	{
-		if (language == entry->language  &&  strcmp (string, entry->string) == 0)
+		if (stringsMatch (string, table->entries [slot].string,
+						  table->folding))
 		{
-			result = entry->value;
+			result = table->entries [slot].value;
 			break;
 		}
-		entry = entry->next;
+		slot = (slot + 1) & mask;
 	}
 	return result;
 }
 
-extern void freeKeywordTable (void)
+extern int lookupKeyword (const char *const string, langType language)
 {
-	if (HashTable != NULL)
-	{
-		unsigned int i;
+	int result = -1;
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
-		{
-			hashEntry *entry = HashTable [i];
-
-			while (entry != NULL)
-			{
-				hashEntry *next = entry->next;
-				eFree (entry);
-				entry = next;
-			}
-		}
-		eFree (HashTable);
+	if ((unsigned int) language < TableCount  &&
+		Tables [language].entries != NULL)
+	{
+		const keywordTable *const table = Tables + language;
+		result = probeTable (table, string,
+				hashValue (string, table->exponent, table->folding));
 	}
+	return result;
 }
 
-extern int analyzeToken (vString *const name, langType language)
+/*  Like lookupKeyword (), but takes the rolling hash the lexer accumulated
+ *  with keywordHashFeed () while scanning the identifier, saving the
+ *  traversal hashValue () would spend recomputing it.  A case-folding
+ *  table hashes lowercased characters, which the lexer did not fold, so
+ *  those tables fall back to hashing the string themselves.
+ */
+extern int lookupKeywordHashed (
+		const char *const string, const unsigned long hash, langType language)
 {
-	vString *keyword = vStringNew ();
-	int result;
-	vStringCopyToLower (keyword, name);
-	result = lookupKeyword (vStringValue (keyword), language);
-	vStringDelete (keyword);
+	int result = -1;
+
+	if ((unsigned int) language < TableCount  &&
+		Tables [language].entries != NULL)
+	{
+		const keywordTable *const table = Tables + language;
+		const unsigned long slot = table->folding
+				? hashValue (string, table->exponent, TRUE)
+				: scaleHashValue (hash, table->exponent);
+		result = probeTable (table, string, slot);
+	}
 	return result;
 }
 
-#ifdef DEBUG
-
-static void printEntry (const hashEntry *const entry)
+extern void freeKeywordTable (void)
 {
-	printf ("  %-15s %-7s\n", entry->string, getLanguageName (entry->language));
+	if (Tables != NULL)
+	{
+		unsigned int i;
+
+		for (i = 0  ;  i < TableCount  ;  ++i)
+			if (Tables [i].entries != NULL)
+				eFree (Tables [i].entries);
+		eFree (Tables);
+		Tables = NULL;
+		TableCount = 0;
+	}
+	if (AnalyzedToken != NULL)
+	{
+		vStringDelete (AnalyzedToken);
+		AnalyzedToken = NULL;
+	}
 }
 
-static unsigned int printBucket (const unsigned int i)
+extern int analyzeToken (vString *const name, langType language)
 {
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry = table [i];
-	unsigned int measure = 1;
-	boolean first = TRUE;
-
-	printf ("%2d:", i);
-	if (entry == NULL)
-		printf ("\n");
-	else while (entry != NULL)
+	if ((unsigned int) language < TableCount  &&
+		Tables [language].folding)
 	{
-		if (! first)
-			printf ("    ");
-		else
-		{
-			printf (" ");
-			first = FALSE;
-		}
-		printEntry (entry);
-		entry = entry->next;
-		measure = 2 * measure;
+		/* The table folds case itself; look the token up in place. */
+		return lookupKeyword (vStringValue (name), language);
 	}
-	return measure - 1;
+
+	/* The lowercased copy is kept between calls; parsers route every
+	 * identifier through here, making a fresh allocation per token
+	 * needlessly expensive. */
+	if (AnalyzedToken == NULL)
+		AnalyzedToken = vStringNew ();
+	vStringCopyToLower (AnalyzedToken, name);
+	return lookupKeyword (vStringValue (AnalyzedToken), language);
 }
 
+#ifdef DEBUG
+
 extern void printKeywordTable (void)
 {
-	unsigned long emptyBucketCount = 0;
-	unsigned long measure = 0;
-	unsigned int i;
+	unsigned int i, slot;
 
-	for (i = 0  ;  i < TableSize  ;  ++i)
+	for (i = 0  ;  i < TableCount  ;  ++i)
 	{
-		const unsigned int pass = printBucket (i);
-
-		measure += pass;
-		if (pass == 0)
-			++emptyBucketCount;
+		const keywordTable *const table = Tables + i;
+
+		if (table->entries == NULL)
+			continue;
+		printf ("%s: %u keywords in %u slots\n", getLanguageName ((langType) i),
+				table->count, 1 << table->exponent);
+		for (slot = 0  ;  slot < (1u << table->exponent)  ;  ++slot)
+			if (table->entries [slot].string != NULL)
+				printf ("  %4u: %-15s %d\n", slot,
+						table->entries [slot].string,
+						table->entries [slot].value);
 	}
-
-	printf ("spread measure = %ld\n", measure);
-	printf ("%ld empty buckets\n", emptyBucketCount);
 }
 
 #endif
@@ -18,11 +18,33 @@
 
 #include "parse.h"
 
+/*
+*   MACROS
+*/
+
+/*  Rolling keyword hash, accumulated by a lexer one character at a time
+ *  while the identifier is being scanned, so that lookupKeywordHashed ()
+ *  need not traverse the completed string a second time.  The update must
+ *  mirror the accumulation loop of hashValue () in keyword.c exactly.
+ */
+#define KEYWORD_HASH_INIT  0UL
+
+#define keywordHashFeed(hash, c) \
+	do { \
+		(hash) <<= 1; \
+		if ((hash) & 0x00000100L) \
+			(hash) = ((hash) & 0x000000ffL) + 1L; \
+		(hash) ^= (unsigned long) (c); \
+	} while (0)
+
 /*
 *   FUNCTION PROTOTYPES
 */
+extern void setKeywordCaseFolding (const langType language);
 extern void addKeyword (const char *const string, langType language, int value);
 extern int lookupKeyword (const char *const string, langType language);
+extern int lookupKeywordHashed (
+		const char *const string, const unsigned long hash, langType language);
 extern void freeKeywordTable (void);
 #ifdef DEBUG
 extern void printKeywordTable (void);
@@ -16,6 +16,7 @@
 
 #include "parse.h"
 #include "read.h"
+#include "sexp.h"
 #include "vstring.h"
 
 /*
@@ -29,6 +30,8 @@ static kindOption LispKinds [] = {
 	{ TRUE, 'f', "function", "functions" }
 };
 
+static vString *Name;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -56,8 +59,6 @@ static int L_isquote (const unsigned char *strp)
 
 static void L_getit (vString *const name, const unsigned char *dbp)
 {
-	const unsigned char *p;
-
 	if (*dbp == '\'')  /* Skip prefix quote */
 		dbp++;
 	else if (*dbp == '(' && L_isquote (dbp))  /* Skip "(quote " */
@@ -66,9 +67,7 @@ static void L_getit (vString *const name, const unsigned char *dbp)
 		while (isspace (*dbp))
 		dbp++;
 	}
-	for (p=dbp ; *p!='\0' && *p!='(' && !isspace ((int) *p) && *p!=')' ; p++)
-		vStringPut (name, *p);
-	vStringTerminate (name);
+	readSexpSymbol (name, dbp);
 
 	if (vStringLength (name) > 0)
 		makeSimpleTag (name, LispKinds, K_FUNCTION);
@@ -77,50 +76,49 @@ static void L_getit (vString *const name, const unsigned char *dbp)
 
 /* Algorithm adapted from from GNU etags.
  */
-static void findLispTags (void)
+static void processLispForm (const unsigned char *const line)
 {
-	vString *name = vStringNew ();
-	const unsigned char* p;
-
+	const unsigned char *p = line;
 
-	while ((p = fileReadLine ()) != NULL)
+	if (L_isdef (p))
 	{
-		if (*p == '(')
+		while (*p != '\0' && !isspace ((int) *p))
+			p++;
+		while (isspace ((int) *p))
+			p++;
+		L_getit (Name, p);
+	}
+	else
+	{
+		/* Check for (foo::defmumble name-defined ... */
+		do
+			p++;
+		while (*p != '\0' && !isspace ((int) *p)
+				&& *p != ':' && *p != '(' && *p != ')');
+		if (*p == ':')
 		{
-			if (L_isdef (p))
+			do
+				p++;
+			while (*p == ':');
+
+			if (L_isdef (p - 1))
 			{
 				while (*p != '\0' && !isspace ((int) *p))
 					p++;
-				while (isspace ((int) *p))
+				while (isspace (*p))
 					p++;
-				L_getit (name, p);
-			}
-			else
-			{
-				/* Check for (foo::defmumble name-defined ... */
-				do
-					p++;
-				while (*p != '\0' && !isspace ((int) *p)
-						&& *p != ':' && *p != '(' && *p != ')');
-				if (*p == ':')
-				{
-					do
-						p++;
-					while (*p == ':');
-
-					if (L_isdef (p - 1))
-					{
-						while (*p != '\0' && !isspace ((int) *p))
-							p++;
-						while (isspace (*p))
-							p++;
-						L_getit (name, p);
-					}
-				}
+				L_getit (Name, p);
 			}
 		}
 	}
-	vStringDelete (name);
+}
+
+static void findLispTags (void)
+{
+	Name = vStringNew ();
+	findTopLevelForms (processLispForm);
+	vStringDelete (Name);
+	Name = NULL;
 }
 
 extern parserDefinition* LispParser (void)
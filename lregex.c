@@ -22,7 +22,9 @@
 
 #ifdef HAVE_REGCOMP
 # include <ctype.h>
+# include <locale.h>  /* to compile single-byte-safe patterns in the C locale */
 # include <stddef.h>
+# include <stdlib.h>  /* to declare MB_CUR_MAX */
 # ifdef HAVE_SYS_TYPES_H
 #  include <sys/types.h>  /* declare off_t (not known to regex.h on FreeBSD) */
 # endif
@@ -31,12 +33,24 @@
 
 #include "debug.h"
 #include "entry.h"
+#include "options.h"
 #include "parse.h"
 #include "read.h"
 #include "routines.h"
+#include "sort.h"
 
 #ifdef HAVE_REGEX
 
+/*  To match the chunks of a large buffered file with worker processes.
+ */
+#if defined (HAVE_FORK) && defined (HAVE_WAITPID)
+# define PARALLEL_MATCH_SUPPORTED
+# ifdef HAVE_UNISTD_H
+#  include <unistd.h>  /* to declare fork() */
+# endif
+# include <sys/wait.h>  /* to declare waitpid() */
+#endif
+
 /*
 *   MACROS
 */
@@ -44,6 +58,17 @@
 /* Back-references \0 through \9 */
 #define BACK_REFERENCE_COUNT 10
 
+/* Lines longer than this are matched against a leading window of this
+ * size instead of the whole line. Only generated or minified sources
+ * (e.g. bundled JavaScript shipped as one multi-megabyte line) have
+ * lines that long, and running every pattern over the full line would
+ * stall the run for no tags worth having. */
+#define MATCH_WINDOW_SIZE 0x10000
+
+/* Minimum number of buffered bytes handed to each worker when a file is
+ * matched in parallel; smaller shares are not worth a fork(). */
+#define PARALLEL_MATCH_CHUNK_SIZE 0x40000
+
 #if defined (HAVE_REGCOMP) && !defined (REGCOMP_BROKEN)
 # define POSIX_REGEX
 #endif
@@ -66,6 +91,42 @@ enum pType { PTRN_TAG, PTRN_CALLBACK };
 
 typedef struct {
 	regex_t *pattern;
+
+		/* Uncompiled pattern text and flags, held so that regcomp() can be
+		 * deferred until the pattern is first needed; both are freed and
+		 * set to NULL once compilation has been attempted, except that the
+		 * text of a compiled pattern is kept under --stats to label the
+		 * statistics report. */
+	char *regex_text;
+	char *flags;
+
+		/* Substring which must occur in any line the pattern matches, or
+		 * NULL if none could be determined; used to reject lines with
+		 * strstr() before resorting to regexec(). */
+	char *literal;
+
+		/* TRUE if the pattern was compiled with REG_NOSUB because nothing
+		 * references its subexpressions, letting regexec() skip register
+		 * tracking. */
+	boolean nosub;
+
+		/* Map indexed by unsigned byte value, non-zero for bytes which can
+		 * begin a match, or NULL if the set could not be determined; used
+		 * to reject lines containing no plausible start byte before
+		 * resorting to regexec(). */
+	char *fastmap;
+
+		/* TRUE if the expression is anchored with '^', in which case only
+		 * the first byte of a line is tested against the fastmap. */
+	boolean anchored;
+
+		/* Lines tried against this pattern, lines discarded by the literal
+		 * and fastmap pre-filters, and lines matched; reported by --stats
+		 * so wasted patterns can be identified. */
+	unsigned long attempts;
+	unsigned long rejections;
+	unsigned long matches;
+
 	enum pType type;
 	union {
 		struct {
@@ -95,6 +156,16 @@ static boolean regexBroken = FALSE;
 static patternSet* Sets = NULL;
 static int SetUpper = -1;  /* upper language index in list */
 
+/* Holds the truncated copy of an over-long line (see MATCH_WINDOW_SIZE) */
+static vString* MatchWindow = NULL;
+
+/* Scratch buffer reused by substitute() for every matched line, so the
+ * match hot loop makes no heap allocations of its own */
+static vString* Substituted = NULL;
+
+/* Set inside a worker of the file queue, which is parallel already */
+static boolean ParallelMatchingSuppressed = FALSE;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -108,11 +179,36 @@ static void clearPatternSet (const langType language)
 		for (i = 0  ;  i < set->count  ;  ++i)
 		{
 			regexPattern *p = &set->patterns [i];
+			if (p->pattern != NULL)
+			{
 #if defined (POSIX_REGEX)
-			regfree (p->pattern);
+				regfree (p->pattern);
 #endif
-			eFree (p->pattern);
-			p->pattern = NULL;
+				eFree (p->pattern);
+				p->pattern = NULL;
+			}
+			if (p->regex_text != NULL)
+			{
+				eFree (p->regex_text);
+				p->regex_text = NULL;
+			}
+			if (p->flags != NULL)
+			{
+				eFree (p->flags);
+				p->flags = NULL;
+			}
+
+			if (p->literal != NULL)
+			{
+				eFree (p->literal);
+				p->literal = NULL;
+			}
+
+			if (p->fastmap != NULL)
+			{
+				eFree (p->fastmap);
+				p->fastmap = NULL;
+			}
 
 			if (p->type == PTRN_TAG)
 			{
@@ -249,10 +345,10 @@ static boolean parseTagRegex (
 	return result;
 }
 
-static void addCompiledTagPattern (
-		const langType language, regex_t* const pattern,
-		char* const name, const char kind, char* const kindName,
-		char *const description)
+static void addTagPattern (
+		const langType language, char* const regex_text, char* const flags,
+		char* const literal, char* const name, const char kind,
+		char* const kindName, char *const description)
 {
 	patternSet* set;
 	regexPattern *ptrn;
@@ -272,7 +368,16 @@ static void addCompiledTagPattern (
 	ptrn = &set->patterns [set->count];
 	set->count += 1;
 
-	ptrn->pattern = pattern;
+	ptrn->pattern = NULL;
+	ptrn->regex_text = regex_text;
+	ptrn->flags   = flags;
+	ptrn->literal = literal;
+	ptrn->nosub   = FALSE;
+	ptrn->fastmap = NULL;
+	ptrn->anchored = FALSE;
+	ptrn->attempts = 0;
+	ptrn->rejections = 0;
+	ptrn->matches = 0;
 	ptrn->type    = PTRN_TAG;
 	ptrn->u.tag.name_pattern = name;
 	ptrn->u.tag.kind.enabled = TRUE;
@@ -281,9 +386,9 @@ static void addCompiledTagPattern (
 	ptrn->u.tag.kind.description = description;
 }
 
-static void addCompiledCallbackPattern (
-		const langType language, regex_t* const pattern,
-		const regexCallback callback)
+static void addCallbackPattern (
+		const langType language, char* const regex_text, char* const flags,
+		char* const literal, const regexCallback callback)
 {
 	patternSet* set;
 	regexPattern *ptrn;
@@ -303,16 +408,396 @@ static void addCompiledCallbackPattern (
 	ptrn = &set->patterns [set->count];
 	set->count += 1;
 
-	ptrn->pattern = pattern;
+	ptrn->pattern = NULL;
+	ptrn->regex_text = regex_text;
+	ptrn->flags   = flags;
+	ptrn->literal = literal;
+	ptrn->nosub   = FALSE;
+	ptrn->fastmap = NULL;
+	ptrn->anchored = FALSE;
+	ptrn->attempts = 0;
+	ptrn->rejections = 0;
+	ptrn->matches = 0;
 	ptrn->type    = PTRN_CALLBACK;
 	ptrn->u.callback.function = callback;
 }
 
 #if defined (POSIX_REGEX)
 
-static regex_t* compileRegex (const char* const regexp, const char* const flags)
+static void saveLiteralRun (
+		char *const best, size_t *const bestLength,
+		const char *const run, size_t *const runLength)
+{
+	if (*runLength > *bestLength)
+	{
+		memcpy (best, run, *runLength);
+		*bestLength = *runLength;
+	}
+	*runLength = 0;
+}
+
+/*  Extracts from an extended regular expression the longest substring
+ *  which must occur in every line the expression matches, or NULL if no
+ *  such substring can be determined. The analysis is conservative: any
+ *  construct whose effect on the matched text is not obvious simply ends
+ *  the literal run being collected, and alternation, case folding and
+ *  basic (non-extended) syntax disable the extraction altogether.
+ */
+static char* extractRequiredLiteral (
+		const char* const regexp, const char* const flags)
+{
+	char *const run  = xMalloc (strlen (regexp) + 1, char);
+	char *const best = xMalloc (strlen (regexp) + 1, char);
+	size_t runLength = 0, bestLength = 0;
+	const char *p = regexp;
+	boolean usable = TRUE;
+	char *result = NULL;
+	int i;
+
+	for (i = 0  ;  flags != NULL  &&  flags [i] != '\0'  ;  ++i)
+		if (flags [i] == 'i'  ||  flags [i] == 'b')
+			usable = FALSE;
+
+	while (usable  &&  *p != '\0')
+	{
+		const int c = *p++;
+		switch (c)
+		{
+			case '|':
+				/* any branch may match; nothing is required */
+				usable = FALSE;
+				break;
+
+			case '\\':
+				/* do not second-guess escape semantics */
+				saveLiteralRun (best, &bestLength, run, &runLength);
+				if (*p != '\0')
+					++p;
+				break;
+
+			case '(':
+			{
+				int depth = 1;
+				saveLiteralRun (best, &bestLength, run, &runLength);
+				while (*p != '\0'  &&  depth > 0)
+				{
+					if (*p == '\\'  &&  *(p + 1) != '\0')
+						++p;
+					else if (*p == '(')
+						++depth;
+					else if (*p == ')')
+						--depth;
+					++p;
+				}
+				break;
+			}
+
+			case '[':
+				saveLiteralRun (best, &bestLength, run, &runLength);
+				if (*p == '^')
+					++p;
+				if (*p == ']')
+					++p;
+				while (*p != '\0'  &&  *p != ']')
+				{
+					if (*p == '['  &&  (*(p + 1) == ':'  ||
+										*(p + 1) == '.'  ||  *(p + 1) == '='))
+					{
+						const int delimiter = *(p + 1);
+						p += 2;
+						while (*p != '\0'  &&
+							   ! (*p == delimiter  &&  *(p + 1) == ']'))
+							++p;
+						if (*p != '\0')
+							p += 2;
+					}
+					else
+						++p;
+				}
+				if (*p == ']')
+					++p;
+				break;
+
+			case '?':
+			case '*':
+			case '{':
+				/* the preceding element may be absent or repeated */
+				if (runLength > 0)
+					--runLength;
+				saveLiteralRun (best, &bestLength, run, &runLength);
+				if (c == '{')
+				{
+					while (*p != '\0'  &&  *p != '}')
+						++p;
+					if (*p == '}')
+						++p;
+				}
+				break;
+
+			case '+':
+				/* the preceding element occurs at least once */
+				saveLiteralRun (best, &bestLength, run, &runLength);
+				break;
+
+			case '.':
+			case '^':
+			case '$':
+			case ')':
+				saveLiteralRun (best, &bestLength, run, &runLength);
+				break;
+
+			default:
+				run [runLength++] = c;
+				break;
+		}
+	}
+	saveLiteralRun (best, &bestLength, run, &runLength);
+
+	if (usable  &&  bestLength >= 2)
+	{
+		best [bestLength] = '\0';
+		result = eStrdup (best);
+	}
+	eFree (run);
+	eFree (best);
+	return result;
+}
+
+/*  Adds a character to a fastmap, in both cases when the expression is
+ *  matched case-insensitively.
+ */
+static void addFastmapChar (char *const map, const int c, const boolean icase)
+{
+	map [(unsigned char) c] = 1;
+	if (icase)
+	{
+		map [(unsigned char) tolower ((unsigned char) c)] = 1;
+		map [(unsigned char) toupper ((unsigned char) c)] = 1;
+	}
+}
+
+/*  Adds the members of the bracket expression starting at *pp (just past
+ *  the opening '[') to the map and advances *pp past the closing ']'.
+ *  Returns FALSE for a negated expression or one containing a construct
+ *  (such as a named character class) which is not expanded here.
+ */
+static boolean addFastmapBracket (
+		char *const map, const char **const pp, const boolean icase)
+{
+	const char *s = *pp;
+	if (*s == '^')
+		return FALSE;  /* the complement is usually most of the byte range */
+	if (*s == ']')
+	{
+		addFastmapChar (map, ']', icase);
+		++s;
+	}
+	while (*s != '\0'  &&  *s != ']')
+	{
+		if (*s == '['  &&
+			(*(s + 1) == ':'  ||  *(s + 1) == '.'  ||  *(s + 1) == '='))
+			return FALSE;  /* named classes are not expanded */
+		else if (*(s + 1) == '-'  &&  *(s + 2) != ']'  &&  *(s + 2) != '\0')
+		{
+			int c;
+			if ((unsigned char) *(s + 2) < (unsigned char) *s)
+				return FALSE;
+			for (c = (unsigned char) *s  ;  c <= (unsigned char) *(s + 2)  ;  ++c)
+				addFastmapChar (map, c, icase);
+			s += 3;
+		}
+		else
+		{
+			addFastmapChar (map, *s, icase);
+			++s;
+		}
+	}
+	if (*s != ']')
+		return FALSE;
+	*pp = s + 1;
+	return TRUE;
+}
+
+/*  Builds a map of the bytes which can begin a match of an extended
+ *  regular expression, setting *anchored when the expression matches
+ *  only at the start of a line. The analysis is conservative in the same
+ *  way as extractRequiredLiteral(): top-level alternation, basic syntax,
+ *  groups, '.' and any other construct whose first characters are not
+ *  obvious yield no map at all, and an optional leading element
+ *  contributes its characters with the analysis continuing at the
+ *  element that follows it. Returns NULL when no useful map results.
+ */
+static char* buildFastmap (
+		const char* const regexp, const char* const flags,
+		boolean *const anchored)
+{
+	const char *p = regexp;
+	boolean icase = FALSE;
+	boolean usable = FALSE;
+	char *map;
+	int i;
+
+	*anchored = FALSE;
+	for (i = 0  ;  flags != NULL  &&  flags [i] != '\0'  ;  ++i)
+	{
+		if (flags [i] == 'i')
+			icase = TRUE;
+		else if (flags [i] == 'b')
+			return NULL;  /* basic syntax is parsed differently */
+	}
+
+	/*  With a top-level alternation any branch can begin the match.
+	 */
+	{
+		const char *s = p;
+		int depth = 0;
+		while (*s != '\0')
+		{
+			if (*s == '\\'  &&  *(s + 1) != '\0')
+				++s;
+			else if (*s == '[')
+			{
+				++s;
+				if (*s == '^')
+					++s;
+				if (*s == ']')
+					++s;
+				while (*s != '\0'  &&  *s != ']')
+				{
+					if (*s == '['  &&  (*(s + 1) == ':'  ||
+										*(s + 1) == '.'  ||  *(s + 1) == '='))
+					{
+						const int delimiter = *(s + 1);
+						s += 2;
+						while (*s != '\0'  &&
+							   ! (*s == delimiter  &&  *(s + 1) == ']'))
+							++s;
+						if (*s != '\0')
+							s += 2;
+					}
+					else
+						++s;
+				}
+				if (*s == '\0')
+					break;
+			}
+			else if (*s == '(')
+				++depth;
+			else if (*s == ')')
+				--depth;
+			else if (*s == '|'  &&  depth == 0)
+				return NULL;
+			++s;
+		}
+	}
+
+	if (*p == '^')
+	{
+		*anchored = TRUE;
+		++p;
+	}
+
+	map = xMalloc (256, char);
+	memset (map, 0, 256);
+	while (*p != '\0'  &&  ! usable)
+	{
+		const char *next;
+
+		if (*p == '\\'  &&  *(p + 1) != '\0'  &&
+			! isalnum ((int) (unsigned char) *(p + 1)))
+		{
+			addFastmapChar (map, *(p + 1), icase);
+			next = p + 2;
+		}
+		else if (*p == '[')
+		{
+			next = p + 1;
+			if (! addFastmapBracket (map, &next, icase))
+				break;
+		}
+		else if (strchr ("\\(.^$*+?{", *p) == NULL)
+		{
+			addFastmapChar (map, *p, icase);
+			next = p + 1;
+		}
+		else
+			break;  /* a construct whose first characters are not obvious */
+
+		/*  When the element is optional a match may instead begin with
+		 *  whatever follows it; otherwise the map is complete.
+		 */
+		if (*next == '*'  ||  *next == '?'  ||
+			(*next == '{'  &&  *(next + 1) == '0'))
+		{
+			p = next + 1;
+			if (*next == '{')
+			{
+				while (*p != '\0'  &&  *p != '}')
+					++p;
+				if (*p == '}')
+					++p;
+			}
+		}
+		else
+			usable = TRUE;
+	}
+	if (! usable)
+	{
+		eFree (map);
+		map = NULL;
+		*anchored = FALSE;
+	}
+	return map;
+}
+
+/*  Decides whether the pattern can be matched byte by byte with the same
+ *  results it would produce when matched character by character in a
+ *  multibyte locale.  True for plain ASCII patterns free of the constructs
+ *  whose meaning depends on the character encoding: case folding, named
+ *  character classes and equivalence classes (which may include non-ASCII
+ *  characters), and "." in positions where it must consume exactly one
+ *  character (an unbounded ".*" or ".+" spans the same text either way).
+ */
+static boolean regexSingleByteSafe (const char* const regexp, const int cflags)
+{
+	const char *p;
+
+	if (cflags & REG_ICASE)
+		return FALSE;
+	for (p = regexp  ;  *p != '\0'  ;  ++p)
+	{
+		if ((unsigned char) *p >= 0x80)
+			return FALSE;
+		else if (*p == '\\'  &&  p [1] != '\0')
+			++p;
+		else if (*p == '.'  &&  p [1] != '*'  &&  p [1] != '+')
+			return FALSE;
+		else if (*p == '[')
+		{
+			++p;
+			if (*p == '^')
+				++p;
+			if (*p == ']')
+				++p;
+			for ( ;  *p != '\0'  &&  *p != ']'  ;  ++p)
+			{
+				if ((unsigned char) *p >= 0x80)
+					return FALSE;
+				else if (*p == '['  &&
+						 (p [1] == ':'  ||  p [1] == '='  ||  p [1] == '.'))
+					return FALSE;
+			}
+			if (*p == '\0')
+				break;
+		}
+	}
+	return TRUE;
+}
+
+static regex_t* compileRegex (const char* const regexp, const char* const flags,
+							  const boolean nosub)
 {
-	int cflags = REG_EXTENDED | REG_NEWLINE;
+	int cflags = REG_EXTENDED | REG_NEWLINE | (nosub ? REG_NOSUB : 0);
 	regex_t *result = NULL;
 	int errcode;
 	int i;
@@ -327,7 +812,30 @@ static regex_t* compileRegex (const char* const regexp, const char* const flags)
 		}
 	}
 	result = xMalloc (1, regex_t);
-	errcode = regcomp (result, regexp, cflags);
+
+	/*  regcomp () records the locale's character encoding inside the
+	 *  compiled pattern, and in a multibyte locale regexec () then
+	 *  converts every line to wide characters before matching.  ctags
+	 *  itself runs in the C locale, but an application embedding the
+	 *  parsers has usually switched to the user's locale; compiling a
+	 *  single-byte-safe pattern under the C ctype and collation rules
+	 *  keeps its matching byte-oriented no matter the locale.
+	 */
+	if (MB_CUR_MAX > 1  &&  regexSingleByteSafe (regexp, cflags))
+	{
+		char *const savedCtype = eStrdup (setlocale (LC_CTYPE, NULL));
+		char *const savedCollate = eStrdup (setlocale (LC_COLLATE, NULL));
+
+		setlocale (LC_CTYPE, "C");
+		setlocale (LC_COLLATE, "C");
+		errcode = regcomp (result, regexp, cflags);
+		setlocale (LC_CTYPE, savedCtype);
+		setlocale (LC_COLLATE, savedCollate);
+		eFree (savedCtype);
+		eFree (savedCollate);
+	}
+	else
+		errcode = regcomp (result, regexp, cflags);
 	if (errcode != 0)
 	{
 		char errmsg[256];
@@ -340,6 +848,55 @@ static regex_t* compileRegex (const char* const regexp, const char* const flags)
 	return result;
 }
 
+/* Returns TRUE if the string contains a back-reference of the form the
+ * name patterns and regular expressions use (backslash followed by a
+ * digit).
+ */
+static boolean referencesSubexpressions (const char* const string)
+{
+	const char* p;
+	for (p = string  ;  *p != '\0'  ;  ++p)
+		if (*p == '\\'  &&  isdigit ((int) (unsigned char) p [1]))
+			return TRUE;
+	return FALSE;
+}
+
+/* Compiles the pattern on its first use, so that patterns added for
+ * languages never encountered in a run cost no regcomp() at all. Tag
+ * patterns whose name pattern and regular expression contain no
+ * back-references are compiled with REG_NOSUB, sparing regexec() the
+ * cost of tracking subexpression registers, and a fastmap of plausible
+ * match start bytes is built where the expression permits one. Returns
+ * TRUE if a compiled pattern is available.
+ */
+static boolean regexCompiled (regexPattern *const patbuf)
+{
+	if (patbuf->pattern == NULL  &&  patbuf->regex_text != NULL)
+	{
+		patbuf->nosub = (boolean)
+			(patbuf->type == PTRN_TAG  &&
+			 ! referencesSubexpressions (patbuf->regex_text)  &&
+			 ! referencesSubexpressions (patbuf->u.tag.name_pattern));
+		patbuf->fastmap = buildFastmap (patbuf->regex_text, patbuf->flags,
+										&patbuf->anchored);
+		patbuf->pattern = compileRegex (patbuf->regex_text, patbuf->flags,
+										patbuf->nosub);
+		if (patbuf->pattern != NULL  &&  Option.printStats)
+			;  /* the text is retained to label the statistics report */
+		else
+		{
+			eFree (patbuf->regex_text);
+			patbuf->regex_text = NULL;
+		}
+		if (patbuf->flags != NULL)
+		{
+			eFree (patbuf->flags);
+			patbuf->flags = NULL;
+		}
+	}
+	return (boolean) (patbuf->pattern != NULL);
+}
+
 #endif
 
 static void parseKinds (
@@ -426,12 +983,21 @@ static void processLanguageRegex (const langType language,
 
 #if defined (POSIX_REGEX)
 
+/*  Expands the back-references of a name pattern into a scratch buffer
+ *  owned by this module and reused across calls; the result is only valid
+ *  until the next call.
+ */
 static vString* substitute (
 		const char* const in, const char* out,
 		const int nmatch, const regmatch_t* const pmatch)
 {
-	vString* result = vStringNew ();
+	vString* result;
 	const char* p;
+
+	if (Substituted == NULL)
+		Substituted = vStringNew ();
+	result = Substituted;
+	vStringClear (result);
 	for (p = out  ;  *p != '\0'  ;  p++)
 	{
 		if (*p == '\\'  &&  isdigit ((int) *++p))
@@ -464,7 +1030,6 @@ static void matchTagPattern (const vString* const line,
 		error (WARNING, "%s:%ld: null expansion of name pattern \"%s\"",
 			getInputFileName (), getInputLineNumber (),
 			patbuf->u.tag.name_pattern);
-	vStringDelete (name);
 }
 
 static void matchCallbackPattern (
@@ -484,15 +1049,50 @@ static void matchCallbackPattern (
 }
 
 static boolean matchRegexPattern (const vString* const line,
-		const regexPattern* const patbuf)
+		regexPattern* const patbuf)
 {
 	boolean result = FALSE;
 	regmatch_t pmatch [BACK_REFERENCE_COUNT];
-	const int match = regexec (patbuf->pattern, vStringValue (line),
-							   BACK_REFERENCE_COUNT, pmatch, 0);
+	int match;
+
+	++patbuf->attempts;
+	if (patbuf->literal != NULL  &&
+		strstr (vStringValue (line), patbuf->literal) == NULL)
+	{
+		++patbuf->rejections;
+		return FALSE;
+	}
+	if (! regexCompiled (patbuf))
+		return FALSE;
+	if (patbuf->fastmap != NULL)
+	{
+		const char *s = vStringValue (line);
+		if (patbuf->anchored)
+		{
+			if (! patbuf->fastmap [(unsigned char) *s])
+			{
+				++patbuf->rejections;
+				return FALSE;
+			}
+		}
+		else
+		{
+			while (*s != '\0'  &&  ! patbuf->fastmap [(unsigned char) *s])
+				++s;
+			if (*s == '\0')
+			{
+				++patbuf->rejections;
+				return FALSE;
+			}
+		}
+	}
+	match = regexec (patbuf->pattern, vStringValue (line),
+					 patbuf->nosub ? 0 : BACK_REFERENCE_COUNT,
+					 patbuf->nosub ? NULL : pmatch, 0);
 	if (match == 0)
 	{
 		result = TRUE;
+		++patbuf->matches;
 		if (patbuf->type == PTRN_TAG)
 			matchTagPattern (line, patbuf, pmatch);
 		else if (patbuf->type == PTRN_CALLBACK)
@@ -519,17 +1119,211 @@ extern boolean matchRegex (const vString* const line, const langType language)
 	if (language != LANG_IGNORE  &&  language <= SetUpper  &&
 		Sets [language].count > 0)
 	{
-		const patternSet* const set = Sets + language;
+		patternSet* const set = Sets + language;
+		const vString* candidate = line;
 		unsigned int i;
+		if (vStringLength (line) > MATCH_WINDOW_SIZE)
+		{
+			if (MatchWindow == NULL)
+				MatchWindow = vStringNew ();
+			vStringClear (MatchWindow);
+			vStringNCatS (MatchWindow, vStringValue (line), MATCH_WINDOW_SIZE);
+			vStringTerminate (MatchWindow);
+			candidate = MatchWindow;
+		}
 		for (i = 0  ;  i < set->count  ;  ++i)
-			if (matchRegexPattern (line, set->patterns + i))
+			if (matchRegexPattern (candidate, set->patterns + i))
 				result = TRUE;
 	}
 	return result;
 }
 
+#ifdef PARALLEL_MATCH_SUPPORTED
+
+/*  Decides how many worker processes the rest of the current file should
+ *  be shared among. Every line of a regex-only language is matched
+ *  independently of the others, so the requirements are only a buffered
+ *  file large enough to share out, patterns to match it against, and a
+ *  tag stream whose records tolerate being appended from outside the
+ *  writing process. Returns 1 when the file is to be read sequentially.
+ */
+static unsigned int parallelMatchChunks (void)
+{
+	size_t chunks, remaining;
+	const unsigned char *cr;
+
+	if (ParallelMatchingSuppressed  ||  Option.jobs <= 1  ||
+		Option.filter  ||  Option.daemonSocket != NULL  ||  Option.etags  ||
+		Option.incremental  ||  Option.cacheDir != NULL  ||  Option.dedup)
+		return 1;
+#ifndef EXTERNAL_SORT
+	if (Option.sorted != SO_UNSORTED)
+		return 1;  /* appended records would escape the internal sort */
+#endif
+	if (File.buffer == NULL  ||  Option.lineDirectives)
+		return 1;
+	if (File.source.language == LANG_IGNORE  ||
+		File.source.language > SetUpper  ||
+		Sets [File.source.language].count == 0)
+		return 1;  /* no patterns; there is no matching to share out */
+	remaining = File.bufferSize - File.offset;
+	chunks = remaining / PARALLEL_MATCH_CHUNK_SIZE;
+	if (chunks > Option.jobs)
+		chunks = Option.jobs;
+	if (chunks < 2)
+		return 1;
+
+	/*  Bare carriage-return line ends are canonicalized one character at
+	 *  a time (see fileGetLineSlice ()) and would drift away from the
+	 *  newline-based line accounting of the chunk boundaries.
+	 */
+	for (cr = (const unsigned char *) memchr (
+				File.buffer + File.offset, CRETURN, remaining)  ;
+		 cr != NULL  ;
+		 cr = (const unsigned char *) memchr (
+				cr + 1, CRETURN,
+				File.bufferSize - (size_t) (cr + 1 - File.buffer)))
+	{
+		if ((size_t) (cr + 1 - File.buffer) >= File.bufferSize  ||
+			cr [1] != NEWLINE)
+			return 1;
+	}
+	return (unsigned int) chunks;
+}
+
+/*  Matches the rest of the current file with one worker process per chunk.
+ *  The chunks are contiguous line ranges of about equal size; each worker
+ *  inherits the reader and the compiled patterns by fork (), restarts the
+ *  reader at its first line and matches up to its boundary into a private
+ *  temporary file, and the parent appends the results in chunk order, so
+ *  the tag records come out exactly as a sequential scan would have
+ *  written them.
+ */
+static void matchChunksInParallel (const unsigned int chunks)
+{
+	size_t *const bound = xMalloc (chunks + 1, size_t);
+	unsigned long *const lineNumber = xMalloc (chunks + 1, unsigned long);
+	char **const tempNames = xMalloc (chunks, char*);
+	pid_t *const pids = xMalloc (chunks, pid_t);
+	const unsigned char *const buffer = File.buffer;
+	const size_t share = (File.bufferSize - File.offset) / chunks;
+	unsigned int i;
+
+	/*  Chunk boundaries fall on the first line starts at or past the even
+	 *  division points of the buffer; the line numbers are carried along
+	 *  for the workers to restart the reader at.
+	 */
+	bound [0] = File.offset;
+	lineNumber [0] = File.lineNumber + 1;
+	for (i = 1  ;  i <= chunks  ;  ++i)
+	{
+		const size_t target =
+				(i == chunks) ? File.bufferSize : File.offset + share * i;
+		size_t next = bound [i - 1];
+		unsigned long lines = 0;
+
+		while (next < File.bufferSize)
+		{
+			const unsigned char *const newline = (const unsigned char *)
+					memchr (buffer + next, NEWLINE, File.bufferSize - next);
+			if (newline == NULL)
+			{
+				next = File.bufferSize;
+				++lines;  /* final line has no terminator */
+				break;
+			}
+			++lines;
+			next = (size_t) (newline - buffer) + 1;
+			if (next >= target)
+				break;
+		}
+		bound [i] = next;
+		lineNumber [i] = lineNumber [i - 1] + lines;
+	}
+
+	verbose ("%s: matching %u chunks in parallel\n",
+			getInputFileName (), chunks);
+	flushTagOutput ();
+	fflush (TagFile.fp);  /* keep buffered output out of the workers */
+	for (i = 0  ;  i < chunks  ;  ++i)
+		fclose (tempFile ("w", &tempNames [i]));
+	for (i = 0  ;  i < chunks  ;  ++i)
+	{
+		pids [i] = fork ();
+		if (pids [i] == -1)
+			error (FATAL | PERROR, "cannot fork worker process");
+		else if (pids [i] == 0)
+		{
+			FILE *const fp = fopen (tempNames [i], "w");
+			if (fp == NULL)
+				error (FATAL | PERROR, "cannot open worker tag file");
+			fclose (TagFile.fp);
+			TagFile.fp = fp;
+#ifdef PIPED_SORT_SUPPORTED
+			abandonSortStream ();  /* the parent alone feeds the sort */
+#endif
+#ifndef EXTERNAL_SORT
+			forgetRememberedTagLines ();  /* inherited from the parent */
+#endif
+			fileRestartAt ((filePos) bound [i], lineNumber [i]);
+			while (File.offset < bound [i + 1]  &&  fileReadLine () != NULL)
+				;
+			fclose (TagFile.fp);
+			_exit (0);
+		}
+	}
+	for (i = 0  ;  i < chunks  ;  ++i)
+	{
+		int status;
+		if (waitpid (pids [i], &status, 0) == -1  ||
+			! WIFEXITED (status)  ||  WEXITSTATUS (status) != 0)
+			error (WARNING, "worker process failed; tag file may be incomplete");
+	}
+	for (i = 0  ;  i < chunks  ;  ++i)
+	{
+		FILE *const fp = fopen (tempNames [i], "r");
+		if (fp == NULL)
+			error (WARNING | PERROR, "cannot read worker tag file");
+		else
+		{
+			const char *line;
+			while ((line = readLine (TagFile.vLine, fp)) != NULL)
+			{
+				fputs (line, TagFile.fp);
+				++TagFile.numTags.added;
+			}
+			fclose (fp);
+		}
+		remove (tempNames [i]);
+		eFree (tempNames [i]);
+	}
+	flushTagOutput ();
+
+	/*  Leave the reader where a sequential scan leaves it: at end of file
+	 *  with every line counted, so the totals reported by fileClose ()
+	 *  stay right.
+	 */
+	fileRestartAt ((filePos) File.bufferSize, lineNumber [chunks]);
+	File.eof = TRUE;
+
+	eFree (pids);
+	eFree (tempNames);
+	eFree (lineNumber);
+	eFree (bound);
+}
+
+#endif  /* PARALLEL_MATCH_SUPPORTED */
+
 extern void findRegexTags (void)
 {
+#ifdef PARALLEL_MATCH_SUPPORTED
+	const unsigned int chunks = parallelMatchChunks ();
+	if (chunks > 1)
+	{
+		matchChunksInParallel (chunks);
+		return;
+	}
+#endif
 	/* merely read all lines of the file */
 	while (fileReadLine () != NULL)
 		;
@@ -537,51 +1331,58 @@ extern void findRegexTags (void)
 
 #endif  /* HAVE_REGEX */
 
+/*  Called inside a worker of the file queue, where the processors are
+ *  already occupied and a second level of forking would oversubscribe
+ *  them.
+ */
+extern void suppressParallelMatching (void)
+{
+#if defined (HAVE_REGEX) && defined (PARALLEL_MATCH_SUPPORTED)
+	ParallelMatchingSuppressed = TRUE;
+#endif
+}
+
 extern void addTagRegex (
-		const langType language __unused__,
-		const char* const regex __unused__,
-		const char* const name __unused__,
-		const char* const kinds __unused__,
-		const char* const flags __unused__)
+		const langType language __ctags_unused__,
+		const char* const regex __ctags_unused__,
+		const char* const name __ctags_unused__,
+		const char* const kinds __ctags_unused__,
+		const char* const flags __ctags_unused__)
 {
 #ifdef HAVE_REGEX
 	Assert (regex != NULL);
 	Assert (name != NULL);
 	if (! regexBroken)
 	{
-		regex_t* const cp = compileRegex (regex, flags);
-		if (cp != NULL)
-		{
-			char kind;
-			char* kindName;
-			char* description;
-			parseKinds (kinds, &kind, &kindName, &description);
-			addCompiledTagPattern (language, cp, eStrdup (name),
-					kind, kindName, description);
-		}
+		char kind;
+		char* kindName;
+		char* description;
+		parseKinds (kinds, &kind, &kindName, &description);
+		addTagPattern (language, eStrdup (regex),
+				flags != NULL ? eStrdup (flags) : NULL,
+				extractRequiredLiteral (regex, flags), eStrdup (name),
+				kind, kindName, description);
 	}
 #endif
 }
 
 extern void addCallbackRegex (
-		const langType language __unused__,
-		const char* const regex __unused__,
-		const char* const flags __unused__,
-		const regexCallback callback __unused__)
+		const langType language __ctags_unused__,
+		const char* const regex __ctags_unused__,
+		const char* const flags __ctags_unused__,
+		const regexCallback callback __ctags_unused__)
 {
 #ifdef HAVE_REGEX
 	Assert (regex != NULL);
 	if (! regexBroken)
-	{
-		regex_t* const cp = compileRegex (regex, flags);
-		if (cp != NULL)
-			addCompiledCallbackPattern (language, cp, callback);
-	}
+		addCallbackPattern (language, eStrdup (regex),
+				flags != NULL ? eStrdup (flags) : NULL,
+				extractRequiredLiteral (regex, flags), callback);
 #endif
 }
 
 extern void addLanguageRegex (
-		const langType language __unused__, const char* const regex __unused__)
+		const langType language __ctags_unused__, const char* const regex __ctags_unused__)
 {
 #ifdef HAVE_REGEX
 	if (! regexBroken)
@@ -602,7 +1403,7 @@ extern void addLanguageRegex (
 */
 
 extern boolean processRegexOption (const char *const option,
-								   const char *const parameter __unused__)
+								   const char *const parameter __ctags_unused__)
 {
 	boolean handled = FALSE;
 	const char* const dash = strchr (option, '-');
@@ -614,7 +1415,13 @@ extern boolean processRegexOption (const char *const option,
 		if (language == LANG_IGNORE)
 			error (WARNING, "unknown language \"%s\" in --%s option", (dash + 1), option);
 		else
+		{
+			/*  Install the built-in patterns first so user supplied ones
+			 *  keep matching after them, as they always have.
+			 */
+			initializeParser (language);
 			processLanguageRegex (language, parameter);
+		}
 #else
 		error (WARNING, "regex support not available; required for --%s option",
 		   option);
@@ -624,7 +1431,7 @@ extern boolean processRegexOption (const char *const option,
 	return handled;
 }
 
-extern void disableRegexKinds (const langType language __unused__)
+extern void disableRegexKinds (const langType language __ctags_unused__)
 {
 #ifdef HAVE_REGEX
 	if (language <= SetUpper  &&  Sets [language].count > 0)
@@ -639,8 +1446,8 @@ extern void disableRegexKinds (const langType language __unused__)
 }
 
 extern boolean enableRegexKind (
-		const langType language __unused__,
-		const int kind __unused__, const boolean mode __unused__)
+		const langType language __ctags_unused__,
+		const int kind __ctags_unused__, const boolean mode __ctags_unused__)
 {
 	boolean result = FALSE;
 #ifdef HAVE_REGEX
@@ -660,7 +1467,7 @@ extern boolean enableRegexKind (
 	return result;
 }
 
-extern void printRegexKinds (const langType language __unused__, boolean indent __unused__)
+extern void printRegexKinds (const langType language __ctags_unused__, boolean indent __ctags_unused__)
 {
 #ifdef HAVE_REGEX
 	if (language <= SetUpper  &&  Sets [language].count > 0)
@@ -674,6 +1481,45 @@ extern void printRegexKinds (const langType language __unused__, boolean indent
 #endif
 }
 
+/*  Reports the attempt, pre-filter rejection and match counts of every
+ *  pattern exercised during the run, so patterns which are pure overhead
+ *  (many attempts, few matches) stand out. Printed by --stats after the
+ *  per-language table.
+ */
+extern void printRegexStatistics (void)
+{
+#ifdef HAVE_REGEX
+	boolean header = FALSE;
+	int i;
+
+	for (i = 0  ;  i <= SetUpper  ;  ++i)
+	{
+		const patternSet* const set = Sets + i;
+		unsigned int j;
+
+		for (j = 0  ;  j < set->count  ;  ++j)
+		{
+			const regexPattern* const p = &set->patterns [j];
+
+			if (p->attempts == 0)
+				continue;
+			if (! header)
+			{
+				fprintf (errout, "%-12s %10s %10s %10s  %s\n",
+						"LANGUAGE", "ATTEMPTS", "REJECTED", "MATCHES",
+						"PATTERN");
+				header = TRUE;
+			}
+			fprintf (errout, "%-12s %10lu %10lu %10lu  %s\n",
+					getLanguageName ((langType) i), p->attempts,
+					p->rejections, p->matches,
+					p->regex_text != NULL ? p->regex_text
+										  : "(failed to compile)");
+		}
+	}
+#endif
+}
+
 extern void freeRegexResources (void)
 {
 #ifdef HAVE_REGEX
@@ -684,6 +1530,16 @@ extern void freeRegexResources (void)
 		eFree (Sets);
 	Sets = NULL;
 	SetUpper = -1;
+	if (MatchWindow != NULL)
+	{
+		vStringDelete (MatchWindow);
+		MatchWindow = NULL;
+	}
+	if (Substituted != NULL)
+	{
+		vStringDelete (Substituted);
+		Substituted = NULL;
+	}
 #endif
 }
 
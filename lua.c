@@ -32,12 +32,17 @@ static kindOption LuaKinds [] = {
 	{ TRUE, 'f', "function", "functions" }
 };
 
+/*  The deepest long bracket level ("[=...=[") recognized; deeper openers
+ *  are left to the line scanner.
+ */
+#define MAX_BRACKET_LEVEL 32
+
 /*
 *   FUNCTION DEFINITIONS
 */
 
 /* for debugging purposes */
-static void __unused__ print_string (char *p, char *q)
+static void __ctags_unused__ print_string (char *p, char *q)
 {
 	for ( ; p != q; p++)
 		fprintf (errout, "%c", *p);
@@ -89,6 +94,27 @@ static void extract_name (const char *begin, const char *end, vString *name)
 	}
 }
 
+/*  Returns the first long bracket opener ("[[", "[=[", ...) in "p", or
+ *  NULL; the number of equals signs in it comes back through "level".
+ */
+static const char *find_long_bracket (const char *p, unsigned int *level)
+{
+	while ((p = strchr (p, '[')) != NULL)
+	{
+		const char *q = p + 1;
+
+		while (*q == '=')
+			q++;
+		if (*q == '[')
+		{
+			*level = (unsigned int) (q - (p + 1));
+			return p;
+		}
+		p = q;
+	}
+	return NULL;
+}
+
 static void findLuaTags (void)
 {
 	vString *name = vStringNew ();
@@ -97,6 +123,31 @@ static void findLuaTags (void)
 	while ((line = fileReadLine ()) != NULL)
 	{
 		const char *p, *q;
+		unsigned int level;
+		const char *const open =
+				find_long_bracket ((const char *) line, &level);
+
+		if (open != NULL  &&  level <= MAX_BRACKET_LEVEL)
+		{
+			char close [MAX_BRACKET_LEVEL + 3];
+			unsigned int i;
+
+			close [0] = ']';
+			for (i = 0  ;  i < level  ;  ++i)
+				close [i + 1] = '=';
+			close [level + 1] = ']';
+			close [level + 2] = '\0';
+			if (strstr (open + level + 2, close) == NULL)
+			{
+				/*  A long string or comment crossing lines; stride to its
+				 *  terminator so that nothing inside it looks like code.
+				 */
+				line = fileSkipLinesUntilString (close);
+				if (line == NULL)
+					break;
+				continue;
+			}
+		}
 
 		if (! is_a_code_line (line))
 			continue;
@@ -25,6 +25,18 @@
 
 #include <string.h>
 
+/*  To throttle the --progress reports.
+ */
+#ifdef HAVE_TIME_H
+# include <time.h>
+#endif
+
+/*  To time the phases of a run (--totals).
+ */
+#ifdef HAVE_GETTIMEOFDAY
+# include <sys/time.h>
+#endif
+
 /*  To provide timings features if available.
  */
 #ifdef HAVE_CLOCK
@@ -75,24 +87,88 @@
 # include <io.h>  /* to declare _findfirst() */
 #endif
 
+/*  To provide the parallel parsing (--jobs) feature.
+ */
+#if defined (HAVE_FORK) && defined (HAVE_WAITPID)
+# define JOBS_SUPPORTED
+# ifdef HAVE_UNISTD_H
+#  include <unistd.h>  /* to declare fork() */
+# endif
+# include <sys/wait.h>  /* to declare waitpid() */
+#endif
 
+/*  To provide the continuous update (--watch) feature.
+ */
+#if defined (HAVE_SYS_INOTIFY_H) && defined (HAVE_OPENDIR)
+# define WATCH_SUPPORTED
+# include <errno.h>
+# ifdef HAVE_UNISTD_H
+#  include <unistd.h>  /* to declare read() */
+# endif
+# include <sys/inotify.h>
+#endif
+
+/*  To provide the persistent server (--daemon) feature.
+ */
+#if defined (JOBS_SUPPORTED) && \
+	defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+# define DAEMON_SUPPORTED
+# include <errno.h>
+# include <signal.h>
+# include <sys/socket.h>  /* to declare socket() */
+# include <sys/un.h>      /* to declare struct sockaddr_un */
+#endif
+
+#include <signal.h>  /* to report progress and memory statistics on SIGUSR1 */
+
+#include "cache.h"
 #include "debug.h"
+#include "entry.h"
+#include "intern.h"
 #include "keyword.h"
 #include "main.h"
 #include "options.h"
+#include "journal.h"
+#include "prefetch.h"
 #include "read.h"
 #include "routines.h"
+#include "sort.h"
+#include "strlist.h"
 
 /*
 *   MACROS
 */
 #define plural(value)  (((unsigned long)(value) == 1L) ? "" : "s")
 
+/*  Number of source files processed between two checkpoint writes.
+ */
+#define CHECKPOINT_INTERVAL 100
+
 /*
 *   DATA DEFINITIONS
 */
 static struct { long files, lines, bytes; } Totals = { 0, 0, 0 };
 
+/*  Number of source files handed to dispatchSourceFile() so far. The count
+ *  depends only on the directory walk, so it identifies how far through the
+ *  tree an interrupted run got for --checkpoint and --resume.
+ */
+static unsigned long DispatchedFiles = 0;
+
+#ifdef JOBS_SUPPORTED
+/*  When parallel parsing is requested, file names discovered by the
+ *  argument and directory walk are queued here instead of being parsed
+ *  immediately.
+ */
+static stringList *FileQueue = NULL;
+
+/*  Current nesting level of the recursive directory walk. Used to decide
+ *  which directories are walked by the parent and which are handed to the
+ *  workers as whole subtrees.
+ */
+static unsigned int WalkDepth = 0;
+#endif
+
 #ifdef AMIGA
 # include "ctags.h"
   static const char *VERsion = "$VER: "PROGRAM_NAME" "PROGRAM_VERSION" "
@@ -104,10 +180,43 @@ static struct { long files, lines, bytes; } Totals = { 0, 0, 0 };
   " "AUTHOR_NAME" $";
 #endif
 
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Classification of a directory entry as reported by the directory walk
+ *  (via d_type where the dirent supports it), so that ordinary files and
+ *  directories are dispatched without the lstat()/stat() pair eStat()
+ *  performs; on network file systems those metadata round trips dominate
+ *  the traversal.
+ */
+typedef enum eEntryKind {
+	ENTRY_UNKNOWN,     /* no information; consult eStat () */
+	ENTRY_FILE,        /* known to be a regular file, not a link */
+	ENTRY_DIRECTORY,   /* known to be a directory, not a link */
+	ENTRY_LINK         /* known to be a symbolic link */
+} entryKind;
+
+#ifdef HAVE_STAT_ST_INO
+/*  One member of the set of (device, inode) pairs of source files parsed
+ *  so far; see isAlreadyParsedFile ().
+ */
+typedef struct sVisitedFile {
+	struct sVisitedFile *next;
+	unsigned long device;
+	unsigned long inode;
+} visitedFile;
+#endif
+
 /*
 *   FUNCTION PROTOTYPES
 */
 static boolean createTagsForEntry (const char *const entryName);
+static boolean createTagsForClassifiedEntry (
+		const char *const entryName, const entryKind kind);
+#ifdef WATCH_SUPPORTED
+static void watchDirectory (const char *const dirName);
+#endif
 
 /*
 *   FUNCTION DEFINITIONS
@@ -122,6 +231,59 @@ extern void addTotals (
 	Totals.bytes += bytes;
 }
 
+/*
+ *  Phase timing (--totals)
+ *
+ *  Wall time is charged to whichever phase is current, so nested work
+ *  (parsing reached from the directory walk, sorting reached from the
+ *  final write) is attributed to its own phase rather than the caller's.
+ *  Each transition costs one clock read and happens a few times per
+ *  file, and only when --totals asked for the accounting.
+ */
+
+static double PhaseSeconds [PHASE_COUNT];
+static timedPhase CurrentPhase = PHASE_WALK;
+static double PhaseStamp = 0.0;
+
+static double wallClock (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return (double) tv.tv_sec + (double) tv.tv_usec / 1000000.0;
+#else
+	return (double) time (NULL);
+#endif
+}
+
+/*  Makes the given phase current, charging the time since the previous
+ *  transition to the phase that was running. Returns the previous phase
+ *  so that callers timing a nested operation can restore it.
+ */
+extern timedPhase beginPhase (const timedPhase phase)
+{
+	const timedPhase previous = CurrentPhase;
+	if (Option.printTotals)
+	{
+		const double now = wallClock ();
+		if (PhaseStamp != 0.0)
+			PhaseSeconds [previous] += now - PhaseStamp;
+		PhaseStamp = now;
+		CurrentPhase = phase;
+	}
+	return previous;
+}
+
+static void printPhaseTimes (void)
+{
+	fprintf (errout,
+			"phase seconds: %.02f walk, %.02f detect, %.02f parse, "
+			"%.02f sort, %.02f write\n",
+			PhaseSeconds [PHASE_WALK], PhaseSeconds [PHASE_DETECT],
+			PhaseSeconds [PHASE_PARSE], PhaseSeconds [PHASE_SORT],
+			PhaseSeconds [PHASE_WRITE]);
+}
+
 extern boolean isDestinationStdout (void)
 {
 	boolean toStdout = FALSE;
@@ -138,6 +300,39 @@ extern boolean isDestinationStdout (void)
 	return toStdout;
 }
 
+/*  Tells whether a file is worth announcing to the prefetcher: only
+ *  files which will actually have their contents parsed are loaded
+ *  ahead, and runs replaying previously captured records rarely read
+ *  contents at all.
+ */
+static boolean wantsPrefetch (const char *const filePath)
+{
+	if (Option.incremental  ||  Option.cacheDir != NULL  ||  Option.dedup)
+		return FALSE;
+	return (boolean) (! isExcludedFile (filePath)  &&
+					  getFileLanguage (filePath) != LANG_IGNORE);
+}
+
+/*  Tells whether a directory entry names the metadata directory of a
+ *  well-known version control system.  Such directories are pruned during
+ *  recursion, before classification or exclusion matching: a .git object
+ *  store often holds more files than the working tree it tracks, and none
+ *  of them are source.  The test is by name alone, so it costs nothing
+ *  beyond the readdir () which produced the entry.
+ */
+static boolean isVcsDirectory (const char *const entryName)
+{
+	static const char *const vcsNames [] = {
+		".git", ".svn", ".hg", ".bzr", "CVS", NULL
+	};
+	boolean result = FALSE;
+	unsigned int i;
+	for (i = 0  ;  vcsNames [i] != NULL  &&  ! result  ;  ++i)
+		if (strcmp (entryName, vcsNames [i]) == 0)
+			result = TRUE;
+	return result;
+}
+
 #if defined (HAVE_OPENDIR)
 static boolean recurseUsingOpendir (const char *const dirName)
 {
@@ -147,22 +342,69 @@ static boolean recurseUsingOpendir (const char *const dirName)
 		error (WARNING | PERROR, "cannot recurse into directory \"%s\"", dirName);
 	else
 	{
+		vString **paths = NULL;
+		entryKind *kinds = NULL;
+		unsigned int count = 0, allocated = 0, i;
 		struct dirent *entry;
+
+		/*  The whole listing is collected before any entry is parsed, so
+		 *  that the regular files of the directory can be announced to
+		 *  the prefetcher as one batch.
+		 */
 		while ((entry = readdir (dir)) != NULL)
 		{
-			if (strcmp (entry->d_name, ".") != 0  &&
+			if (Option.pruneVcs  &&  isVcsDirectory (entry->d_name))
+				verbose ("ignoring \"%s%c%s\" (version control data)\n",
+						 dirName, OUTPUT_PATH_SEPARATOR, entry->d_name);
+			else if (strcmp (entry->d_name, ".") != 0  &&
 				strcmp (entry->d_name, "..") != 0)
 			{
 				vString *filePath;
+				entryKind kind = ENTRY_UNKNOWN;
 				if (strcmp (dirName, ".") == 0)
 					filePath = vStringNewInit (entry->d_name);
 				else
 					filePath = combinePathAndFile (dirName, entry->d_name);
-				resize |= createTagsForEntry (vStringValue (filePath));
-				vStringDelete (filePath);
+#ifdef DT_UNKNOWN
+				/*  File systems which report entry types spare us a stat
+				 *  call per entry; DT_UNKNOWN and special files fall back
+				 *  to eStat() classification.
+				 */
+				switch (entry->d_type)
+				{
+					case DT_REG:  kind = ENTRY_FILE;       break;
+					case DT_DIR:  kind = ENTRY_DIRECTORY;  break;
+					case DT_LNK:  kind = ENTRY_LINK;       break;
+					default:      kind = ENTRY_UNKNOWN;    break;
+				}
+#endif
+				if (count == allocated)
+				{
+					allocated = (allocated == 0) ? 32 : 2 * allocated;
+					paths = xRealloc (paths, allocated, vString*);
+					kinds = xRealloc (kinds, allocated, entryKind);
+				}
+				paths [count] = filePath;
+				kinds [count] = kind;
+				++count;
+				if (kind == ENTRY_FILE  &&
+					wantsPrefetch (vStringValue (filePath)))
+					prefetchAnnounce (vStringValue (filePath));
 			}
 		}
 		closedir (dir);
+		prefetchSubmit ();
+		for (i = 0  ;  i < count  ;  ++i)
+		{
+			resize |= createTagsForClassifiedEntry (
+					vStringValue (paths [i]), kinds [i]);
+			vStringDelete (paths [i]);
+		}
+		if (paths != NULL)
+		{
+			eFree (paths);
+			eFree (kinds);
+		}
 	}
 	return resize;
 }
@@ -175,7 +417,9 @@ static boolean createTagsForWildcardEntry (
 {
 	boolean resize = FALSE;
 	/* we must not recurse into the directories "." or ".." */
-	if (strcmp (entryName, ".") != 0  &&  strcmp (entryName, "..") != 0)
+	if (Option.pruneVcs  &&  isVcsDirectory (entryName))
+		;  /* pruned before the path is even built */
+	else if (strcmp (entryName, ".") != 0  &&  strcmp (entryName, "..") != 0)
 	{
 		vString *const filePath = vStringNew ();
 		vStringNCopyS (filePath, pattern, dirLength);
@@ -244,16 +488,24 @@ static boolean createTagsForAmigaWildcard (const char *const pattern)
 }
 #endif
 
-static boolean recurseIntoDirectory (const char *const dirName)
+static boolean recurseIntoDirectory (
+		const char *const dirName, const boolean mayBeLink)
 {
 	boolean resize = FALSE;
-	if (isRecursiveLink (dirName))
+	if (mayBeLink  &&  isRecursiveLink (dirName))
 		verbose ("ignoring \"%s\" (recursive link)\n", dirName);
 	else if (! Option.recurse)
 		verbose ("ignoring \"%s\" (directory)\n", dirName);
 	else
 	{
 		verbose ("RECURSING into directory \"%s\"\n", dirName);
+#ifdef WATCH_SUPPORTED
+		if (Option.watch)
+			watchDirectory (dirName);
+#endif
+#ifdef JOBS_SUPPORTED
+		++WalkDepth;
+#endif
 #if defined (HAVE_OPENDIR)
 		resize = recurseUsingOpendir (dirName);
 #elif defined (HAVE_FINDFIRST) || defined (HAVE__FINDFIRST)
@@ -278,34 +530,255 @@ static boolean recurseIntoDirectory (const char *const dirName)
 			resize = createTagsForAmigaWildcard (vStringValue (pattern));
 			vStringDelete (pattern);
 		}
+#endif
+#ifdef JOBS_SUPPORTED
+		--WalkDepth;
 #endif
 	}
 	return resize;
 }
 
-static boolean createTagsForEntry (const char *const entryName)
+static boolean dispatchDirectory (
+		const char *const dirName, const boolean mayBeLink)
+{
+	boolean resize = FALSE;
+#ifdef JOBS_SUPPORTED
+	/*  Deeper directories are queued whole so that the workers
+	 *  enumerate and stat their subtrees in parallel; the parent
+	 *  walks only far enough to generate independent work units.
+	 */
+	if (FileQueue != NULL  &&  WalkDepth >= 2)
+		stringListAdd (FileQueue, vStringNewInit (dirName));
+	else
+#endif
+	resize = recurseIntoDirectory (dirName, mayBeLink);
+	return resize;
+}
+
+/*  Progress reporting (--progress) state. The signal handler only raises a
+ *  flag; the report itself is printed from the file loop, where stdio use
+ *  is safe. Unlike verbose mode there is no per-file output, just one
+ *  cheap counter update and time check between files.
+ */
+static long ProgressFiles = 0;
+static time_t ProgressStarted = 0;
+static time_t ProgressDue = 0;
+static volatile boolean ProgressRequested = FALSE;
+
+#ifdef SIGUSR1
+static void progressRequestHandler (int signo __ctags_unused__)
+{
+	ProgressRequested = TRUE;
+	signal (SIGUSR1, progressRequestHandler);
+}
+#endif
+
+static void printProgress (void)
+{
+	const long elapsed = (long) (time (NULL) - ProgressStarted);
+
+	fprintf (errout, "%ld file%s", ProgressFiles, plural (ProgressFiles));
+	if (Totals.bytes > 0)  /* bytes are only accumulated with --progress=N */
+		fprintf (errout, ", %ld kB", Totals.bytes / 1024L);
+	fprintf (errout, " in %ld:%02ld", elapsed / 60L, elapsed % 60L);
+	if (elapsed > 0  &&  Totals.bytes > 0)
+		fprintf (errout, " (%ld kB/s)", Totals.bytes / 1024L / elapsed);
+	fputc ('\n', errout);
+	fflush (errout);
+#ifdef DEBUG
+	eMemoryReport (errout);
+#endif
+}
+
+static void beginProgress (void)
+{
+	ProgressFiles = 0;
+	ProgressStarted = time (NULL);
+	ProgressDue = ProgressStarted + (time_t) Option.progressInterval;
+#ifdef SIGUSR1
+	signal (SIGUSR1, progressRequestHandler);
+#endif
+}
+
+static void fileProgress (void)
+{
+	++ProgressFiles;
+	if (ProgressRequested  ||
+		(Option.progressInterval > 0  &&  time (NULL) >= ProgressDue))
+	{
+		printProgress ();
+		ProgressRequested = FALSE;
+		ProgressDue = time (NULL) + (time_t) Option.progressInterval;
+	}
+}
+
+/*  Tests whether a deterministic hash of the file name assigns it to the
+ *  shard this process was told to parse (see --shard). Every shard applies
+ *  the same hash, so the shards partition any file list identically without
+ *  coordinating with each other.
+ */
+static boolean inShard (const char *const fileName)
+{
+	unsigned long hash = 5381;
+	const char *p;
+
+	for (p = fileName  ;  *p != '\0'  ;  ++p)
+		hash = hash * 33 + (unsigned char) *p;
+	return (boolean) (hash % Option.shardCount == Option.shardIndex - 1);
+}
+
+#ifdef HAVE_STAT_ST_INO
+#define VISITED_EXPONENT 12
+static visitedFile **VisitedFiles = NULL;
+#endif
+
+/*  Tests whether the (device, inode) pair of "fileName" has been seen
+ *  before on this walk, recording it when it has not. Files reachable
+ *  through several paths (hard links, bind mounts, symbolic links
+ *  followed under --links=yes) would otherwise be parsed once per path,
+ *  duplicating every one of their entries in the tag file.
+ *  isRecursiveLink () only guards against a link cycling back to an
+ *  ancestor directory, not against two paths meeting at the same file.
+ */
+static boolean isAlreadyParsedFile (const char *const fileName)
+{
+	boolean result = FALSE;
+#ifdef HAVE_STAT_ST_INO
+	fileStatus *const status = eStat (fileName);
+
+	if (status->exists  &&  status->isNormalFile)
+	{
+		const unsigned long hashedValue =
+				((status->inode * 40503UL) ^ status->device) &
+				((1UL << VISITED_EXPONENT) - 1);
+		visitedFile *entry;
+
+		if (VisitedFiles == NULL)
+		{
+			unsigned int i;
+
+			VisitedFiles = xMalloc (1 << VISITED_EXPONENT, visitedFile*);
+			for (i = 0  ;  i < (1 << VISITED_EXPONENT)  ;  ++i)
+				VisitedFiles [i] = NULL;
+		}
+		entry = VisitedFiles [hashedValue];
+		while (entry != NULL  &&
+			   (entry->device != status->device  ||
+				entry->inode != status->inode))
+			entry = entry->next;
+		if (entry != NULL)
+			result = TRUE;
+		else
+		{
+			entry = xMalloc (1, visitedFile);
+			entry->device = status->device;
+			entry->inode = status->inode;
+			entry->next = VisitedFiles [hashedValue];
+			VisitedFiles [hashedValue] = entry;
+		}
+	}
+	eStatFree (status);
+#endif
+	return result;
+}
+
+/*  Empties the visited set so that every file is again eligible for
+ *  parsing; a file re-parsed by the watch loop was necessarily seen on
+ *  the initial walk.
+ */
+static void forgetVisitedFiles (void)
+{
+#ifdef HAVE_STAT_ST_INO
+	if (VisitedFiles != NULL)
+	{
+		unsigned int i;
+
+		for (i = 0  ;  i < (1 << VISITED_EXPONENT)  ;  ++i)
+		{
+			visitedFile *entry = VisitedFiles [i];
+
+			while (entry != NULL)
+			{
+				visitedFile *next = entry->next;
+				eFree (entry);
+				entry = next;
+			}
+		}
+		eFree (VisitedFiles);
+		VisitedFiles = NULL;
+	}
+#endif
+}
+
+static boolean dispatchSourceFile (const char *const fileName)
+{
+	boolean resize = FALSE;
+	++DispatchedFiles;
+	if (DispatchedFiles <= resumedFileCount ())
+		verbose ("skipping \"%s\" (already completed)\n", fileName);
+	else if (Option.shardCount > 0  &&  ! inShard (fileName))
+		verbose ("skipping \"%s\" (outside shard)\n", fileName);
+	else if (isSourceFileUnchanged (fileName))
+		verbose ("skipping \"%s\" (unchanged)\n", fileName);
+	else if (isAlreadyParsedFile (fileName))
+		verbose ("skipping \"%s\" (already parsed through another path)\n",
+				fileName);
+#ifdef JOBS_SUPPORTED
+	else if (FileQueue != NULL)
+		stringListAdd (FileQueue, vStringNewInit (fileName));
+#endif
+	else
+	{
+		resize = parseFile (fileName);
+		writeSourceMtimeTag (fileName);
+		writeJournalFileTag (fileName);
+		if (DispatchedFiles % CHECKPOINT_INTERVAL == 0)
+			writeCheckpoint (DispatchedFiles);
+	}
+	fileProgress ();
+	return resize;
+}
+
+static boolean createTagsForClassifiedEntry (
+		const char *const entryName, const entryKind kind)
 {
 	boolean resize = FALSE;
-	fileStatus *status = eStat (entryName);
 
 	Assert (entryName != NULL);
 	if (isExcludedFile (entryName))
 		verbose ("excluding \"%s\"\n", entryName);
-	else if (status->isSymbolicLink  &&  ! Option.followLinks)
+	else if (kind == ENTRY_LINK  &&  ! Option.followLinks)
 		verbose ("ignoring \"%s\" (symbolic link)\n", entryName);
-	else if (! status->exists)
-		error (WARNING | PERROR, "cannot open source file \"%s\"", entryName);
-	else if (status->isDirectory)
-		resize = recurseIntoDirectory (entryName);
-	else if (! status->isNormalFile)
-		verbose ("ignoring \"%s\" (special file)\n", entryName);
+	else if (kind == ENTRY_DIRECTORY)
+		resize = dispatchDirectory (entryName, FALSE);
+	else if (kind == ENTRY_FILE)
+		resize = dispatchSourceFile (entryName);
 	else
-		resize = parseFile (entryName);
-
-	eStatFree (status);
+	{
+		fileStatus *status = eStat (entryName);
+		if (status->isSymbolicLink  &&  ! Option.followLinks)
+			verbose ("ignoring \"%s\" (symbolic link)\n", entryName);
+		else if (! status->exists)
+			error (WARNING | PERROR, "cannot open source file \"%s\"",
+					entryName);
+		else if (status->isDirectory)
+			resize = dispatchDirectory (entryName, TRUE);
+		else if (! status->isNormalFile)
+			verbose ("ignoring \"%s\" (special file)\n", entryName);
+		else
+			resize = dispatchSourceFile (entryName);
+		eStatFree (status);
+	}
 	return resize;
 }
 
+static boolean createTagsForEntry (const char *const entryName)
+{
+	if (strcmp (entryName, "-") == 0)
+		return parseStandardInput ();
+	return createTagsForClassifiedEntry (entryName, ENTRY_UNKNOWN);
+}
+
 #ifdef MANUAL_GLOBBING
 
 static boolean createTagsForWildcardArg (const char *const arg)
@@ -353,6 +826,298 @@ static boolean createTagsForArgs (cookedArgs *const args)
 	return resize;
 }
 
+#ifdef JOBS_SUPPORTED
+
+#ifndef EXTERNAL_SORT
+
+/*  Counts the lines of a worker shard with block reads, so the parent can
+ *  account for tags it adopts without parsing them.
+ */
+static unsigned long countFileLines (const char *const name)
+{
+	FILE *const fp = fopen (name, "rb");
+	unsigned long lines = 0;
+
+	if (fp != NULL)
+	{
+		enum { BufferSize = 0x4000 };
+		char *const buffer = xMalloc (BufferSize, char);
+		size_t numRead, i;
+
+		while ((numRead = fread (buffer, 1, (size_t) BufferSize, fp)) > 0)
+			for (i = 0  ;  i < numRead  ;  ++i)
+				if (buffer [i] == '\n')
+					++lines;
+		eFree (buffer);
+		fclose (fp);
+	}
+	return lines;
+}
+
+#endif
+
+/*  A queued entry with its detected language and submission position, used
+ *  while grouping the queue by language.
+ */
+typedef struct sQueuedEntry {
+	vString *path;
+	langType language;
+	unsigned int order;
+} queuedEntry;
+
+static int compareQueuedEntries (const void *a, const void *b)
+{
+	const queuedEntry *const x = (const queuedEntry *) a;
+	const queuedEntry *const y = (const queuedEntry *) b;
+	if (x->language != y->language)
+		return (x->language < y->language) ? -1 : 1;
+	return (x->order < y->order) ? -1 : 1;
+}
+
+/*  Reorders the queue so that files of the same language are adjacent,
+ *  which the contiguous assignment below turns into same-language batches
+ *  per worker: a worker stays within one parser's code and keyword tables
+ *  instead of cycling every parser in the build through its instruction
+ *  cache.  Submission order is kept within each language, and directories
+ *  (whose contents are classified by the worker which walks them) gather
+ *  under LANG_IGNORE.  Only callers whose output is sorted afterwards may
+ *  group: unsorted output must reproduce the submission order exactly.
+ */
+static void groupQueueByLanguage (void)
+{
+	const unsigned int count = stringListCount (FileQueue);
+	queuedEntry *const entries = xMalloc (count, queuedEntry);
+	unsigned int i;
+
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		entries [i].path = stringListItem (FileQueue, i);
+		entries [i].language =
+				getFileLanguage (vStringValue (entries [i].path));
+		entries [i].order = i;
+	}
+	qsort (entries, count, sizeof (queuedEntry), compareQueuedEntries);
+	for (i = 0  ;  i < count  ;  ++i)
+		FileQueue->list [i] = entries [i].path;
+	eFree (entries);
+}
+
+/*  Assigns the queued entries to workers as contiguous runs of the
+ *  submission order, each run carrying about the same total weight.
+ *  Contiguous runs mean that appending the worker outputs in worker order
+ *  reproduces the order a single process would have written, keeping
+ *  parallel output deterministic; the weights, from the same stat data the
+ *  traversal used, keep the runs balanced to within the largest single
+ *  entry.  A queued directory is an opaque unit whose subtree the worker
+ *  enumerates itself; each is weighted as at least the largest known file.
+ */
+static unsigned int *scheduleFileQueue (const unsigned int count,
+										const unsigned int jobs)
+{
+	unsigned int *const assignment = xMalloc (count, unsigned int);
+	unsigned long *const weight = xMalloc (count, unsigned long);
+	boolean *const isDirectory = xMalloc (count, boolean);
+	unsigned long largest = 0, total = 0, accumulated = 0;
+	unsigned int worker = 0;
+	unsigned int i;
+
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		fileStatus *const status =
+				eStat (vStringValue (stringListItem (FileQueue, i)));
+		isDirectory [i] = (boolean)
+				(status->exists  &&  status->isDirectory);
+		weight [i] = (status->exists  &&  ! status->isDirectory)
+				? status->size : 0;
+		if (weight [i] > largest)
+			largest = weight [i];
+	}
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		if (isDirectory [i])
+			weight [i] = largest + 1;
+		total += weight [i] + 1;
+	}
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		/*  Move on to the next worker once this one has reached its share
+		 *  of the total, leaving at least one entry for each worker still
+		 *  without any.
+		 */
+		if (worker + 1 < jobs  &&
+			accumulated >= ((worker + 1) * total) / jobs  &&
+			count - i >= jobs - worker)
+			++worker;
+		assignment [i] = worker;
+		accumulated += weight [i] + 1;
+	}
+	eFree (weight);
+	eFree (isDirectory);
+	return assignment;
+}
+
+/*  Parses the queued files with a pool of worker processes. The parsers
+ *  and the tag file writer rely on global state (File, TagFile), so the
+ *  workers are created with fork(): each one inherits fully initialized
+ *  parsers, redirects its tag output to a private temporary file and
+ *  parses the queued files assigned to it. With the internal sort each worker
+ *  delivers its shard already sorted and the parent merges the shards
+ *  directly, so the sorting work scales with the workers; otherwise the
+ *  parent appends each shard to the real tag file, whence sorting
+ *  proceeds as usual.  Appending in worker order, with the contiguous
+ *  assignment of scheduleFileQueue, reproduces the record order of a
+ *  single process.
+ */
+static void parseFileQueue (void)
+{
+	const unsigned int jobs = Option.jobs;
+	const unsigned int count = stringListCount (FileQueue);
+	unsigned int *assignment;
+	char **const tempNames = xMalloc (jobs, char*);
+	pid_t *const pids = xMalloc (jobs, pid_t);
+	unsigned int i, j;
+#ifndef EXTERNAL_SORT
+	const boolean sortedShards = (boolean)
+			(Option.sorted != SO_UNSORTED  &&  ! Option.append  &&
+			 ! Option.xref  &&  ! Option.etags);
+#endif
+
+	if (count == 1)
+	{
+		/*  A single entry cannot be spread over the workers (a directory
+		 *  is assigned whole), so parse it in process; this leaves the
+		 *  jobs available for matching the chunks of a large file of a
+		 *  regex language in parallel.
+		 */
+		stringList *const queue = FileQueue;
+		FileQueue = NULL;
+		forgetVisitedFiles ();  /* recorded when the entry was queued */
+		createTagsForEntry (vStringValue (stringListItem (queue, 0)));
+		FileQueue = queue;
+		eFree (tempNames);
+		eFree (pids);
+		return;
+	}
+	if (Option.sorted != SO_UNSORTED  &&  ! Option.xref  &&  ! Option.etags)
+		groupQueueByLanguage ();
+	assignment = scheduleFileQueue (count, jobs);
+	flushTagOutput ();
+	fflush (TagFile.fp);  /* keep buffered output out of the workers */
+	for (i = 0  ;  i < jobs  ;  ++i)
+		fclose (tempFile ("w", &tempNames [i]));
+	for (i = 0  ;  i < jobs  ;  ++i)
+	{
+		pids [i] = fork ();
+		if (pids [i] == -1)
+			error (FATAL | PERROR, "cannot fork worker process");
+		else if (pids [i] == 0)
+		{
+			stringList *const queue = FileQueue;
+			FILE *const fp = fopen (tempNames [i], "w");
+			if (fp == NULL)
+				error (FATAL | PERROR, "cannot open worker tag file");
+			fclose (TagFile.fp);
+			TagFile.fp = fp;
+			FileQueue = NULL;  /* workers parse and recurse directly */
+#ifdef PIPED_SORT_SUPPORTED
+			abandonSortStream ();  /* the parent alone feeds the sort */
+#endif
+#ifndef EXTERNAL_SORT
+			forgetRememberedTagLines ();  /* inherited from the parent */
+#endif
+			suppressParallelMatching ();  /* the queue is parallel already */
+			prefetchAbandon ();  /* the inherited ring belongs to the parent */
+			forgetVisitedFiles ();  /* queued entries are already in the set */
+			for (j = 0  ;  j < count  ;  ++j)
+				if (assignment [j] == i  &&
+					wantsPrefetch (vStringValue (stringListItem (queue, j))))
+					prefetchAnnounce (vStringValue (stringListItem (queue, j)));
+			prefetchSubmit ();
+			for (j = 0  ;  j < count  ;  ++j)
+				if (assignment [j] == i)
+					createTagsForEntry (
+							vStringValue (stringListItem (queue, j)));
+#ifndef EXTERNAL_SORT
+			if (sortedShards)
+			{
+				/*  Rewrite the shard in sorted order for the parent to
+				 *  merge.
+				 */
+				TagFile.fp = freopen (tempNames [i], "w", TagFile.fp);
+				if (TagFile.fp == NULL)
+					error (FATAL | PERROR, "cannot rewrite worker tag file");
+				writeSortedShard (TagFile.fp);
+			}
+#endif
+			fclose (TagFile.fp);
+			_exit (0);
+		}
+	}
+	for (i = 0  ;  i < jobs  ;  ++i)
+	{
+		int status;
+		if (waitpid (pids [i], &status, 0) == -1  ||
+			! WIFEXITED (status)  ||  WEXITSTATUS (status) != 0)
+			error (WARNING, "worker process failed; tag file may be incomplete");
+	}
+	for (i = 0  ;  i < jobs  ;  ++i)
+	{
+#ifndef EXTERNAL_SORT
+		if (sortedShards)
+		{
+			/*  The shard becomes a run of the final merge, which disposes
+			 *  of the file and its name.
+			 */
+			TagFile.numTags.added += countFileLines (tempNames [i]);
+			adoptSortedRun (tempNames [i]);
+			continue;
+		}
+#endif
+		{
+			FILE *const fp = fopen (tempNames [i], "r");
+			if (fp == NULL)
+				error (WARNING | PERROR, "cannot read worker tag file");
+			else
+			{
+				const char *line;
+				while ((line = readLine (TagFile.vLine, fp)) != NULL)
+				{
+					fputs (line, TagFile.fp);
+					++TagFile.numTags.added;
+				}
+				fclose (fp);
+			}
+			remove (tempNames [i]);
+			eFree (tempNames [i]);
+		}
+	}
+	flushTagOutput ();
+	eFree (tempNames);
+	eFree (pids);
+	eFree (assignment);
+}
+
+/*  Number of file names buffered from a file list before the worker pool
+ *  drains them. Bounds the queue so that a slow producer piped into -L -
+ *  overlaps the parsing instead of being read to the end first.
+ */
+#define FILE_QUEUE_DRAIN_THRESHOLD 500
+
+/*  Parses and empties the file queue once enough names have accumulated,
+ *  so that list input is consumed concurrently with parsing.
+ */
+static void drainFileQueue (void)
+{
+	if (FileQueue != NULL  &&
+		stringListCount (FileQueue) >= FILE_QUEUE_DRAIN_THRESHOLD)
+	{
+		parseFileQueue ();
+		stringListClear (FileQueue);
+	}
+}
+
+#endif
+
 /*  Read from an opened file a list of file names for which to generate tags.
  */
 static boolean createTagsFromFileInput (FILE *const fp, const boolean filter)
@@ -365,6 +1130,9 @@ static boolean createTagsFromFileInput (FILE *const fp, const boolean filter)
 		while (! cArgOff (args))
 		{
 			resize |= createTagsForEntry (cArgItem (args));
+#ifdef JOBS_SUPPORTED
+			drainFileQueue ();
+#endif
 			if (filter)
 			{
 				if (Option.filterTerminator != NULL)
@@ -398,6 +1166,255 @@ static boolean createTagsFromListFile (const char *const fileName)
 	return resize;
 }
 
+#ifdef WATCH_SUPPORTED
+
+/*  Directories registered with the change monitor. The inotify watch
+ *  descriptor for each directory is kept at the same index.
+ */
+static stringList *WatchedDirectories = NULL;
+static int *WatchDescriptors = NULL;
+static unsigned int WatchDescriptorCount = 0;
+static int InotifyFd = -1;
+
+static const char *watchedDirectoryName (const int wd)
+{
+	unsigned int i;
+	for (i = 0  ;  i < WatchDescriptorCount  ;  ++i)
+		if (WatchDescriptors [i] == wd)
+			return vStringValue (stringListItem (WatchedDirectories, i));
+	return NULL;
+}
+
+/*  Registers watches for directories added to WatchedDirectories since the
+ *  last call.
+ */
+static void registerDirectoryWatches (void)
+{
+	const unsigned int count = stringListCount (WatchedDirectories);
+
+	if (count > WatchDescriptorCount)
+		WatchDescriptors = xRealloc (WatchDescriptors, count, int);
+	while (WatchDescriptorCount < count)
+	{
+		const char *const dirName = vStringValue (
+			stringListItem (WatchedDirectories, WatchDescriptorCount));
+		const int wd = inotify_add_watch (InotifyFd, dirName,
+			IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+			IN_MOVED_FROM | IN_MOVED_TO);
+
+		if (wd == -1)
+			error (WARNING | PERROR, "cannot watch directory \"%s\"",
+					dirName);
+		WatchDescriptors [WatchDescriptorCount++] = wd;
+	}
+}
+
+/*  Called from the directory walk for every directory entered, both during
+ *  the initial pass (before the monitor exists) and when new directories
+ *  appear while watching.
+ */
+static void watchDirectory (const char *const dirName)
+{
+	if (WatchedDirectories == NULL)
+		WatchedDirectories = stringListNew ();
+	stringListAdd (WatchedDirectories, vStringNewInit (dirName));
+	if (InotifyFd != -1)
+		registerDirectoryWatches ();
+}
+
+/*  Is this the tag file itself, or the index written beside it? When they
+ *  live inside a watched directory their rewrites must not be mistaken for
+ *  source changes, or every update would trigger the next.
+ */
+static boolean isTagOutputFile (const char *const fileName)
+{
+	/*  TagFile.name only lives while the tag file is open; the option
+	 *  value persists across the update cycles.
+	 */
+	const char *const tagFile = Option.tagFileName;
+	size_t length;
+
+	if (tagFile == NULL)
+		return FALSE;
+	length = strlen (tagFile);
+	if (strncmp (fileName, tagFile, length) == 0  &&
+		(fileName [length] == '\0'  ||
+		 strcmp (fileName + length, ".idx") == 0))
+		return TRUE;
+	return isSameFile (fileName, tagFile);
+}
+
+/*  Re-parses the files named by a batch of change events. Reopening the
+ *  tag file in incremental mode carries over the entries of all unchanged
+ *  files and drops those of modified or deleted ones, so only the files in
+ *  the batch need to be parsed again.
+ */
+static void processWatchEvents (const char *const events, const size_t length)
+{
+	boolean resize = FALSE;
+	const char *at = events;
+	stringList *const changed = stringListNew ();
+
+	while (at < events + length)
+	{
+		const struct inotify_event *const event =
+			(const struct inotify_event *) at;
+		const char *const dirName = watchedDirectoryName (event->wd);
+
+		if (dirName != NULL  &&  event->len > 0)
+		{
+			vString *filePath;
+			if (strcmp (dirName, ".") == 0)
+				filePath = vStringNewInit (event->name);
+			else
+				filePath = combinePathAndFile (dirName, event->name);
+			if (isTagOutputFile (vStringValue (filePath))  ||
+				stringListHas (changed, vStringValue (filePath)))
+				vStringDelete (filePath);
+			else
+				stringListAdd (changed, filePath);
+		}
+		at += sizeof (struct inotify_event) + event->len;
+	}
+	if (stringListCount (changed) > 0)
+	{
+		unsigned int i;
+
+		openTagFile ();
+		forgetVisitedFiles ();
+		for (i = 0  ;  i < stringListCount (changed)  ;  ++i)
+		{
+			const char *const fileName =
+				vStringValue (stringListItem (changed, i));
+			fileStatus *status = eStat (fileName);
+			const boolean exists = status->exists;
+
+			eStatFree (status);
+			if (exists)
+			{
+				verbose ("re-parsing \"%s\" (changed)\n", fileName);
+				resize |= createTagsForEntry (fileName);
+			}
+			else  /* carryOverTags () already dropped its entries */
+				verbose ("dropping \"%s\" (removed)\n", fileName);
+		}
+		closeTagFile (resize);
+	}
+	stringListDelete (changed);
+}
+
+/*  Monitors the directories walked by the tagging pass and keeps the tag
+ *  file up to date as their contents change. Runs until interrupted.
+ */
+static void watchForChanges (void)
+{
+	if (WatchedDirectories == NULL)
+	{
+		error (WARNING, "no directories were walked; nothing to watch");
+		return;
+	}
+	InotifyFd = inotify_init ();
+	if (InotifyFd == -1)
+		error (FATAL | PERROR, "cannot initialize file change monitor");
+	registerDirectoryWatches ();
+	verbose ("Watching %u directories\n", WatchDescriptorCount);
+	for (;;)
+	{
+		union {  /* force alignment of the event structures */
+			struct inotify_event event;
+			char buffer [8192];
+		} events;
+		const ssize_t length = read (
+			InotifyFd, events.buffer, sizeof events.buffer);
+
+		if (length <= 0)
+		{
+			if (errno == EINTR)
+				continue;
+			error (FATAL | PERROR, "cannot read file change events");
+		}
+		processWatchEvents (events.buffer, (size_t) length);
+	}
+}
+
+#endif
+
+#ifdef DAEMON_SUPPORTED
+
+/*  Path of the listening socket, so that the signal handler can remove it.
+ */
+static const char *DaemonSocketPath = NULL;
+
+static void daemonExitHandler (int __ctags_unused__ signo)
+{
+	if (DaemonSocketPath != NULL)
+		remove (DaemonSocketPath);
+	_exit (0);
+}
+
+/*  Serve tag requests over a unix domain socket. Parser definitions,
+ *  keyword tables and option state are initialized once in this process;
+ *  each connection is handled by a forked child which inherits that warm
+ *  state and speaks the filter protocol (file names in, tag lines out)
+ *  over the connection.
+ */
+static void runDaemon (const char *const socketPath)
+{
+	int listenFd;
+	struct sockaddr_un address;
+
+	if (strlen (socketPath) >= sizeof address.sun_path)
+		error (FATAL, "daemon socket path is too long: \"%s\"", socketPath);
+	listenFd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (listenFd == -1)
+		error (FATAL | PERROR, "cannot create daemon socket");
+	memset (&address, 0, sizeof address);
+	address.sun_family = AF_UNIX;
+	strcpy (address.sun_path, socketPath);
+	remove (socketPath);
+	if (bind (listenFd, (struct sockaddr *) &address, sizeof address) != 0)
+		error (FATAL | PERROR, "cannot bind daemon socket \"%s\"", socketPath);
+	if (listen (listenFd, 8) != 0)
+		error (FATAL | PERROR, "cannot listen on daemon socket \"%s\"",
+				socketPath);
+	DaemonSocketPath = socketPath;
+	signal (SIGINT, daemonExitHandler);
+	signal (SIGTERM, daemonExitHandler);
+	signal (SIGCHLD, SIG_IGN);  /* connection children are not waited for */
+	signal (SIGPIPE, SIG_IGN);  /* clients may hang up mid-reply */
+	verbose ("Serving tag requests on \"%s\"\n", socketPath);
+	for (;;)
+	{
+		const int connection = accept (listenFd, NULL, NULL);
+		pid_t pid;
+		if (connection == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			error (FATAL | PERROR, "cannot accept daemon connection");
+		}
+		pid = fork ();
+		if (pid == -1)
+			error (WARNING | PERROR, "cannot fork daemon worker");
+		else if (pid == 0)
+		{
+			FILE *const request = fdopen (connection, "r");
+			close (listenFd);
+			DaemonSocketPath = NULL;  /* the socket belongs to the parent */
+			signal (SIGCHLD, SIG_DFL);  /* sorting may spawn children */
+			prefetchAbandon ();  /* any inherited ring belongs to the parent */
+			dup2 (connection, fileno (stdout));
+			if (request != NULL)
+				createTagsFromFileInput (request, TRUE);
+			fflush (stdout);
+			_exit (0);
+		}
+		close (connection);
+	}
+}
+
+#endif
+
 #if defined (HAVE_CLOCK)
 # define CLOCK_AVAILABLE
 # ifndef CLOCKS_PER_SEC
@@ -455,17 +1472,78 @@ static void printTotals (const clock_t *const timeStamps)
 		fputc ('\n', errout);
 	}
 
+	printPhaseTimes ();
+
 #ifdef DEBUG
 	fprintf (errout, "longest tag line = %lu\n",
 			(unsigned long) TagFile.max.line);
+	eMemoryReport (errout);
 #endif
 }
 
+#if defined (DEBUG) && defined (SIGUSR1)
+
+/*  Reports heap statistics on demand, without interrupting the run.
+ */
+static void memoryReportHandler (int signo __ctags_unused__)
+{
+	eMemoryReport (errout);
+	signal (SIGUSR1, memoryReportHandler);
+}
+
+#endif
+
+#ifdef SIGUSR2
+
+/*  Dumps the trace ring on demand, so that a stalled production run can
+ *  be diagnosed without restarting it under a debug build.
+ */
+static void traceDumpHandler (int signo __ctags_unused__)
+{
+	traceDump (errout);
+	signal (SIGUSR2, traceDumpHandler);
+}
+
+#endif
+
 static boolean etagsInclude (void)
 {
 	return (boolean)(Option.etags && Option.etagsInclude != NULL);
 }
 
+/*  The older tag file named by --delta is commonly the very file this run
+ *  overwrites, so its content is stashed in a temporary file before the
+ *  output is opened; the finished output is diffed against the stash.
+ */
+static char *DeltaBase = NULL;
+
+static void stashDeltaBase (void)
+{
+	fileStatus *status = eStat (Option.deltaFile);
+	const boolean exists = status->exists;
+	const unsigned long size = status->size;
+
+	eStatFree (status);  /* tempFile () reuses the stat cache */
+	fclose (tempFile ("w", &DeltaBase));
+	if (exists)
+		copyFile (Option.deltaFile, DeltaBase, (long) size);
+	else
+		verbose ("old tag file \"%s\" is absent; the delta lists every tag as added\n",
+				 Option.deltaFile);
+}
+
+static void writeDeltaOutput (void)
+{
+	vString *const deltaName = vStringNewInit (Option.tagFileName);
+
+	vStringCatS (deltaName, ".delta");
+	writeTagsDelta (DeltaBase, Option.tagFileName, vStringValue (deltaName));
+	vStringDelete (deltaName);
+	remove (DeltaBase);
+	eFree (DeltaBase);
+	DeltaBase = NULL;
+}
+
 static void makeTags (cookedArgs *args)
 {
 	clock_t timeStamps [3];
@@ -473,6 +1551,43 @@ static void makeTags (cookedArgs *args)
 	boolean files = (boolean)(! cArgOff (args) || Option.fileList != NULL
 							  || Option.filter);
 
+#ifdef DAEMON_SUPPORTED
+	if (Option.daemonSocket != NULL)
+		runDaemon (Option.daemonSocket);  /* does not return */
+#endif
+
+	if (Option.merge)
+	{
+		stringList *const names = stringListNew ();
+
+		/*  The arguments name the shard tag files to merge, not sources.
+		 */
+		while (! cArgOff (args))
+		{
+			stringListAdd (names, vStringNewInit (cArgItem (args)));
+			cArgForth (args);
+			parseOptions (args);
+		}
+		if (stringListCount (names) == 0)
+			error (FATAL, "No tag files specified for --merge. Try \"%s --help\".",
+				getExecutableName ());
+		verbose ("Merging %u shard tag files\n", stringListCount (names));
+		setDefaultTagFileName ();
+		mergeTagFiles (names, isDestinationStdout ());
+		stringListDelete (names);
+		return;
+	}
+
+	if (Option.journalCompact)
+	{
+		/*  No sources are parsed; the journal segments of the tag file
+		 *  are folded into it.
+		 */
+		setDefaultTagFileName ();
+		compactJournal ();
+		return;
+	}
+
 	if (! files)
 	{
 		if (filesRequired ())
@@ -482,11 +1597,26 @@ static void makeTags (cookedArgs *args)
 			return;
 	}
 
+	beginProgress ();
+
 #define timeStamp(n) timeStamps[(n)]=(Option.printTotals ? clock():(clock_t)0)
 	if (! Option.filter)
+	{
+		if (Option.deltaFile != NULL)
+			stashDeltaBase ();
 		openTagFile ();
+	}
 
 	timeStamp (0);
+	beginPhase (PHASE_WALK);
+
+#ifdef JOBS_SUPPORTED
+	if (Option.jobs > 1  &&  ! Option.filter)
+	{
+		verbose ("Parsing with %u worker processes\n", Option.jobs);
+		FileQueue = stringListNew ();
+	}
+#endif
 
 	if (! cArgOff (args))
 	{
@@ -504,17 +1634,35 @@ static void makeTags (cookedArgs *args)
 		resize = (boolean) (createTagsFromFileInput (stdin, TRUE) || resize);
 	}
 	if (! files  &&  Option.recurse)
-		resize = recurseIntoDirectory (".");
+		resize = recurseIntoDirectory (".", TRUE);
+
+#ifdef JOBS_SUPPORTED
+	if (FileQueue != NULL)
+	{
+		parseFileQueue ();
+		stringListDelete (FileQueue);
+		FileQueue = NULL;
+	}
+#endif
 
 	timeStamp (1);
+	beginPhase (PHASE_WRITE);
 
 	if (! Option.filter)
+	{
 		closeTagFile (resize);
+		journalMaybeCompact ();
+		if (DeltaBase != NULL)
+			writeDeltaOutput ();
+	}
 
 	timeStamp (2);
+	beginPhase (PHASE_WALK);  /* charge the final writes before reporting */
 
 	if (Option.printTotals)
 		printTotals (timeStamps);
+	if (Option.printStats)
+		printParserStatistics ();
 #undef timeStamp
 }
 
@@ -522,7 +1670,7 @@ static void makeTags (cookedArgs *args)
  *		Start up code
  */
 
-extern int main (int __unused__ argc, char **argv)
+extern int main (int __ctags_unused__ argc, char **argv)
 {
 	cookedArgs *args;
 #ifdef VMS
@@ -546,9 +1694,16 @@ extern int main (int __unused__ argc, char **argv)
 	argc = ccommand (&argv);
 #endif
 
+	initCharacterClass ();
 	setCurrentDirectory ();
 	setExecutableName (*argv++);
 	checkRegex ();
+#if defined (DEBUG) && defined (SIGUSR1)
+	signal (SIGUSR1, memoryReportHandler);
+#endif
+#ifdef SIGUSR2
+	signal (SIGUSR2, traceDumpHandler);
+#endif
 
 	args = cArgNewFromArgv (argv);
 	previewFirstOption (args);
@@ -560,10 +1715,18 @@ extern int main (int __unused__ argc, char **argv)
 	parseOptions (args);
 	checkOptions ();
 	makeTags (args);
+#ifdef WATCH_SUPPORTED
+	if (Option.watch)
+		watchForChanges ();  /* runs until interrupted */
+#endif
 
 	/*  Clean up.
 	 */
 	cArgDelete (args);
+	freeCacheResources ();
+	freePrefetchResources ();
+	forgetVisitedFiles ();
+	freeInternTable ();
 	freeKeywordTable ();
 	freeRoutineResources ();
 	freeSourceFileResources ();
@@ -20,10 +20,26 @@
 
 #include "vstring.h"
 
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Phases of a run whose wall time is accounted separately (--totals).
+ */
+typedef enum eTimedPhase {
+	PHASE_WALK,    /* directory traversal and file dispatch */
+	PHASE_DETECT,  /* language detection */
+	PHASE_PARSE,   /* parsing source files */
+	PHASE_SORT,    /* sorting the tag file */
+	PHASE_WRITE,   /* tag file resizing and final writes */
+	PHASE_COUNT
+} timedPhase;
+
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void addTotals (const unsigned int files, const long unsigned int lines, const long unsigned int bytes);
+extern timedPhase beginPhase (const timedPhase phase);
 extern boolean isDestinationStdout (void);
 extern int main (int argc, char **argv);
 
@@ -17,7 +17,7 @@
 #include <string.h>
 #include <ctype.h>
 
-#include "options.h"
+#include "entry.h"
 #include "parse.h"
 #include "read.h"
 #include "vstring.h"
@@ -33,30 +33,78 @@ static kindOption MakeKinds [] = {
 	{ TRUE, 'm', "macro", "macros"}
 };
 
+/*  The scanner below works a logical line at a time; these hold its place
+ *  within the line being scanned and where that line began in the file,
+ *  so that tags point at the first physical line of a continued one.
+ */
+static const unsigned char *LineCursor;
+static int LineUngetc;
+static unsigned long LineNumber;
+static filePos FilePosition;
+
 /*
 *   FUNCTION DEFINITIONS
 */
 
+/*  Assembles the next logical line, appending each physical line ending in
+ *  a backslash-newline (an odd number of trailing backslashes) to the one
+ *  which follows it, so that target and macro detection runs once per
+ *  logical line. Returns FALSE at end of file.
+ */
+static boolean readLogicalLine (vString *const line)
+{
+	const unsigned char *physical;
+	boolean eof = TRUE;
+
+	vStringClear (line);
+	while ((physical = fileReadLine ()) != NULL)
+	{
+		const size_t length = strlen ((const char *) physical);
+		size_t backslashes = 0;
+
+		if (eof)  /* first physical line of this logical line */
+		{
+			LineNumber   = getSourceLineNumber ();
+			FilePosition = getInputFilePosition ();
+		}
+		eof = FALSE;
+		while (backslashes < length  &&
+			   physical [length - 1 - backslashes] == '\\')
+			++backslashes;
+		if ((backslashes & 1) == 0)
+		{
+			vStringNCatS (line, (const char *) physical, length);
+			break;
+		}
+		vStringNCatS (line, (const char *) physical, length - 1);
+	}
+	return (boolean) ! eof;
+}
+
+/*  Hands out the characters of the current logical line, dropping each
+ *  backslash and passing the character it escapes through unadorned, and
+ *  returning a newline once the line is exhausted.
+ */
 static int nextChar (void)
 {
-	int c = fileGetc ();
-	if (c == '\\')
+	int c;
+	if (LineUngetc != '\0')
 	{
-		c = fileGetc ();
-		if (c == '\n')
-			c = fileGetc ();
+		c = LineUngetc;
+		LineUngetc = '\0';
 	}
+	else if (*LineCursor == '\0')
+		return '\n';
+	else
+		c = *LineCursor++;
+	if (c == '\\'  &&  *LineCursor != '\0')
+		c = *LineCursor++;
 	return c;
 }
 
-static void skipLine (void)
+static void ungetChar (const int c)
 {
-	int c;
-	do
-		c = nextChar ();
-	while (c != EOF  &&  c != '\n');
-	if (c == '\n')
-		fileUngetc (c);
+	LineUngetc = c;
 }
 
 static int skipToNonWhite (void)
@@ -82,16 +130,15 @@ static void readIdentifier (const int first, vString *const id)
 		vStringPut (id, c);
 		c = nextChar ();
 	}
-	fileUngetc (c);
+	ungetChar (c);
 	vStringTerminate (id);
 }
 
 static void skipToMatch (const char *const pair)
 {
 	const int begin = pair [0], end = pair [1];
-	const unsigned long inputLineNumber = getInputLineNumber ();
 	int matchLevel = 1;
-	int c = '\0';
+	int c;
 
 	while (matchLevel > 0)
 	{
@@ -100,104 +147,117 @@ static void skipToMatch (const char *const pair)
 			++matchLevel;
 		else if (c == end)
 			--matchLevel;
-		else if (c == '\n' || c == EOF)
+		else if (c == '\n')
 			break;
 	}
-	if (c == EOF)
-		verbose ("%s: failed to find match for '%c' at line %lu\n",
-				getInputFileName (), begin, inputLineNumber);
+}
+
+/*  Like makeSimpleTag (), but stamped with the position recorded when the
+ *  current logical line began rather than where reading has advanced to.
+ */
+static void makeMacroTag (const vString* const name)
+{
+	if (MakeKinds [K_MACRO].enabled  &&  vStringLength (name) > 0)
+	{
+		tagEntryInfo e;
+		initTagEntry (&e, vStringValue (name));
+
+		e.lineNumber   = LineNumber;
+		e.filePosition = FilePosition;
+		e.kindName     = MakeKinds [K_MACRO].name;
+		e.kind         = MakeKinds [K_MACRO].letter;
+
+		makeTagEntry (&e);
+	}
 }
 
 static void findMakeTags (void)
 {
 	vString *name = vStringNew ();
-	boolean newline = TRUE;
+	vString *line = vStringNew ();
 	boolean in_define = FALSE;
 	boolean in_rule = FALSE;
-	boolean variable_possible = TRUE;
 	int c;
 
-	while ((c = nextChar ()) != EOF)
+	while (readLogicalLine (line))
 	{
-		if (newline)
-		{
-			if (in_rule)
-			{
-				if (c == '\t')
-				{
-					skipLine ();  /* skip rule */
-					continue;
-				}
-				else
-					in_rule = FALSE;
-			}
-			variable_possible = (boolean)(!in_rule);
-			newline = FALSE;
-		}
-		if (c == '\n')
-			newline = TRUE;
-		else if (isspace (c))
-			continue;
-		else if (c == '#')
-			skipLine ();
-		else if (c == '(')
-			skipToMatch ("()");
-		else if (c == '{')
-			skipToMatch ("{}");
-		else if (c == ':')
+		boolean variable_possible;
+
+		LineCursor = (const unsigned char *) vStringValue (line);
+		LineUngetc = '\0';
+
+		if (in_rule)
 		{
-			variable_possible = TRUE;
-			in_rule = TRUE;
+			if (LineCursor [0] == '\t')
+				continue;  /* skip rule */
+			else
+				in_rule = FALSE;
 		}
-		else if (variable_possible && isIdentifier (c))
+		variable_possible = TRUE;
+
+		while ((c = nextChar ()) != '\n')
 		{
-			readIdentifier (c, name);
-			if (strcmp (vStringValue (name), "endef") == 0)
-				in_define = FALSE;
-			else if (in_define)
-				skipLine ();
-			else if (strcmp (vStringValue (name), "define") == 0  &&
-				isIdentifier (c))
+			if (isspace (c))
+				continue;
+			else if (c == '#')
+				break;  /* comment runs to the end of the logical line */
+			else if (c == '(')
+				skipToMatch ("()");
+			else if (c == '{')
+				skipToMatch ("{}");
+			else if (c == ':')
 			{
-				in_define = TRUE;
-				c = skipToNonWhite ();
-				readIdentifier (c, name);
-				makeSimpleTag (name, MakeKinds, K_MACRO);
-				skipLine ();
+				variable_possible = TRUE;
+				in_rule = TRUE;
 			}
-			else {
-				if (strcmp(vStringValue (name), "export") == 0 &&
+			else if (variable_possible && isIdentifier (c))
+			{
+				readIdentifier (c, name);
+				if (strcmp (vStringValue (name), "endef") == 0)
+					in_define = FALSE;
+				else if (in_define)
+					break;  /* skip body of definition */
+				else if (strcmp (vStringValue (name), "define") == 0  &&
 					isIdentifier (c))
 				{
+					in_define = TRUE;
 					c = skipToNonWhite ();
 					readIdentifier (c, name);
+					makeMacroTag (name);
+					break;
 				}
-				c = skipToNonWhite ();
-				if (strchr (":?+", c) != NULL)
-				{
-					boolean append = (boolean)(c == '+');
-					if (c == ':')
-						in_rule = TRUE;
-					c = nextChar ();
-					if (c != '=')
-						fileUngetc (c);
-					else if (append)
+				else {
+					if (strcmp(vStringValue (name), "export") == 0 &&
+						isIdentifier (c))
 					{
-						skipLine ();
-						continue;
+						c = skipToNonWhite ();
+						readIdentifier (c, name);
+					}
+					c = skipToNonWhite ();
+					if (strchr (":?+", c) != NULL)
+					{
+						boolean append = (boolean)(c == '+');
+						if (c == ':')
+							in_rule = TRUE;
+						c = nextChar ();
+						if (c != '=')
+							ungetChar (c);
+						else if (append)
+							break;
+					}
+					if (c == '=')
+					{
+						makeMacroTag (name);
+						in_rule = FALSE;
+						break;
 					}
-				}
-				if (c == '=')
-				{
-					makeSimpleTag (name, MakeKinds, K_MACRO);
-					in_rule = FALSE;
-					skipLine ();
 				}
 			}
+			else
+				variable_possible = FALSE;
 		}
-		else
-			variable_possible = FALSE;
 	}
+	vStringDelete (line);
 	vStringDelete (name);
 }
 
@@ -1,44 +1,153 @@
-/*
-*   $Id$
-*
-*   Copyright (c) 2008, David Fishburn
-*
-*   This source code is released for free distribution under the terms of the
-*   GNU General Public License.
-*
-*   This module contains functions for generating tags for MATLAB language files.
-*/
-
-/*
-*   INCLUDE FILES
-*/
-#include "general.h"  /* must always come first */
-
-#include <string.h>
-#include "parse.h"
-
-/*
-*   FUNCTION DEFINITIONS
-*/
-
-static void installMatLabRegex (const langType language)
-{
-    /* function [x,y,z] = asdf */
-    addTagRegex (language, "^function[ \t]*\\[.*\\][ \t]*=[ \t]*([a-zA-Z0-9_]+)", "\\1", "f,function", NULL);
-    /* function x = asdf */
-    addTagRegex (language, "^function[ \t]*[a-zA-Z0-9_]+[ \t]*=[ \t]*([a-zA-Z0-9_]+)", "\\1", "f,function", NULL);
-    /* function asdf */
-    addTagRegex (language, "^function[ \t]*([a-zA-Z0-9_]+)[^=]*$", "\\1", "f,function", NULL);
-}
-
-extern parserDefinition* MatLabParser ()
-{
-	static const char *const extensions [] = { "m", NULL };
-	parserDefinition* const def = parserNew ("MatLab");
-	def->extensions = extensions;
-	def->initialize = installMatLabRegex;
-	def->regex      = TRUE;
-	return def;
-}
-
-/* vi:set tabstop=4 shiftwidth=4: */
+/*
+*   $Id$
+*
+*   Copyright (c) 2008, David Fishburn
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for generating tags for MATLAB language files.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+#include <ctype.h>
+
+#include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_FUNCTION
+} matlabKind;
+
+static kindOption MatLabKinds [] = {
+	{ TRUE, 'f', "function", "function definitions" }
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static boolean isIdentChar (const int c)
+{
+	return (boolean) (isalnum (c)  ||  c == '_');
+}
+
+static const unsigned char *skipBlanks (const unsigned char *cp)
+{
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	return cp;
+}
+
+static const unsigned char *captureIdentifier (
+		const unsigned char *cp, vString *const name)
+{
+	vStringClear (name);
+	while (isIdentChar ((int) *cp))
+	{
+		vStringPut (name, (int) *cp);
+		++cp;
+	}
+	vStringTerminate (name);
+	return cp;
+}
+
+/*  Recognizes the three definition forms the old regex patterns covered:
+ *
+ *      function [out1, out2] = name (...)
+ *      function out = name (...)
+ *      function name (...)
+ *
+ *  The bracketed output list may contain anything up to the last ']' on the
+ *  line, and the third form only applies when no '=' follows the name.
+ */
+static void findMatLabTags (void)
+{
+	vString *const name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		const unsigned char *cp = line;
+
+		if (strncmp ((const char *) cp, "function", (size_t) 8) != 0)
+			continue;
+		cp = skipBlanks (cp + 8);
+
+		if (*cp == '[')
+		{
+			/*  Use the rightmost ']' which is followed by '=', matching
+			 *  what the greedy, backtracking pattern used to select.
+			 */
+			const char *close = strrchr ((const char *) cp, ']');
+			const unsigned char *after = NULL;
+
+			while (close != NULL  &&  close > (const char *) cp)
+			{
+				after = skipBlanks ((const unsigned char *) close + 1);
+				if (*after == '=')
+					break;
+				do
+					--close;
+				while (close > (const char *) cp  &&  *close != ']');
+				after = NULL;
+				if (*close != ']')
+					close = NULL;
+			}
+			if (close == NULL  ||  close <= (const char *) cp  ||
+				after == NULL)
+				continue;
+			cp = skipBlanks (after + 1);
+			captureIdentifier (cp, name);
+			if (vStringLength (name) > 0)
+				makeSimpleTag (name, MatLabKinds, K_FUNCTION);
+		}
+		else if (isIdentChar ((int) *cp))
+		{
+			cp = captureIdentifier (cp, name);
+			if (strchr ((const char *) cp, '=') == NULL)
+			{
+				/*  "function name ..." with no assignment anywhere after
+				 *  the name: the name itself is the function.
+				 */
+				makeSimpleTag (name, MatLabKinds, K_FUNCTION);
+			}
+			else
+			{
+				/*  "function out = name ...": the right-hand side carries
+				 *  the function name.
+				 */
+				cp = skipBlanks (cp);
+				if (*cp != '=')
+					continue;
+				cp = skipBlanks (cp + 1);
+				captureIdentifier (cp, name);
+				if (vStringLength (name) > 0)
+					makeSimpleTag (name, MatLabKinds, K_FUNCTION);
+			}
+		}
+	}
+	vStringDelete (name);
+}
+
+extern parserDefinition* MatLabParser (void)
+{
+	static const char *const extensions [] = { "m", NULL };
+	parserDefinition* const def = parserNew ("MatLab");
+	def->kinds      = MatLabKinds;
+	def->kindCount  = KIND_COUNT (MatLabKinds);
+	def->extensions = extensions;
+	def->parser     = findMatLabTags;
+	return def;
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
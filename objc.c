@@ -263,38 +263,36 @@ static void eatComment (lexingState * st)
 static void readIdentifier (lexingState * st)
 {
 	const unsigned char *p;
-	vStringClear (st->name);
+	const unsigned char *start = st->cp + 1;
 
 	/* first char is a simple letter */
 	if (isAlpha (*st->cp) || *st->cp == '_')
-		vStringPut (st->name, (int) *st->cp);
+		start = st->cp;
 
-	/* Go till you get identifier chars */
+	/* Go till you get identifier chars, then copy the whole span at once */
 	for (p = st->cp + 1; isIdent (*p); p++)
-		vStringPut (st->name, (int) *p);
+		;
 
+	vStringCopySpan (st->name, (const char *) start, (size_t) (p - start));
 	st->cp = p;
-
-	vStringTerminate (st->name);
 }
 
 /* read the @something directives */
 static void readIdentifierObjcDirective (lexingState * st)
 {
 	const unsigned char *p;
-	vStringClear (st->name);
+	const unsigned char *start = st->cp + 1;
 
-	/* first char is a simple letter */
+	/* first char is the marker */
 	if (*st->cp == '@')
-		vStringPut (st->name, (int) *st->cp);
+		start = st->cp;
 
-	/* Go till you get identifier chars */
+	/* Go till you get identifier chars, then copy the whole span at once */
 	for (p = st->cp + 1; isIdent (*p); p++)
-		vStringPut (st->name, (int) *p);
+		;
 
+	vStringCopySpan (st->name, (const char *) start, (size_t) (p - start));
 	st->cp = p;
-
-	vStringTerminate (st->name);
 }
 
 /* The lexer is in charge of reading the file.
@@ -432,16 +430,16 @@ typedef void (*parseNext) (vString * const ident, objcToken what);
 /********** Helpers */
 /* This variable hold the 'parser' which is going to
  * handle the next token */
-parseNext toDoNext;
+static parseNext toDoNext;
 
 /* Special variable used by parser eater to
  * determine which action to put after their
  * job is finished. */
-parseNext comeAfter;
+static parseNext comeAfter;
 
 /* Used by some parsers detecting certain token
  * to revert to previous parser. */
-parseNext fallback;
+static parseNext fallback;
 
 
 /********** Grammar */
@@ -487,7 +485,7 @@ static void addTag (vString * const ident, int kind)
 	makeTagEntry (&toCreate);
 }
 
-objcToken waitedToken, fallBackToken;
+static objcToken waitedToken, fallBackToken;
 
 /* Ignore everything till waitedToken and jump to comeAfter.
  * If the "end" keyword is encountered break, doesn't remember
@@ -1107,6 +1105,7 @@ static void findObjcTags (void)
 
 	st.name = vStringNew ();
 	st.cp = fileReadLine ();
+	parentType = K_INTERFACE;  /* do not carry scope over from the last file */
 	toDoNext = &globalScope;
 	tok = lex (&st);
 	while (tok != Tok_EOF)
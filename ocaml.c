@@ -343,19 +343,18 @@ static void eatComment (lexingState * st)
 static void readIdentifier (lexingState * st)
 {
 	const unsigned char *p;
-	vStringClear (st->name);
+	const unsigned char *start = st->cp + 1;
 
 	/* first char is a simple letter */
 	if (isAlpha (*st->cp) || *st->cp == '_')
-		vStringPut (st->name, (int) *st->cp);
+		start = st->cp;
 
-	/* Go till you get identifier chars */
+	/* Go till you get identifier chars, then copy the whole span at once */
 	for (p = st->cp + 1; isIdent (*p); p++)
-		vStringPut (st->name, (int) *p);
+		;
 
+	vStringCopySpan (st->name, (const char *) start, (size_t) (p - start));
 	st->cp = p;
-
-	vStringTerminate (st->name);
 }
 
 static ocamlKeyword eatNumber (lexingState * st)
@@ -372,15 +371,10 @@ static ocamlKeyword eatOperator (lexingState * st)
 	int count = 0;
 	const unsigned char *root = st->cp;
 
-	vStringClear (st->name);
-
 	while (isOperator[st->cp[count]])
-	{
-		vStringPut (st->name, st->cp[count]);
 		count++;
-	}
 
-	vStringTerminate (st->name);
+	vStringCopySpan (st->name, (const char *) root, (size_t) count);
 
 	st->cp += count;
 	if (count <= 1)
@@ -514,20 +508,20 @@ typedef void (*parseNext) (vString * const ident, ocaToken what);
 /********** Helpers */
 /* This variable hold the 'parser' which is going to
  * handle the next token */
-parseNext toDoNext;
+static parseNext toDoNext;
 
 /* Special variable used by parser eater to
  * determine which action to put after their
  * job is finished. */
-parseNext comeAfter;
+static parseNext comeAfter;
 
 /* If a token put an end to current delcaration/
  * statement */
-ocaToken terminatingToken;
+static ocaToken terminatingToken;
 
 /* Token to be searched by the different
  * parser eater. */
-ocaToken waitedToken;
+static ocaToken waitedToken;
 
 /* name of the last class, used for
  * context stacking. */
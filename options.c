@@ -23,7 +23,11 @@
 #if defined(HAVE_SCANDIR)
 #include <dirent.h>
 #endif
+#ifdef HAVE_FNMATCH_H
+# include <fnmatch.h>
+#endif
 
+#include "cache.h"
 #include "ctags.h"
 #include "debug.h"
 #include "main.h"
@@ -62,6 +66,19 @@
 # define RECURSE_SUPPORTED
 #endif
 
+#if defined (HAVE_FORK) && defined (HAVE_WAITPID)
+# define JOBS_SUPPORTED
+#endif
+
+#if defined (JOBS_SUPPORTED) && \
+	defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H)
+# define DAEMON_SUPPORTED
+#endif
+
+#if defined (HAVE_SYS_INOTIFY_H) && defined (HAVE_OPENDIR)
+# define WATCH_SUPPORTED
+#endif
+
 #define isCompoundOption(c)  (boolean) (strchr ("fohiILpDb", (c)) != NULL)
 
 /*
@@ -99,6 +116,8 @@ typedef const struct {
 static boolean NonOptionEncountered;
 static stringList *OptionFiles;
 static stringList* Excluded;
+static stringList* ExcludedLiteral;  /* compiled from Excluded */
+static stringList* ExcludedPattern;  /* compiled from Excluded */
 static boolean FilesRequired = TRUE;
 static boolean SkipConfiguration;
 
@@ -126,7 +145,6 @@ optionValues Option = {
 		FALSE,  /* -fields=S */
 		TRUE    /* -fields=t */
 	},
-	NULL,       /* -I */
 	FALSE,      /* -a */
 	FALSE,      /* -B */
 	FALSE,      /* -e */
@@ -136,24 +154,52 @@ optionValues Option = {
 	EX_MIX,     /* -n, --excmd */
 #endif
 	FALSE,      /* -R */
+	TRUE,       /* --prune-vcs */
 	SO_SORTED,  /* -u, --sort */
 	FALSE,      /* -V */
 	FALSE,      /* -x */
 	NULL,       /* -L */
+	NULL,       /* --stdin-filename */
 	NULL,       /* -o */
 	NULL,       /* -h */
 	NULL,		/* --config-filename */
 	NULL,       /* --etags-include */
 	DEFAULT_FILE_FORMAT,/* --format */
 	FALSE,      /* --if0 */
+	NULL,       /* --input-encoding */
 	FALSE,      /* --kind-long */
 	LANG_AUTO,  /* --lang */
 	TRUE,       /* --links */
 	FALSE,      /* --filter */
 	NULL,       /* --filter-terminator */
+	NULL,       /* --daemon */
+	FALSE,      /* --watch */
 	FALSE,      /* --tag-relative */
 	FALSE,      /* --totals */
+	FALSE,      /* --stats */
+	0,          /* --progress */
+	0,          /* --max-file-size */
+	0,          /* --max-line-length */
+	0,          /* --max-parse-time */
 	FALSE,      /* --line-directives */
+	1,          /* --jobs */
+	FALSE,      /* --incremental */
+	FALSE,      /* --journal */
+	FALSE,      /* --journal-compact */
+	NULL,       /* --cache-dir */
+	FALSE,      /* --dedup */
+	NULL,       /* --checkpoint */
+	FALSE,      /* --resume */
+	NULL,       /* --database */
+	NULL,       /* --delta */
+	FALSE,      /* --output-format=binary */
+	FALSE,      /* --compress */
+	FALSE,      /* --tag-index */
+	FALSE,      /* --unique */
+	FALSE,      /* --merge */
+	0,          /* --shard index */
+	0,          /* --shard count */
+	FALSE,      /* --split-output */
 #ifdef DEBUG
 	0, 0        /* -D, -b */
 #endif
@@ -201,8 +247,41 @@ static optionDescription LongOptionDescription [] = {
  {1,"  -x   Print a tabular cross reference file to standard output."},
  {1,"  --append=[yes|no]"},
  {1,"       Should tags should be appended to existing tag file [no]?"},
+ {1,"  --cache-dir=directory"},
+ {1,"       Store the tag records each file produces in 'directory' and replay"},
+ {1,"       them, instead of parsing, for files whose contents are unchanged."},
+ {1,"  --checkpoint=file"},
+ {1,"       Periodically record progress in 'file' so that an interrupted run"},
+ {1,"       can be continued with --resume."},
+ {1,"  --compress=[yes|no]"},
+#ifdef HAVE_ZLIB_H
+ {1,"       Write the tag records in compressed, indexed blocks [no]."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
  {1,"  --config-filename=fileName"},
  {1,"      Use 'fileName' instead of 'ctags' in option file names."},
+ {1,"  --daemon=socket"},
+#ifdef DAEMON_SUPPORTED
+ {1,"       Serve tag requests on the named unix socket, keeping parser state"},
+ {1,"       warm; each connection behaves as --filter (files in, tags out)."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
+ {1,"  --database=file"},
+#ifdef HAVE_SQLITE3_H
+ {1,"       Write the tags into the named SQLite database instead of a tag"},
+ {1,"       file, indexed by tag name and by source file."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
+ {1,"  --delta=file"},
+ {1,"       Diff the finished tag file against this older tag file and write"},
+ {1,"       the added and removed lines, prefixed \"+\" and \"-\", beside the"},
+ {1,"       output as <tagfile>.delta."},
+ {1,"  --dedup=[yes|no]"},
+ {1,"       Parse only the first of several files with identical contents and"},
+ {1,"       repeat its tag records for the other copies [no]."},
  {1,"  --etags-include=file"},
  {1,"      Include reference to 'file' in Emacs-style tag file (requires -e)."},
  {1,"  --exclude=pattern"},
@@ -236,6 +315,25 @@ static optionDescription LongOptionDescription [] = {
  {1,"       Print this option summary."},
  {1,"  --if0=[yes|no]"},
  {1,"       Should C code within #if 0 conditional branches be parsed [no]?"},
+ {1,"  --incremental=[yes|no]"},
+ {1,"       Reuse tags recorded for files unchanged since the last run [no]."},
+ {1,"  --input-encoding=encoding"},
+#ifdef HAVE_ICONV_H
+ {1,"       Convert source files from this encoding when no byte order mark"},
+ {1,"       identifies one [none]."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
+ {1,"  --jobs=number"},
+#ifdef JOBS_SUPPORTED
+ {1,"       Parse files using this many worker processes [1]."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
+ {1,"  --journal=[yes|no]"},
+ {1,"       Write updates of an existing tag file as journal segments [no]."},
+ {1,"  --journal-compact"},
+ {1,"       Merge the journal segments of the tag file into it and exit."},
  {1,"  --<LANG>-kinds=[+|-]kinds"},
  {1,"       Enable/disable tag kinds for language <LANG>."},
  {1,"  --langdef=name"},
@@ -260,8 +358,29 @@ static optionDescription LongOptionDescription [] = {
  {1,"       Output list of supported languages."},
  {1,"  --list-maps=[language|all]"},
  {1,"       Output list of language mappings."},
+ {1,"  --max-file-size=size"},
+ {1,"       Skip source files larger than this size, given in bytes or with"},
+ {1,"       a k, M or G suffix; 0 means no limit [0]."},
+ {1,"  --max-line-length=length"},
+ {1,"       Truncate source lines longer than this many bytes, given as for"},
+ {1,"       --max-file-size; 0 means no limit [0]."},
+ {1,"  --max-parse-time=seconds"},
+ {1,"       Cut short the parse of any single file after this many seconds,"},
+ {1,"       keeping the tags made so far; 0 means no limit [0]."},
+ {1,"  --merge=[yes|no]"},
+ {1,"       Treat the file arguments as sorted tag files (the shards of a"},
+ {1,"       distributed run) and merge them into the output file [no]."},
  {1,"  --options=file"},
  {1,"       Specify file from which command line options should be read."},
+ {1,"  --output-format=ctags|etags|xref|binary"},
+ {1,"       Select the output format [ctags]. The binary format streams"},
+ {1,"       length-prefixed records which consumers ingest without parsing."},
+ {1,"  --progress=[seconds]"},
+ {1,"       Report files and bytes processed with throughput every interval"},
+ {1,"       seconds, and on SIGUSR1 (0 turns the timer off) [10]."},
+ {1,"  --prune-vcs=[yes|no]"},
+ {1,"       Skip the metadata directories of version control systems (.git,"},
+ {1,"       .svn, CVS, etc.) when recursing [yes]."},
  {1,"  --recurse=[yes|no]"},
 #ifdef RECURSE_SUPPORTED
  {1,"       Recurse into directories supplied on command line [no]."},
@@ -272,16 +391,46 @@ static optionDescription LongOptionDescription [] = {
  {1,"  --regex-<LANG>=/line_pattern/name_pattern/[flags]"},
  {1,"       Define regular expression for locating tags in specific language."},
 #endif
+ {1,"  --resume=[yes|no]"},
+ {1,"       Continue an interrupted run from the state recorded by its"},
+ {1,"       --checkpoint file, skipping the files already completed [no]."},
+ {1,"  --shard=index/count"},
+ {1,"       Parse only the files a deterministic partition assigns to the"},
+ {1,"       given shard (1 <= index <= count), so that independent hosts can"},
+ {1,"       each produce one shard of a distributed run."},
  {0,"  --sort=[yes|no|foldcase]"},
  {0,"       Should tags be sorted (optionally ignoring case) [yes]?."},
+ {1,"  --split-output=by-language"},
+ {1,"       Also write each language's tags to a file of its own beside the"},
+ {1,"       combined tag file (e.g. tags-C), each sorted independently."},
+ {1,"  --stats=[yes|no]"},
+ {1,"       Print a per-language table of files, lines, bytes, tags,"},
+ {1,"       allocations and time at exit [no]."},
+ {1,"  --stdin-filename=file"},
+ {1,"       Name reported for source text read from standard input when \"-\""},
+ {1,"       is given as a file argument; its extension also selects the"},
+ {1,"       language unless one is forced [stdin]."},
+ {1,"  --tag-index=[yes|no]"},
+ {1,"       Write binary, trigram and per-file indexes beside the tag file to"},
+ {1,"       speed up name, substring and file-scoped lookups [no]."},
  {0,"  --tag-relative=[yes|no]"},
  {0,"       Should paths be relative to location of tag file [no; yes when -e]?"},
  {1,"  --totals=[yes|no]"},
  {1,"       Print statistics about source and tag files [no]."},
+ {1,"  --unique=[yes|no]"},
+ {1,"       Drop tag lines duplicated within one source file as they are"},
+ {1,"       made, instead of leaving them for the output sort [no]."},
  {1,"  --verbose=[yes|no]"},
  {1,"       Enable verbose messages describing actions on each source file."},
  {1,"  --version"},
  {1,"       Print version identifier to standard output."},
+ {1,"  --watch=[yes|no]"},
+#ifdef WATCH_SUPPORTED
+ {1,"       After tagging, monitor the walked directories and re-parse only"},
+ {1,"       files that change, updating the tag file in place [no]."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
  {1, NULL}
 };
 
@@ -519,6 +668,294 @@ extern void checkOptions (void)
 		if (isDestinationStdout ())
 			error (FATAL, "%s tags to stdout", notice);
 	}
+#ifdef WATCH_SUPPORTED
+	if (Option.watch)
+	{
+		if (Option.filter  ||  Option.daemonSocket != NULL)
+		{
+			error (WARNING, "watch mode is not compatible with filter mode");
+			Option.watch = FALSE;
+		}
+		else if (isDestinationStdout ())
+		{
+			error (WARNING, "watch mode cannot update tags on stdout");
+			Option.watch = FALSE;
+		}
+		else
+		{
+			if (Option.jobs > 1)
+			{
+				/*  Directory watches must be registered by the process
+				 *  which stays alive, not by the worker children.
+				 */
+				error (WARNING, "watch mode disables parallel jobs");
+				Option.jobs = 1;
+			}
+			Option.incremental = TRUE;  /* re-parse only files that change */
+		}
+	}
+#else
+	if (Option.watch)
+	{
+		error (WARNING, "watch mode not supported on this platform");
+		Option.watch = FALSE;
+	}
+#endif
+	if (Option.incremental)
+	{
+		notice = "incremental mode is not compatible with";
+		if (Option.etags  ||  Option.xref)
+		{
+			error (WARNING, "%s this output format", notice);
+			Option.incremental = FALSE;
+		}
+		else if (Option.append  ||  Option.tagRelative)
+		{
+			error (WARNING, "%s this option", notice);
+			Option.incremental = FALSE;
+		}
+	}
+#ifdef WATCH_SUPPORTED
+	if (Option.watch  &&  ! Option.incremental)
+		Option.watch = FALSE;  /* incremental mode was rejected above */
+#endif
+	if (Option.journal)
+	{
+		notice = "journal mode is not compatible with";
+		if (Option.etags  ||  Option.xref  ||  Option.binaryOutput  ||
+			Option.databaseFile != NULL)
+		{
+			error (WARNING, "%s this output format", notice);
+			Option.journal = FALSE;
+		}
+		else if (Option.append  ||  Option.incremental  ||  Option.merge  ||
+				 Option.resume  ||  Option.splitByLanguage  ||
+				 Option.compress  ||  Option.filter)
+		{
+			error (WARNING, "%s this option", notice);
+			Option.journal = FALSE;
+		}
+		else if (isDestinationStdout ())
+		{
+			error (WARNING, "%s tags to stdout", notice);
+			Option.journal = FALSE;
+		}
+		else if (Option.jobs > 1)
+		{
+			/*  The segment's replaced-file records are written by the
+			 *  process which owns the tag file, not by the workers.
+			 */
+			error (WARNING, "journal mode disables parallel jobs");
+			Option.jobs = 1;
+		}
+	}
+	if (Option.tagIndex  &&  (Option.etags  ||  Option.xref))
+	{
+		error (WARNING, "tag index is not compatible with this output format");
+		Option.tagIndex = FALSE;
+	}
+	if (Option.compress)
+	{
+#ifdef HAVE_ZLIB_H
+		notice = "compressed output is not compatible with";
+		if (Option.etags  ||  Option.xref)
+		{
+			error (WARNING, "%s this output format", notice);
+			Option.compress = FALSE;
+		}
+		else if (Option.append  ||  Option.incremental  ||  Option.filter  ||
+				 Option.daemonSocket != NULL)
+		{
+			error (WARNING, "%s this option", notice);
+			Option.compress = FALSE;
+		}
+		else if (isDestinationStdout ())
+		{
+			error (WARNING, "%s tags to stdout", notice);
+			Option.compress = FALSE;
+		}
+		else if (Option.tagIndex)
+		{
+			/*  The block index written into the tag file replaces it. */
+			error (WARNING, "compressed output disables the tag index");
+			Option.tagIndex = FALSE;
+		}
+#else
+		error (WARNING, "compressed output not supported on this platform");
+		Option.compress = FALSE;
+#endif
+	}
+	if (Option.databaseFile != NULL)
+	{
+#ifdef HAVE_SQLITE3_H
+		notice = "database output is not compatible with";
+		if (Option.etags  ||  Option.xref)
+		{
+			error (WARNING, "%s this output format", notice);
+			freeString (&Option.databaseFile);
+		}
+		else if (Option.filter  ||  Option.daemonSocket != NULL  ||
+				 Option.watch)
+		{
+			error (WARNING, "%s this option", notice);
+			freeString (&Option.databaseFile);
+		}
+		else
+		{
+			notice = "database output disables";
+			if (Option.jobs > 1)
+			{
+				error (WARNING, "%s parallel jobs", notice);
+				Option.jobs = 1;
+			}
+			if (Option.incremental)
+			{
+				error (WARNING, "%s incremental mode", notice);
+				Option.incremental = FALSE;
+			}
+			if (Option.checkpointFile != NULL  ||  Option.resume)
+			{
+				error (WARNING, "%s checkpointing", notice);
+				freeString (&Option.checkpointFile);
+				Option.resume = FALSE;
+			}
+			if (Option.cacheDir != NULL  ||  Option.dedup)
+			{
+				error (WARNING, "%s the parse cache", notice);
+				freeString (&Option.cacheDir);
+				Option.dedup = FALSE;
+			}
+			if (Option.compress)
+			{
+				error (WARNING, "%s compressed output", notice);
+				Option.compress = FALSE;
+			}
+			if (Option.tagIndex)
+			{
+				error (WARNING, "%s the tag index", notice);
+				Option.tagIndex = FALSE;
+			}
+		}
+#else
+		error (WARNING, "database output not supported on this platform");
+		freeString (&Option.databaseFile);
+#endif
+	}
+	if (Option.deltaFile != NULL)
+	{
+		notice = "delta output is not compatible with";
+		if (Option.etags  ||  Option.xref  ||  Option.binaryOutput  ||
+			Option.databaseFile != NULL)
+		{
+			error (WARNING, "%s this output format", notice);
+			freeString (&Option.deltaFile);
+		}
+		else if (Option.filter  ||  Option.splitByLanguage  ||
+				 Option.journal  ||  Option.compress)
+		{
+			error (WARNING, "%s this option", notice);
+			freeString (&Option.deltaFile);
+		}
+		else if (isDestinationStdout ())
+		{
+			error (WARNING, "%s tags to stdout", notice);
+			freeString (&Option.deltaFile);
+		}
+		else if (Option.sorted == SO_UNSORTED)
+		{
+			/*  The comparison is a linear merge of two sorted files. */
+			error (WARNING, "%s unsorted output", notice);
+			freeString (&Option.deltaFile);
+		}
+	}
+	if (Option.binaryOutput)
+	{
+		notice = "binary output is not compatible with";
+		if (Option.etags  ||  Option.xref)
+		{
+			error (WARNING, "%s this output format", notice);
+			Option.binaryOutput = FALSE;
+		}
+		else if (Option.append  ||  Option.filter  ||
+				 Option.daemonSocket != NULL  ||  Option.watch  ||
+				 Option.databaseFile != NULL)
+		{
+			error (WARNING, "%s this option", notice);
+			Option.binaryOutput = FALSE;
+		}
+		else
+		{
+			/*  Records stream out in parse order; consumers index them
+			 *  themselves, so sorting the stream would be wasted work.
+			 */
+			Option.sorted = SO_UNSORTED;
+			notice = "binary output disables";
+			if (Option.jobs > 1)
+			{
+				error (WARNING, "%s parallel jobs", notice);
+				Option.jobs = 1;
+			}
+			if (Option.incremental)
+			{
+				error (WARNING, "%s incremental mode", notice);
+				Option.incremental = FALSE;
+			}
+			if (Option.checkpointFile != NULL  ||  Option.resume)
+			{
+				error (WARNING, "%s checkpointing", notice);
+				freeString (&Option.checkpointFile);
+				Option.resume = FALSE;
+			}
+			if (Option.cacheDir != NULL  ||  Option.dedup)
+			{
+				error (WARNING, "%s the parse cache", notice);
+				freeString (&Option.cacheDir);
+				Option.dedup = FALSE;
+			}
+			if (Option.compress)
+			{
+				error (WARNING, "%s compressed output", notice);
+				Option.compress = FALSE;
+			}
+			if (Option.tagIndex)
+			{
+				error (WARNING, "%s the tag index", notice);
+				Option.tagIndex = FALSE;
+			}
+		}
+	}
+	if (Option.splitByLanguage)
+	{
+		notice = "split output is not compatible with";
+		if (Option.etags  ||  Option.xref  ||  Option.binaryOutput  ||
+			Option.databaseFile != NULL)
+		{
+			error (WARNING, "%s this output format", notice);
+			Option.splitByLanguage = FALSE;
+		}
+		else if (Option.filter  ||  Option.daemonSocket != NULL  ||
+				 Option.append  ||  Option.incremental  ||  Option.merge  ||
+				 Option.resume  ||  Option.shardCount != 0)
+		{
+			error (WARNING, "%s this option", notice);
+			Option.splitByLanguage = FALSE;
+		}
+		else if (isDestinationStdout ())
+		{
+			error (WARNING, "%s tags to stdout", notice);
+			Option.splitByLanguage = FALSE;
+		}
+		else if (Option.jobs > 1)
+		{
+			/*  The split streams live in this process; the shard files
+			 *  written by parallel workers would bypass them.
+			 */
+			error (WARNING, "split output disables parallel jobs");
+			Option.jobs = 1;
+		}
+	}
+	if (Option.daemonSocket != NULL  &&  ! Option.filter)
+		Option.filter = TRUE;  /* each daemon connection acts as a filter */
 	if (Option.filter)
 	{
 		notice = "filter mode";
@@ -527,6 +964,11 @@ extern void checkOptions (void)
 			error (WARNING, "%s disables totals", notice);
 			Option.printTotals = FALSE;
 		}
+		if (Option.incremental)
+		{
+			error (WARNING, "%s disables incremental mode", notice);
+			Option.incremental = FALSE;
+		}
 		if (Option.tagFileName != NULL)
 			error (WARNING, "%s ignores output tag file name", notice);
 	}
@@ -587,19 +1029,25 @@ static void parseShortOption (cookedArgs *const args)
 static void parseLongOption (cookedArgs *const args, const char *item)
 {
 	const char* const equal = strchr (item, '=');
+
+	/*  The option name is copied into a buffer owned by the cooked
+	 *  arguments and reused from option to option, so that cooking the
+	 *  thousands of options a generated configuration may contain does
+	 *  not perform an allocation for each of them.
+	 */
+	if (args->longItem == NULL)
+		args->longItem = vStringNew ();
 	if (equal == NULL)
 	{
-		args->item = eStrdup (item); /* FIXME: memory leak. */
+		vStringCopyS (args->longItem, item);
 		args->parameter = "";
 	}
 	else
 	{
-		const size_t length = equal - item;
-		args->item = xMalloc (length + 1, char); /* FIXME: memory leak. */
-		strncpy (args->item, item, length);
-		args->item [length] = '\0';
+		vStringNCopyS (args->longItem, item, (size_t) (equal - item));
 		args->parameter = equal + 1;
 	}
+	args->item = vStringValue (args->longItem);
 	Assert (args->item != NULL);
 	Assert (args->parameter != NULL);
 }
@@ -622,7 +1070,7 @@ static void cArgRead (cookedArgs *const current)
 			Assert (current->item != NULL);
 			Assert (current->parameter != NULL);
 		}
-		else if (*item == '-')
+		else if (*item == '-'  &&  item [1] != '\0')
 		{
 			current->isOption = TRUE;
 			current->longOption = FALSE;
@@ -679,6 +1127,7 @@ extern void cArgDelete (cookedArgs* const current)
 {
 	Assert (current != NULL);
 	argDelete (current->args);
+	vStringDelete (current->longItem);  /* NULL is handled */
 	memset (current, 0, sizeof (cookedArgs));
 	eFree (current);
 }
@@ -752,6 +1201,13 @@ static void addExtensionList (
 	verbose ("      adding: ");
 	if (elist != NULL  &&  *elist != '\0')
 	{
+		const char *p;
+		unsigned int count = 1;
+
+		for (p = elist  ;  *p != '\0'  ;  ++p)
+			if (*p == EXTENSION_SEPARATOR)
+				++count;
+		stringListReserve (slist, stringListCount (slist) + count);
 		extension = extensionList;
 		if (elist [0] == EXTENSION_SEPARATOR)
 			++extension;
@@ -815,7 +1271,7 @@ extern boolean isIncludeFile (const char *const fileName)
  */
 
  static void processConfigFilenameOption (
- 		const char *const option __unused__, const char *const parameter)
+ 		const char *const option __ctags_unused__, const char *const parameter)
  {
  	freeString (&Option.configFilename);
  	Option.configFilename = stringCopy (parameter);
@@ -837,9 +1293,11 @@ static void processEtagsInclude (
 }
 
 static void processExcludeOption (
-		const char *const option __unused__, const char *const parameter)
+		const char *const option __ctags_unused__, const char *const parameter)
 {
 	const char *const fileName = parameter + 1;
+	freeList (&ExcludedLiteral);
+	freeList (&ExcludedPattern);
 	if (parameter [0] == '\0')
 		freeList (&Excluded);
 	else if (parameter [0] == '@')
@@ -863,15 +1321,64 @@ static void processExcludeOption (
 	}
 }
 
+/*  Partitions the exclude list once into literal names, which a binary
+ *  search covers in one lookup, and wildcard patterns, which still cost an
+ *  fnmatch () each; most entries on a typical exclude list are literals.
+ */
+static void compileExcludePatterns (void)
+{
+	unsigned int i;
+	ExcludedLiteral = stringListNew ();
+	ExcludedPattern = stringListNew ();
+	for (i = 0  ;  i < stringListCount (Excluded)  ;  ++i)
+	{
+		vString *const pattern = stringListItem (Excluded, i);
+#ifdef HAVE_FNMATCH
+		if (strpbrk (vStringValue (pattern), "*?[\\") != NULL)
+			stringListAdd (ExcludedPattern, vStringNewCopy (pattern));
+		else
+#endif
+			stringListAdd (ExcludedLiteral, vStringNewCopy (pattern));
+	}
+	stringListSort (ExcludedLiteral);
+}
+
+static boolean matchedExcludePattern (const char* const fileName)
+{
+	boolean result;
+#if defined (CASE_INSENSITIVE_FILENAMES) && ! defined (HAVE_FNMATCH)
+	result = stringListHasInsensitive (ExcludedLiteral, fileName);
+#else
+	result = stringListHasSorted (ExcludedLiteral, fileName);
+#endif
+#ifdef HAVE_FNMATCH
+	if (! result)
+	{
+		unsigned int i;
+		for (i = 0  ;  ! result  &&  i < stringListCount (ExcludedPattern)  ;  ++i)
+		{
+			const char *const pattern =
+					vStringValue (stringListItem (ExcludedPattern, i));
+			const size_t prefix = strcspn (pattern, "*?[\\");
+			if (strncmp (pattern, fileName, prefix) == 0)
+				result = (boolean) (fnmatch (pattern, fileName, 0) == 0);
+		}
+	}
+#endif
+	return result;
+}
+
 extern boolean isExcludedFile (const char* const name)
 {
 	const char* base = baseFilename (name);
 	boolean result = FALSE;
 	if (Excluded != NULL)
 	{
-		result = stringListFileMatched (Excluded, base);
+		if (ExcludedLiteral == NULL)
+			compileExcludePatterns ();
+		result = matchedExcludePattern (base);
 		if (! result  &&  name != base)
-			result = stringListFileMatched (Excluded, name);
+			result = matchedExcludePattern (name);
 	}
 #ifdef AMIGA
 	/* not a good solution, but the only one which works often */
@@ -973,13 +1480,107 @@ static void processFieldsOption (
 	}
 }
 
+static void processDaemonOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing socket path for \"%s\" option", option);
+#ifdef DAEMON_SUPPORTED
+	freeString (&Option.daemonSocket);
+	Option.daemonSocket = stringCopy (parameter);
+#else
+	error (WARNING, "daemon mode not supported on this platform");
+#endif
+}
+
+static void processCacheDirOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing directory for \"%s\" option", option);
+	freeString (&Option.cacheDir);
+	Option.cacheDir = stringCopy (parameter);
+}
+
+static void processCheckpointOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing file name for \"%s\" option", option);
+	freeString (&Option.checkpointFile);
+	Option.checkpointFile = stringCopy (parameter);
+}
+
+static void processDatabaseOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing file name for \"%s\" option", option);
+	freeString (&Option.databaseFile);
+	Option.databaseFile = stringCopy (parameter);
+}
+
+static void processDeltaOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing file name for \"%s\" option", option);
+	freeString (&Option.deltaFile);
+	Option.deltaFile = stringCopy (parameter);
+}
+
+static void processOutputFormatOption (
+		const char *const option, const char *const parameter)
+{
+	Option.binaryOutput = FALSE;
+	Option.etags = FALSE;
+	Option.xref = FALSE;
+	if (strcmp (parameter, "binary") == 0)
+		Option.binaryOutput = TRUE;
+	else if (strcmp (parameter, "etags") == 0)
+		Option.etags = TRUE;
+	else if (strcmp (parameter, "xref") == 0)
+		Option.xref = TRUE;
+	else if (strcmp (parameter, "ctags") != 0)
+		error (FATAL, "Invalid value for \"%s\" option", option);
+}
+
 static void processFilterTerminatorOption (
-		const char *const option __unused__, const char *const parameter)
+		const char *const option __ctags_unused__, const char *const parameter)
 {
 	freeString (&Option.filterTerminator);
 	Option.filterTerminator = stringCopy (parameter);
 }
 
+static void processInputEncodingOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing encoding name for \"%s\" option", option);
+#ifndef HAVE_ICONV_H
+	error (WARNING, "%s option not supported on this platform", option);
+#endif
+	freeString (&Option.inputEncoding);
+	Option.inputEncoding = stringCopy (parameter);
+}
+
+static void processJobsOption (
+		const char *const option, const char *const parameter)
+{
+	unsigned int jobs;
+
+	if (sscanf (parameter, "%u", &jobs) < 1  ||  jobs == 0)
+		error (FATAL, "Invalid value for \"%s\" option", option);
+#ifndef JOBS_SUPPORTED
+	if (jobs > 1)
+	{
+		error (WARNING, "parallel jobs not supported on this platform");
+		jobs = 1;
+	}
+#endif
+	Option.jobs = jobs;
+}
+
 static void processFormatOption (
 		const char *const option, const char *const parameter)
 {
@@ -1037,8 +1638,8 @@ static void printProgramIdentification (void)
 }
 
 static void processHelpOption (
-		const char *const option __unused__,
-		const char *const parameter __unused__)
+		const char *const option __ctags_unused__,
+		const char *const parameter __ctags_unused__)
 {
 	printProgramIdentification ();
 	putchar ('\n');
@@ -1246,8 +1847,8 @@ static void processLanguagesOption (
 }
 
 static void processLicenseOption (
-		const char *const option __unused__,
-		const char *const parameter __unused__)
+		const char *const option __ctags_unused__,
+		const char *const parameter __ctags_unused__)
 {
 	printProgramIdentification ();
 	puts ("");
@@ -1273,8 +1874,8 @@ static void processListKindsOption (
 }
 
 static void processListMapsOption (
-		const char *const __unused__ option,
-		const char *const __unused__ parameter)
+		const char *const __ctags_unused__ option,
+		const char *const __ctags_unused__ parameter)
 {
 	if (parameter [0] == '\0' || strcasecmp (parameter, "all") == 0)
 	    printLanguageMaps (LANG_AUTO);
@@ -1290,8 +1891,8 @@ static void processListMapsOption (
 }
 
 static void processListLanguagesOption (
-		const char *const option __unused__,
-		const char *const parameter __unused__)
+		const char *const option __ctags_unused__,
+		const char *const parameter __ctags_unused__)
 {
 	printLanguageList ();
 	exit (0);
@@ -1314,6 +1915,75 @@ static void processOptionFile (
 	}
 }
 
+/*  Parses a byte count with an optional k, M or G suffix.
+ */
+static unsigned long parseSizeParameter (
+		const char *const option, const char *const parameter)
+{
+	unsigned long size;
+	char suffix = '\0';
+
+	if (parameter == NULL  ||
+		sscanf (parameter, "%lu%c", &size, &suffix) < 1)
+		error (FATAL, "Invalid value for \"%s\" option", option);
+	switch (suffix)
+	{
+		case '\0':                                break;
+		case 'k':  size *= 1024UL;                break;
+		case 'M':  size *= 1024UL * 1024UL;       break;
+		case 'G':  size *= 1024UL * 1024UL * 1024UL;  break;
+		default:   error (FATAL, "Invalid value for \"%s\" option", option);
+	}
+	return size;
+}
+
+static void processMaxFileSizeOption (
+		const char *const option, const char *const parameter)
+{
+	Option.maxFileSize = parseSizeParameter (option, parameter);
+}
+
+static void processMaxLineLengthOption (
+		const char *const option, const char *const parameter)
+{
+	Option.maxLineLength = parseSizeParameter (option, parameter);
+}
+
+static void processMaxParseTimeOption (
+		const char *const option, const char *const parameter)
+{
+	unsigned int seconds;
+
+	if (parameter == NULL  ||  sscanf (parameter, "%u", &seconds) < 1)
+		error (FATAL, "Invalid value for \"%s\" option", option);
+	Option.maxParseTime = seconds;
+}
+
+static void processProgressOption (
+		const char *const option, const char *const parameter)
+{
+	unsigned int seconds;
+
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		Option.progressInterval = 10;
+	else if (sscanf (parameter, "%u", &seconds) < 1)
+		error (FATAL, "Invalid value for \"%s\" option", option);
+	else
+		Option.progressInterval = seconds;
+}
+
+static void processShardOption (
+		const char *const option, const char *const parameter)
+{
+	unsigned int index, count;
+
+	if (sscanf (parameter, "%u/%u", &index, &count) < 2  ||
+		index == 0  ||  count == 0  ||  index > count)
+		error (FATAL, "Invalid value for \"%s\" option", option);
+	Option.shardIndex = index;
+	Option.shardCount = count;
+}
+
 static void processSortOption (
 		const char *const option, const char *const parameter)
 {
@@ -1329,6 +1999,24 @@ static void processSortOption (
 		error (FATAL, "Invalid value for \"%s\" option", option);
 }
 
+static void processStdinFilenameOption (
+		const char *const option, const char *const parameter)
+{
+	if (parameter == NULL  ||  parameter [0] == '\0')
+		error (FATAL, "Missing file name for \"%s\" option", option);
+	freeString (&Option.stdinFileName);
+	Option.stdinFileName = stringCopy (parameter);
+}
+
+static void processSplitOutputOption (
+		const char *const option, const char *const parameter)
+{
+	if (strcmp (parameter, "by-language") == 0)
+		Option.splitByLanguage = TRUE;
+	else
+		error (FATAL, "Invalid value for \"%s\" option", option);
+}
+
 static void installHeaderListDefaults (void)
 {
 	Option.headerExt = stringListNewFromArgv (HeaderExtensions);
@@ -1369,6 +2057,85 @@ static void processHeaderListOption (const int option, const char *parameter)
  *  Token ignore processing
  */
 
+/*  The ignore list is consulted for every identifier the C parser reads,
+ *  so entries are kept in an open-addressed hash table keyed by the bare
+ *  token name rather than in a list scanned linearly.
+ */
+typedef struct sIgnoredToken {
+	char *name;           /* NULL when the slot is empty */
+	char *replacement;    /* text following '=', or NULL */
+	boolean ignoreParens; /* entry ended in '+' */
+} ignoredToken;
+
+#define IGNORE_TABLE_INITIAL_SIZE 256
+
+static ignoredToken *IgnoreTable = NULL;
+static unsigned int IgnoreTableSize = 0;   /* slot count; a power of two */
+static unsigned int IgnoreTableCount = 0;  /* number of occupied slots */
+
+static unsigned long ignoreHashValue (const char *const string)
+{
+	/* Mixes the string as the keyword hash does (TAOCP vol. 3 p. 512) */
+	unsigned long value = 0;
+	const unsigned char *p;
+	for (p = (const unsigned char *) string  ;  *p != '\0'  ;  ++p)
+	{
+		value <<= 1;
+		if (value & 0x00000100L)
+			value = (value & 0x000000ffL) + 1L;
+		value ^= *p;
+	}
+	value *= 40503L;
+	return value & 0x0000ffffL;
+}
+
+static ignoredToken *findIgnoreSlot (ignoredToken *const table,
+		const unsigned int size, const char *const name)
+{
+	const unsigned long mask = size - 1;
+	unsigned long slot = ignoreHashValue (name) & mask;
+
+	while (table [slot].name != NULL  &&
+		   strcmp (table [slot].name, name) != 0)
+		slot = (slot + 1) & mask;
+	return table + slot;
+}
+
+static void growIgnoreTable (void)
+{
+	const unsigned int newSize = (IgnoreTableSize == 0) ?
+			IGNORE_TABLE_INITIAL_SIZE : 2 * IgnoreTableSize;
+	ignoredToken *const newTable = xCalloc (newSize, ignoredToken);
+	unsigned int i;
+
+	for (i = 0  ;  i < IgnoreTableSize  ;  ++i)
+		if (IgnoreTable [i].name != NULL)
+			*findIgnoreSlot (newTable, newSize, IgnoreTable [i].name) =
+				IgnoreTable [i];
+	if (IgnoreTable != NULL)
+		eFree (IgnoreTable);
+	IgnoreTable = newTable;
+	IgnoreTableSize = newSize;
+}
+
+static void clearIgnoreList (void)
+{
+	unsigned int i;
+
+	for (i = 0  ;  i < IgnoreTableSize  ;  ++i)
+		if (IgnoreTable [i].name != NULL)
+		{
+			eFree (IgnoreTable [i].name);
+			if (IgnoreTable [i].replacement != NULL)
+				eFree (IgnoreTable [i].replacement);
+		}
+	if (IgnoreTable != NULL)
+		eFree (IgnoreTable);
+	IgnoreTable = NULL;
+	IgnoreTableSize = 0;
+	IgnoreTableCount = 0;
+}
+
 /*  Determines whether or not "name" should be ignored, per the ignore list.
  */
 extern boolean isIgnoreToken (
@@ -1377,53 +2144,68 @@ extern boolean isIgnoreToken (
 {
 	boolean result = FALSE;
 
-	if (Option.ignore != NULL)
+	if (pIgnoreParens != NULL)
+		*pIgnoreParens = FALSE;
+	if (IgnoreTableCount > 0)
 	{
-		const size_t nameLen = strlen (name);
-		unsigned int i;
-
-		if (pIgnoreParens != NULL)
-			*pIgnoreParens = FALSE;
+		const ignoredToken *const entry =
+				findIgnoreSlot (IgnoreTable, IgnoreTableSize, name);
 
-		for (i = 0  ;  i < stringListCount (Option.ignore)  ;  ++i)
+		if (entry->name != NULL)
 		{
-			vString *token = stringListItem (Option.ignore, i);
-
-			if (strncmp (vStringValue (token), name, nameLen) == 0)
+			if (entry->replacement != NULL)
 			{
-				const size_t tokenLen = vStringLength (token);
-
-				if (nameLen == tokenLen)
-				{
-					result = TRUE;
-					break;
-				}
-				else if (tokenLen == nameLen + 1  &&
-						vStringChar (token, tokenLen - 1) == '+')
-				{
-					result = TRUE;
-					if (pIgnoreParens != NULL)
-						*pIgnoreParens = TRUE;
-					break;
-				}
-				else if (vStringChar (token, nameLen) == '=')
-				{
-					if (replacement != NULL)
-						*replacement = vStringValue (token) + nameLen + 1;
-					break;
-				}
+				if (replacement != NULL)
+					*replacement = entry->replacement;
+			}
+			else
+			{
+				result = TRUE;
+				if (pIgnoreParens != NULL)
+					*pIgnoreParens = entry->ignoreParens;
 			}
 		}
 	}
 	return result;
 }
 
-static void saveIgnoreToken (vString *const ignoreToken)
+static void saveIgnoreToken (const char *const ignoreToken)
 {
-	if (Option.ignore == NULL)
-		Option.ignore = stringListNew ();
-	stringListAdd (Option.ignore, ignoreToken);
-	verbose ("    ignore token: %s\n", vStringValue (ignoreToken));
+	const char *const equal = strchr (ignoreToken, '=');
+	boolean ignoreParens = FALSE;
+	size_t nameLength;
+	ignoredToken *slot;
+	char *name;
+
+	nameLength = (equal != NULL) ? (size_t) (equal - ignoreToken)
+								 : strlen (ignoreToken);
+	if (equal == NULL  &&  nameLength > 0  &&
+		ignoreToken [nameLength - 1] == '+')
+	{
+		ignoreParens = TRUE;
+		--nameLength;
+	}
+	if (nameLength == 0)
+		return;
+
+	if (4 * (IgnoreTableCount + 1) > 3 * IgnoreTableSize)
+		growIgnoreTable ();
+
+	name = (char*) eMalloc (nameLength + 1);
+	strncpy (name, ignoreToken, nameLength);
+	name [nameLength] = '\0';
+
+	slot = findIgnoreSlot (IgnoreTable, IgnoreTableSize, name);
+	if (slot->name != NULL)
+		eFree (name);  /* the first entry for a token wins, as before */
+	else
+	{
+		slot->name = name;
+		slot->replacement = (equal != NULL) ? eStrdup (equal + 1) : NULL;
+		slot->ignoreParens = ignoreParens;
+		IgnoreTableCount++;
+	}
+	verbose ("    ignore token: %s\n", ignoreToken);
 }
 
 static void readIgnoreList (const char *const list)
@@ -1433,9 +2215,7 @@ static void readIgnoreList (const char *const list)
 
 	while (token != NULL)
 	{
-		vString *const entry = vStringNewInit (token);
-
-		saveIgnoreToken (entry);
+		saveIgnoreToken (token);
 		token = strtok (NULL, IGNORE_SEPARATORS);
 	}
 	eFree (newList);
@@ -1444,12 +2224,12 @@ static void readIgnoreList (const char *const list)
 static void addIgnoreListFromFile (const char *const fileName)
 {
 	stringList* tokens = stringListNewFromFile (fileName);
+	unsigned int i;
 	if (tokens == NULL)
 		error (FATAL | PERROR, "cannot open \"%s\"", fileName);
-	if (Option.ignore == NULL)
-		Option.ignore = tokens;
-	else
-		stringListCombine (Option.ignore, tokens);
+	for (i = 0  ;  i < stringListCount (tokens)  ;  ++i)
+		saveIgnoreToken (vStringValue (stringListItem (tokens, i)));
+	stringListDelete (tokens);
 }
 
 static void processIgnoreOption (const char *const list)
@@ -1465,7 +2245,7 @@ static void processIgnoreOption (const char *const list)
 #endif
 	else if (strcmp (list, "-") == 0)
 	{
-		freeList (&Option.ignore);
+		clearIgnoreList ();
 		verbose ("    clearing list\n");
 	}
 	else
@@ -1473,8 +2253,8 @@ static void processIgnoreOption (const char *const list)
 }
 
 static void processVersionOption (
-		const char *const option __unused__,
-		const char *const parameter __unused__)
+		const char *const option __ctags_unused__,
+		const char *const parameter __ctags_unused__)
 {
 	printProgramIdentification ();
 	exit (0);
@@ -1484,8 +2264,16 @@ static void processVersionOption (
  *  Option tables
  */
 
+/*  Kept in strcmp () order of the option names; the option processors
+ *  binary search this table.
+ */
 static parametricOption ParametricOptions [] = {
+	{ "cache-dir",              processCacheDirOption,          TRUE    },
+	{ "checkpoint",             processCheckpointOption,        TRUE    },
 	{ "config-filename",      	processConfigFilenameOption,  	TRUE    },
+	{ "daemon",                 processDaemonOption,            TRUE    },
+	{ "database",               processDatabaseOption,          TRUE    },
+	{ "delta",                  processDeltaOption,             TRUE    },
 	{ "etags-include",          processEtagsInclude,            FALSE   },
 	{ "exclude",                processExcludeOption,           FALSE   },
 	{ "excmd",                  processExcmdOption,             FALSE   },
@@ -1494,36 +2282,61 @@ static parametricOption ParametricOptions [] = {
 	{ "filter-terminator",      processFilterTerminatorOption,  TRUE    },
 	{ "format",                 processFormatOption,            TRUE    },
 	{ "help",                   processHelpOption,              TRUE    },
+	{ "input-encoding",         processInputEncodingOption,     TRUE    },
+	{ "jobs",                   processJobsOption,              TRUE    },
 	{ "lang",                   processLanguageForceOption,     FALSE   },
+	{ "langdef",                processLanguageDefineOption,    FALSE   },
+	{ "langmap",                processLanguageMapOption,       FALSE   },
 	{ "language",               processLanguageForceOption,     FALSE   },
 	{ "language-force",         processLanguageForceOption,     FALSE   },
 	{ "languages",              processLanguagesOption,         FALSE   },
-	{ "langdef",                processLanguageDefineOption,    FALSE   },
-	{ "langmap",                processLanguageMapOption,       FALSE   },
 	{ "license",                processLicenseOption,           TRUE    },
 	{ "list-kinds",             processListKindsOption,         TRUE    },
-	{ "list-maps",              processListMapsOption,          TRUE    },
 	{ "list-languages",         processListLanguagesOption,     TRUE    },
+	{ "list-maps",              processListMapsOption,          TRUE    },
+	{ "max-file-size",          processMaxFileSizeOption,       TRUE    },
+	{ "max-line-length",        processMaxLineLengthOption,     TRUE    },
+	{ "max-parse-time",         processMaxParseTimeOption,      TRUE    },
 	{ "options",                processOptionFile,              FALSE   },
+	{ "output-format",          processOutputFormatOption,      TRUE    },
+	{ "progress",               processProgressOption,          TRUE    },
+	{ "shard",                  processShardOption,             TRUE    },
 	{ "sort",                   processSortOption,              TRUE    },
+	{ "split-output",           processSplitOutputOption,       TRUE    },
+	{ "stdin-filename",         processStdinFilenameOption,     FALSE   },
 	{ "version",                processVersionOption,           TRUE    },
 };
 
+/*  Kept in strcmp () order of the option names; the option processors
+ *  binary search this table.
+ */
 static booleanOption BooleanOptions [] = {
 	{ "append",         &Option.append,                 TRUE    },
+	{ "compress",       &Option.compress,               TRUE    },
+	{ "dedup",          &Option.dedup,                  TRUE    },
 	{ "file-scope",     &Option.include.fileScope,      FALSE   },
 	{ "file-tags",      &Option.include.fileNames,      FALSE   },
 	{ "filter",         &Option.filter,                 TRUE    },
 	{ "if0",            &Option.if0,                    FALSE   },
+	{ "incremental",    &Option.incremental,            TRUE    },
+	{ "journal",        &Option.journal,                TRUE    },
+	{ "journal-compact",&Option.journalCompact,         TRUE    },
 	{ "kind-long",      &Option.kindLong,               TRUE    },
 	{ "line-directives",&Option.lineDirectives,         FALSE   },
 	{ "links",          &Option.followLinks,            FALSE   },
+	{ "merge",          &Option.merge,                  TRUE    },
+	{ "prune-vcs",      &Option.pruneVcs,               FALSE   },
 #ifdef RECURSE_SUPPORTED
 	{ "recurse",        &Option.recurse,                FALSE   },
 #endif
+	{ "resume",         &Option.resume,                 TRUE    },
+	{ "stats",          &Option.printStats,             TRUE    },
+	{ "tag-index",      &Option.tagIndex,               TRUE    },
 	{ "tag-relative",   &Option.tagRelative,            TRUE    },
 	{ "totals",         &Option.printTotals,            TRUE    },
+	{ "unique",         &Option.unique,                 TRUE    },
 	{ "verbose",        &Option.verbose,                FALSE   },
+	{ "watch",          &Option.watch,                  TRUE    },
 };
 
 /*
@@ -1539,20 +2352,26 @@ static void checkOptionOrder (const char* const option)
 static boolean processParametricOption (
 		const char *const option, const char *const parameter)
 {
-	const int count = sizeof (ParametricOptions) / sizeof (parametricOption);
+	int low = 0;
+	int high = (sizeof (ParametricOptions) / sizeof (parametricOption)) - 1;
 	boolean found = FALSE;
-	int i;
 
-	for (i = 0  ;  i < count  &&  ! found  ;  ++i)
+	while (low <= high  &&  ! found)
 	{
-		parametricOption* const entry = &ParametricOptions [i];
-		if (strcmp (option, entry->name) == 0)
+		const int mid = (low + high) / 2;
+		parametricOption* const entry = &ParametricOptions [mid];
+		const int comparison = strcmp (option, entry->name);
+		if (comparison == 0)
 		{
 			found = TRUE;
 			if (entry->initOnly)
 				checkOptionOrder (option);
 			(entry->handler) (option, parameter);
 		}
+		else if (comparison < 0)
+			high = mid - 1;
+		else
+			low = mid + 1;
 	}
 	return found;
 }
@@ -1577,20 +2396,26 @@ static boolean getBooleanOption (
 static boolean processBooleanOption (
 		const char *const option, const char *const parameter)
 {
-	const int count = sizeof (BooleanOptions) / sizeof (booleanOption);
+	int low = 0;
+	int high = (sizeof (BooleanOptions) / sizeof (booleanOption)) - 1;
 	boolean found = FALSE;
-	int i;
 
-	for (i = 0  ;  i < count  &&  ! found  ;  ++i)
+	while (low <= high  &&  ! found)
 	{
-		booleanOption* const entry = &BooleanOptions [i];
-		if (strcmp (option, entry->name) == 0)
+		const int mid = (low + high) / 2;
+		booleanOption* const entry = &BooleanOptions [mid];
+		const int comparison = strcmp (option, entry->name);
+		if (comparison == 0)
 		{
 			found = TRUE;
 			if (entry->initOnly)
 				checkOptionOrder (option);
 			*entry->pValue = getBooleanOption (option, parameter);
 		}
+		else if (comparison < 0)
+			high = mid - 1;
+		else
+			low = mid + 1;
 	}
 	return found;
 }
@@ -1604,6 +2429,7 @@ static void processLongOption (
 	else
 		verbose ("  Option: --%s=%s\n", option, parameter);
 
+	cacheRecordOption (option, parameter);
 	if (processBooleanOption (option, parameter))
 		;
 	else if (processParametricOption (option, parameter))
@@ -1628,6 +2454,7 @@ static void processShortOption (
 	else
 		verbose ("  Option: -%s %s\n", option, parameter);
 
+	cacheRecordOption (option, parameter);
 	if (isCompoundOption (*option) && (parameter == NULL  ||  parameter [0] == '\0'))
 		error (FATAL, "Missing parameter for \"%s\" option", option);
 	else switch (*option)
@@ -1762,26 +2589,31 @@ static boolean parseFileOptions (const char* const fileName)
 {
 	boolean fileFound = FALSE;
 	const char* const format = "Considering option file %s: %s\n";
-	CheckFile = fileName;
-	if (stringListHasTest (OptionFiles, checkSameFile))
-		verbose (format, fileName, "already considered");
+	if (! doesFileExist (fileName))
+		verbose (format, fileName, "not found");
 	else
 	{
-		FILE* const fp = fopen (fileName, "r");
-		if (fp == NULL)
-			verbose (format, fileName, "not found");
+		CheckFile = fileName;
+		if (stringListHasTest (OptionFiles, checkSameFile))
+			verbose (format, fileName, "already considered");
 		else
 		{
-			cookedArgs* const args = cArgNewFromLineFile (fp);
-			vString* file = vStringNewInit (fileName);
-			stringListAdd (OptionFiles, file);
-			verbose (format, fileName, "reading...");
-			parseOptions (args);
-			if (NonOptionEncountered)
-				error (WARNING, "Ignoring non-option in %s\n", fileName);
-			cArgDelete (args);
-			fclose (fp);
-			fileFound = TRUE;
+			FILE* const fp = fopen (fileName, "r");
+			if (fp == NULL)
+				verbose (format, fileName, "not found");
+			else
+			{
+				cookedArgs* const args = cArgNewFromLineFile (fp);
+				vString* file = vStringNewInit (fileName);
+				stringListAdd (OptionFiles, file);
+				verbose (format, fileName, "reading...");
+				parseOptions (args);
+				if (NonOptionEncountered)
+					error (WARNING, "Ignoring non-option in %s\n", fileName);
+				cArgDelete (args);
+				fclose (fp);
+				fileFound = TRUE;
+			}
 		}
 	}
 	return fileFound;
@@ -1994,6 +2826,18 @@ extern void readOptionConfiguration (void)
 
 extern void initOptions (void)
 {
+#ifdef DEBUG
+	/*  The binary searched option tables silently miss entries that are
+	 *  out of order; verify the order when debugging is compiled in.
+	 */
+	unsigned int i;
+	for (i = 1  ;  i < sizeof (ParametricOptions) / sizeof (parametricOption)  ;  ++i)
+		Assert (strcmp (ParametricOptions [i-1].name,
+						ParametricOptions [i].name) < 0);
+	for (i = 1  ;  i < sizeof (BooleanOptions) / sizeof (booleanOption)  ;  ++i)
+		Assert (strcmp (BooleanOptions [i-1].name,
+						BooleanOptions [i].name) < 0);
+#endif
 	OptionFiles = stringListNew ();
 	verbose ("Setting option defaults\n");
 	installHeaderListDefaults ();
@@ -2027,10 +2871,19 @@ extern void freeOptionResources (void)
 {
 	freeString (&Option.tagFileName);
 	freeString (&Option.fileList);
+	freeString (&Option.stdinFileName);
 	freeString (&Option.filterTerminator);
+	freeString (&Option.daemonSocket);
+	freeString (&Option.cacheDir);
+	freeString (&Option.checkpointFile);
+	freeString (&Option.databaseFile);
+	freeString (&Option.deltaFile);
+	freeString (&Option.inputEncoding);
 
 	freeList (&Excluded);
-	freeList (&Option.ignore);
+	freeList (&ExcludedLiteral);
+	freeList (&ExcludedPattern);
+	clearIgnoreList ();
 	freeList (&Option.headerExt);
 	freeList (&Option.etagsInclude);
 	freeList (&OptionFiles);
@@ -39,6 +39,7 @@ typedef struct sCookedArgs {
 	/* private */
 	Arguments* args;
 	char *shortOptions;
+	vString* longItem;  /* reused buffer holding the current long option name */
 	char simple[2];
 	boolean isOption;
 	boolean longOption;
@@ -85,30 +86,57 @@ struct sExtFields {  /* extension field content control */
 typedef struct sOptionValues {
 	struct sInclude include;/* --extra  extra tag inclusion */
 	struct sExtFields extensionFields;/* --fields  extension field control */
-	stringList* ignore;     /* -I  name of file containing tokens to ignore */
 	boolean append;         /* -a  append to "tags" file */
 	boolean backward;       /* -B  regexp patterns search backwards */
 	boolean etags;          /* -e  output Emacs style tags file */
 	exCmd locate;           /* --excmd  EX command used to locate tag */
 	boolean recurse;        /* -R  recurse into directories */
+	boolean pruneVcs;       /* --prune-vcs  skip VCS metadata directories */
 	sortType sorted;        /* -u,--sort  sort tags */
 	boolean verbose;        /* -V  verbose */
 	boolean xref;           /* -x  generate xref output instead */
 	char *fileList;         /* -L  name of file containing names of files */
+	char* stdinFileName;    /* --stdin-filename  name reported for stdin text */
 	char *tagFileName;      /* -o  name of tags file */
 	stringList* headerExt;  /* -h  header extensions */
 	char* configFilename;   /* --config-filename  use instead of 'ctags' in option file names */
 	stringList* etagsInclude;/* --etags-include  list of TAGS files to include*/
 	unsigned int tagFileFormat;/* --format  tag file format (level) */
 	boolean if0;            /* --if0  examine code within "#if 0" branch */
+	char* inputEncoding;    /* --input-encoding  assumed source file encoding */
 	boolean kindLong;       /* --kind-long */
 	langType language;      /* --lang specified language override */
 	boolean followLinks;    /* --link  follow symbolic links? */
 	boolean filter;         /* --filter  behave as filter: files in, tags out */
 	char* filterTerminator; /* --filter-terminator  string to output */
+	char* daemonSocket;     /* --daemon  serve filter requests on this socket */
+	boolean watch;          /* --watch  monitor walked directories for changes */
 	boolean tagRelative;    /* --tag-relative file paths relative to tag file */
 	boolean printTotals;    /* --totals  print cumulative statistics */
+	boolean printStats;     /* --stats  print per-language statistics */
+	unsigned int progressInterval;/* --progress  seconds between progress reports */
+	unsigned long maxFileSize;  /* --max-file-size  skip source files larger than this */
+	unsigned long maxLineLength;/* --max-line-length  truncate longer source lines */
+	unsigned int maxParseTime;  /* --max-parse-time  per-file parse time budget */
 	boolean lineDirectives; /* --linedirectives  process #line directives */
+	unsigned int jobs;      /* --jobs  number of parallel parsing processes */
+	boolean incremental;    /* --incremental  reuse tags of unchanged files */
+	boolean journal;        /* --journal  write updates as journal segments */
+	boolean journalCompact; /* --journal-compact  merge segments into the tag file */
+	char* cacheDir;         /* --cache-dir  replay tag records of cached files */
+	boolean dedup;          /* --dedup  parse identical file contents only once */
+	char* checkpointFile;   /* --checkpoint  record traversal progress here */
+	boolean resume;         /* --resume  continue an interrupted run */
+	char* databaseFile;     /* --database  write tags into an SQLite database */
+	char* deltaFile;        /* --delta  previous tag file to diff against */
+	boolean binaryOutput;   /* --output-format=binary  length-prefixed records */
+	boolean compress;       /* --compress  write tag file in compressed blocks */
+	boolean tagIndex;       /* --tag-index  write binary index of tag file */
+	boolean unique;         /* --unique  drop tag lines duplicated in a file */
+	boolean merge;          /* --merge  combine sorted shard tag files */
+	unsigned int shardIndex;/* --shard  which shard of the partition to parse */
+	unsigned int shardCount;/* --shard  total shards in the partition */
+	boolean splitByLanguage;/* --split-output  one tag file per language */
 #ifdef DEBUG
 	long debugLevel;        /* -D  debugging output */
 	unsigned long breakLine;/* -b  source line at which to call lineBreak() */
@@ -16,7 +16,21 @@
 #include "general.h"  /* must always come first */
 
 #include <string.h>
+#include <ctype.h>    /* to define tolower () */
 
+/*  To time each parse for the --stats report.
+ */
+#ifdef HAVE_CLOCK
+# include <time.h>  /* to declare clock() */
+# define parseClock()  ((unsigned long) clock ())
+#else
+# define parseClock()  0UL
+#endif
+#ifndef CLOCKS_PER_SEC
+# define CLOCKS_PER_SEC  1000000
+#endif
+
+#include "cache.h"
 #include "debug.h"
 #include "entry.h"
 #include "main.h"
@@ -27,6 +41,14 @@
 #include "routines.h"
 #include "vstring.h"
 
+/*
+*   MACROS
+*/
+
+/*  Leading block examined when detecting the language from file content.
+ */
+#define SNIFF_BLOCK_SIZE  512
+
 /*
 *   DATA DEFINITIONS
 */
@@ -34,6 +56,53 @@ static parserDefinitionFunc* BuiltInParsers[] = { PARSER_LIST };
 static parserDefinition** LanguageTable = NULL;
 static unsigned int LanguageCount = 0;
 
+/*  A hash table over every extension in the current language maps, so that
+ *  mapping a file name to its language need not scan each parser's
+ *  extension list in turn. The table is rebuilt lazily after any change to
+ *  a language map (e.g. through --langmap). File name patterns may contain
+ *  wildcards and so cannot be hashed; they are still scanned directly, but
+ *  only for files whose extension is not mapped.
+ */
+#define EXTENSION_HASH_SIZE 128
+
+typedef struct sExtensionHashEntry {
+	struct sExtensionHashEntry *next;
+	char *extension;
+	langType language;
+} extensionHashEntry;
+
+static extensionHashEntry *ExtensionHash [EXTENSION_HASH_SIZE];
+static boolean ExtensionHashValid = FALSE;
+
+/*  Literal content markers deciding between languages which claim the same
+ *  file extension (".m" is Objective-C or MatLab, a ".h" header may belong
+ *  to Objective-C rather than C++, ".cmd" is a DOS batch file or a REXX
+ *  program).  The first marker found in the leading block of the file
+ *  selects its language; when none is found the usual map-order winner
+ *  stands.  Markers of a language which no longer claims the extension are
+ *  ignored, so a --langmap resolving the ambiguity also disables the probe.
+ */
+typedef struct sContentMarker {
+	const char *extension;
+	const char *language;
+	const char *marker;
+} contentMarker;
+
+static const contentMarker ContentMarkers [] = {
+	{ "m",   "ObjectiveC", "@interface"      },
+	{ "m",   "ObjectiveC", "@implementation" },
+	{ "m",   "ObjectiveC", "@protocol"       },
+	{ "m",   "ObjectiveC", "#import"         },
+	{ "m",   "MatLab",     "function"        },
+	{ "h",   "ObjectiveC", "@interface"      },
+	{ "h",   "ObjectiveC", "@protocol"       },
+	{ "h",   "ObjectiveC", "#import"         },
+	{ "cmd", "REXX",       "/*"              }
+};
+
+#define CONTENT_MARKER_COUNT \
+		(sizeof (ContentMarkers) / sizeof (ContentMarkers [0]))
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -92,19 +161,89 @@ extern langType getNamedLanguage (const char *const name)
 	return result;
 }
 
-static langType getExtensionLanguage (const char *const extension)
+static unsigned int hashExtension (const char *const extension)
+{
+	unsigned int value = 0;
+	const unsigned char *p;
+	for (p = (const unsigned char *) extension  ;  *p != '\0'  ;  ++p)
+#ifdef CASE_INSENSITIVE_FILENAMES
+		value = value * 37 + (unsigned char) tolower ((int) *p);
+#else
+		value = value * 37 + *p;
+#endif
+	return value % EXTENSION_HASH_SIZE;
+}
+
+static langType lookupExtensionHash (const char *const extension)
 {
 	langType result = LANG_IGNORE;
-	unsigned int i;
-	for (i = 0  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+	const extensionHashEntry *entry;
+	for (entry = ExtensionHash [hashExtension (extension)]  ;
+		 entry != NULL  &&  result == LANG_IGNORE  ;  entry = entry->next)
 	{
-		stringList* const exts = LanguageTable [i]->currentExtensions;
-		if (exts != NULL  &&  stringListExtensionMatched (exts, extension))
-			result = i;
+#ifdef CASE_INSENSITIVE_FILENAMES
+		if (strcasecmp (extension, entry->extension) == 0)
+#else
+		if (strcmp (extension, entry->extension) == 0)
+#endif
+			result = entry->language;
 	}
 	return result;
 }
 
+static void clearExtensionHash (void)
+{
+	unsigned int i;
+	for (i = 0  ;  i < EXTENSION_HASH_SIZE  ;  ++i)
+	{
+		while (ExtensionHash [i] != NULL)
+		{
+			extensionHashEntry *const entry = ExtensionHash [i];
+			ExtensionHash [i] = entry->next;
+			eFree (entry->extension);
+			eFree (entry);
+		}
+	}
+	ExtensionHashValid = FALSE;
+}
+
+static void buildExtensionHash (void)
+{
+	unsigned int i;
+	clearExtensionHash ();
+	for (i = 0  ;  i < LanguageCount  ;  ++i)
+	{
+		const stringList* const exts = LanguageTable [i]->currentExtensions;
+		unsigned int j;
+		for (j = 0  ;  exts != NULL  &&  j < stringListCount (exts)  ;  ++j)
+		{
+			const char *const ext = vStringValue (stringListItem (exts, j));
+
+			/*  The first language claiming an extension wins, exactly as
+			 *  in the linear scan this table replaces.
+			 */
+			if (lookupExtensionHash (ext) == LANG_IGNORE)
+			{
+				const unsigned int bucket = hashExtension (ext);
+				extensionHashEntry *const entry =
+										xMalloc (1, extensionHashEntry);
+				entry->extension = eStrdup (ext);
+				entry->language = (langType) i;
+				entry->next = ExtensionHash [bucket];
+				ExtensionHash [bucket] = entry;
+			}
+		}
+	}
+	ExtensionHashValid = TRUE;
+}
+
+static langType getExtensionLanguage (const char *const extension)
+{
+	if (! ExtensionHashValid)
+		buildExtensionHash ();
+	return lookupExtensionHash (extension);
+}
+
 static langType getPatternLanguage (const char *const fileName)
 {
 	langType result = LANG_IGNORE;
@@ -119,6 +258,82 @@ static langType getPatternLanguage (const char *const fileName)
 	return result;
 }
 
+static boolean languageClaimsExtension (
+		const langType language, const char *const extension)
+{
+	boolean result = FALSE;
+	if (language != LANG_IGNORE)
+	{
+		const stringList* const exts =
+								LanguageTable [language]->currentExtensions;
+		result = (boolean) (exts != NULL  &&
+							stringListExtensionMatched (exts, extension));
+	}
+	return result;
+}
+
+/*  Decides between the languages claiming the same extension by probing
+ *  the leading block of the file for the content markers above.  Map order
+ *  picks the default; a wrong pick there costs a full parse by the wrong
+ *  parser, while the probe costs one read of a block which is about to be
+ *  read again anyway and so is hot in the page cache.  The file is not
+ *  touched at all unless a language other than the mapped one contests the
+ *  extension.
+ */
+static langType disambiguateExtensionLanguage (
+		const char *const fileName, const char *const extension,
+		const langType mapped)
+{
+	langType result = mapped;
+	langType candidate [CONTENT_MARKER_COUNT];
+	boolean contested = FALSE;
+	unsigned int i;
+
+	for (i = 0  ;  i < CONTENT_MARKER_COUNT  ;  ++i)
+	{
+		candidate [i] = LANG_IGNORE;
+#ifdef CASE_INSENSITIVE_FILENAMES
+		if (strcasecmp (extension, ContentMarkers [i].extension) == 0)
+#else
+		if (strcmp (extension, ContentMarkers [i].extension) == 0)
+#endif
+		{
+			const langType language =
+							getNamedLanguage (ContentMarkers [i].language);
+			if (languageClaimsExtension (language, extension))
+			{
+				candidate [i] = language;
+				if (language != mapped)
+					contested = TRUE;
+			}
+		}
+	}
+	if (contested)
+	{
+		FILE* const fp = fopen (fileName, "r");
+		if (fp != NULL)
+		{
+			char block [SNIFF_BLOCK_SIZE + 1];
+			const size_t length = fread (block, 1, SNIFF_BLOCK_SIZE, fp);
+			fclose (fp);
+			block [length] = '\0';
+			for (i = 0  ;  i < CONTENT_MARKER_COUNT  ;  ++i)
+			{
+				if (candidate [i] != LANG_IGNORE  &&
+					strstr (block, ContentMarkers [i].marker) != NULL)
+				{
+					result = candidate [i];
+					break;
+				}
+			}
+			if (result != mapped)
+				verbose ("%s: content selects %s over %s\n", fileName,
+						 getLanguageName (result), getLanguageName (mapped));
+		}
+	}
+	return result;
+}
+
 #ifdef SYS_INTERPRETER
 
 /*  The name of the language interpreter, either directly or as the argument
@@ -140,26 +355,75 @@ static vString* determineInterpreter (const char* const cmd)
 	return interpreter;
 }
 
-static langType getInterpreterLanguage (const char *const fileName)
+/*  Looks for an emacs mode specification ("-*- c++ -*-" or
+ *  "-*- mode: python; ... -*-") within the sniffed block.
+ */
+static langType determineEmacsModeLanguage (const char *const block)
+{
+	langType result = LANG_IGNORE;
+	const char *start = strstr (block, "-*-");
+	if (start != NULL)
+	{
+		vString* const mode = vStringNew ();
+		start += 3;
+		while (isspace ((int) *start))
+			++start;
+		if (strncmp (start, "mode:", 5) == 0)
+		{
+			start += 5;
+			while (isspace ((int) *start))
+				++start;
+		}
+		while (*start != '\0'  &&  *start != ';'  &&
+			   ! isspace ((int) *start)  &&  strncmp (start, "-*-", 3) != 0)
+		{
+			vStringPut (mode, (int) *start);
+			++start;
+		}
+		vStringTerminate (mode);
+		if (vStringLength (mode) > 0)
+			result = getNamedLanguage (vStringValue (mode));
+		vStringDelete (mode);
+	}
+	return result;
+}
+
+/*  Determines the language from the leading block of the file: a "#!"
+ *  interpreter line or an emacs mode specification. The block is read with
+ *  one stdio call; the file contents are not otherwise touched here, since
+ *  fileOpen () maps or reads the whole file anyway and the block just read
+ *  is hot in the page cache by then.
+ */
+static langType sniffFileLanguage (const char *const fileName)
 {
 	langType result = LANG_IGNORE;
 	FILE* const fp = fopen (fileName, "r");
 	if (fp != NULL)
 	{
-		vString* const vLine = vStringNew ();
-		const char* const line = readLine (vLine, fp);
-		if (line != NULL  &&  line [0] == '#'  &&  line [1] == '!')
+		char block [SNIFF_BLOCK_SIZE + 1];
+		const size_t length = fread (block, 1, SNIFF_BLOCK_SIZE, fp);
+		fclose (fp);
+		block [length] = '\0';
+		if (block [0] == '#'  &&  block [1] == '!')
 		{
-			const char* const lastSlash = strrchr (line, '/');
-			const char *const cmd = lastSlash != NULL ? lastSlash+1 : line+2;
-			vString* const interpreter = determineInterpreter (cmd);
+			char *const eol = strchr (block, '\n');
+			const char *lastSlash, *cmd;
+			vString* interpreter;
+
+			if (eol != NULL)
+				*eol = '\0';
+			lastSlash = strrchr (block, '/');
+			cmd = lastSlash != NULL ? lastSlash + 1 : block + 2;
+			interpreter = determineInterpreter (cmd);
 			result = getExtensionLanguage (vStringValue (interpreter));
 			if (result == LANG_IGNORE)
 				result = getNamedLanguage (vStringValue (interpreter));
 			vStringDelete (interpreter);
+			if (eol != NULL)
+				*eol = '\n';
 		}
-		vStringDelete (vLine);
-		fclose (fp);
+		if (result == LANG_IGNORE)
+			result = determineEmacsModeLanguage (block);
 	}
 	return result;
 }
@@ -171,17 +435,37 @@ extern langType getFileLanguage (const char *const fileName)
 	langType language = Option.language;
 	if (language == LANG_AUTO)
 	{
-		language = getExtensionLanguage (fileExtension (fileName));
+		const timedPhase phase = beginPhase (PHASE_DETECT);
+
+		/*  A compression suffix hides the real name of the contents; the
+		 *  language is mapped from the file name with the suffix removed.
+		 */
+		const char *const suffix = fileCompressionSuffix (fileName);
+		vString *stripped = NULL;
+		const char *name = fileName;
+		if (suffix != NULL)
+		{
+			stripped = vStringNew ();
+			vStringNCopyS (stripped, fileName, (size_t) (suffix - fileName));
+			name = vStringValue (stripped);
+		}
+		language = getExtensionLanguage (fileExtension (name));
+		if (language != LANG_IGNORE  &&  suffix == NULL)
+			language = disambiguateExtensionLanguage (
+							fileName, fileExtension (name), language);
 		if (language == LANG_IGNORE)
-			language = getPatternLanguage (fileName);
+			language = getPatternLanguage (name);
 #ifdef SYS_INTERPRETER
-		if (language == LANG_IGNORE)
+		if (language == LANG_IGNORE  &&  suffix == NULL)
 		{
 			fileStatus *status = eStat (fileName);
 			if (status->isExecutable)
-				language = getInterpreterLanguage (fileName);
+				language = sniffFileLanguage (fileName);
 		}
 #endif
+		if (stripped != NULL)
+			vStringDelete (stripped);
+		beginPhase (phase);
 	}
 	return language;
 }
@@ -234,6 +518,7 @@ extern void installLanguageMapDefault (const langType language)
 	if (Option.verbose)
 		printLanguageMap (language);
 	verbose ("\n");
+	ExtensionHashValid = FALSE;
 }
 
 extern void installLanguageMapDefaults (void)
@@ -251,6 +536,7 @@ extern void clearLanguageMap (const langType language)
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	stringListClear (LanguageTable [language]->currentPatterns);
 	stringListClear (LanguageTable [language]->currentExtensions);
+	ExtensionHashValid = FALSE;
 }
 
 extern void addLanguagePatternMap (const langType language, const char* ptrn)
@@ -277,6 +563,8 @@ extern boolean removeLanguageExtensionMap (const char *const extension)
 			result = TRUE;
 		}
 	}
+	if (result)
+		ExtensionHashValid = FALSE;
 	return result;
 }
 
@@ -287,6 +575,7 @@ extern void addLanguageExtensionMap (
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	removeLanguageExtensionMap (extension);
 	stringListAdd (LanguageTable [language]->currentExtensions, str);
+	ExtensionHashValid = FALSE;
 }
 
 extern void enableLanguage (const langType language, const boolean state)
@@ -302,12 +591,21 @@ extern void enableLanguages (const boolean state)
 		enableLanguage (i, state);
 }
 
-static void initializeParsers (void)
+/*  Runs a parser's initialize hook the first time the language is needed
+ *  (keyword sets and built-in regex patterns are installed there), so runs
+ *  touching few languages skip the startup cost of all the others.
+ */
+extern void initializeParser (const langType language)
 {
-	unsigned int i;
-	for (i = 0  ;  i < LanguageCount  ;  ++i)
-		if (LanguageTable [i]->initialize != NULL)
-			(LanguageTable [i]->initialize) ((langType) i);
+	parserDefinition* lang;
+	Assert (0 <= language  &&  language < (int) LanguageCount);
+	lang = LanguageTable [language];
+	if (! lang->initialized)
+	{
+		lang->initialized = TRUE;
+		if (lang->initialize != NULL)
+			(lang->initialize) (language);
+	}
 }
 
 extern void initializeParsing (void)
@@ -350,7 +648,6 @@ extern void initializeParsing (void)
 	}
 	verbose ("\n");
 	enableLanguages (TRUE);
-	initializeParsers ();
 }
 
 extern void freeParserResources (void)
@@ -369,6 +666,7 @@ extern void freeParserResources (void)
 		eFree (LanguageTable);
 	LanguageTable = NULL;
 	LanguageCount = 0;
+	clearExtensionHash ();
 }
 
 /*
@@ -376,7 +674,7 @@ extern void freeParserResources (void)
 */
 
 extern void processLanguageDefineOption (
-		const char *const option, const char *const parameter __unused__)
+		const char *const option, const char *const parameter __ctags_unused__)
 {
 #ifdef HAVE_REGEX
 	if (parameter [0] == '\0')
@@ -457,6 +755,7 @@ static void processLangKindOption (
 	int c;
 
 	Assert (0 <= language  &&  language < (int) LanguageCount);
+	initializeParser (language);  /* built-in regex kinds must exist */
 	if (*p != '+'  &&  *p != '-')
 		disableLanguageKinds (language);
 	while ((c = *p++) != '\0') switch (c)
@@ -506,6 +805,7 @@ static void printKinds (langType language, boolean indent)
 {
 	const parserDefinition* lang;
 	Assert (0 <= language  &&  language < (int) LanguageCount);
+	initializeParser (language);  /* built-in regex kinds must exist */
 	lang = LanguageTable [language];
 	if (lang->kinds != NULL  ||  lang->regex)
 	{
@@ -605,6 +905,9 @@ static rescanReason createTagsForFile (
 {
 	rescanReason rescan = RESCAN_NONE;
 	Assert (0 <= language  &&  language < (int) LanguageCount);
+	initializeParser (language);
+	if (Option.unique)
+		clearDuplicateTagLines ();
 	if (fileOpen (fileName, language))
 	{
 		const parserDefinition* const lang = LanguageTable [language];
@@ -631,33 +934,154 @@ static boolean createTagsWithFallback (
 		const char *const fileName, const langType language)
 {
 	unsigned long numTags	= TagFile.numTags.added;
-	fpos_t tagFilePosition;
 	unsigned int passCount = 0;
 	boolean tagFileResized = FALSE;
 	rescanReason whyRescan;
 
-	fgetpos (TagFile.fp, &tagFilePosition);
+	markTagOutput ();
+	traceEvent (TRACE_PARSER_BEGIN, fileName, 0);
 	while ( ( whyRescan =
 	            createTagsForFile (fileName, language, ++passCount) )
 	                != RESCAN_NONE)
 	{
+		if (fileTimeBudgetExpired ())
+			break;  /* keep what the interrupted pass produced */
 		if (whyRescan == RESCAN_FAILED)
 		{
+			traceEvent (TRACE_SLOW_PATH, fileName, (unsigned long) passCount);
 			/*  Restore prior state of tag file.
 			*/
-			fsetpos (TagFile.fp, &tagFilePosition);
+			rewindTagOutput ();
 			TagFile.numTags.added = numTags;
+			cacheRewindCapture ();
 			tagFileResized = TRUE;
 		}
 		else if (whyRescan == RESCAN_APPEND)
 		{
-			fgetpos(TagFile.fp, &tagFilePosition);
+			markTagOutput ();
 			numTags = TagFile.numTags.added;
+			cacheMarkCapture ();
 		}
 	}
+	traceEvent (TRACE_PARSER_END, fileName, TagFile.numTags.added - numTags);
 	return tagFileResized;
 }
 
+/*  Attempts to parse only the portion of a changed file past the last
+ *  checkpoint of its previous parse still valid for its current content,
+ *  re-emitting the records captured up to that point and reading on from
+ *  the checkpoint line. Returns FALSE when no checkpoint survives or the
+ *  tail asks for another pass, in which case nothing has been written and
+ *  a full parse must follow.
+ */
+static boolean createTagsFromCheckpoint (
+		const char *const fileName, const langType language)
+{
+	boolean resumed = FALSE;
+	filePos offset;
+	unsigned long lineNumber;
+
+	initializeParser (language);
+	if (Option.unique)
+		clearDuplicateTagLines ();
+	if (fileOpen (fileName, language))
+	{
+		if (cacheRestartPoint (fileName, &offset, &lineNumber))
+		{
+			const parserDefinition* const lang = LanguageTable [language];
+			const unsigned long numTags = TagFile.numTags.added;
+			rescanReason rescan = RESCAN_NONE;
+
+			markTagOutput ();
+			cacheReplayPrefix ();
+			fileRestartAt (offset, lineNumber);
+			if (lang->parser != NULL)
+				lang->parser ();
+			else if (lang->parser2 != NULL)
+				rescan = lang->parser2 (1);
+			if (rescan == RESCAN_NONE)
+			{
+				verbose ("%s: resumed at line %lu from a parse checkpoint\n",
+						fileName, lineNumber);
+				resumed = TRUE;
+			}
+			else
+			{
+				/*  Restore prior state of tag file.
+				*/
+				rewindTagOutput ();
+				TagFile.numTags.added = numTags;
+				cacheRewindCapture ();
+			}
+		}
+		fileClose ();
+	}
+	return resumed;
+}
+
+/*
+*   Parser statistics (--stats)
+*/
+
+static struct {
+	unsigned long tags;
+	unsigned long allocations;
+	unsigned long ticks;
+} StatsCheckpoint;
+
+static void beginParserStatistics (void)
+{
+	StatsCheckpoint.tags = TagFile.numTags.added;
+	StatsCheckpoint.allocations = eAllocationCount ();
+	StatsCheckpoint.ticks = parseClock ();
+}
+
+static void endParserStatistics (
+		const langType language, const char *const fileName)
+{
+	parserStatistics *const stats = &LanguageTable [language]->stats;
+	fileStatus *status = eStat (fileName);
+
+	stats->ticks += parseClock () - StatsCheckpoint.ticks;
+	stats->files += 1;
+	if (status->exists)
+	{
+		/*  File.lineNumber is one-based and counts the final pass of any
+		 *  multi-pass parse; only that pass's figure is charged here.  It
+		 *  is zero when the file was never opened (unreadable, or refused
+		 *  by --max-file-size).
+		 */
+		if (File.lineNumber > 0)
+			stats->lines += File.lineNumber - 1L;
+		stats->bytes += status->size;
+	}
+	eStatFree (status);
+	stats->tags += TagFile.numTags.added - StatsCheckpoint.tags;
+	stats->allocations += eAllocationCount () - StatsCheckpoint.allocations;
+}
+
+extern void printParserStatistics (void)
+{
+	unsigned int i;
+
+	fprintf (errout, "%-12s %6s %10s %12s %8s %12s %8s\n",
+			"LANGUAGE", "FILES", "LINES", "BYTES", "TAGS",
+			"ALLOCATIONS", "SECONDS");
+	for (i = 0  ;  i < LanguageCount  ;  ++i)
+	{
+		const parserStatistics *const stats = &LanguageTable [i]->stats;
+
+		if (stats->files > 0)
+			fprintf (errout, "%-12s %6lu %10lu %12lu %8lu %12lu %8.2f\n",
+					LanguageTable [i]->name, stats->files, stats->lines,
+					stats->bytes, stats->tags, stats->allocations,
+					(double) stats->ticks / (double) CLOCKS_PER_SEC);
+	}
+	fputc ('\n', errout);
+	printRegexStatistics ();
+	printReadStatistics ();
+}
+
 extern boolean parseFile (const char *const fileName)
 {
 	boolean tagFileResized = FALSE;
@@ -674,7 +1098,32 @@ extern boolean parseFile (const char *const fileName)
 		if (Option.filter)
 			openTagFile ();
 
-		tagFileResized = createTagsWithFallback (fileName, language);
+		selectSplitStream (getLanguageName (language));
+		if (cacheReplayTags (fileName, language))
+			;  /* cached records already appended */
+		else
+		{
+			const timedPhase phase = beginPhase (PHASE_PARSE);
+			cacheBeginCapture ();
+			if (Option.printStats)
+				beginParserStatistics ();
+			fileStartTimeBudget ();
+			if (! (cacheHasReparseState (fileName)  &&
+				   createTagsFromCheckpoint (fileName, language)))
+				tagFileResized = createTagsWithFallback (fileName, language);
+			if (fileEndTimeBudget ())
+			{
+				error (WARNING,
+					   "\"%s\" exceeded --max-parse-time; its tags may be incomplete",
+					   fileName);
+				cacheAbandonCapture ();
+			}
+			if (Option.printStats)
+				endParserStatistics (language, fileName);
+			cacheEndCapture ();
+			beginPhase (phase);
+		}
+		flushTagOutput ();
 
 		if (Option.filter)
 			closeTagFile (tagFileResized);
@@ -685,4 +1134,173 @@ extern boolean parseFile (const char *const fileName)
 	return tagFileResized;
 }
 
+/*  Parses one pass over source text held in memory, with the same
+ *  per-pass setup as createTagsForFile ().  The text is consumed as it
+ *  is read; rescanning parsers must be handed a fresh copy per pass.
+ */
+static rescanReason createTagsFromBuffer (
+		const char *const fileName, const langType language,
+		unsigned char *const buffer, const size_t size,
+		const unsigned int passCount)
+{
+	rescanReason rescan = RESCAN_NONE;
+	Assert (0 <= language  &&  language < (int) LanguageCount);
+	initializeParser (language);
+	if (Option.unique)
+		clearDuplicateTagLines ();
+	if (bufferOpen (fileName, language, buffer, size))
+	{
+		const parserDefinition* const lang = LanguageTable [language];
+		if (Option.etags)
+			beginEtagsFile ();
+
+		makeFileTag (fileName);
+
+		if (lang->parser != NULL)
+			lang->parser ();
+		else if (lang->parser2 != NULL)
+			rescan = lang->parser2 (passCount);
+
+		if (Option.etags)
+			endEtagsFile (getSourceFileTagPath ());
+
+		bufferClose ();
+	}
+
+	return rescan;
+}
+
+/*  Reads the whole of standard input and parses it as a source file named
+ *  by --stdin-filename, writing tags as for an ordinary file.  The
+ *  language follows from the reported name unless one is forced.  Invoked
+ *  by "-" given as a file argument, which spares editors the temporary
+ *  file otherwise needed to tag an unsaved buffer.
+ */
+extern boolean parseStandardInput (void)
+{
+	size_t allocated = 16 * 1024;
+	size_t size = 0;
+	size_t nread;
+	unsigned char *buffer = xMalloc (allocated, unsigned char);
+	const char *const fileName =
+			(Option.stdinFileName != NULL) ? Option.stdinFileName : "stdin";
+	const langType language = getFileLanguage (fileName);
+	boolean tagFileResized = FALSE;
+
+	while ((nread = fread (buffer + size, 1, allocated - size, stdin)) > 0)
+	{
+		size += nread;
+		if (size == allocated)
+		{
+			allocated *= 2;
+			buffer = xRealloc (buffer, allocated, unsigned char);
+		}
+	}
+
+	if (language == LANG_IGNORE)
+		error (WARNING,
+			   "cannot determine language of standard input; supply --language-force or a --stdin-filename with a mapped extension");
+	else if (! LanguageTable [language]->enabled)
+		verbose ("ignoring standard input (language disabled)\n");
+	else
+	{
+		const timedPhase phase = beginPhase (PHASE_PARSE);
+		const parserDefinition* const lang = LanguageTable [language];
+		unsigned char *scratch = NULL;
+		unsigned long numTags = TagFile.numTags.added;
+		unsigned int passCount = 0;
+		rescanReason whyRescan;
+
+		selectSplitStream (getLanguageName (language));
+		if (lang->parser2 != NULL  &&  size > 0)
+			scratch = xMalloc (size, unsigned char);
+		markTagOutput ();
+		do
+		{
+			unsigned char *text = buffer;
+
+			if (scratch != NULL)
+			{
+				memcpy (scratch, buffer, size);
+				text = scratch;
+			}
+			whyRescan = createTagsFromBuffer (fileName, language, text, size,
+											  ++passCount);
+			if (whyRescan == RESCAN_FAILED)
+			{
+				rewindTagOutput ();
+				TagFile.numTags.added = numTags;
+				tagFileResized = TRUE;
+			}
+			else if (whyRescan == RESCAN_APPEND)
+			{
+				markTagOutput ();
+				numTags = TagFile.numTags.added;
+			}
+		} while (whyRescan != RESCAN_NONE);
+		if (scratch != NULL)
+			eFree (scratch);
+		beginPhase (phase);
+		flushTagOutput ();
+		addTotals (1, 0L, 0L);
+	}
+	eFree (buffer);
+	return tagFileResized;
+}
+
+/*  Parses source text already held in memory, delivering each completed
+ *  tag to func instead of formatting it into the tag file.  The buffer
+ *  must be writable and comes back modified: line terminators within it
+ *  are overwritten in place as lines are handed out.  For the unusual
+ *  languages whose parsers may rescan their input, each pass works on a
+ *  private copy, since a pass consumes the text it reads.  fileName is
+ *  used for reporting and for the source file fields of the tags.
+ */
+extern boolean parseBuffer (const char *const fileName,
+							const langType language,
+							unsigned char *const buffer, const size_t size,
+							const tagEntryFunction func,
+							void *const clientData)
+{
+	boolean parsed = FALSE;
+
+	if (0 <= language  &&  language < (int) LanguageCount  &&
+		LanguageTable [language]->enabled)
+	{
+		const parserDefinition* const lang = LanguageTable [language];
+		unsigned char *scratch = NULL;
+		unsigned int passCount = 0;
+		rescanReason rescan;
+
+		if (lang->parser2 != NULL  &&  size > 0)
+			scratch = xMalloc (size, unsigned char);
+		initializeParser (language);
+		setTagEntryFunction (func, clientData);
+		do
+		{
+			unsigned char *text = buffer;
+
+			if (scratch != NULL)
+			{
+				memcpy (scratch, buffer, size);
+				text = scratch;
+			}
+			rescan = RESCAN_NONE;
+			if (! bufferOpen (fileName, language, text, size))
+				break;
+			parsed = TRUE;
+			makeFileTag (fileName);
+			if (lang->parser != NULL)
+				lang->parser ();
+			else if (lang->parser2 != NULL)
+				rescan = lang->parser2 (++passCount);
+			bufferClose ();
+		} while (rescan != RESCAN_NONE);
+		setTagEntryFunction (NULL, NULL);
+		if (scratch != NULL)
+			eFree (scratch);
+	}
+	return parsed;
+}
+
 /* vi:set tabstop=4 shiftwidth=4 nowrap: */
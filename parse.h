@@ -37,6 +37,13 @@ typedef enum {
 	RESCAN_APPEND  /* Scan succeeded, rescan */
 } rescanReason;
 
+/*  Delivers one tag made while parsing a caller-supplied buffer (see
+ *  parseBuffer ()); tagEntryInfo is declared in entry.h.
+ */
+struct sTagEntryInfo;
+typedef void (*tagEntryFunction) (const struct sTagEntryInfo *const tag,
+								  void *const clientData);
+
 typedef void (*createRegexTag) (const vString* const name);
 typedef void (*simpleParser) (void);
 typedef rescanReason (*rescanParser) (const unsigned int passCount);
@@ -49,6 +56,15 @@ typedef struct sKindOption {
 	const char* description;  /* displayed in --help output */
 } kindOption;
 
+typedef struct sParserStatistics {
+	unsigned long files;        /* number of source files parsed */
+	unsigned long lines;        /* number of source lines read */
+	unsigned long bytes;        /* number of source bytes read */
+	unsigned long tags;         /* number of tags emitted */
+	unsigned long allocations;  /* number of heap allocations made */
+	unsigned long ticks;        /* processor time spent, in clock ticks */
+} parserStatistics;
+
 typedef struct {
 	/* defined by parser */
 	char* name;                    /* name of language */
@@ -64,8 +80,10 @@ typedef struct {
 	/* used internally */
 	unsigned int id;               /* id assigned to language */
 	boolean enabled;               /* currently enabled? */
+	boolean initialized;           /* initialize routine already run? */
 	stringList* currentPatterns;   /* current list of file name patterns */
 	stringList* currentExtensions; /* current list of extensions */
+	parserStatistics stats;        /* accumulated when --stats is given */
 } parserDefinition;
 
 typedef parserDefinition* (parserDefinitionFunc) (void);
@@ -107,19 +125,24 @@ extern void printLanguageMaps (const langType language);
 extern void enableLanguages (const boolean state);
 extern void enableLanguage (const langType language, const boolean state);
 extern void initializeParsing (void);
+extern void initializeParser (const langType language);
 extern void freeParserResources (void);
 extern void processLanguageDefineOption (const char *const option, const char *const parameter);
 extern boolean processKindOption (const char *const option, const char *const parameter);
 extern void printKindOptions (void);
 extern void printLanguageKinds (const langType language);
 extern void printLanguageList (void);
+extern void printParserStatistics (void);
 extern boolean parseFile (const char *const fileName);
+extern boolean parseStandardInput (void);
+extern boolean parseBuffer (const char *const fileName, const langType language, unsigned char *const buffer, const size_t size, const tagEntryFunction func, void *const clientData);
 
 /* Regex interface */
 #ifdef HAVE_REGEX
 extern void findRegexTags (void);
 extern boolean matchRegex (const vString* const line, const langType language);
 #endif
+extern void suppressParallelMatching (void);
 extern boolean processRegexOption (const char *const option, const char *const parameter);
 extern void addLanguageRegex (const langType language, const char* const regex);
 extern void addTagRegex (const langType language, const char* const regex, const char* const name, const char* const kinds, const char* const flags);
@@ -127,6 +150,7 @@ extern void addCallbackRegex (const langType language, const char *const regex,
 extern void disableRegexKinds (const langType language);
 extern boolean enableRegexKind (const langType language, const int kind, const boolean mode);
 extern void printRegexKinds (const langType language, boolean indent);
+extern void printRegexStatistics (void);
 extern void freeRegexResources (void);
 extern void checkRegex (void);
 
@@ -41,6 +41,7 @@
 	LuaParser, \
 	MakefileParser, \
 	ObjcParser, \
+	MatLabParser, /* after Objc, which has first claim on ".m" */ \
 	OcamlParser, \
 	PascalParser, \
 	PerlParser, \
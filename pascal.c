@@ -128,12 +128,27 @@ static void findPascalTags (void)
 				dbp++;
 				incomment = FALSE;
 			}
+			else if (*dbp != '\0')
+			{
+				/* stride to the next possible comment closer */
+				const char *const close = strchr ((const char*) dbp,
+						(comment_char == '{') ? '}' : '*');
+				dbp = (close == NULL) ? dbp + strlen ((const char*) dbp)
+									  : (const unsigned char*) close;
+			}
 			continue;
 		}
 		else if (inquote)
 		{
 			if (c == '\'')
 				inquote = FALSE;
+			else if (*dbp != '\0')
+			{
+				/* stride to the closing quote */
+				const char *const close = strchr ((const char*) dbp, '\'');
+				dbp = (close == NULL) ? dbp + strlen ((const char*) dbp)
+									  : (const unsigned char*) close;
+			}
 			continue;
 		}
 		else switch (c)
@@ -248,6 +263,13 @@ static void findPascalTags (void)
 					}
 					break;
 			}
+			/* Nothing in this state reacts to the characters between here
+			 * and the next quote, comment, punctuation or keyword first
+			 * letter, so stride over them; statement bodies are most of the
+			 * bytes of an implementation section.
+			 */
+			if (!get_tagname)
+				dbp += strcspn ((const char*) dbp, "'{();cCdDpPfF");
 		}  /* while not eof */
 	}
 	vStringDelete (name);
@@ -172,7 +172,6 @@ static void findPerlTags (void)
 {
 	vString *name = vStringNew ();
 	vString *package = NULL;
-	boolean skipPodDoc = FALSE;
 	const unsigned char *line;
 
 	while ((line = fileReadLine ()) != NULL)
@@ -183,15 +182,17 @@ static void findPerlTags (void)
 		perlKind kind = K_NONE;
 		tagEntryInfo e;
 
-		if (skipPodDoc)
+		if (line [0] == '=')
 		{
-			if (strncmp ((const char*) line, "=cut", (size_t) 4) == 0)
-				skipPodDoc = FALSE;
-			continue;
-		}
-		else if (line [0] == '=')
-		{
-			skipPodDoc = isPodWord ((const char*)line + 1);
+			if (isPodWord ((const char*)line + 1))
+			{
+				/*  POD carries no tags, and some files carry a lot of it,
+				 *  so jump straight to the closing "=cut" line.
+				 */
+				line = fileSkipLinesUntilPrefix ("=cut");
+				if (line == NULL)
+					break;
+			}
 			continue;
 		}
 		else if (strcmp ((const char*) line, "__DATA__") == 0)
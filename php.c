@@ -221,7 +221,7 @@ typedef struct {
 	vString *		string;
 	vString *		scope;
 	unsigned long 	lineNumber;
-	fpos_t			filePosition;
+	filePos			filePosition;
 	int 			parentKind; /* -1 if none */
 } tokenInfo;
 
@@ -243,6 +243,7 @@ static void buildPhpKeywordHash (void)
 {
 	const size_t count = sizeof (PhpKeywordTable) / sizeof (PhpKeywordTable[0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_php);
 	for (i = 0; i < count ; i++)
 	{
 		const keywordDesc* const p = &PhpKeywordTable[i];
@@ -385,14 +386,33 @@ static void makeFunctionTag (const tokenInfo *const token,
 	}
 }
 
+/* The statement parsers create and destroy a token for nearly every
+ * declaration found, so spent tokens are kept for reuse rather than
+ * repeatedly allocated and freed. */
+#define TOKEN_POOL_SIZE 8
+
+static tokenInfo *TokenPool [TOKEN_POOL_SIZE];
+static unsigned int TokenPoolCount = 0;
+
 static tokenInfo *newToken (void)
 {
-	tokenInfo *const token = xMalloc (1, tokenInfo);
+	tokenInfo *token;
+
+	if (TokenPoolCount > 0)
+	{
+		token = TokenPool [--TokenPoolCount];
+		vStringClear (token->string);
+		vStringClear (token->scope);
+	}
+	else
+	{
+		token = xMalloc (1, tokenInfo);
+		token->string = vStringNew ();
+		token->scope  = vStringNew ();
+	}
 
 	token->type			= TOKEN_UNDEFINED;
 	token->keyword		= KEYWORD_NONE;
-	token->string		= vStringNew ();
-	token->scope		= vStringNew ();
 	token->lineNumber   = getSourceLineNumber ();
 	token->filePosition = getInputFilePosition ();
 	token->parentKind	= -1;
@@ -402,9 +422,14 @@ static tokenInfo *newToken (void)
 
 static void deleteToken (tokenInfo *const token)
 {
-	vStringDelete (token->string);
-	vStringDelete (token->scope);
-	eFree (token);
+	if (TokenPoolCount < TOKEN_POOL_SIZE)
+		TokenPool [TokenPoolCount++] = token;
+	else
+	{
+		vStringDelete (token->string);
+		vStringDelete (token->scope);
+		eFree (token);
+	}
 }
 
 static void copyToken (tokenInfo *const dest, const tokenInfo *const src,
@@ -497,17 +522,12 @@ static void addToScope (tokenInfo *const token, const vString *const extra)
 
 static boolean isIdentChar (const int c)
 {
-	return (isalnum (c) || c == '_' || c & 0x80);
+	return (charIsIdentifier (c) || c & 0x80);
 }
 
 static int skipToCharacter (const int c)
 {
-	int d;
-	do
-	{
-		d = fileGetc ();
-	} while (d != EOF  &&  d != c);
-	return d;
+	return fileSkipToCharacter (c);
 }
 
 static void parseString (vString *const string, const int delimiter)
@@ -666,7 +686,9 @@ static int findPhpStart (void)
 	int c;
 	do
 	{
-		if ((c = fileGetc ()) == '<' &&
+		/* racing to the next '<' with the line-buffered skip makes
+		 * crossing large HTML sections between PHP chunks cheap */
+		if ((c = fileSkipToCharacter ('<')) != EOF &&
 			(c = fileGetc ()) == '?' &&
 			/* don't enter PHP mode on "<?xml", yet still support short open tags (<?) */
 			(tolower ((c = fileGetc ())) != 'x' ||
@@ -0,0 +1,600 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains an asynchronous ingestion path for source files.
+*   Walking millions of small files is bound by per-file syscall latency:
+*   each file costs an open, a stat, the reads and a close taken one at a
+*   time. On Linux the io_uring interface can carry those requests in
+*   batches: callers announce the files they are about to parse, the module
+*   keeps a window of open/read chains in flight, and fileOpen () collects
+*   the finished contents with prefetchTake (), paying roughly one syscall
+*   for many files instead of several syscalls for each.
+*
+*   Everything here degrades to a no-op when io_uring is unavailable (old
+*   kernel, other platform, or a denied io_uring_setup ()), in which case
+*   prefetchTake () always misses and files are read as before.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#if defined (HAVE_LINUX_IO_URING_H) && defined (HAVE_UNISTD_H) && \
+	defined (HAVE_FCNTL_H) && defined (__GNUC__)
+# define URING_PREFETCH_SUPPORTED
+# include <fcntl.h>  /* to declare O_RDONLY and AT_FDCWD */
+# include <unistd.h>  /* to declare close() and syscall() */
+# include <sys/mman.h>  /* to declare mmap() */
+# include <sys/syscall.h>  /* to declare __NR_io_uring_setup */
+# include <linux/io_uring.h>
+#endif
+
+#include "options.h"
+#include "prefetch.h"
+#include "routines.h"
+
+#ifdef URING_PREFETCH_SUPPORTED
+
+/*
+*   MACROS
+*/
+
+/*  Number of submission queue entries of the ring; also bounds the number
+ *  of open/read chains kept in flight at once.
+ */
+#define PREFETCH_RING_ENTRIES 64
+
+/*  Announced names beyond the in-flight window wait in a list of at most
+ *  this many; announcements past the cap are simply dropped, and the
+ *  dropped files are read through the ordinary path. The waiting names
+ *  are cheap (the window bounds the descriptors and buffers), so the cap
+ *  serves only to keep a degenerate caller from hoarding memory.
+ */
+#define PREFETCH_PENDING_MAX 0x100000
+
+/*  First read of every file; small sources complete in a single request.
+ */
+#define PREFETCH_INITIAL_BUFFER 0x10000
+
+/*  The ring head and tail indexes are shared with the kernel; make the
+ *  ordering of our loads and stores around them explicit.
+ */
+#define memoryBarrier() __sync_synchronize ()
+
+/*
+*   DATA DECLARATIONS
+*/
+
+enum prefetchStage {
+	STAGE_OPENING,  /* waiting for the openat () completion */
+	STAGE_READING,  /* waiting for a read () completion */
+	STAGE_READY,    /* whole contents in the buffer */
+	STAGE_FAILED    /* open or read failed; fall back to the normal path */
+};
+
+typedef struct sPrefetchFile {
+	char *name;
+	int fd;
+	unsigned char *buffer;
+	size_t size;      /* bytes read so far */
+	size_t capacity;  /* bytes allocated for the buffer */
+	int stage;
+	struct sPrefetchFile *next;
+} prefetchFile;
+
+typedef struct sPendingName {
+	char *name;
+	struct sPendingName *next;
+} pendingName;
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/*  The mapped rings of the io_uring instance (see io_uring_setup (2)).
+ */
+static struct {
+	int fd;
+	unsigned entries;
+	unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+	unsigned *cqHead, *cqTail, *cqMask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sqRing, *cqRing;
+	size_t sqRingSize, cqRingSize, sqesSize;
+	unsigned queued;  /* filled entries not yet handed to the kernel */
+} Ring = { -1 };
+
+static boolean RingReady = FALSE;
+static boolean RingBroken = FALSE;  /* setup failed; do not try again */
+
+/*  The window of files in flight, oldest first.
+ */
+static prefetchFile *Window = NULL;
+static prefetchFile *WindowTail = NULL;
+static unsigned int WindowCount = 0;
+
+/*  Announced names waiting for room in the window, oldest first.
+ */
+static pendingName *Pending = NULL;
+static pendingName *PendingTail = NULL;
+static unsigned int PendingCount = 0;
+
+/*  How often collection found the contents ready versus fell back.
+ */
+static unsigned long ServedFiles = 0;
+static unsigned long MissedFiles = 0;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static int uringSetup (unsigned entries, struct io_uring_params *const params)
+{
+	return (int) syscall (__NR_io_uring_setup, entries, params);
+}
+
+static int uringEnter (unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+	return (int) syscall (__NR_io_uring_enter, Ring.fd, toSubmit,
+						  minComplete, flags, NULL, 0);
+}
+
+/*  Creates the ring and maps its queues on first use. A failure of any
+ *  step (typically io_uring_setup () on kernels or in sandboxes without
+ *  io_uring) permanently disables the module.
+ */
+static boolean ringInitialize (void)
+{
+	struct io_uring_params params;
+
+	if (RingReady)
+		return TRUE;
+	if (RingBroken)
+		return FALSE;
+	RingBroken = TRUE;  /* until everything below has succeeded */
+
+	memset (&params, 0, sizeof params);
+	Ring.fd = uringSetup (PREFETCH_RING_ENTRIES, &params);
+	if (Ring.fd < 0)
+		return FALSE;
+	Ring.entries = params.sq_entries;
+	Ring.sqRingSize = params.sq_off.array +
+			params.sq_entries * sizeof (unsigned);
+	Ring.cqRingSize = params.cq_off.cqes +
+			params.cq_entries * sizeof (struct io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		if (Ring.cqRingSize > Ring.sqRingSize)
+			Ring.sqRingSize = Ring.cqRingSize;
+		Ring.cqRingSize = 0;  /* shares the submission ring mapping */
+	}
+	Ring.sqRing = mmap (NULL, Ring.sqRingSize, PROT_READ | PROT_WRITE,
+						MAP_SHARED | MAP_POPULATE, Ring.fd,
+						IORING_OFF_SQ_RING);
+	if (Ring.sqRing == MAP_FAILED)
+	{
+		close (Ring.fd);
+		return FALSE;
+	}
+	if (Ring.cqRingSize == 0)
+		Ring.cqRing = Ring.sqRing;
+	else
+	{
+		Ring.cqRing = mmap (NULL, Ring.cqRingSize, PROT_READ | PROT_WRITE,
+							MAP_SHARED | MAP_POPULATE, Ring.fd,
+							IORING_OFF_CQ_RING);
+		if (Ring.cqRing == MAP_FAILED)
+		{
+			munmap (Ring.sqRing, Ring.sqRingSize);
+			close (Ring.fd);
+			return FALSE;
+		}
+	}
+	Ring.sqesSize = params.sq_entries * sizeof (struct io_uring_sqe);
+	Ring.sqes = (struct io_uring_sqe *) mmap (
+			NULL, Ring.sqesSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, Ring.fd, IORING_OFF_SQES);
+	if (Ring.sqes == (struct io_uring_sqe *) MAP_FAILED)
+	{
+		if (Ring.cqRing != Ring.sqRing)
+			munmap (Ring.cqRing, Ring.cqRingSize);
+		munmap (Ring.sqRing, Ring.sqRingSize);
+		close (Ring.fd);
+		return FALSE;
+	}
+	Ring.sqHead  = (unsigned *) ((char *) Ring.sqRing + params.sq_off.head);
+	Ring.sqTail  = (unsigned *) ((char *) Ring.sqRing + params.sq_off.tail);
+	Ring.sqMask  = (unsigned *) ((char *) Ring.sqRing +
+								 params.sq_off.ring_mask);
+	Ring.sqArray = (unsigned *) ((char *) Ring.sqRing + params.sq_off.array);
+	Ring.cqHead  = (unsigned *) ((char *) Ring.cqRing + params.cq_off.head);
+	Ring.cqTail  = (unsigned *) ((char *) Ring.cqRing + params.cq_off.tail);
+	Ring.cqMask  = (unsigned *) ((char *) Ring.cqRing +
+								 params.cq_off.ring_mask);
+	Ring.cqes = (struct io_uring_cqe *) ((char *) Ring.cqRing +
+										 params.cq_off.cqes);
+	Ring.queued = 0;
+	RingBroken = FALSE;
+	RingReady = TRUE;
+	verbose ("Prefetching source files through io_uring\n");
+	return TRUE;
+}
+
+/*  Hands the filled submission entries to the kernel, waiting for at
+ *  least minComplete completions.
+ */
+static void submitQueued (const unsigned minComplete)
+{
+	if (Ring.queued > 0  ||  minComplete > 0)
+	{
+		const int submitted = uringEnter (Ring.queued, minComplete,
+				minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+		if (submitted > 0)
+			Ring.queued -= (unsigned) submitted;
+	}
+}
+
+/*  Returns the next free submission entry, zeroed, making room first if
+ *  the submission queue is full.
+ */
+static struct io_uring_sqe *nextSubmission (void)
+{
+	unsigned tail, index;
+
+	memoryBarrier ();
+	if (*Ring.sqTail - *Ring.sqHead >= Ring.entries)
+		submitQueued (0);
+	tail = *Ring.sqTail;
+	index = tail & *Ring.sqMask;
+	memset (&Ring.sqes [index], 0, sizeof (struct io_uring_sqe));
+	Ring.sqArray [index] = index;
+	memoryBarrier ();
+	*Ring.sqTail = tail + 1;
+	Ring.queued++;
+	return &Ring.sqes [index];
+}
+
+static void queueOpen (prefetchFile *const entry)
+{
+	struct io_uring_sqe *const sqe = nextSubmission ();
+	sqe->opcode = IORING_OP_OPENAT;
+	sqe->fd = AT_FDCWD;
+	sqe->addr = (unsigned long) entry->name;
+	sqe->open_flags = O_RDONLY;
+	sqe->user_data = (unsigned long) entry;
+}
+
+static void queueRead (prefetchFile *const entry)
+{
+	struct io_uring_sqe *const sqe = nextSubmission ();
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = entry->fd;
+	sqe->addr = (unsigned long) (entry->buffer + entry->size);
+	sqe->len = (unsigned) (entry->capacity - entry->size);
+	sqe->off = (unsigned long) entry->size;
+	sqe->user_data = (unsigned long) entry;
+}
+
+static void queueClose (const int fd)
+{
+	struct io_uring_sqe *const sqe = nextSubmission ();
+	sqe->opcode = IORING_OP_CLOSE;
+	sqe->fd = fd;
+	sqe->user_data = 0;  /* completion requires no action */
+}
+
+/*  Moves waiting names into the window while there is room, queueing
+ *  their opens.
+ */
+static void fillWindow (void)
+{
+	while (Pending != NULL  &&  WindowCount < PREFETCH_RING_ENTRIES / 2)
+	{
+		pendingName *const waiting = Pending;
+		prefetchFile *const entry = xMalloc (1, prefetchFile);
+
+		Pending = waiting->next;
+		if (Pending == NULL)
+			PendingTail = NULL;
+		PendingCount--;
+
+		entry->name = waiting->name;
+		entry->fd = -1;
+		entry->buffer = NULL;
+		entry->size = 0;
+		entry->capacity = 0;
+		entry->stage = STAGE_OPENING;
+		entry->next = NULL;
+		if (WindowTail == NULL)
+			Window = entry;
+		else
+			WindowTail->next = entry;
+		WindowTail = entry;
+		WindowCount++;
+		eFree (waiting);
+		queueOpen (entry);
+	}
+}
+
+/*  Applies the available completions to their files: a finished open
+ *  starts the first read, a full read grows the buffer and reads on, and
+ *  a short read completes the file and queues the close of its
+ *  descriptor.
+ */
+static void processCompletions (void)
+{
+	unsigned head = *Ring.cqHead;
+
+	memoryBarrier ();
+	while (head != *Ring.cqTail)
+	{
+		const struct io_uring_cqe *const cqe =
+				&Ring.cqes [head & *Ring.cqMask];
+		prefetchFile *const entry = (prefetchFile *) (unsigned long)
+				cqe->user_data;
+		const int result = cqe->res;
+
+		if (entry != NULL)
+		{
+			if (entry->stage == STAGE_OPENING)
+			{
+				if (result < 0)
+					entry->stage = STAGE_FAILED;
+				else
+				{
+					entry->fd = result;
+					entry->stage = STAGE_READING;
+					entry->capacity = PREFETCH_INITIAL_BUFFER;
+					entry->buffer = xMalloc (entry->capacity, unsigned char);
+					queueRead (entry);
+				}
+			}
+			else if (entry->stage == STAGE_READING)
+			{
+				if (result < 0)
+				{
+					entry->stage = STAGE_FAILED;
+					queueClose (entry->fd);
+					entry->fd = -1;
+				}
+				else
+				{
+					entry->size += (size_t) result;
+					if (result > 0  &&  entry->size == entry->capacity  &&
+						(Option.maxFileSize == 0  ||
+						 entry->size <= (size_t) Option.maxFileSize))
+					{
+						/*  The file goes on; double the buffer and read
+						 *  the next piece.
+						 */
+						entry->capacity *= 2;
+						entry->buffer = xRealloc (
+								entry->buffer, entry->capacity,
+								unsigned char);
+						queueRead (entry);
+					}
+					else
+					{
+						entry->stage =
+								(Option.maxFileSize > 0  &&
+								 entry->size > (size_t) Option.maxFileSize)
+									? STAGE_FAILED : STAGE_READY;
+						queueClose (entry->fd);
+						entry->fd = -1;
+					}
+				}
+			}
+		}
+		++head;
+		memoryBarrier ();
+	}
+	memoryBarrier ();
+	*Ring.cqHead = head;
+}
+
+static void removeFromWindow (
+		prefetchFile *const entry, prefetchFile *const previous)
+{
+	if (previous == NULL)
+		Window = entry->next;
+	else
+		previous->next = entry->next;
+	if (WindowTail == entry)
+		WindowTail = previous;
+	WindowCount--;
+}
+
+static void deleteEntry (prefetchFile *const entry)
+{
+	if (entry->fd >= 0)
+		close (entry->fd);
+	if (entry->buffer != NULL)
+		eFree (entry->buffer);
+	eFree (entry->name);
+	eFree (entry);
+}
+
+/*  Releases everything without touching the ring queues; also the
+ *  after-fork cleanup, where the inherited ring is shared with the parent
+ *  and must not be manipulated (the mappings and descriptor of this
+ *  process alone go away).
+ */
+static void tearDown (void)
+{
+	while (Window != NULL)
+	{
+		prefetchFile *const entry = Window;
+		Window = entry->next;
+		deleteEntry (entry);
+	}
+	WindowTail = NULL;
+	WindowCount = 0;
+	while (Pending != NULL)
+	{
+		pendingName *const waiting = Pending;
+		Pending = waiting->next;
+		eFree (waiting->name);
+		eFree (waiting);
+	}
+	PendingTail = NULL;
+	PendingCount = 0;
+	if (RingReady)
+	{
+		munmap ((void *) Ring.sqes, Ring.sqesSize);
+		if (Ring.cqRing != Ring.sqRing)
+			munmap (Ring.cqRing, Ring.cqRingSize);
+		munmap (Ring.sqRing, Ring.sqRingSize);
+		close (Ring.fd);
+		Ring.fd = -1;
+		RingReady = FALSE;
+	}
+}
+
+#endif  /* URING_PREFETCH_SUPPORTED */
+
+/*
+*   EXTERNAL INTERFACE
+*/
+
+/*  Notes a file expected to be parsed soon, so that its contents can be
+ *  loaded ahead of time. Announcements are hints: they may be dropped,
+ *  and files never announced are simply read the ordinary way.
+ */
+extern void prefetchAnnounce (const char *const fileName)
+{
+#ifdef URING_PREFETCH_SUPPORTED
+	pendingName *waiting;
+
+	if (! ringInitialize ()  ||  PendingCount >= PREFETCH_PENDING_MAX)
+		return;
+	waiting = xMalloc (1, pendingName);
+	waiting->name = eStrdup (fileName);
+	waiting->next = NULL;
+	if (PendingTail == NULL)
+		Pending = waiting;
+	else
+		PendingTail->next = waiting;
+	PendingTail = waiting;
+	PendingCount++;
+	fillWindow ();
+#endif
+}
+
+/*  Starts the announced work; called once a batch of announcements (a
+ *  directory listing, a worker's assignment) is complete.
+ */
+extern void prefetchSubmit (void)
+{
+#ifdef URING_PREFETCH_SUPPORTED
+	if (RingReady)
+		submitQueued (0);
+#endif
+}
+
+/*  Collects the contents of an announced file, waiting for them if they
+ *  are still on their way. Returns an allocated buffer which the caller
+ *  owns (release with eFree ()), with the byte count in "size"; returns
+ *  NULL when the file was never announced or its prefetch failed, and the
+ *  caller reads the file itself.
+ */
+extern unsigned char *prefetchTake (
+		const char *const fileName, size_t *const size)
+{
+#ifdef URING_PREFETCH_SUPPORTED
+	prefetchFile *entry, *previous = NULL;
+	unsigned char *result = NULL;
+
+	if (! RingReady)
+		return NULL;
+	processCompletions ();
+	for (entry = Window  ;  entry != NULL  ;  entry = entry->next)
+	{
+		if (strcmp (entry->name, fileName) == 0)
+			break;
+		previous = entry;
+	}
+	if (entry == NULL)
+	{
+		MissedFiles++;
+		return NULL;
+	}
+
+	/*  Entries announced before this one and still here were passed over
+	 *  by their consumer (excluded or unrecognized after all); release
+	 *  the completed ones so they cannot clog the window.
+	 */
+	while (Window != entry  &&
+		   (Window->stage == STAGE_READY  ||  Window->stage == STAGE_FAILED))
+	{
+		prefetchFile *const stale = Window;
+		Window = stale->next;
+		WindowCount--;
+		deleteEntry (stale);
+	}
+	previous = NULL;
+	if (Window != entry)
+		for (previous = Window  ;  previous->next != entry  ;
+			 previous = previous->next)
+			;
+
+	while (entry->stage != STAGE_READY  &&  entry->stage != STAGE_FAILED)
+	{
+		submitQueued (1);
+		processCompletions ();
+	}
+	removeFromWindow (entry, previous);
+	if (entry->stage == STAGE_READY)
+	{
+		result = entry->buffer;
+		*size = entry->size;
+		entry->buffer = NULL;
+		ServedFiles++;
+	}
+	else
+		MissedFiles++;
+	deleteEntry (entry);
+
+	/*  The window has room again; keep the pipeline moving.
+	 */
+	fillWindow ();
+	submitQueued (0);
+	return result;
+#else
+	(void) fileName;
+	(void) size;
+	return NULL;
+#endif
+}
+
+/*  Disowns the ring inherited across a fork (): the child releases its
+ *  own references and starts from scratch should it prefetch itself,
+ *  leaving the queues, which are shared with the parent, untouched.
+ */
+extern void prefetchAbandon (void)
+{
+#ifdef URING_PREFETCH_SUPPORTED
+	tearDown ();
+	RingBroken = FALSE;  /* this process may create a ring of its own */
+#endif
+}
+
+extern void freePrefetchResources (void)
+{
+#ifdef URING_PREFETCH_SUPPORTED
+	if (ServedFiles > 0  ||  MissedFiles > 0)
+		verbose ("prefetch served %lu file(s), fell back for %lu\n",
+				ServedFiles, MissedFiles);
+	tearDown ();
+#endif
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
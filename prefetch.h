@@ -0,0 +1,32 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 1998-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to prefetch.c
+*/
+#ifndef _PREFETCH_H
+#define _PREFETCH_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>  /* to declare size_t */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void prefetchAnnounce (const char *const fileName);
+extern void prefetchSubmit (void);
+extern unsigned char *prefetchTake (const char *const fileName, size_t *const size);
+extern void prefetchAbandon (void);
+extern void freePrefetchResources (void);
+
+#endif  /* _PREFETCH_H */
+
+/* vi:set tabstop=4 shiftwidth=4: */
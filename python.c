@@ -135,7 +135,7 @@ static boolean isIdentifierCharacter (int c)
  * extract all relevant information and create a tag.
  */
 static void makeFunctionTag (vString *const function,
-	vString *const parent, int is_class_parent, const char *arglist __unused__)
+	vString *const parent, int is_class_parent, const char *arglist __ctags_unused__)
 {
 	tagEntryInfo tag;
 	initTagEntry (&tag, vStringValue (function));
@@ -235,31 +235,46 @@ static const char *skipString (const char *cp)
 	return cp;
 }
 
-/* Skip everything up to an identifier start. */
+/* Skip everything up to an identifier start. Dispatches on the current
+ * character so each byte is examined only once; the prefix checks find
+ * unicode, binary (Python 3) and raw strings.
+ */
 static const char *skipEverything (const char *cp)
 {
 	int match;
 	for (; *cp; cp++)
 	{
 		match = 0;
-		if (*cp == '"' || *cp == '\'' || *cp == '#')
-			match = 1;
-
-		/* these checks find unicode, binary (Python 3) and raw strings */
-		if (!match && (
-			!strncasecmp(cp, "u'", 2) || !strncasecmp(cp, "u\"", 2) ||
-			!strncasecmp(cp, "r'", 2) || !strncasecmp(cp, "r\"", 2) ||
-			!strncasecmp(cp, "b'", 2) || !strncasecmp(cp, "b\"", 2)))
-		{
-			match = 1;
-			cp += 1;
-		}
-		if (!match && (
-			!strncasecmp(cp, "ur'", 3) || !strncasecmp(cp, "ur\"", 3) ||
-			!strncasecmp(cp, "br'", 3) || !strncasecmp(cp, "br\"", 3)))
+		switch (tolower ((int) *cp))
 		{
-			match = 1;
-			cp += 2;
+			case '"':
+			case '\'':
+			case '#':
+				match = 1;
+				break;
+
+			case 'u':
+			case 'b':
+				if (cp [1] == '\'' || cp [1] == '"')
+				{
+					match = 1;
+					cp += 1;
+				}
+				else if (tolower ((int) cp [1]) == 'r' &&
+						 (cp [2] == '\'' || cp [2] == '"'))
+				{
+					match = 1;
+					cp += 2;
+				}
+				break;
+
+			case 'r':
+				if (cp [1] == '\'' || cp [1] == '"')
+				{
+					match = 1;
+					cp += 1;
+				}
+				break;
 		}
 		if (match)
 		{
@@ -285,8 +300,9 @@ static const char *findDefinitionOrClass (const char *cp)
 	while (*cp)
 	{
 		cp = skipEverything (cp);
-		if (!strncmp(cp, "def", 3) || !strncmp(cp, "class", 5) ||
-			!strncmp(cp, "cdef", 4) || !strncmp(cp, "cpdef", 5))
+		if ((*cp == 'd' && !strncmp(cp, "def", 3)) ||
+			(*cp == 'c' && (!strncmp(cp, "class", 5) ||
+				!strncmp(cp, "cdef", 4) || !strncmp(cp, "cpdef", 5))))
 		{
 			return cp;
 		}
@@ -349,6 +365,11 @@ static void parseImports (const char *cp)
 	const char *pos;
 	vString *name, *name_next;
 
+	/* Reject the overwhelmingly common case cheaply before scanning the
+	 * line in earnest. */
+	if (strstr (cp, "import") == NULL)
+		return;
+
 	cp = skipEverything (cp);
 
 	if ((pos = strstr (cp, "import")) == NULL)
@@ -388,11 +409,12 @@ static void parseImports (const char *cp)
 }
 
 /* modified from get.c getArglistFromStr().
- * warning: terminates rest of string past arglist!
  * note: does not ignore brackets inside strings! */
 static char *parseArglist(const char *buf)
 {
-	char *start, *end;
+	const char *start, *end;
+	size_t length;
+	char *result;
 	int level;
 	if (NULL == buf)
 		return NULL;
@@ -407,8 +429,11 @@ static char *parseArglist(const char *buf)
 		else if (')' == *end)
 			-- level;
 	}
-	*end = '\0';
-	return strdup(start);
+	length = end - start;
+	result = (char*) eMalloc (length + 1);
+	strncpy (result, start, length);
+	result [length] = '\0';
+	return result;
 }
 
 static void parseFunction (const char *cp, vString *const def,
@@ -563,6 +588,24 @@ static void find_triple_end(char const *string, char const **which)
 	}
 }
 
+/* Skip to the line closing the triple string pointed to by "which" without
+ * scanning the intervening lines; generated files embed multi-megabyte data
+ * blobs in docstrings, and striding over them with the buffered reader's
+ * string search moves at memory speed. The stopping line is handed to
+ * find_triple_end () so that trailing triple strings on it are chained
+ * exactly as when reading line by line.
+ */
+static void skip_to_triple_end(char const **which)
+{
+	while (*which)
+	{
+		char const *line = (char const *) fileSkipLinesUntilString (*which);
+		if (!line)
+			break;  /* string is never closed; end of file */
+		find_triple_end(line, which);
+	}
+}
+
 static const char *findVariable(const char *line)
 {
 	/* Parse global and class variable names (C.x) from assignment statements.
@@ -571,7 +614,7 @@ static const char *findVariable(const char *line)
 	 * TODO: ignore duplicate tags from reassignment statements. */
 	const char *cp, *sp, *eq, *start;
 
-	cp = strstr(line, "=");
+	cp = strchr(line, '=');
 	if (!cp)
 		return NULL;
 	eq = cp + 1;
@@ -667,7 +710,7 @@ static boolean varIsLambda (const char *cp, char **arglist)
 				vStringPut (args, ')');
 				vStringTerminate (args);
 				if (arglist)
-					*arglist = strdup (vStringValue (args));
+					*arglist = eStrdup (vStringValue (args));
 				vStringDelete (args);
 				is_lambda = TRUE;
 			}
@@ -693,6 +736,7 @@ static void findPythonTags (void)
 		const char *cp = line, *candidate;
 		char const *longstring;
 		char const *keyword, *variable;
+		const char *end;
 		int indent;
 
 		cp = skipSpace (cp);
@@ -704,26 +748,38 @@ static void findPythonTags (void)
 		if (*cp == '#' && !longStringLiteral)
 			continue;
 
-		/* Deal with line continuation. */
-		if (!line_skip) vStringClear(continuation);
-		vStringCatS(continuation, line);
-		vStringStripTrailing(continuation);
-		if (vStringLast(continuation) == '\\')
+		/* Deal with line continuation. The common case of a line which
+		 * neither continues another nor ends in a backslash is parsed in
+		 * place, without copying it into the continuation buffer. */
+		end = line + strlen (line);
+		while (end > line && isspace ((int) end [-1]))
+			--end;
+		if (end > line && end [-1] == '\\')
 		{
+			if (!line_skip) vStringClear(continuation);
+			vStringCatS(continuation, line);
+			vStringStripTrailing(continuation);
 			vStringChop(continuation);
 			vStringCatS(continuation, " ");
 			line_skip = 1;
 			continue;
 		}
-		cp = line = vStringValue(continuation);
-		cp = skipSpace (cp);
+		if (line_skip)
+		{
+			vStringCatS(continuation, line);
+			vStringStripTrailing(continuation);
+			cp = line = vStringValue(continuation);
+			cp = skipSpace (cp);
+			line_skip = 0;
+		}
 		indent = cp - line;
-		line_skip = 0;
 
 		/* Deal with multiline string ending. */
 		if (longStringLiteral)
 		{
 			find_triple_end(cp, &longStringLiteral);
+			if (longStringLiteral)
+				skip_to_triple_end(&longStringLiteral);
 			continue;
 		}
 		
@@ -735,6 +791,8 @@ static void findPythonTags (void)
 		{
 			longstring += 3;
 			find_triple_end(longstring, &longStringLiteral);
+			if (longStringLiteral)
+				skip_to_triple_end(&longStringLiteral);
 			/* We don't parse for any tags in the rest of the line. */
 			continue;
 		}
@@ -18,24 +18,375 @@
 #include <string.h>
 #include <ctype.h>
 
-#define FILE_WRITE
+#ifdef HAVE_MMAP
+# ifdef HAVE_SYS_TYPES_H
+#  include <sys/types.h>
+# endif
+# include <sys/mman.h>  /* to declare mmap() */
+#endif
+
+#ifdef HAVE_ZLIB_H
+# include <zlib.h>  /* to read gzip compressed source files */
+#endif
+
+#ifdef HAVE_POSIX_FADVISE
+# include <fcntl.h>  /* to declare posix_fadvise() */
+#endif
+
+#ifdef HAVE_ICONV_H
+# include <iconv.h>  /* to transcode source files (--input-encoding) */
+# include <errno.h>
+#endif
+
+#include <signal.h>  /* to arm the --max-parse-time watchdog */
+
 #include "read.h"
+#include "cache.h"
 #include "debug.h"
 #include "entry.h"
+#include "intern.h"
 #include "main.h"
+#include "prefetch.h"
 #include "routines.h"
 #include "options.h"
 
+/*
+*   MACROS
+*/
+
+/* A line buffer grown beyond this is released when its file is closed
+ * rather than kept for reuse; only generated or minified sources have
+ * lines that long, and carrying the buffer for the rest of the run
+ * would hold the full line size in memory. */
+#define LINE_BUFFER_RETAIN 0x10000
+
 /*
 *   DATA DEFINITIONS
 */
-inputFile File;  /* globally read through macros */
-static fpos_t StartOfLine;  /* holds deferred position of start of line */
+/*  The built-in input file state, in effect until a parser context is
+ *  activated.  All access goes through CurrentFile (as "File").
+ */
+static inputFile DefaultFile;
+
+inputFile *CurrentFile = &DefaultFile;
+/*  Byte offset of the most recent start of line within File.buffer. Line
+ *  positions are plain offset arithmetic on the in-memory buffer; no stdio
+ *  position call is involved, and any recorded position can later be read
+ *  back by readSourceLine () in constant time.
+ */
+static filePos StartOfLine;
+
+/*  Events recorded for the --max-file-size, --max-line-length and
+ *  --max-parse-time guards, reported with --stats.
+ */
+static struct {
+	unsigned long skippedFiles, truncatedLines, expiredParses;
+} GuardEvents = { 0, 0, 0 };
+
+/*  Per-file parse time budget (--max-parse-time). The alarm handler only
+ *  raises a flag; the line-fetch paths below turn the flag into an early
+ *  end of file, so the parse winds down at a line boundary and the tags
+ *  already made are kept.
+ */
+static volatile sig_atomic_t TimeBudgetExpired = 0;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
+/*
+ *   Input buffer access
+ *
+ *   The whole source file is held in File.buffer (memory-mapped where
+ *   mmap() is available, otherwise read into an allocated buffer), so
+ *   character input reduces to indexing the buffer and file positions
+ *   are plain byte offsets.
+ */
+
+/*  Makes the given input file state the one accessed through "File",
+ *  returning the previous one.  A NULL argument restores the built-in
+ *  default state.  Switching is only meaningful between files; the
+ *  position of the most recent line start is not part of the state.
+ */
+extern inputFile *setInputContext (inputFile *const context)
+{
+	inputFile *const previous = CurrentFile;
+
+	CurrentFile = (context != NULL) ? context : &DefaultFile;
+	return previous;
+}
+
+static int bufferGetc (void)
+{
+	if (File.offset >= File.bufferSize)
+		return EOF;
+	return File.buffer [File.offset++];
+}
+
+static void bufferUngetc (const int c)
+{
+	if (c != EOF  &&  File.offset > 0)
+		--File.offset;
+}
+
+static void freeInputBuffer (void)
+{
+	if (File.buffer != NULL)
+	{
+#ifdef HAVE_MMAP
+		if (File.bufferMapped)
+			munmap (File.buffer, File.bufferSize);
+		else
+#endif
+		if (! File.bufferBorrowed)
+			eFree (File.buffer);
+		File.buffer = NULL;
+	}
+	File.bufferSize = 0;
+	File.offset = 0;
+	File.bufferMapped = FALSE;
+	File.bufferBorrowed = FALSE;
+}
+
+#ifdef HAVE_ZLIB_H
+
+/*  Decompresses the whole of a gzip compressed file into an allocated
+ *  buffer, so that the rest of the input layer need not know the file was
+ *  compressed. The uncompressed size is not known in advance, so the buffer
+ *  grows by doubling.
+ */
+static boolean makeDecompressedBuffer (const char *const fileName)
+{
+	boolean ok = FALSE;
+	gzFile gz = gzopen (fileName, "rb");
+
+	freeInputBuffer ();
+	if (gz != NULL)
+	{
+		size_t allocated = 0x10000;
+		size_t used = 0;
+		unsigned char *buffer = xMalloc (allocated, unsigned char);
+		int count;
+
+		while ((count = gzread (gz, buffer + used,
+								(unsigned int) (allocated - used))) > 0)
+		{
+			used += count;
+			if (used == allocated)
+			{
+				allocated *= 2;
+				buffer = xRealloc (buffer, allocated, unsigned char);
+			}
+		}
+		if (count == 0)
+		{
+			int errnum = Z_OK;
+			(void) gzerror (gz, &errnum);
+			if (errnum == Z_OK  ||  errnum == Z_STREAM_END)
+			{
+				File.buffer = buffer;
+				File.bufferSize = used;
+				ok = TRUE;
+			}
+		}
+		if (! ok)
+			eFree (buffer);  /* the file is corrupt or truncated */
+		gzclose (gz);
+	}
+	return ok;
+}
+
+#endif
+
+#ifdef HAVE_ICONV_H
+
+/*  Converts the input buffer from the named encoding to UTF-8 through
+ *  iconv (), a block at a time, and installs the converted text as the
+ *  input buffer; `skip' bytes (a byte order mark) are dropped from the
+ *  front. The original buffer is kept if the conversion fails, so a
+ *  wrongly guessed encoding degrades to the old raw-byte behaviour
+ *  instead of losing the file.
+ */
+static void convertInputBuffer (
+		const char *const fileName, const char *const fromCode,
+		const size_t skip)
+{
+	const iconv_t cd = iconv_open ("UTF-8", fromCode);
+	char *in = (char *) File.buffer + skip;
+	size_t inLeft = File.bufferSize - skip;
+	size_t allocated = inLeft + inLeft / 2 + 4;
+	unsigned char *buffer;
+	char *out;
+	size_t outLeft;
+	boolean ok = TRUE;
+	boolean flushed = FALSE;
+
+	if (cd == (iconv_t) -1)
+	{
+		error (WARNING, "%s: unsupported source encoding \"%s\"",
+			   fileName, fromCode);
+		return;
+	}
+	buffer = xMalloc (allocated, unsigned char);
+	out = (char *) buffer;
+	outLeft = allocated;
+	while (ok  &&  ! flushed)
+	{
+		size_t result;
+		if (inLeft > 0)
+			result = iconv (cd, &in, &inLeft, &out, &outLeft);
+		else
+		{
+			/*  Flush any shift state pending at end of input.
+			 */
+			result = iconv (cd, NULL, NULL, &out, &outLeft);
+			flushed = (boolean) (result != (size_t) -1);
+		}
+		if (result == (size_t) -1)
+		{
+			if (errno == E2BIG)
+			{
+				const size_t used = allocated - outLeft;
+				allocated *= 2;
+				buffer = xRealloc (buffer, allocated, unsigned char);
+				out = (char *) buffer + used;
+				outLeft = allocated - used;
+			}
+			else
+			{
+				error (WARNING,
+					   "%s: invalid byte sequence for encoding \"%s\"",
+					   fileName, fromCode);
+				ok = FALSE;
+			}
+		}
+	}
+	iconv_close (cd);
+	if (ok)
+	{
+		const size_t used = allocated - outLeft;
+		freeInputBuffer ();
+		File.buffer = buffer;
+		File.bufferSize = used;
+	}
+	else
+		eFree (buffer);
+}
+
+#endif
+
+/*  Strips a UTF-8 byte order mark and, where iconv () is available,
+ *  converts UTF-16 files (recognized by their byte order mark) and files
+ *  in the encoding named by --input-encoding to UTF-8, so that parsers
+ *  always see byte-oriented text. Files already in a byte-oriented
+ *  encoding pass through untouched.
+ */
+static void transcodeInputBuffer (const char *const fileName)
+{
+	if (File.bufferSize >= 3  &&
+		File.buffer [0] == 0xef  &&  File.buffer [1] == 0xbb  &&
+		File.buffer [2] == 0xbf)
+		File.offset = 3;  /* skip the UTF-8 byte order mark */
+#ifdef HAVE_ICONV_H
+	else
+	{
+		const char *fromCode = NULL;
+		size_t skip = 0;
+		if (File.bufferSize >= 2  &&
+			File.buffer [0] == 0xff  &&  File.buffer [1] == 0xfe)
+		{
+			fromCode = "UTF-16LE";
+			skip = 2;
+		}
+		else if (File.bufferSize >= 2  &&
+				 File.buffer [0] == 0xfe  &&  File.buffer [1] == 0xff)
+		{
+			fromCode = "UTF-16BE";
+			skip = 2;
+		}
+		else
+			fromCode = Option.inputEncoding;
+		if (fromCode != NULL)
+			convertInputBuffer (fileName, fromCode, skip);
+	}
+#endif
+}
+
+/*  Makes the contents of the open file available as a contiguous buffer.
+ */
+static boolean makeInputBuffer (const char *const fileName)
+{
+	boolean ok = FALSE;
+	long size;
+
+#ifdef HAVE_ZLIB_H
+	if (fileCompressionSuffix (fileName) != NULL)
+	{
+		ok = makeDecompressedBuffer (fileName);
+		if (ok)
+			transcodeInputBuffer (fileName);
+		return ok;
+	}
+#endif
+	freeInputBuffer ();
+#ifdef HAVE_POSIX_FADVISE
+	/*  Each source file is read once from front to back and never
+	 *  revisited, so ask for aggressive readahead and mark the pages
+	 *  as first candidates for eviction.
+	 */
+	posix_fadvise (fileno (File.fp), 0, 0, POSIX_FADV_SEQUENTIAL);
+	posix_fadvise (fileno (File.fp), 0, 0, POSIX_FADV_NOREUSE);
+#endif
+	if (fseek (File.fp, 0L, SEEK_END) == 0  &&
+		(size = ftell (File.fp)) != -1L  &&
+		fseek (File.fp, 0L, SEEK_SET) == 0)
+	{
+		File.bufferSize = (size_t) size;
+		if (size == 0)
+			ok = TRUE;  /* empty file; all reads report end of file */
+		else
+		{
+#ifdef HAVE_MMAP
+			/*  The mapping is private and writable so that line terminators
+			 *  can be overwritten in place when handing out line slices;
+			 *  modified pages are copies and never reach the file.
+			 */
+			File.buffer = (unsigned char *) mmap (
+					NULL, File.bufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+					fileno (File.fp), 0);
+			if (File.buffer == (unsigned char *) MAP_FAILED)
+				File.buffer = NULL;
+			else
+			{
+				File.bufferMapped = TRUE;
+				ok = TRUE;
+#if defined (MADV_SEQUENTIAL) && defined (MADV_WILLNEED)
+				/*  Start asynchronous kernel readahead, so that the disk
+				 *  reads for the rest of the file overlap with parsing
+				 *  its beginning.
+				 */
+				madvise ((void *) File.buffer, File.bufferSize,
+						MADV_SEQUENTIAL);
+				madvise ((void *) File.buffer, File.bufferSize,
+						MADV_WILLNEED);
+#endif
+			}
+			if (! ok)
+#endif
+			{
+				File.buffer = xMalloc (File.bufferSize, unsigned char);
+				ok = (boolean) (fread (File.buffer, 1, File.bufferSize,
+									   File.fp) == File.bufferSize);
+				if (! ok)
+					freeInputBuffer ();
+			}
+		}
+	}
+	if (ok)
+		transcodeInputBuffer (fileName);
+	return ok;
+}
+
 extern void freeSourceFileResources (void)
 {
 	if (File.name != NULL)
@@ -44,8 +395,6 @@ extern void freeSourceFileResources (void)
 		vStringDelete (File.path);
 	if (File.source.name != NULL)
 		vStringDelete (File.source.name);
-	if (File.source.tagPath != NULL)
-		eFree (File.source.tagPath);
 	if (File.line != NULL)
 		vStringDelete (File.line);
 }
@@ -81,14 +430,21 @@ static void setSourceFileParameters (vString *const fileName)
 		vStringDelete (File.source.name);
 	File.source.name = fileName;
 
-	if (File.source.tagPath != NULL)
-		eFree (File.source.tagPath);
+	/*  The tag path is interned; a file visited again (incremental and watch
+	 *  modes rescan) finds its path already in the table.
+	 */
 	if (! Option.tagRelative || isAbsolutePath (vStringValue (fileName)))
-		File.source.tagPath = eStrdup (vStringValue (fileName));
+		File.source.tagPath = internString (vStringValue (fileName));
 	else
-		File.source.tagPath =
+	{
+		char *const relative =
 				relativeFilename (vStringValue (fileName), TagFile.directory);
 
+		File.source.tagPath = internString (relative);
+		eFree (relative);
+	}
+	recordReplacedSourceFile (File.source.tagPath);
+
 	if (vStringLength (fileName) > TagFile.max.file)
 		TagFile.max.file = vStringLength (fileName);
 
@@ -121,7 +477,7 @@ static int skipWhite (void)
 {
 	int c;
 	do
-		c = getc (File.fp);
+		c = bufferGetc ();
 	while (c == ' '  ||  c == '\t');
 	return c;
 }
@@ -133,9 +489,9 @@ static unsigned long readLineNumber (void)
 	while (c != EOF  &&  isdigit (c))
 	{
 		lNum = (lNum * 10) + (c - '0');
-		c = getc (File.fp);
+		c = bufferGetc ();
 	}
-	ungetc (c, File.fp);
+	bufferUngetc (c);
 	if (c != ' '  &&  c != '\t')
 		lNum = 0;
 
@@ -158,17 +514,17 @@ static vString *readFileName (void)
 
 	if (c == '"')
 	{
-		c = getc (File.fp);  /* skip double-quote */
+		c = bufferGetc ();  /* skip double-quote */
 		quoteDelimited = TRUE;
 	}
 	while (c != EOF  &&  c != '\n'  &&
 			(quoteDelimited ? (c != '"') : (c != ' '  &&  c != '\t')))
 	{
 		vStringPut (fileName, c);
-		c = getc (File.fp);
+		c = bufferGetc ();
 	}
 	if (c == '\n')
-		ungetc (c, File.fp);
+		bufferUngetc (c);
 	vStringPut (fileName, '\0');
 
 	return fileName;
@@ -182,13 +538,13 @@ static boolean parseLineDirective (void)
 
 	if (isdigit (c))
 	{
-		ungetc (c, File.fp);
+		bufferUngetc (c);
 		result = TRUE;
 	}
-	else if (c == 'l'  &&  getc (File.fp) == 'i'  &&
-			 getc (File.fp) == 'n'  &&  getc (File.fp) == 'e')
+	else if (c == 'l'  &&  bufferGetc () == 'i'  &&
+			 bufferGetc () == 'n'  &&  bufferGetc () == 'e')
 	{
-		c = getc (File.fp);
+		c = bufferGetc ();
 		if (c == ' '  ||  c == '\t')
 		{
 			DebugStatement ( lineStr = "line"; )
@@ -240,6 +596,72 @@ static boolean parseLineDirective (void)
  *   Source file I/O operations
  */
 
+#ifdef SIGALRM
+static void timeBudgetHandler (int signo __ctags_unused__)
+{
+	TimeBudgetExpired = 1;
+}
+#endif
+
+extern void fileStartTimeBudget (void)
+{
+#ifdef SIGALRM
+	if (Option.maxParseTime > 0)
+	{
+		TimeBudgetExpired = 0;
+		signal (SIGALRM, timeBudgetHandler);
+		alarm (Option.maxParseTime);
+	}
+#endif
+}
+
+/*  Disarms the watchdog, reporting whether it fired during the parse just
+ *  finished.
+ */
+extern boolean fileEndTimeBudget (void)
+{
+	boolean expired = FALSE;
+#ifdef SIGALRM
+	if (Option.maxParseTime > 0)
+	{
+		alarm (0);
+		expired = (boolean) (TimeBudgetExpired != 0);
+		if (expired)
+			GuardEvents.expiredParses++;
+		TimeBudgetExpired = 0;
+	}
+#endif
+	return expired;
+}
+
+extern boolean fileTimeBudgetExpired (void)
+{
+	return (boolean) (TimeBudgetExpired != 0);
+}
+
+/*  With --max-file-size in effect, refuses files larger than the limit, so
+ *  that one degenerate input (a generated asset bundle, say) cannot consume
+ *  most of a run's time and memory.
+ */
+static boolean withinSizeLimit (const char *const fileName)
+{
+	boolean result = TRUE;
+	if (Option.maxFileSize > 0)
+	{
+		fileStatus *status = eStat (fileName);
+		if (status->exists  &&
+			(unsigned long) status->size > Option.maxFileSize)
+		{
+			error (WARNING, "\"%s\" is larger than --max-file-size; skipping",
+				   fileName);
+			GuardEvents.skippedFiles++;
+			result = FALSE;
+		}
+		eStatFree (status);
+	}
+	return result;
+}
+
 /*  This function opens a source file, and resets the line counter.  If it
  *  fails, it will display an error message and leave the File.fp set to NULL.
  */
@@ -251,6 +673,8 @@ extern boolean fileOpen (const char *const fileName, const langType language)
 	const char *const openMode = "rb";
 #endif
 	boolean opened = FALSE;
+	unsigned char *prefetched;
+	size_t prefetchedSize = 0;
 
 	/*	If another file was already open, then close it.
 	 */
@@ -259,17 +683,44 @@ extern boolean fileOpen (const char *const fileName, const langType language)
 		fclose (File.fp);  /* close any open source file */
 		File.fp = NULL;
 	}
+	File.lineNumber = 0L;  /* stays zero if the open fails below */
 
-	File.fp = fopen (fileName, openMode);
-	if (File.fp == NULL)
+	/*  An announced file may already be in memory (prefetch.c enforces
+	 *  --max-file-size while reading); otherwise open and read it here.
+	 *  Compressed files hold only raw bytes and take the decompressing
+	 *  path below.
+	 */
+	prefetched = (fileCompressionSuffix (fileName) == NULL)
+			? prefetchTake (fileName, &prefetchedSize) : NULL;
+	if (prefetched != NULL)
+	{
+		freeInputBuffer ();
+		File.buffer = prefetched;
+		File.bufferSize = prefetchedSize;
+		transcodeInputBuffer (fileName);
+		opened = TRUE;
+	}
+	else if ((File.fp = fopen (fileName, openMode)) == NULL)
 		error (WARNING | PERROR, "cannot open \"%s\"", fileName);
-	else
+	else if (! withinSizeLimit (fileName))
 	{
+		fclose (File.fp);
+		File.fp = NULL;
+	}
+	else if (! makeInputBuffer (fileName))
+	{
+		error (WARNING | PERROR, "cannot read \"%s\"", fileName);
+		fclose (File.fp);
+		File.fp = NULL;
+	}
+	else
 		opened = TRUE;
 
+	if (opened)
+	{
 		setInputFileName (fileName);
-		fgetpos (File.fp, &StartOfLine);
-		fgetpos (File.fp, &File.filePosition);
+		StartOfLine = (filePos) File.offset;  /* past any byte order mark */
+		File.filePosition = StartOfLine;
 		File.currentLine  = NULL;
 		File.lineNumber   = 0L;
 		File.eof          = FALSE;
@@ -284,24 +735,88 @@ extern boolean fileOpen (const char *const fileName, const langType language)
 		verbose ("OPENING %s as %s language %sfile\n", fileName,
 				getLanguageName (language),
 				File.source.isHeader ? "include " : "");
+		traceEvent (TRACE_FILE_OPENED, fileName, 0);
 	}
 	return opened;
 }
 
-extern void fileClose (void)
+/*  Opens source text already held in memory as the current input file.
+ *  The buffer is borrowed, not copied: it must stay valid until
+ *  bufferClose () and must be writable, since line terminators within it
+ *  are overwritten in place when lines are handed out.  fileName is used
+ *  for reporting and for the source file fields of the tags made.
+ */
+extern boolean bufferOpen (const char *const fileName,
+						   const langType language,
+						   unsigned char *const buffer, const size_t size)
 {
 	if (File.fp != NULL)
+	{
+		fclose (File.fp);  /* close any open source file */
+		File.fp = NULL;
+	}
+	freeInputBuffer ();
+	File.buffer = buffer;
+	File.bufferSize = size;
+	File.bufferBorrowed = TRUE;
+	transcodeInputBuffer (fileName);
+
+	setInputFileName (fileName);
+	StartOfLine = (filePos) File.offset;  /* past any byte order mark */
+	File.filePosition = StartOfLine;
+	File.currentLine  = NULL;
+	File.lineNumber   = 0L;
+	File.eof          = FALSE;
+	File.newLine      = TRUE;
+
+	if (File.line != NULL)
+		vStringClear (File.line);
+
+	setSourceFileParameters (vStringNewInit (fileName));
+	File.source.language = language;
+	File.source.lineNumber = 0L;
+
+	verbose ("OPENING buffer for %s as %s language %sfile\n", fileName,
+			getLanguageName (language),
+			File.source.isHeader ? "include " : "");
+	return TRUE;
+}
+
+extern void bufferClose (void)
+{
+	freeInputBuffer ();
+	if (File.line != NULL  &&  vStringSize (File.line) > LINE_BUFFER_RETAIN)
+	{
+		vStringDelete (File.line);
+		File.line = vStringNew ();
+	}
+}
+
+extern void fileClose (void)
+{
+	/*  A prefetched file has no stream of its own, only the buffer.
+	 */
+	if (File.fp != NULL  ||  File.buffer != NULL)
 	{
 		/*  The line count of the file is 1 too big, since it is one-based
 		 *  and is incremented upon each newline.
 		 */
-		if (Option.printTotals)
+		if (Option.printTotals  ||  Option.progressInterval > 0)
 		{
 			fileStatus *status = eStat (vStringValue (File.name));
 			addTotals (0, File.lineNumber - 1L, status->size);
 		}
-		fclose (File.fp);
-		File.fp = NULL;
+		if (File.fp != NULL)
+		{
+			fclose (File.fp);
+			File.fp = NULL;
+		}
+		freeInputBuffer ();
+		if (File.line != NULL  &&  vStringSize (File.line) > LINE_BUFFER_RETAIN)
+		{
+			vStringDelete (File.line);
+			File.line = vStringNew ();
+		}
 	}
 }
 
@@ -329,7 +844,7 @@ static int iFileGetc (void)
 {
 	int	c;
 readnext:
-	c = getc (File.fp);
+	c = bufferGetc ();
 
 	/*	If previous character was a newline, then we're starting a line.
 	 */
@@ -342,8 +857,8 @@ readnext:
 				goto readnext;
 			else
 			{
-				fsetpos (File.fp, &StartOfLine);
-				c = getc (File.fp);
+				File.offset = (size_t) StartOfLine;
+				c = bufferGetc ();
 			}
 		}
 	}
@@ -353,7 +868,7 @@ readnext:
 	else if (c == NEWLINE)
 	{
 		File.newLine = TRUE;
-		fgetpos (File.fp, &StartOfLine);
+		StartOfLine = (filePos) File.offset;
 	}
 	else if (c == CRETURN)
 	{
@@ -362,15 +877,15 @@ readnext:
 		 * and CR-LF (MS-DOS) are converted into a generic newline.
 		 */
 #ifndef macintosh
-		const int next = getc (File.fp);  /* is CR followed by LF? */
+		const int next = bufferGetc ();  /* is CR followed by LF? */
 		if (next != NEWLINE)
-			ungetc (next, File.fp);
+			bufferUngetc (next);
 		else
 #endif
 		{
 			c = NEWLINE;  /* convert CR into newline */
 			File.newLine = TRUE;
-			fgetpos (File.fp, &StartOfLine);
+			StartOfLine = (filePos) File.offset;
 		}
 	}
 	DebugStatement ( debugPutc (DEBUG_RAW, c); )
@@ -382,18 +897,87 @@ extern void fileUngetc (int c)
 	File.ungetch = c;
 }
 
+/*  Repositions the input to the start of the line beginning at byte offset
+ *  "lineOffset", numbered "lineNumber". Only meaningful on a file opened
+ *  through fileOpen () whose content up to the offset is known to match the
+ *  parse during which the position was recorded; used to resume a parse
+ *  from a checkpoint instead of starting over at the top of the file.
+ */
+extern void fileRestartAt (const filePos lineOffset, const unsigned long lineNumber)
+{
+	File.offset = (size_t) lineOffset;
+	StartOfLine = lineOffset;
+	File.filePosition = lineOffset;
+	File.currentLine = NULL;
+	File.ungetch = '\0';
+	File.eof     = FALSE;
+	File.newLine = TRUE;
+
+	/*  fileNewline () advances onto the line when its first character is
+	 *  read.
+	 */
+	File.lineNumber = lineNumber - 1;
+	File.source.lineNumber = lineNumber - 1;
+
+	if (File.line != NULL)
+		vStringClear (File.line);
+}
+
+static void recordTruncatedLine (void)
+{
+	error (WARNING, "%s, line %lu: longer than --max-line-length; truncated",
+		   vStringValue (File.name), File.lineNumber);
+	GuardEvents.truncatedLines++;
+}
+
+/*  Discards input up to and including the next line terminator, striding
+ *  the buffer directly; used to drop the remainder of a line which
+ *  exceeded --max-line-length. The dropped text is never stored.
+ */
+static void skipRestOfLine (void)
+{
+	const unsigned char *const start = File.buffer + File.offset;
+	const size_t remaining = File.bufferSize - File.offset;
+	const unsigned char *const nl =
+			(const unsigned char *) memchr (start, NEWLINE, remaining);
+
+	/*  Only a newline ends a line here, as in iFileGetc (); the CR of a
+	 *  CR-LF pair is simply part of the discarded text.
+	 */
+	if (nl != NULL)
+		File.offset = (size_t) (nl - File.buffer) + 1;
+	else
+		File.offset = File.bufferSize;  /* unterminated final line */
+	StartOfLine = (filePos) File.offset;
+	File.newLine = TRUE;
+}
+
 static vString *iFileGetLine (void)
 {
 	vString *result = NULL;
 	int c;
+	if (TimeBudgetExpired)
+	{
+		File.eof = TRUE;
+		return NULL;
+	}
 	if (File.line == NULL)
 		File.line = vStringNew ();
 	vStringClear (File.line);
+	cacheNoteFetchedLine ();
 	do
 	{
 		c = iFileGetc ();
 		if (c != EOF)
 			vStringPut (File.line, c);
+		if (c != EOF  &&  c != '\n'  &&  Option.maxLineLength > 0  &&
+			vStringLength (File.line) >= Option.maxLineLength)
+		{
+			recordTruncatedLine ();
+			skipRestOfLine ();
+			vStringPut (File.line, '\n');
+			c = '\n';
+		}
 		if (c == '\n'  ||  (c == EOF  &&  vStringLength (File.line) > 0))
 		{
 			vStringTerminate (File.line);
@@ -448,16 +1032,183 @@ extern int fileGetc (void)
 	return c;
 }
 
+/*  Returns the unread remainder of the line holding the character last
+ *  returned by fileGetc (), or NULL at end of file. The text is not
+ *  consumed, letting a caller inspect a whole line cheaply before
+ *  deciding how to process it.
+ */
+extern const char *fileCurrentLine (void)
+{
+	return (const char *) File.currentLine;
+}
+
+/*  Both skipping functions below scan the remainder of the current line
+ *  with strchr()/strpbrk(), which the C library vectorizes, rather than
+ *  testing one fileGetc() result at a time; fileGetc() is called only to
+ *  fetch each new line (and so keeps the line bookkeeping intact).
+ */
 extern int fileSkipToCharacter (int c)
 {
 	int d;
-	do
+	for (;;)
 	{
 		d = fileGetc ();
-	} while (d != EOF && d != c);
+		if (d == EOF  ||  d == c)
+			break;
+		if (File.currentLine != NULL)
+		{
+			const char *const found =
+				strchr ((const char *) File.currentLine, c);
+			if (found != NULL)
+			{
+				File.currentLine = (const unsigned char *) found + 1;
+				d = c;
+				break;
+			}
+			File.currentLine = NULL;
+		}
+	}
 	return d;
 }
 
+/*  Like fileSkipToCharacter (), but skips to (and consumes) the next
+ *  occurrence of any character in "set", returning that character.
+ */
+extern int fileSkipToCharacters (const char *const set)
+{
+	int d;
+	for (;;)
+	{
+		d = fileGetc ();
+		if (d == EOF  ||  strchr (set, d) != NULL)
+			break;
+		if (File.currentLine != NULL)
+		{
+			const char *const found =
+				strpbrk ((const char *) File.currentLine, set);
+			if (found != NULL)
+			{
+				File.currentLine = (const unsigned char *) found + 1;
+				d = (unsigned char) *found;
+				break;
+			}
+			File.currentLine = NULL;
+		}
+	}
+	return d;
+}
+
+/*  Like fileSkipToCharacters (), but word characters (alphanumerics and
+ *  underscore) in "set" are only matched where a word begins: occurrences
+ *  embedded in a longer word are passed over. Non-word characters in the
+ *  set always match.
+ */
+#define isWordChar(c)  (isalnum (c) || (c) == '_')
+
+extern int fileSkipToWordStart (const char *const set)
+{
+	int d;
+	int prev = '\n';
+	for (;;)
+	{
+		d = fileGetc ();
+		if (d == EOF)
+			break;
+		if (strchr (set, d) != NULL  &&
+			! (isWordChar (d) && isWordChar (prev)))
+			break;
+		prev = d;
+		if (File.currentLine != NULL)
+		{
+			const char *const line = (const char *) File.currentLine;
+			const char *p = line;
+			const char *found;
+			while ((found = strpbrk (p, set)) != NULL)
+			{
+				const int before = (found == line) ?
+									prev : (unsigned char) found [-1];
+				if (! (isWordChar ((unsigned char) *found) &&
+					   isWordChar (before)))
+					break;
+				p = found + 1;
+			}
+			if (found != NULL)
+			{
+				File.currentLine = (const unsigned char *) found + 1;
+				d = (unsigned char) *found;
+				break;
+			}
+			File.currentLine = NULL;
+			prev = '\n';  /* lines are newline-terminated */
+		}
+	}
+	return d;
+}
+
+/*  Returns the next line as a null-terminated slice of the input buffer,
+ *  without copying it: the line terminator in the buffer is overwritten
+ *  with a null byte (the buffer is a private mapping, so the file itself
+ *  is never touched). Returns NULL at end of file, and also for the rare
+ *  lines which need character-level treatment (line directives, bare
+ *  carriage-return line ends, a final line lacking a terminator);
+ *  File.eof tells these cases apart.
+ */
+static const unsigned char *fileGetLineSlice (void)
+{
+	const size_t start = File.offset;
+	unsigned char *terminator;
+	unsigned char *newline;
+
+	DebugStatement ( if (Option.debugLevel & (DEBUG_RAW | DEBUG_READ))
+						return NULL; )
+	if (start >= File.bufferSize  ||  TimeBudgetExpired)
+	{
+		File.eof = TRUE;
+		return NULL;
+	}
+	if (Option.lineDirectives  &&  File.buffer [start] == '#')
+		return NULL;
+	newline = (unsigned char *) memchr (
+			File.buffer + start, NEWLINE, File.bufferSize - start);
+	if (newline == NULL)
+		return NULL;  /* final line has no terminator; copy it instead */
+	terminator = (unsigned char *) memchr (
+			File.buffer + start, CRETURN, newline - (File.buffer + start));
+	if (terminator == NULL)
+		terminator = newline;
+	else if (terminator != newline - 1)
+		return NULL;  /* bare CR line ends; canonicalize per character */
+
+	/*  The bookkeeping below matches reading the line through iFileGetc ().
+	 */
+	File.filePosition = (filePos) start;
+	File.newLine = TRUE;
+	File.lineNumber++;
+	File.source.lineNumber++;
+	DebugStatement ( if (Option.breakLine == File.lineNumber) lineBreak (); )
+	File.offset = (size_t) (newline - File.buffer) + 1;
+	StartOfLine = (filePos) File.offset;
+
+	if (Option.maxLineLength > 0  &&
+		(size_t) (terminator - (File.buffer + start)) > Option.maxLineLength)
+	{
+		recordTruncatedLine ();
+		terminator = File.buffer + start + Option.maxLineLength;
+	}
+	*terminator = '\0';
+#ifdef HAVE_REGEX
+	if (terminator != File.buffer + start)
+	{
+		vString slice;
+		slice.buffer = (char *) (File.buffer + start);
+		slice.length = terminator - (File.buffer + start);
+		slice.size   = slice.length + 1;
+		matchRegex (&slice, File.source.language);
+	}
+#endif
+	return File.buffer + start;
+}
+
 /*  An alternative interface to fileGetc (). Do not mix use of fileReadLine()
  *  and fileGetc() for the same file. The returned string does not contain
  *  the terminating newline. A NULL return value means that all lines in the
@@ -465,17 +1216,147 @@ extern int fileSkipToCharacter (int c)
  */
 extern const unsigned char *fileReadLine (void)
 {
-	vString* const line = iFileGetLine ();
-	const unsigned char* result = NULL;
-	if (line != NULL)
+	const unsigned char *result = fileGetLineSlice ();
+
+	if (result == NULL  &&  ! File.eof)
 	{
-		result = (const unsigned char*) vStringValue (line);
-		vStringStripNewline (line);
-		DebugStatement ( debugPrintf (DEBUG_READ, "%s\n", result); )
+		vString* const line = iFileGetLine ();
+		if (line != NULL)
+		{
+			result = (const unsigned char*) vStringValue (line);
+			vStringStripNewline (line);
+		}
 	}
+	DebugStatement ( if (result != NULL)
+						debugPrintf (DEBUG_READ, "%s\n", result); )
 	return result;
 }
 
+/*  Skips whole lines without surrendering them to the caller, stopping at
+ *  the first line which begins with "prefix" (which must contain neither a
+ *  null byte nor a line terminator). The stopping line is read and returned
+ *  exactly as by fileReadLine (); the lines passed over are counted for the
+ *  line bookkeeping but are never offered to regex patterns. Returns NULL
+ *  if no such line remains before end of file.
+ */
+extern const unsigned char *fileSkipLinesUntilPrefix (const char *const prefix)
+{
+	const size_t prefixLength = strlen (prefix);
+	const unsigned char *line;
+	boolean striding = (boolean) (File.buffer != NULL  &&
+								  ! Option.lineDirectives);
+
+	DebugStatement ( if (Option.debugLevel & (DEBUG_RAW | DEBUG_READ))
+						striding = FALSE; )
+	while (striding  &&  File.offset < File.bufferSize)
+	{
+		const unsigned char *const start = File.buffer + File.offset;
+		const size_t remaining = File.bufferSize - File.offset;
+		const unsigned char *newline;
+		const unsigned char *cr;
+
+		if (remaining >= prefixLength  &&
+			memcmp (start, prefix, prefixLength) == 0)
+			break;
+		newline = (const unsigned char *) memchr (start, NEWLINE, remaining);
+		if (newline == NULL)
+			break;  /* final line has no terminator; read it normally */
+		cr = (const unsigned char *) memchr (
+				start, CRETURN, (size_t) (newline - start));
+		if (cr != NULL  &&  cr != newline - 1)
+			break;  /* bare CR line ends; count lines one at a time */
+		File.offset = (size_t) (newline - File.buffer) + 1;
+		StartOfLine = (filePos) File.offset;
+		File.lineNumber++;
+		File.source.lineNumber++;
+	}
+	while ((line = fileReadLine ()) != NULL)
+	{
+		if (strncmp ((const char *) line, prefix, prefixLength) == 0)
+			break;
+	}
+	return line;
+}
+
+/*  Searches [haystack, end) for the given bytes; memchr () carries the
+ *  scan between candidate positions so that it moves at memory speed.
+ */
+static const unsigned char *findBytes (
+		const unsigned char *haystack, const unsigned char *const end,
+		const char *const needle, const size_t length)
+{
+	while ((size_t) (end - haystack) >= length)
+	{
+		haystack = (const unsigned char *) memchr (
+				haystack, needle [0], (size_t) (end - haystack) - length + 1);
+		if (haystack == NULL)
+			break;
+		if (memcmp (haystack, needle, length) == 0)
+			return haystack;
+		++haystack;
+	}
+	return NULL;
+}
+
+/*  Like fileSkipLinesUntilPrefix (), but stops at the first line which
+ *  contains "string" anywhere within it. The stopping line is read and
+ *  returned exactly as by fileReadLine (); the lines passed over are
+ *  counted for the line bookkeeping but are never offered to regex
+ *  patterns. Returns NULL if the string does not occur before end of file.
+ */
+extern const unsigned char *fileSkipLinesUntilString (const char *const string)
+{
+	const size_t length = strlen (string);
+	const unsigned char *line;
+	boolean striding = (boolean) (File.buffer != NULL  &&
+								  ! Option.lineDirectives);
+
+	DebugStatement ( if (Option.debugLevel & (DEBUG_RAW | DEBUG_READ))
+						striding = FALSE; )
+	while (striding  &&  File.offset < File.bufferSize)
+	{
+		const unsigned char *const start = File.buffer + File.offset;
+		const size_t remaining = File.bufferSize - File.offset;
+		const unsigned char *const newline =
+				(const unsigned char *) memchr (start, NEWLINE, remaining);
+		const unsigned char *cr;
+
+		if (newline == NULL)
+			break;  /* final line has no terminator; read it normally */
+		cr = (const unsigned char *) memchr (
+				start, CRETURN, (size_t) (newline - start));
+		if (cr != NULL  &&  cr != newline - 1)
+			break;  /* bare CR line ends; count lines one at a time */
+		if (findBytes (start, newline, string, length) != NULL)
+			break;
+		File.offset = (size_t) (newline - File.buffer) + 1;
+		StartOfLine = (filePos) File.offset;
+		File.lineNumber++;
+		File.source.lineNumber++;
+	}
+	while ((line = fileReadLine ()) != NULL)
+	{
+		if (strstr ((const char *) line, string) != NULL)
+			break;
+	}
+	return line;
+}
+
+/*  Reports the guard events recorded above; part of the --stats report.
+ */
+extern void printReadStatistics (void)
+{
+	if (GuardEvents.skippedFiles > 0)
+		fprintf (errout, "%lu file(s) skipped by --max-file-size\n",
+				GuardEvents.skippedFiles);
+	if (GuardEvents.truncatedLines > 0)
+		fprintf (errout, "%lu line(s) truncated by --max-line-length\n",
+				GuardEvents.truncatedLines);
+	if (GuardEvents.expiredParses > 0)
+		fprintf (errout, "%lu file(s) cut short by --max-parse-time\n",
+				GuardEvents.expiredParses);
+}
+
 /*
  *   Source file line reading with automatic buffer sizing
  */
@@ -488,76 +1369,105 @@ extern char *readLine (vString *const vLine, FILE *const fp)
 		error (FATAL, "NULL file pointer");
 	else
 	{
-		boolean reReadLine;
+		boolean lineDone = FALSE;
 
-		/*  If reading the line places any character other than a null or a
-		 *  newline at the last character position in the buffer (one less
-		 *  than the buffer size), then we must resize the buffer and
-		 *  reattempt to read the line.
+		/*  Read the line in one pass, appending each further piece of an
+		 *  overlong line behind the last after growing the buffer, rather
+		 *  than repositioning the file and rereading the line from its
+		 *  start. Only the newly read piece is scanned for its length.
 		 */
 		do
 		{
-			char *const pLastChar = vStringValue (vLine) + vStringSize (vLine) -2;
-			fpos_t startOfLine;
-
-			fgetpos (fp, &startOfLine);
-			reReadLine = FALSE;
-			*pLastChar = '\0';
-			result = fgets (vStringValue (vLine), (int) vStringSize (vLine), fp);
-			if (result == NULL)
+			char *const pTail = vStringValue (vLine) + vStringLength (vLine);
+			const size_t space = vStringSize (vLine) - vStringLength (vLine);
+			char *const piece = fgets (pTail, (int) space, fp);
+
+			if (piece == NULL)
 			{
 				if (! feof (fp))
 					error (FATAL | PERROR, "Failure on attempt to read file");
+				lineDone = TRUE;
 			}
-			else if (*pLastChar != '\0'  &&
-					 *pLastChar != '\n'  &&  *pLastChar != '\r')
+			else
 			{
-				/*  buffer overflow */
-				reReadLine = vStringAutoResize (vLine);
-				if (reReadLine)
-					fsetpos (fp, &startOfLine);
-				else
+				const size_t length = strlen (piece);
+
+				result = piece;  /* something was read; see below */
+				vStringAdvance (vLine, length);
+				if (length > 0  &&  piece [length - 1] == '\n')
+					lineDone = TRUE;
+				else if (feof (fp))
+					lineDone = TRUE;  /* final line lacks a newline */
+				else if (! vStringAutoResize (vLine))
 					error (FATAL | PERROR, "input line too big; out of memory");
 			}
-			else
+		} while (! lineDone);
+
+		if (result != NULL)  /* growing the buffer may have moved the line */
+			result = vStringValue (vLine);
+		if (result != NULL  &&  vStringLength (vLine) > 0)
+		{
+			/* canonicalize new line */
+			char *const eol = vStringValue (vLine) + vStringLength (vLine) - 1;
+
+			if (*eol == '\r')
+				*eol = '\n';
+			else if (vStringLength (vLine) > 1  &&
+					 *(eol - 1) == '\r'  &&  *eol == '\n')
 			{
-				char* eol;
-				vStringSetLength (vLine);
-				/* canonicalize new line */
-				eol = vStringValue (vLine) + vStringLength (vLine) - 1;
-				if (*eol == '\r')
-					*eol = '\n';
-				else if (*(eol - 1) == '\r'  &&  *eol == '\n')
-				{
-					*(eol - 1) = '\n';
-					*eol = '\0';
-					--vLine->length;
-				}
+				*(eol - 1) = '\n';
+				*eol = '\0';
+				--vLine->length;
 			}
-		} while (reReadLine);
+		}
 	}
 	return result;
 }
 
 /*  Places into the line buffer the contents of the line referenced by
- *  "location".
+ *  "location". The input buffer makes this a block copy which leaves
+ *  the read position untouched; this runs once per tag written, so it
+ *  locates the line end with memchr rather than walking bytes.
  */
 extern char *readSourceLine (
-		vString *const vLine, fpos_t location, long *const pSeekValue)
+		vString *const vLine, filePos location, long *const pSeekValue)
 {
-	fpos_t orignalPosition;
-	char *result;
+	const size_t offset = (size_t) location;
+	const char *start, *nl, *end;
+	size_t span, length;
 
-	fgetpos (File.fp, &orignalPosition);
-	fsetpos (File.fp, &location);
 	if (pSeekValue != NULL)
-		*pSeekValue = ftell (File.fp);
-	result = readLine (vLine, File.fp);
-	if (result == NULL)
+		*pSeekValue = (long) location;
+	if (offset >= File.bufferSize)
 		error (FATAL, "Unexpected end of file: %s", vStringValue (File.name));
-	fsetpos (File.fp, &orignalPosition);
 
-	return result;
+	start = (const char *) File.buffer + offset;
+	nl = (const char *) memchr (start, NEWLINE, File.bufferSize - offset);
+	span = (nl != NULL) ? (size_t) (nl - start) + 1 : File.bufferSize - offset;
+
+	/*  A CR or null byte ends the line before any newline: CR and CR-LF
+	 *  line ends are canonicalized into a newline, and a null byte is a
+	 *  line terminator which fileGetLineSlice () has already overwritten
+	 *  in place.
+	 */
+	end = (const char *) memchr (start, CRETURN, span);
+	if (end == NULL)
+		end = (const char *) memchr (start, '\0', span);
+	else
+	{
+		const char *const nul =
+				(const char *) memchr (start, '\0', (size_t) (end - start));
+		if (nul != NULL)
+			end = nul;
+	}
+	length = (end != NULL) ? (size_t) (end - start) : span;
+
+	vStringCopySpan (vLine, start, length);
+	if (end != NULL)
+		vStringPut (vLine, NEWLINE);
+	vStringTerminate (vLine);
+
+	return vStringValue (vLine);
 }
 
 /* vi:set tabstop=4 shiftwidth=4: */
@@ -11,12 +11,6 @@
 #ifndef _READ_H
 #define _READ_H
 
-#if defined(FILE_WRITE) || defined(VAXC)
-# define CONST_FILE
-#else
-# define CONST_FILE const
-#endif
-
 /*
 *   INCLUDE FILES
 */
@@ -46,6 +40,12 @@
 *   DATA DECLARATIONS
 */
 
+/*  A position within the source file, a plain byte offset into the input
+ *  buffer. This replaces the opaque fpos_t for source files now that each
+ *  file is read into a contiguous buffer.
+ */
+typedef long filePos;
+
 enum eCharacters {
 	/* white space characters */
 	SPACE         = ' ',
@@ -72,8 +72,13 @@ typedef struct sInputFile {
 	vString    *line;          /* last line read from file */
 	const unsigned char* currentLine;  /* current line being worked on */
 	FILE       *fp;            /* stream used for reading the file */
+	unsigned char *buffer;     /* contents of the file */
+	size_t      bufferSize;    /* number of bytes in buffer */
+	size_t      offset;        /* read position within buffer */
+	boolean     bufferMapped;  /* is buffer memory-mapped? */
+	boolean     bufferBorrowed;/* is buffer owned by the caller? */
 	unsigned long lineNumber;  /* line number in the input file */
-	fpos_t      filePosition;  /* file position of current line */
+	filePos     filePosition;  /* file position of current line */
 	int         ungetch;       /* a single character that was ungotten */
 	boolean     eof;           /* have we reached the end of file? */
 	boolean     newLine;       /* will the next character begin a new line? */
@@ -84,7 +89,7 @@ typedef struct sInputFile {
 	 */
 	struct sSource {
 		vString *name;           /* name to report for source file */
-		char    *tagPath;        /* path of source file relative to tag file */
+		const char *tagPath;     /* path of source file relative to tag file */
 		unsigned long lineNumber;/* line number in the source file */
 		boolean  isHeader;       /* is source file a header file? */
 		langType language;       /* language of source file */
@@ -94,21 +99,40 @@ typedef struct sInputFile {
 /*
 *   GLOBAL VARIABLES
 */
-extern CONST_FILE inputFile File;
+extern inputFile *CurrentFile;
+
+/*  Compatibility shim: the reader and the parsers continue to name the
+ *  active input file "File"; it now resolves through a context pointer so
+ *  that more than one input state can exist in a process.
+ */
+#define File (*CurrentFile)
 
 /*
 *   FUNCTION PROTOTYPES
 */
+extern inputFile *setInputContext (inputFile *const context);
 extern void freeSourceFileResources (void);
 extern boolean fileOpen (const char *const fileName, const langType language);
+extern boolean bufferOpen (const char *const fileName, const langType language, unsigned char *const buffer, const size_t size);
+extern void bufferClose (void);
 extern boolean fileEOF (void);
 extern void fileClose (void);
 extern int fileGetc (void);
+extern const char *fileCurrentLine (void);
 extern int fileSkipToCharacter (int c);
+extern int fileSkipToCharacters (const char *const set);
+extern int fileSkipToWordStart (const char *const set);
 extern void fileUngetc (int c);
+extern void fileRestartAt (const filePos lineOffset, const unsigned long lineNumber);
 extern const unsigned char *fileReadLine (void);
+extern const unsigned char *fileSkipLinesUntilPrefix (const char *const prefix);
+extern const unsigned char *fileSkipLinesUntilString (const char *const string);
+extern void fileStartTimeBudget (void);
+extern boolean fileEndTimeBudget (void);
+extern boolean fileTimeBudgetExpired (void);
+extern void printReadStatistics (void);
 extern char *readLine (vString *const vLine, FILE *const fp);
-extern char *readSourceLine (vString *const vLine, fpos_t location, long *const pSeekValue);
+extern char *readSourceLine (vString *const vLine, filePos location, long *const pSeekValue);
 
 #endif  /* _READ_H */
 
@@ -11,12 +11,23 @@
 /*
 *   INCLUDE FILES
 */
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
 #include <errno.h>
 #include <sys/types.h>  /* to declare off_t */
+#include <sys/stat.h>   /* to revalidate cached tag file handles */
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+# include <unistd.h>    /* to declare fileno() */
+#endif
+#ifdef HAVE_ZLIB_H
+# include <zlib.h>      /* to read tag files written by ctags --compress */
+#endif
 
 #include "readtags.h"
 
@@ -34,6 +45,20 @@ typedef struct {
 	char *buffer;
 } vstring;
 
+/* One compressed block of a tag file written with ctags --compress */
+typedef struct {
+		/* name of the first tag in the block */
+	char *key;
+		/* offset of the block's first byte in the uncompressed record space */
+	off_t start;
+		/* offset of the compressed frame within the tag file */
+	off_t frame;
+		/* bytes occupied by the compressed frame */
+	unsigned long compressedSize;
+		/* bytes when uncompressed */
+	unsigned long size;
+} tagBlockEntry;
+
 /* Information about current tag file */
 struct sTagFile {
 		/* has the file been opened and this structure initialized? */
@@ -44,6 +69,10 @@ struct sTagFile {
 	sortType sortMethod;
 		/* pointer to file structure */
 	FILE* fp;
+		/* memory-mapped image of the tag file, or NULL if not mapped */
+	const char *data;
+		/* current read offset within the mapped image */
+	off_t offset;
 		/* file position of first character of `line' */
 	off_t pos;
 		/* size of tag file in seekable positions */
@@ -62,9 +91,99 @@ struct sTagFile {
 			size_t nameLength;
 				/* peforming partial match */
 			short partial;
+				/* performing substring match */
+			short substring;
 				/* ignoring case */
 			short ignorecase;
+				/* hash of the name last searched for */
+			unsigned long hash;
+				/* next index record to consider, when searching via index */
+			unsigned long indexNext;
+				/* is the current search driven by the binary index? */
+			short usingIndex;
+				/* next trigram record to consider, and the first one past
+				 * the run, when searching via the trigram index */
+			unsigned long trigramNext;
+			unsigned long trigramLimit;
+				/* is the current search driven by the trigram index? */
+			short usingTrigrams;
+				/* is the current search scoped to one source file? */
+			short fileScoped;
+				/* is the file-scoped search driven by the file map? */
+			short usingFileMap;
+				/* next and last-plus-one positions within the selected
+				 * file map run */
+			unsigned long fileNext;
+			unsigned long fileLimit;
+				/* position of the run's offsets in the file map image */
+			const char *fileOffsets;
 	} search;
+		/* binary index of the tag file, if present and current */
+	struct {
+				/* number of records in `table' */
+			unsigned long count;
+				/* records sorted by name hash, ties in tag file order */
+			tagIndexEntry *table;
+	} index;
+		/* trigram index of the tag file, if present and current */
+	struct {
+				/* number of records in `table' */
+			unsigned long count;
+				/* records sorted by trigram, ties in tag file order */
+			tagTrigramEntry *table;
+	} trigrams;
+		/* per-file section map of the tag file, if present and current */
+	struct {
+				/* number of source files in `data' */
+			unsigned long files;
+				/* size of `data' in bytes */
+			size_t size;
+				/* the entries as stored on disk, in file name order */
+			char *data;
+	} filemap;
+		/* compressed block structure of the tag file, if compressed */
+	struct {
+				/* is the tag file compressed? */
+			short compressed;
+				/* is the file compressed but support not compiled in? */
+			short unsupported;
+				/* number of records in `blocks' */
+			unsigned long count;
+				/* per-block records, in tag file order */
+			tagBlockEntry *blocks;
+				/* total size of the uncompressed record space */
+			off_t totalSize;
+				/* index of the block currently inflated, or `count' */
+			unsigned long loaded;
+				/* buffer holding the inflated block */
+			char *buffer;
+				/* capacity of `buffer' */
+			size_t bufferSize;
+				/* scratch buffer holding a compressed frame when not mapped */
+			char *frame;
+				/* capacity of `frame' */
+			size_t frameSize;
+	} zip;
+		/* journal segments layered over this tag file, if any */
+	struct {
+				/* number of open segments in `layer' */
+			unsigned long count;
+				/* the open segments, newest first */
+			struct sTagFile **layer;
+				/* layer the current search or iteration is reading;
+				 * `count' addresses this file itself */
+			unsigned long current;
+				/* saved search, re-issued as it moves to older layers */
+			char *searchName;
+			int searchOptions;
+				/* is the current search scoped to one source file (and
+				 * therefore confined to `current')? */
+			short fileScoped;
+				/* when this handle is itself a segment: the source
+				 * files whose older entries it replaces */
+			unsigned long coveredCount;
+			char **covered;
+	} journal;
 		/* miscellaneous extension fields */
 	struct {
 				/* number of entries in `list' */
@@ -122,6 +241,31 @@ static int strnuppercmp (const char *s1, const char *s2, size_t n)
 	return result;
 }
 
+/* Pack three consecutive bytes of a tag name into the case-folded trigram
+ * under which the trigram index records them. Case is folded with toupper()
+ * to agree with struppercmp() above, so one table serves both
+ * case-sensitive and case-insensitive substring searches.
+ */
+static unsigned long packTrigram (const char *const s)
+{
+	return ((unsigned long) toupper ((int) (unsigned char) s [0]) << 16) |
+	       ((unsigned long) toupper ((int) (unsigned char) s [1]) <<  8) |
+	        (unsigned long) toupper ((int) (unsigned char) s [2]);
+}
+
+/* Hash a tag name for the binary index. Case is folded with toupper() to
+ * agree with struppercmp() above, and hashing stops at the field separator
+ * so that a whole tag line hashes like the name it begins with.
+ */
+extern unsigned long tagsHashName (const char *const name)
+{
+	unsigned long result = 5381;
+	const char *p;
+	for (p = name  ;  *p != '\0'  &&  *p != TAB  ;  ++p)
+		result = result * 33 + (unsigned long) toupper ((int) (unsigned char) *p);
+	return result;
+}
+
 static int growString (vstring *s)
 {
 	int result = 0;
@@ -149,7 +293,10 @@ static int growString (vstring *s)
 	return result;
 }
 
-/* Copy name of tag out of tag line */
+/*  Copy name of tag out of tag line. Called only where a NUL terminated
+ *  copy of the name is really needed (the index writers); searches compare
+ *  names on the raw line instead.
+ */
 static void copyName (tagFile *const file)
 {
 	size_t length;
@@ -170,11 +317,196 @@ static void copyName (tagFile *const file)
 	file->name.buffer [length] = '\0';
 }
 
+/*  Report the file position at which the next line will be read, whether the
+ *  tag file is memory-mapped or read through stdio.
+ */
+static off_t tellTagFile (tagFile *const file)
+{
+	off_t result;
+	if (file->zip.compressed  ||  file->data != NULL)
+		result = file->offset;
+	else
+		result = ftell (file->fp);
+	return result;
+}
+
+/*  Position the next read at `pos'. Returns 0 upon success, as fseek() does.
+ *  Seeking a memory-mapped file is mere offset assignment and cannot fail.
+ */
+static int seekTagFile (tagFile *const file, const off_t pos)
+{
+	int result = 0;
+	if (file->zip.compressed  ||  file->data != NULL)
+		file->offset = pos;
+	else
+		result = fseek (file->fp, pos, SEEK_SET);
+	return result;
+}
+
+/*  Read a line from the memory-mapped image of the tag file. The line is
+ *  copied into `file->line' because the mapping is read-only while
+ *  parseTagLine() splits the line buffer in place.
+ */
+static int readTagLineRawMapped (tagFile *const file)
+{
+	int result = 0;
+	file->pos = file->offset;
+	if (file->offset < file->size)
+	{
+		const char *const start = file->data + file->offset;
+		const char *const end = (const char*) memchr (
+				start, '\n', (size_t) (file->size - file->offset));
+		size_t length;
+		if (end == NULL)
+		{
+			length = (size_t) (file->size - file->offset);
+			file->offset = file->size;
+		}
+		else
+		{
+			length = (size_t) (end - start);
+			file->offset += (off_t) length + 1;
+		}
+		while (length > 0  &&
+			   (start [length - 1] == '\n'  ||  start [length - 1] == '\r'))
+			--length;
+		while (length >= file->line.size)
+			growString (&file->line);
+		memcpy (file->line.buffer, start, length);
+		file->line.buffer [length] = '\0';
+		result = 1;
+	}
+	return result;
+}
+
+#ifdef HAVE_ZLIB_H
+
+/*  Inflates the compressed frame of block `i' into the block buffer. Only
+ *  one block is held inflated at a time; lookups touch one or two blocks so
+ *  a larger cache would rarely be hit.
+ */
+static int loadBlock (tagFile *const file, const unsigned long i)
+{
+	const tagBlockEntry *const block = file->zip.blocks + i;
+	uLongf size = (uLongf) block->size;
+	const unsigned char *frame;
+	int result = 0;
+
+	if (file->zip.bufferSize < (size_t) block->size)
+	{
+		char *const buffer = (char*) realloc (file->zip.buffer,
+											  (size_t) block->size);
+		if (buffer == NULL)
+			return 0;
+		file->zip.buffer = buffer;
+		file->zip.bufferSize = (size_t) block->size;
+	}
+	if (file->data != NULL)
+		frame = (const unsigned char*) (file->data + block->frame);
+	else
+	{
+		if (file->zip.frameSize < (size_t) block->compressedSize)
+		{
+			char *const buffer = (char*) realloc (file->zip.frame,
+					(size_t) block->compressedSize);
+			if (buffer == NULL)
+				return 0;
+			file->zip.frame = buffer;
+			file->zip.frameSize = (size_t) block->compressedSize;
+		}
+		if (fseek (file->fp, block->frame, SEEK_SET) != 0  ||
+			fread (file->zip.frame, 1, (size_t) block->compressedSize,
+				   file->fp) != (size_t) block->compressedSize)
+			return 0;
+		frame = (const unsigned char*) file->zip.frame;
+	}
+	if (uncompress ((Bytef*) file->zip.buffer, &size, (const Bytef*) frame,
+					(uLong) block->compressedSize) == Z_OK  &&
+		size == (uLongf) block->size)
+	{
+		file->zip.loaded = i;
+		result = 1;
+	}
+	else
+		file->zip.loaded = file->zip.count;
+	return result;
+}
+
+/*  Reads a line out of the inflated image of the block holding the current
+ *  offset. Blocks begin and end at line boundaries, so a line never spans
+ *  two frames.
+ */
+static int readTagLineRawZip (tagFile *const file)
+{
+	int result = 0;
+	file->pos = file->offset;
+	if (file->offset < file->zip.totalSize)
+	{
+		const tagBlockEntry *block;
+		const char *start, *end;
+		size_t within, length;
+		unsigned long i = file->zip.loaded;
+
+		if (i >= file->zip.count  ||
+			file->offset < file->zip.blocks [i].start  ||
+			file->offset >= file->zip.blocks [i].start +
+							(off_t) file->zip.blocks [i].size)
+		{
+			unsigned long lower = 0;
+			unsigned long upper = file->zip.count;
+			while (lower + 1 < upper)
+			{
+				const unsigned long middle = lower + (upper - lower) / 2;
+				if (file->zip.blocks [middle].start > file->offset)
+					upper = middle;
+				else
+					lower = middle;
+			}
+			i = lower;
+			if (! loadBlock (file, i))
+				return 0;
+		}
+		block = file->zip.blocks + i;
+		within = (size_t) (file->offset - block->start);
+		start = file->zip.buffer + within;
+		end = (const char*) memchr (start, '\n',
+									(size_t) block->size - within);
+		if (end == NULL)
+		{
+			length = (size_t) block->size - within;
+			file->offset = block->start + (off_t) block->size;
+		}
+		else
+		{
+			length = (size_t) (end - start);
+			file->offset += (off_t) length + 1;
+		}
+		while (length > 0  &&
+			   (start [length - 1] == '\n'  ||  start [length - 1] == '\r'))
+			--length;
+		while (length >= file->line.size)
+			growString (&file->line);
+		memcpy (file->line.buffer, start, length);
+		file->line.buffer [length] = '\0';
+		result = 1;
+	}
+	return result;
+}
+
+#endif
+
 static int readTagLineRaw (tagFile *const file)
 {
 	int result = 1;
 	int reReadLine;
 
+#ifdef HAVE_ZLIB_H
+	if (file->zip.compressed)
+		return readTagLineRawZip (file);
+#endif
+	if (file->data != NULL)
+		return readTagLineRawMapped (file);
+
 	/*  If reading the line places any character other than a null or a
 	 *  newline at the last character position in the buffer (one less than
 	 *  the buffer size), then we must resize the buffer and reattempt to read
@@ -215,8 +547,6 @@ static int readTagLineRaw (tagFile *const file)
 			}
 		}
 	} while (reReadLine  &&  result);
-	if (result)
-		copyName (file);
 	return result;
 }
 
@@ -226,7 +556,8 @@ static int readTagLine (tagFile *const file)
 	do
 	{
 		result = readTagLineRaw (file);
-	} while (result && *file->name.buffer == '\0');
+	} while (result  &&
+			 (*file->line.buffer == '\0'  ||  *file->line.buffer == TAB));
 	return result;
 }
 
@@ -368,9 +699,71 @@ static char *duplicate (const char *str)
 	return result;
 }
 
+#ifdef HAVE_ZLIB_H
+
+/*  Records one block pseudo tag in the block table. The line names the
+ *  first tag of the block and carries its compressed and uncompressed
+ *  sizes; the offsets accumulate in file order once all blocks are known.
+ */
+static void addTagBlock (tagFile *const file, char *const line)
+{
+	char *const keyStart = strchr (line, TAB);
+	char *sizes;
+	if (keyStart != NULL  &&  (sizes = strchr (keyStart + 1, TAB)) != NULL)
+	{
+		unsigned long compressedSize, size;
+		*sizes++ = '\0';
+		if (sscanf (sizes, "%lu,%lu", &compressedSize, &size) == 2)
+		{
+			if (file->zip.count == 0  ||
+				(file->zip.count >= 16  &&
+				 (file->zip.count & (file->zip.count - 1)) == 0))
+			{
+				const unsigned long slots =
+						(file->zip.count == 0) ? 16 : 2 * file->zip.count;
+				tagBlockEntry *const blocks = (tagBlockEntry*) realloc (
+						file->zip.blocks, slots * sizeof (tagBlockEntry));
+				if (blocks == NULL)
+					return;
+				file->zip.blocks = blocks;
+			}
+			file->zip.blocks [file->zip.count].key = duplicate (keyStart + 1);
+			file->zip.blocks [file->zip.count].compressedSize = compressedSize;
+			file->zip.blocks [file->zip.count].size = size;
+			++file->zip.count;
+		}
+	}
+}
+
+/*  Called upon reading the compression pseudo tag, after which the
+ *  compressed frames follow immediately. Assigns each block its offsets and
+ *  switches the file into the uncompressed record space, in which offset
+ *  zero is the first tag record.
+ */
+static void finishCompressedHeader (tagFile *const file)
+{
+	off_t frame = tellTagFile (file);
+	off_t start = 0;
+	unsigned long i;
+	for (i = 0  ;  i < file->zip.count  ;  ++i)
+	{
+		tagBlockEntry *const block = file->zip.blocks + i;
+		block->frame = frame;
+		block->start = start;
+		frame += (off_t) block->compressedSize;
+		start += (off_t) block->size;
+	}
+	file->zip.totalSize = start;
+	file->zip.loaded = file->zip.count;
+	file->zip.compressed = 1;
+	file->offset = 0;
+}
+
+#endif
+
 static void readPseudoTags (tagFile *const file, tagFileInfo *const info)
 {
-	fpos_t startOfLine;
+	off_t startOfLine;
 	const size_t prefixLength = strlen (PseudoTagPrefix);
 	if (info != NULL)
 	{
@@ -383,11 +776,29 @@ static void readPseudoTags (tagFile *const file, tagFileInfo *const info)
 	}
 	while (1)
 	{
-		fgetpos (file->fp, &startOfLine);
+		startOfLine = tellTagFile (file);
 		if (! readTagLine (file))
 			break;
 		if (strncmp (file->line.buffer, PseudoTagPrefix, prefixLength) != 0)
 			break;
+#ifdef HAVE_ZLIB_H
+		else if (strncmp (file->line.buffer, "!_TAG_BLOCK\t", 12) == 0)
+			addTagBlock (file, file->line.buffer);
+		else if (strncmp (file->line.buffer, "!_TAG_COMPRESSED\t", 17) == 0)
+		{
+			/*  The compressed frames follow this line; stop before reading
+			 *  into them.
+			 */
+			finishCompressedHeader (file);
+			return;
+		}
+#else
+		else if (strncmp (file->line.buffer, "!_TAG_COMPRESSED\t", 17) == 0)
+		{
+			file->zip.unsupported = 1;
+			return;
+		}
+#endif
 		else
 		{
 			tagEntry entry;
@@ -418,25 +829,200 @@ static void readPseudoTags (tagFile *const file, tagFileInfo *const info)
 			}
 		}
 	}
-	fsetpos (file->fp, &startOfLine);
+	seekTagFile (file, startOfLine);
 }
 
 static void gotoFirstLogicalTag (tagFile *const file)
 {
-	fpos_t startOfLine;
+	off_t startOfLine;
 	const size_t prefixLength = strlen (PseudoTagPrefix);
-	rewind (file->fp);
+	seekTagFile (file, (off_t) 0);
 	while (1)
 	{
-		fgetpos (file->fp, &startOfLine);
+		startOfLine = tellTagFile (file);
 		if (! readTagLine (file))
 			break;
 		if (strncmp (file->line.buffer, PseudoTagPrefix, prefixLength) != 0)
 			break;
 	}
-	fsetpos (file->fp, &startOfLine);
+	seekTagFile (file, startOfLine);
+}
+
+/*  Attempts to load the binary index accompanying the tag file. A missing
+ *  index, or one whose header does not match the tag file (wrong magic or
+ *  version, or recorded for a tag file of a different size), is silently
+ *  ignored and searches proceed as if no index existed.
+ */
+/*  Returns the name of the binary index accompanying the tag file named
+ *  `filePath', in a buffer which the caller must free, or NULL if the name
+ *  cannot be allocated.
+ */
+static char *indexFilePath (const char *const filePath)
+{
+	char *const result = (char*) malloc (
+			strlen (filePath) + strlen (TAG_INDEX_SUFFIX) + 1);
+	if (result != NULL)
+		sprintf (result, "%s%s", filePath, TAG_INDEX_SUFFIX);
+	return result;
+}
+
+static void loadTagIndex (tagFile *const file, const char *const filePath)
+{
+	char *const indexPath = indexFilePath (filePath);
+	if (indexPath != NULL)
+	{
+		FILE *const fp = fopen (indexPath, "rb");
+		if (fp != NULL)
+		{
+			char magic [sizeof TAG_INDEX_MAGIC - 1];
+			unsigned long header [3];
+			if (fread (magic, sizeof magic, (size_t) 1, fp) == 1  &&
+				memcmp (magic, TAG_INDEX_MAGIC, sizeof magic) == 0  &&
+				fread (header, sizeof header [0], (size_t) 3, fp) == 3  &&
+				header [0] == (unsigned long) TAG_INDEX_VERSION  &&
+				header [1] == (unsigned long) file->size  &&
+				header [2] > 0)
+			{
+				tagIndexEntry *const table = (tagIndexEntry*) malloc (
+						(size_t) header [2] * sizeof (tagIndexEntry));
+				if (table != NULL)
+				{
+					if (fread (table, sizeof (tagIndexEntry),
+							   (size_t) header [2], fp) == (size_t) header [2])
+					{
+						file->index.count = header [2];
+						file->index.table = table;
+					}
+					else
+						free (table);
+				}
+			}
+			fclose (fp);
+		}
+		free (indexPath);
+	}
+}
+
+/*  Returns the name of the trigram index accompanying the tag file named
+ *  `filePath', in a buffer which the caller must free, or NULL if the name
+ *  cannot be allocated.
+ */
+static char *trigramFilePath (const char *const filePath)
+{
+	char *const result = (char*) malloc (
+			strlen (filePath) + strlen (TAG_TRIGRAM_SUFFIX) + 1);
+	if (result != NULL)
+		sprintf (result, "%s%s", filePath, TAG_TRIGRAM_SUFFIX);
+	return result;
+}
+
+/*  Attempts to load the trigram index accompanying the tag file, under the
+ *  same rules as loadTagIndex(): a missing index, or one whose header does
+ *  not match the tag file, is silently ignored and substring searches
+ *  proceed sequentially.
+ */
+static void loadTrigramIndex (tagFile *const file, const char *const filePath)
+{
+	char *const indexPath = trigramFilePath (filePath);
+	if (indexPath != NULL)
+	{
+		FILE *const fp = fopen (indexPath, "rb");
+		if (fp != NULL)
+		{
+			char magic [sizeof TAG_TRIGRAM_MAGIC - 1];
+			unsigned long header [3];
+			if (fread (magic, sizeof magic, (size_t) 1, fp) == 1  &&
+				memcmp (magic, TAG_TRIGRAM_MAGIC, sizeof magic) == 0  &&
+				fread (header, sizeof header [0], (size_t) 3, fp) == 3  &&
+				header [0] == (unsigned long) TAG_TRIGRAM_VERSION  &&
+				header [1] == (unsigned long) file->size  &&
+				header [2] > 0)
+			{
+				tagTrigramEntry *const table = (tagTrigramEntry*) malloc (
+						(size_t) header [2] * sizeof (tagTrigramEntry));
+				if (table != NULL)
+				{
+					if (fread (table, sizeof (tagTrigramEntry),
+							   (size_t) header [2], fp) == (size_t) header [2])
+					{
+						file->trigrams.count = header [2];
+						file->trigrams.table = table;
+					}
+					else
+						free (table);
+				}
+			}
+			fclose (fp);
+		}
+		free (indexPath);
+	}
+}
+
+/*  Returns the name of the per-file section map accompanying the tag file
+ *  named `filePath', in a buffer which the caller must free, or NULL if the
+ *  name cannot be allocated.
+ */
+static char *fileMapPath (const char *const filePath)
+{
+	char *const result = (char*) malloc (
+			strlen (filePath) + strlen (TAG_FILEMAP_SUFFIX) + 1);
+	if (result != NULL)
+		sprintf (result, "%s%s", filePath, TAG_FILEMAP_SUFFIX);
+	return result;
+}
+
+/*  Attempts to load the per-file section map accompanying the tag file,
+ *  under the same rules as loadTagIndex(): a missing map, or one whose
+ *  header does not match the tag file, is silently ignored and file-scoped
+ *  searches proceed sequentially. The entries are variable length, so the
+ *  image is kept as stored and walked entry by entry when searched.
+ */
+static void loadFileMap (tagFile *const file, const char *const filePath)
+{
+	char *const mapPath = fileMapPath (filePath);
+	if (mapPath != NULL)
+	{
+		FILE *const fp = fopen (mapPath, "rb");
+		if (fp != NULL)
+		{
+			char magic [sizeof TAG_FILEMAP_MAGIC - 1];
+			unsigned long header [3];
+			long dataSize = 0;
+			if (fseek (fp, 0, SEEK_END) == 0)
+				dataSize = ftell (fp) -
+						(long) (sizeof magic + sizeof header);
+			rewind (fp);
+			if (dataSize > 0  &&
+				fread (magic, sizeof magic, (size_t) 1, fp) == 1  &&
+				memcmp (magic, TAG_FILEMAP_MAGIC, sizeof magic) == 0  &&
+				fread (header, sizeof header [0], (size_t) 3, fp) == 3  &&
+				header [0] == (unsigned long) TAG_FILEMAP_VERSION  &&
+				header [1] == (unsigned long) file->size  &&
+				header [2] > 0)
+			{
+				char *const data = (char*) malloc ((size_t) dataSize);
+				if (data != NULL)
+				{
+					if (fread (data, (size_t) 1, (size_t) dataSize,
+							   fp) == (size_t) dataSize)
+					{
+						file->filemap.files = header [2];
+						file->filemap.size = (size_t) dataSize;
+						file->filemap.data = data;
+					}
+					else
+						free (data);
+				}
+			}
+			fclose (fp);
+		}
+		free (mapPath);
+	}
 }
 
+static void terminate (tagFile *const file);
+static void openJournalSegments (tagFile *const file, const char *const filePath);
+
 static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 {
 	tagFile *result = (tagFile*) calloc ((size_t) 1, sizeof (tagFile));
@@ -459,9 +1045,44 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 			fseek (result->fp, 0, SEEK_END);
 			result->size = ftell (result->fp);
 			rewind (result->fp);
+#ifdef HAVE_MMAP
+			if (result->size > 0)
+			{
+				/*  A shared read-only mapping lets every client of the same
+				 *  tag file share one copy of its pages; search probes then
+				 *  touch the mapping directly instead of seeking a stream.
+				 */
+				void *const mapped = mmap (NULL, (size_t) result->size,
+						PROT_READ, MAP_SHARED, fileno (result->fp), (off_t) 0);
+				if (mapped != MAP_FAILED)
+					result->data = (const char*) mapped;
+			}
+#endif
+			loadTagIndex (result, filePath);
+			loadTrigramIndex (result, filePath);
+			loadFileMap (result, filePath);
 			readPseudoTags (result, info);
-			info->status.opened = 1;
-			result->initialized = 1;
+			if (result->zip.unsupported)
+			{
+				/*  The tag file is compressed but support for reading
+				 *  compressed tag files is not compiled in.
+				 */
+				result->initialized = 1;  /* so that terminate() cleans up */
+				terminate (result);
+				result = NULL;
+				info->status.opened = 0;
+				info->status.error_number = EINVAL;
+				info->program.author  = NULL;
+				info->program.name    = NULL;
+				info->program.url     = NULL;
+				info->program.version = NULL;
+			}
+			else
+			{
+				info->status.opened = 1;
+				result->initialized = 1;
+				openJournalSegments (result, filePath);
+			}
 		}
 	}
 	return result;
@@ -469,12 +1090,38 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 
 static void terminate (tagFile *const file)
 {
+#ifdef HAVE_MMAP
+	if (file->data != NULL)
+		munmap ((void*) file->data, (size_t) file->size);
+#endif
 	fclose (file->fp);
 
 	free (file->line.buffer);
 	free (file->name.buffer);
 	free (file->fields.list);
 
+	if (file->index.table != NULL)
+		free (file->index.table);
+
+	if (file->trigrams.table != NULL)
+		free (file->trigrams.table);
+
+	if (file->filemap.data != NULL)
+		free (file->filemap.data);
+
+	if (file->zip.blocks != NULL)
+	{
+		unsigned long i;
+		for (i = 0  ;  i < file->zip.count  ;  ++i)
+			if (file->zip.blocks [i].key != NULL)
+				free (file->zip.blocks [i].key);
+		free (file->zip.blocks);
+	}
+	if (file->zip.buffer != NULL)
+		free (file->zip.buffer);
+	if (file->zip.frame != NULL)
+		free (file->zip.frame);
+
 	if (file->program.author != NULL)
 		free (file->program.author);
 	if (file->program.name != NULL)
@@ -486,11 +1133,115 @@ static void terminate (tagFile *const file)
 	if (file->search.name != NULL)
 		free (file->search.name);
 
+	if (file->journal.layer != NULL)
+	{
+		unsigned long i;
+		for (i = 0  ;  i < file->journal.count  ;  ++i)
+			terminate (file->journal.layer [i]);
+		free (file->journal.layer);
+	}
+	if (file->journal.covered != NULL)
+	{
+		unsigned long i;
+		for (i = 0  ;  i < file->journal.coveredCount  ;  ++i)
+			free (file->journal.covered [i]);
+		free (file->journal.covered);
+	}
+	if (file->journal.searchName != NULL)
+		free (file->journal.searchName);
+
 	memset (file, 0, sizeof (tagFile));
 
 	free (file);
 }
 
+/*  Collects from a journal segment the names of the source files it
+ *  covers, recorded in its !_TAG_JOURNAL_FILE pseudo tags. An unsorted
+ *  segment scatters them among the tag lines, so the whole segment is
+ *  scanned; a segment holds only one run's output and stays small.
+ */
+static void loadJournalCoverage (tagFile *const segment)
+{
+	const size_t prefixLength = 19;  /* strlen ("!_TAG_JOURNAL_FILE\t") */
+
+	seekTagFile (segment, (off_t) 0);
+	while (readTagLine (segment))
+	{
+		if (strncmp (segment->line.buffer, "!_TAG_JOURNAL_FILE\t",
+					 prefixLength) == 0)
+		{
+			const char *const start = segment->line.buffer + prefixLength;
+			const char *const tab = strchr (start, '\t');
+
+			if (tab != NULL)
+			{
+				const size_t length = tab - start;
+				char **const grown = (char**) realloc (
+					segment->journal.covered,
+					(segment->journal.coveredCount + 1) * sizeof (char*));
+				char *name;
+
+				if (grown == NULL)
+					break;
+				segment->journal.covered = grown;
+				name = (char*) malloc (length + 1);
+				if (name == NULL)
+					break;
+				memcpy (name, start, length);
+				name [length] = '\0';
+				grown [segment->journal.coveredCount++] = name;
+			}
+		}
+	}
+	gotoFirstLogicalTag (segment);
+}
+
+/*  Opens the journal segments layered over the tag file, newest first. A
+ *  tag file updated under ctags --journal is left untouched as the base
+ *  of the store; each update writes its output as a numbered segment
+ *  "<path>.jnlN" beside it, naming the source files whose older entries
+ *  it replaces. Lookups consult the segments before the base and
+ *  suppress the replaced entries, so they see the updated store without
+ *  it ever having been rewritten.
+ */
+static void openJournalSegments (tagFile *const file, const char *const filePath)
+{
+	char *const segmentPath = (char*) malloc (strlen (filePath) + 32);
+	unsigned long n;
+
+	if (segmentPath == NULL)
+		return;
+	for (n = 1  ;  ;  ++n)
+	{
+		tagFileInfo segmentInfo;
+		tagFile *segment;
+		tagFile **grown;
+
+		sprintf (segmentPath, "%s.jnl%lu", filePath, n);
+		segment = initialize (segmentPath, &segmentInfo);
+		if (segment == NULL)
+			break;
+		grown = (tagFile**) realloc (file->journal.layer,
+									 n * sizeof (tagFile*));
+		if (grown == NULL)
+		{
+			terminate (segment);
+			break;
+		}
+		/*  Newest first: the latest segment goes to the front. */
+		memmove (grown + 1, grown, (n - 1) * sizeof (tagFile*));
+		grown [0] = segment;
+		file->journal.layer = grown;
+		file->journal.count = n;
+		loadJournalCoverage (segment);
+	}
+	free (segmentPath);
+	/*  Reading begins on the newest segment; every layer is already
+	 *  positioned past its pseudo-tag header.
+	 */
+	file->journal.current = 0;
+}
+
 static tagResult readNext (tagFile *const file, tagEntry *const entry)
 {
 	tagResult result;
@@ -525,7 +1276,7 @@ static const char *readFieldValue (
 static int readTagLineSeek (tagFile *const file, const off_t pos)
 {
 	int result = 0;
-	if (fseek (file->fp, pos, SEEK_SET) == 0)
+	if (seekTagFile (file, pos) == 0)
 	{
 		result = readTagLine (file);  /* read probable partial line */
 		if (pos > 0  &&  result)
@@ -534,62 +1285,255 @@ static int readTagLineSeek (tagFile *const file, const off_t pos)
 	return result;
 }
 
-static int nameComparison (tagFile *const file)
+/*  Compares the name sought against `name' with the comparator selected by
+ *  the current search options.
+ */
+static int compareName (tagFile *const file, const char *const name)
 {
 	int result;
 	if (file->search.ignorecase)
 	{
 		if (file->search.partial)
-			result = strnuppercmp (file->search.name, file->name.buffer,
+			result = strnuppercmp (file->search.name, name,
 					file->search.nameLength);
 		else
-			result = struppercmp (file->search.name, file->name.buffer);
+			result = struppercmp (file->search.name, name);
 	}
 	else
 	{
 		if (file->search.partial)
-			result = strncmp (file->search.name, file->name.buffer,
+			result = strncmp (file->search.name, name,
 					file->search.nameLength);
 		else
-			result = strcmp (file->search.name, file->name.buffer);
+			result = strcmp (file->search.name, name);
 	}
 	return result;
 }
 
-static void findFirstNonMatchBefore (tagFile *const file)
+/*  Compares the name sought against the name field of the line last read.
+ *  The comparison runs on the raw line, temporarily terminated at the end
+ *  of the name field, so the probes of a search need not copy the name
+ *  into a separate buffer.
+ */
+static int nameComparison (tagFile *const file)
 {
-#define JUMP_BACK 512
-	int more_lines;
-	int comp;
-	off_t start = file->pos;
-	off_t pos = start;
-	do
-	{
-		if (pos < (off_t) JUMP_BACK)
-			pos = 0;
-		else
-			pos = pos - JUMP_BACK;
-		more_lines = readTagLineSeek (file, pos);
-		comp = nameComparison (file);
-	} while (more_lines  &&  comp == 0  &&  pos > 0  &&  pos < start);
-}
+	char *const line = file->line.buffer;
+	char *const end = strchr (line, TAB);
+	int result;
 
-static tagResult findFirstMatchBefore (tagFile *const file)
-{
-	tagResult result = TagFailure;
-	int more_lines;
-	off_t start = file->pos;
-	findFirstNonMatchBefore (file);
-	do
+	if (end != NULL)
 	{
-		more_lines = readTagLine (file);
-		if (nameComparison (file) == 0)
-			result = TagSuccess;
-	} while (more_lines  &&  result != TagSuccess  &&  file->pos < start);
+		*end = '\0';
+		result = compareName (file, line);
+		*end = TAB;
+	}
+	else
+		result = compareName (file, line);
 	return result;
 }
 
-static tagResult findBinary (tagFile *const file)
+/*  Does the name field of the line last read contain the name sought?
+ *  Scans the raw line in place, like nameComparison().
+ */
+static int nameContains (tagFile *const file)
+{
+	char *const line = file->line.buffer;
+	char *const end = strchr (line, TAB);
+	const size_t length = file->search.nameLength;
+	const char *name;
+	int found = 0;
+
+	if (end != NULL)
+		*end = '\0';
+	for (name = line  ;  *name != '\0'  ;  ++name)
+	{
+		const int comp = file->search.ignorecase
+				? strnuppercmp (file->search.name, name, length)
+				: strncmp (file->search.name, name, length);
+		if (comp == 0)
+		{
+			found = 1;
+			break;
+		}
+	}
+	if (end != NULL)
+		*end = TAB;
+	return found;
+}
+
+/*  Does the file field of the line last read name the source file sought?
+ *  The field lies between the first and second tabs of the line and is
+ *  compared exactly, as tag file generators record it.
+ */
+static int fileFieldMatches (tagFile *const file)
+{
+	const char *field = strchr (file->line.buffer, TAB);
+	const char *end;
+	size_t length;
+	if (field == NULL)
+		return 0;
+	++field;
+	end = strchr (field, TAB);
+	length = (end != NULL) ? (size_t) (end - field) : strlen (field);
+	return (length == file->search.nameLength  &&
+			strncmp (field, file->search.name, length) == 0);
+}
+
+/*  Does the line last read match the name sought under the current search
+ *  options? Used where records are examined one by one; the sorted and
+ *  indexed searches compare names directly.
+ */
+static int lineMatches (tagFile *const file)
+{
+	if (file->search.fileScoped)
+		return fileFieldMatches (file);
+	return file->search.substring
+			? nameContains (file)
+			: (nameComparison (file) == 0);
+}
+
+/*  Probes the binary index for the next record whose hash matches the name
+ *  sought and whose line actually matches it. Hash collisions and, for
+ *  case-sensitive searches, entries differing only in case are simply
+ *  skipped. Records with equal hashes are stored in tag file order, so
+ *  duplicate tags are found in the order they occur in the tag file.
+ */
+static tagResult findIndex (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	while (result == TagFailure  &&
+		   file->search.indexNext < file->index.count  &&
+		   file->index.table [file->search.indexNext].hash == file->search.hash)
+	{
+		const off_t pos = (off_t)
+				file->index.table [file->search.indexNext].offset;
+		++file->search.indexNext;
+		if (seekTagFile (file, pos) == 0  &&  readTagLineRaw (file)  &&
+			nameComparison (file) == 0)
+			result = TagSuccess;
+	}
+	return result;
+}
+
+/*  Probes the trigram index for the next record actually containing the
+ *  name sought; candidates bearing the selected trigram without containing
+ *  the whole name are simply skipped. Records with equal trigrams are
+ *  stored in tag file order, so matches are found in the order they occur
+ *  in the tag file.
+ */
+static tagResult findTrigram (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	while (result == TagFailure  &&
+		   file->search.trigramNext < file->search.trigramLimit)
+	{
+		const off_t pos = (off_t)
+				file->trigrams.table [file->search.trigramNext].offset;
+		++file->search.trigramNext;
+		if (seekTagFile (file, pos) == 0  &&  readTagLineRaw (file)  &&
+			nameContains (file))
+			result = TagSuccess;
+	}
+	return result;
+}
+
+/*  Steps to the next record of the file map run selected by
+ *  tagsFindByFile(). The offsets are exact, not candidates, so every one
+ *  delivers a line; they are stored unaligned behind the file name, hence
+ *  the memcpy. A short read means the map disagrees with the tag file
+ *  despite its header matching; the search simply ends.
+ */
+static tagResult findFileMap (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	while (result == TagFailure  &&
+		   file->search.fileNext < file->search.fileLimit)
+	{
+		unsigned long offset;
+		memcpy (&offset, file->search.fileOffsets +
+				file->search.fileNext * sizeof offset, sizeof offset);
+		++file->search.fileNext;
+		if (seekTagFile (file, (off_t) offset) == 0  &&  readTagLineRaw (file))
+			result = TagSuccess;
+	}
+	return result;
+}
+
+/*  Locates the run of trigram index records for the rarest trigram of the
+ *  name sought, leaving its bounds in the search state. A tag name which
+ *  contains the sought name bears every one of its trigrams, so any single
+ *  run covers all matches and the shortest yields the fewest candidates.
+ */
+static void selectTrigramRun (tagFile *const file)
+{
+	const char *const name = file->search.name;
+	const size_t length = file->search.nameLength;
+	size_t i;
+
+	file->search.trigramNext = 0;
+	file->search.trigramLimit = 0;
+	for (i = 0  ;  i + 2 < length  ;  ++i)
+	{
+		const unsigned long trigram = packTrigram (name + i);
+		unsigned long lower = 0;
+		unsigned long upper = file->trigrams.count;
+		unsigned long limit;
+		while (lower < upper)
+		{
+			const unsigned long middle = lower + (upper - lower) / 2;
+			if (file->trigrams.table [middle].trigram < trigram)
+				lower = middle + 1;
+			else
+				upper = middle;
+		}
+		for (limit = lower  ;  limit < file->trigrams.count  &&
+				file->trigrams.table [limit].trigram == trigram  ;  ++limit)
+			;
+		if (i == 0  ||  limit - lower <
+				file->search.trigramLimit - file->search.trigramNext)
+		{
+			file->search.trigramNext = lower;
+			file->search.trigramLimit = limit;
+		}
+		if (limit == lower)
+			break;  /* trigram absent from the index; nothing can match */
+	}
+}
+
+static void findFirstNonMatchBefore (tagFile *const file)
+{
+#define JUMP_BACK 512
+	int more_lines;
+	int comp;
+	off_t start = file->pos;
+	off_t pos = start;
+	do
+	{
+		if (pos < (off_t) JUMP_BACK)
+			pos = 0;
+		else
+			pos = pos - JUMP_BACK;
+		more_lines = readTagLineSeek (file, pos);
+		comp = nameComparison (file);
+	} while (more_lines  &&  comp == 0  &&  pos > 0  &&  pos < start);
+}
+
+static tagResult findFirstMatchBefore (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	int more_lines;
+	off_t start = file->pos;
+	findFirstNonMatchBefore (file);
+	do
+	{
+		more_lines = readTagLine (file);
+		if (nameComparison (file) == 0)
+			result = TagSuccess;
+	} while (more_lines  &&  result != TagSuccess  &&  file->pos < start);
+	return result;
+}
+
+static tagResult findBinary (tagFile *const file)
 {
 	tagResult result = TagFailure;
 	off_t lower_limit = 0;
@@ -629,155 +1573,1282 @@ static tagResult findBinary (tagFile *const file)
 				result = findFirstMatchBefore (file);
 		}
 	}
-	return result;
+	return result;
+}
+
+#ifdef HAVE_ZLIB_H
+
+/*  Binary searches the in-memory block index for the block which could hold
+ *  the name sought, and scans the records from its beginning; typically only
+ *  that one frame is inflated. The index names the first tag of each block,
+ *  so the scan starts in the last block whose first tag sorts strictly
+ *  before the name, covering runs of duplicates which straddle a block
+ *  boundary.
+ */
+static tagResult findCompressed (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	unsigned long lower = 0;
+	unsigned long upper = file->zip.count;
+	int more;
+
+	if (upper == 0)
+		return TagFailure;
+	while (lower + 1 < upper)
+	{
+		const unsigned long middle = lower + (upper - lower) / 2;
+		if (compareName (file, file->zip.blocks [middle].key) <= 0)
+			upper = middle;
+		else
+			lower = middle;
+	}
+	seekTagFile (file, file->zip.blocks [lower].start);
+	do
+	{
+		more = readTagLine (file);
+		if (more)
+		{
+			const int comp = nameComparison (file);
+			if (comp == 0)
+				result = TagSuccess;
+			else if (comp < 0)
+				more = 0;  /* records are sorted; the name cannot follow */
+		}
+	} while (more  &&  result != TagSuccess);
+	return result;
+}
+
+#endif
+
+static tagResult findSequential (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	if (file->initialized)
+	{
+		while (result == TagFailure  &&  readTagLine (file))
+		{
+			if (lineMatches (file))
+				result = TagSuccess;
+		}
+	}
+	return result;
+}
+
+static tagResult findInFile (tagFile *const file, tagEntry *const entry,
+							 const char *const name, const int options)
+{
+	tagResult result;
+	if (file->search.name != NULL)
+		free (file->search.name);
+	file->search.name = duplicate (name);
+	file->search.nameLength = strlen (name);
+	file->search.partial = (options & TAG_PARTIALMATCH) != 0;
+	file->search.substring = (options & TAG_SUBSTRINGMATCH) != 0;
+	file->search.ignorecase = (options & TAG_IGNORECASE) != 0;
+	if (file->data == NULL  &&  ! file->zip.compressed)
+	{
+		/*  the stream may have grown since it was opened; a mapped file
+		 *  retains the extent recorded when the mapping was made
+		 */
+		fseek (file->fp, 0, SEEK_END);
+		file->size = ftell (file->fp);
+	}
+	seekTagFile (file, (off_t) 0);
+	file->search.usingIndex = 0;
+	file->search.usingTrigrams = 0;
+	file->search.usingFileMap = 0;
+	file->search.fileScoped = 0;
+	if (file->search.substring)
+	{
+		if (file->trigrams.table != NULL  &&  file->search.nameLength >= 3)
+		{
+			selectTrigramRun (file);
+			file->search.usingTrigrams = 1;
+#ifdef DEBUG
+			printf ("<performing trigram search>\n");
+#endif
+			result = findTrigram (file);
+		}
+		else
+		{
+#ifdef DEBUG
+			printf ("<performing sequential search>\n");
+#endif
+			result = findSequential (file);
+		}
+	}
+	else if (file->index.table != NULL  &&  ! file->search.partial)
+	{
+		/*  Locate the first index record bearing the hash of the name
+		 *  sought; findIndex() walks the run of equal hashes from there.
+		 */
+		unsigned long lower = 0;
+		unsigned long upper = file->index.count;
+		file->search.hash = tagsHashName (name);
+		while (lower < upper)
+		{
+			const unsigned long middle = lower + (upper - lower) / 2;
+			if (file->index.table [middle].hash < file->search.hash)
+				lower = middle + 1;
+			else
+				upper = middle;
+		}
+		file->search.indexNext = lower;
+		file->search.usingIndex = 1;
+#ifdef DEBUG
+		printf ("<performing indexed search>\n");
+#endif
+		result = findIndex (file);
+	}
+	else if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
+	{
+#ifdef HAVE_ZLIB_H
+		if (file->zip.compressed)
+		{
+# ifdef DEBUG
+			printf ("<performing block index search>\n");
+# endif
+			result = findCompressed (file);
+		}
+		else
+#endif
+		{
+#ifdef DEBUG
+			printf ("<performing binary search>\n");
+#endif
+			result = findBinary (file);
+		}
+	}
+	else
+	{
+#ifdef DEBUG
+		printf ("<performing sequential search>\n");
+#endif
+		result = findSequential (file);
+	}
+
+	if (result != TagSuccess)
+		file->search.pos = file->size;
+	else
+	{
+		file->search.pos = file->pos;
+		if (entry != NULL)
+			parseTagLine (file, entry);
+	}
+	return result;
+}
+
+/*  Begins a search for the tags of the source file named `fileName'. When
+ *  the per-file section map is present its run of record offsets drives the
+ *  search; a source file absent from a current map has no tags, so the
+ *  search ends at once. Without a map every record is scanned and its file
+ *  field compared.
+ */
+static tagResult findByFileInFile (tagFile *const file, tagEntry *const entry,
+								   const char *const fileName)
+{
+	tagResult result;
+	if (file->search.name != NULL)
+		free (file->search.name);
+	file->search.name = duplicate (fileName);
+	file->search.nameLength = strlen (fileName);
+	file->search.partial = 0;
+	file->search.substring = 0;
+	file->search.ignorecase = 0;
+	if (file->data == NULL  &&  ! file->zip.compressed)
+	{
+		fseek (file->fp, 0, SEEK_END);
+		file->size = ftell (file->fp);
+	}
+	seekTagFile (file, (off_t) 0);
+	file->search.usingIndex = 0;
+	file->search.usingTrigrams = 0;
+	file->search.usingFileMap = 0;
+	file->search.fileScoped = 1;
+	if (file->filemap.data != NULL)
+	{
+		const char *p = file->filemap.data;
+		const char *const limit = file->filemap.data + file->filemap.size;
+		unsigned long i;
+
+		file->search.usingFileMap = 1;
+		file->search.fileNext = 0;
+		file->search.fileLimit = 0;
+		for (i = 0  ;  i < file->filemap.files  &&  p < limit  ;  ++i)
+		{
+			const size_t nameLength = strlen (p);
+			unsigned long count;
+			const char *const offsets = p + nameLength + 1 + sizeof count;
+			const int comparison = strcmp (p, fileName);
+			memcpy (&count, p + nameLength + 1, sizeof count);
+			if (comparison == 0)
+			{
+				file->search.fileOffsets = offsets;
+				file->search.fileLimit = count;
+				break;
+			}
+			else if (comparison > 0)
+				break;  /* entries are in name order; the file is absent */
+			p = offsets + count * sizeof (unsigned long);
+		}
+		result = findFileMap (file);
+	}
+	else
+		result = findSequential (file);
+
+	if (result != TagSuccess)
+		file->search.pos = file->size;
+	else
+	{
+		file->search.pos = file->pos;
+		if (entry != NULL)
+			parseTagLine (file, entry);
+	}
+	return result;
+}
+
+static tagResult findNextInFile (tagFile *const file, tagEntry *const entry)
+{
+	tagResult result;
+	if (file->search.usingFileMap)
+	{
+		result = findFileMap (file);
+		if (result == TagSuccess  &&  entry != NULL)
+			parseTagLine (file, entry);
+	}
+	else if (file->search.fileScoped)
+	{
+		result = findSequential (file);
+		if (result == TagSuccess  &&  entry != NULL)
+			parseTagLine (file, entry);
+	}
+	else if (file->search.usingTrigrams)
+	{
+		result = findTrigram (file);
+		if (result == TagSuccess  &&  entry != NULL)
+			parseTagLine (file, entry);
+	}
+	else if (file->search.substring)
+	{
+		result = findSequential (file);
+		if (result == TagSuccess  &&  entry != NULL)
+			parseTagLine (file, entry);
+	}
+	else if (file->search.usingIndex)
+	{
+		result = findIndex (file);
+		if (result == TagSuccess  &&  entry != NULL)
+			parseTagLine (file, entry);
+	}
+	else if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
+	{
+		result = readNext (file, entry);
+		if (result == TagSuccess  && nameComparison (file) != 0)
+			result = TagFailure;
+	}
+	else
+	{
+		result = findSequential (file);
+		if (result == TagSuccess  &&  entry != NULL)
+			parseTagLine (file, entry);
+	}
+	return result;
+}
+
+/*
+*  Journal layering
+*
+*  A tag file with journal segments answers every read from its layers,
+*  newest segment first and the base file last. An entry is suppressed
+*  when a newer segment names its source file among the files it covers;
+*  the segment's own entries for the file, if any, have already been
+*  offered by then.
+*/
+
+/*  Locates the file field of the line just read on `h', returning its
+ *  length; the field is not NUL terminated within the line.
+ */
+static size_t lineFileField (const char *const line, const char **const field)
+{
+	const char *const tab1 = strchr (line, '\t');
+	const char *tab2;
+	size_t length = 0;
+
+	*field = NULL;
+	if (tab1 != NULL)
+	{
+		*field = tab1 + 1;
+		tab2 = strchr (*field, '\t');
+		if (tab2 != NULL)
+			length = tab2 - *field;
+		else
+		{
+			length = strlen (*field);
+			if (length > 0  &&  (*field) [length - 1] == '\n')
+				--length;
+		}
+	}
+	return length;
+}
+
+static int segmentCovers (tagFile *const segment,
+						  const char *const name, const size_t length)
+{
+	unsigned long i;
+
+	for (i = 0  ;  i < segment->journal.coveredCount  ;  ++i)
+	{
+		const char *const covered = segment->journal.covered [i];
+
+		if (strncmp (covered, name, length) == 0  &&
+			covered [length] == '\0')
+			return 1;
+	}
+	return 0;
+}
+
+/*  Tests whether the line just read on layer `h' is superseded from the
+ *  point of view of the layered file: a pseudo tag of a layer is never
+ *  an entry, and a tag line is hidden when any layer newer than `layer'
+ *  covers its source file.
+ */
+static int journalHidden (tagFile *const file, const unsigned long layer,
+						  tagFile *const h)
+{
+	const char *field;
+	size_t length;
+	unsigned long i;
+
+	if (strncmp (h->line.buffer, PseudoTagPrefix, 2) == 0)
+		return 1;
+	length = lineFileField (h->line.buffer, &field);
+	if (field == NULL)
+		return 0;
+	for (i = 0  ;  i < layer  ;  ++i)
+		if (segmentCovers (file->journal.layer [i], field, length))
+			return 1;
+	return 0;
+}
+
+/*  Copies the line just read on a segment into the layered file's own
+ *  buffers, so that parsing and the caller's later field references find
+ *  it where every other path leaves it.
+ */
+static void adoptLayerLine (tagFile *const file, tagFile *const h)
+{
+	size_t length;
+
+	if (h == file)
+		return;
+	length = strlen (h->line.buffer);
+	while (length + 1 > file->line.size)
+		if (! growString (&file->line))
+			return;
+	strcpy (file->line.buffer, h->line.buffer);
+	copyName (file);
+}
+
+/*  Advances a layered search to its next visible match. `fresh' starts
+ *  the search anew on the current layer; exhausting a layer moves on to
+ *  the next older one, the base file being the oldest. A file-scoped
+ *  search stays on its one layer, which wholly supersedes the others for
+ *  the file sought.
+ */
+static tagResult journalSearch (tagFile *const file, tagEntry *const entry,
+								int fresh)
+{
+	while (1)
+	{
+		tagFile *const h = (file->journal.current < file->journal.count)
+				? file->journal.layer [file->journal.current] : file;
+		tagResult result;
+
+		if (fresh  &&  ! file->journal.fileScoped)
+			result = findInFile (h, NULL, file->journal.searchName,
+								 file->journal.searchOptions);
+		else
+			result = findNextInFile (h, NULL);
+		if (result != TagSuccess)
+		{
+			if (file->journal.fileScoped  ||
+				file->journal.current == file->journal.count)
+				return TagFailure;
+			++file->journal.current;
+			fresh = 1;
+			continue;
+		}
+		fresh = 0;
+		if (file->journal.fileScoped)
+		{
+			if (strncmp (h->line.buffer, PseudoTagPrefix, 2) == 0)
+				continue;
+		}
+		else if (journalHidden (file, file->journal.current, h))
+			continue;
+		adoptLayerLine (file, h);
+		if (entry != NULL)
+			parseTagLine (file, entry);
+		return TagSuccess;
+	}
+}
+
+static tagResult journalFind (tagFile *const file, tagEntry *const entry,
+							  const char *const name, const int options)
+{
+	if (file->journal.searchName != NULL)
+		free (file->journal.searchName);
+	file->journal.searchName = duplicate (name);
+	file->journal.searchOptions = options;
+	file->journal.fileScoped = 0;
+	file->journal.current = 0;
+	return journalSearch (file, entry, 1);
+}
+
+static tagResult journalFindByFile (tagFile *const file, tagEntry *const entry,
+									const char *const fileName)
+{
+	tagFile *h = file;
+	tagResult result;
+	unsigned long i;
+
+	file->journal.fileScoped = 1;
+	file->journal.current = file->journal.count;
+	for (i = 0  ;  i < file->journal.count  ;  ++i)
+	{
+		if (segmentCovers (file->journal.layer [i], fileName,
+						   strlen (fileName)))
+		{
+			/*  The newest covering segment holds all of the file's
+			 *  current entries; the older layers are wholly superseded,
+			 *  even when this segment records none (the file no longer
+			 *  defines any tags).
+			 */
+			h = file->journal.layer [i];
+			file->journal.current = i;
+			break;
+		}
+	}
+	result = findByFileInFile (h, NULL, fileName);
+	while (result == TagSuccess  &&
+		   strncmp (h->line.buffer, PseudoTagPrefix, 2) == 0)
+		result = findNextInFile (h, NULL);
+	if (result == TagSuccess)
+	{
+		adoptLayerLine (file, h);
+		if (entry != NULL)
+			parseTagLine (file, entry);
+	}
+	return result;
+}
+
+static tagResult find (tagFile *const file, tagEntry *const entry,
+					   const char *const name, const int options)
+{
+	if (file->journal.count > 0)
+		return journalFind (file, entry, name, options);
+	return findInFile (file, entry, name, options);
+}
+
+static tagResult findNext (tagFile *const file, tagEntry *const entry)
+{
+	if (file->journal.count > 0)
+		return journalSearch (file, entry, 0);
+	return findNextInFile (file, entry);
+}
+
+static tagResult findByFile (tagFile *const file, tagEntry *const entry,
+							 const char *const fileName)
+{
+	if (file->journal.count > 0)
+		return journalFindByFile (file, entry, fileName);
+	return findByFileInFile (file, entry, fileName);
+}
+
+static tagResult journalReadNext (tagFile *const file, tagEntry *const entry)
+{
+	while (1)
+	{
+		tagFile *const h = (file->journal.current < file->journal.count)
+				? file->journal.layer [file->journal.current] : file;
+
+		if (! readTagLine (h))
+		{
+			if (file->journal.current == file->journal.count)
+				return TagFailure;
+			++file->journal.current;
+			gotoFirstLogicalTag (
+				(file->journal.current < file->journal.count)
+					? file->journal.layer [file->journal.current] : file);
+			continue;
+		}
+		if (journalHidden (file, file->journal.current, h))
+			continue;
+		adoptLayerLine (file, h);
+		if (entry != NULL)
+			parseTagLine (file, entry);
+		return TagSuccess;
+	}
+}
+
+/*  Starts a layered read over the segments and the base file: the
+ *  segments come first, newest to oldest, then the still visible part of
+ *  the base.
+ */
+static tagResult journalFirst (tagFile *const file, tagEntry *const entry)
+{
+	file->journal.current = 0;
+	gotoFirstLogicalTag (file->journal.layer [0]);
+	return journalReadNext (file, entry);
+}
+
+/*
+*  EXTERNAL INTERFACE
+*/
+
+extern tagFile *tagsOpen (const char *const filePath, tagFileInfo *const info)
+{
+	return initialize (filePath, info);
+}
+
+extern tagResult tagsSetSortType (tagFile *const file, const sortType type)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+	{
+		file->sortMethod = type;
+		result = TagSuccess;
+	}
+	return result;
+}
+
+extern tagResult tagsFirst (tagFile *const file, tagEntry *const entry)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+	{
+		if (file->journal.count > 0)
+			result = journalFirst (file, entry);
+		else
+		{
+			gotoFirstLogicalTag (file);
+			result = readNext (file, entry);
+		}
+	}
+	return result;
+}
+
+extern tagResult tagsNext (tagFile *const file, tagEntry *const entry)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+	{
+		if (file->journal.count > 0)
+			result = journalReadNext (file, entry);
+		else
+			result = readNext (file, entry);
+	}
+	return result;
+}
+
+extern const char *tagsField (const tagEntry *const entry, const char *const key)
+{
+	const char *result = NULL;
+	if (entry != NULL)
+		result = readFieldValue (entry, key);
+	return result;
+}
+
+extern tagResult tagsFind (tagFile *const file, tagEntry *const entry,
+						   const char *const name, const int options)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+		result = find (file, entry, name, options);
+	return result;
+}
+
+extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+		result = findNext (file, entry);
+	return result;
+}
+
+extern tagResult tagsFindByFile (tagFile *const file, tagEntry *const entry,
+								 const char *const fileName)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+		result = findByFile (file, entry, fileName);
+	return result;
+}
+
+/*  Rounds an arena offset up so that the next allocation is suitably
+ *  aligned for a structure holding pointers.
+ */
+static size_t alignArena (const size_t used)
+{
+	const size_t alignment = sizeof (void*);
+	return used + (alignment - used % alignment) % alignment;
+}
+
+/*  Copies a string into the arena, returning its new location or NULL if the
+ *  arena is full.
+ */
+static char *arenaString (tagArena *const arena, const char *const string)
+{
+	char *result = NULL;
+	const size_t length = strlen (string) + 1;
+	if (arena->size - arena->used >= length)
+	{
+		result = arena->buffer + arena->used;
+		memcpy (result, string, length);
+		arena->used += length;
+	}
+	return result;
+}
+
+/*  Copies `source', whose strings live in the tag file's line buffer, into
+ *  `dest' with every string and the extension field list relocated into the
+ *  arena. Returns 1 upon success; upon failure the arena is restored to its
+ *  previous state and 0 is returned.
+ */
+static int arenaEntry (tagArena *const arena, tagEntry *const dest,
+					   const tagEntry *const source)
+{
+	int result = 1;
+	const size_t saved = arena->used;
+
+	dest->name = arenaString (arena, source->name);
+	dest->file = arenaString (arena, source->file);
+	dest->address.pattern = (source->address.pattern == NULL) ? NULL :
+			arenaString (arena, source->address.pattern);
+	dest->address.lineNumber = source->address.lineNumber;
+	dest->kind = (source->kind == NULL) ? NULL :
+			arenaString (arena, source->kind);
+	dest->fileScope = source->fileScope;
+	dest->fields.count = source->fields.count;
+	dest->fields.list = NULL;
+
+	if (dest->name == NULL  ||  dest->file == NULL  ||
+		(source->address.pattern != NULL  &&  dest->address.pattern == NULL) ||
+		(source->kind != NULL  &&  dest->kind == NULL))
+		result = 0;
+	else if (source->fields.count > 0)
+	{
+		const size_t aligned = alignArena (arena->used);
+		const size_t needed =
+				source->fields.count * sizeof (tagExtensionField);
+		if (aligned > arena->size  ||  arena->size - aligned < needed)
+			result = 0;
+		else
+		{
+			unsigned short i;
+			arena->used = aligned + needed;
+			dest->fields.list = (tagExtensionField*) (arena->buffer + aligned);
+			for (i = 0  ;  i < source->fields.count  &&  result  ;  ++i)
+			{
+				dest->fields.list [i].key =
+						arenaString (arena, source->fields.list [i].key);
+				dest->fields.list [i].value =
+						arenaString (arena, source->fields.list [i].value);
+				if (dest->fields.list [i].key == NULL  ||
+					dest->fields.list [i].value == NULL)
+					result = 0;
+			}
+		}
+	}
+	if (! result)
+		arena->used = saved;
+	return result;
+}
+
+extern tagResult tagsFindPrefix (tagFile *const file, const char *const prefix,
+								 const int options, tagArena *const arena)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized  &&  arena != NULL)
+	{
+		int full = 0;
+		tagResult match;
+		arena->matches = 0;
+		arena->stored = 0;
+		arena->used = 0;
+		match = find (file, NULL, prefix, options | TAG_PARTIALMATCH);
+		while (match == TagSuccess)
+		{
+			++arena->matches;
+			if (! full  &&  arena->stored < arena->maxEntries)
+			{
+				tagEntry parsed;
+				parseTagLine (file, &parsed);
+				if (arenaEntry (arena, arena->entries + arena->stored,
+								&parsed))
+					++arena->stored;
+				else
+					full = 1;
+			}
+			match = findNext (file, NULL);
+		}
+		if (arena->matches > 0)
+			result = TagSuccess;
+	}
+	return result;
+}
+
+extern tagResult tagsClose (tagFile *const file)
+{
+	tagResult result = TagFailure;
+	if (file != NULL  &&  file->initialized)
+	{
+		terminate (file);
+		result = TagSuccess;
+	}
+	return result;
+}
+
+/* Number of validated tag file handles kept open between queries. */
+#define MAX_CACHED_HANDLES 8
+
+typedef struct {
+		/* path the handle was opened for, or NULL if the slot is empty */
+	char *path;
+		/* the open handle */
+	tagFile *file;
+		/* identity of the tag file when the handle was opened */
+	time_t mtime;
+	off_t size;
+		/* is the handle currently lent out to a caller? */
+	short inUse;
+		/* logical time of the last lookup, for least-recently-used eviction */
+	unsigned long stamp;
+} cachedFile;
+
+static cachedFile HandleCache [MAX_CACHED_HANDLES];
+static unsigned long HandleCacheClock;
+
+/*  Fills `info' from an already open handle, as tagsOpen() would have done
+ *  by reading the pseudo tag header.
+ */
+static void describeCachedFile (tagFile *const file, tagFileInfo *const info)
+{
+	if (info != NULL)
+	{
+		info->status.opened = 1;
+		info->status.error_number = 0;
+		info->file.format = file->format;
+		info->file.sort = file->sortMethod;
+		info->program.author = file->program.author;
+		info->program.name = file->program.name;
+		info->program.url = file->program.url;
+		info->program.version = file->program.version;
+	}
+}
+
+static void dropCachedFile (cachedFile *const slot)
+{
+	if (slot->file != NULL)
+		tagsClose (slot->file);
+	if (slot->path != NULL)
+		free (slot->path);
+	memset (slot, 0, sizeof (cachedFile));
+}
+
+extern tagFile *tagsOpenCached (const char *const filePath, tagFileInfo *const info)
+{
+	struct stat status;
+	cachedFile *slot = NULL;
+	cachedFile *room = NULL;
+	tagFile *file;
+	int i;
+
+	for (i = 0  ;  i < MAX_CACHED_HANDLES  ;  ++i)
+	{
+		cachedFile *const candidate = HandleCache + i;
+		if (candidate->path != NULL  &&
+			strcmp (candidate->path, filePath) == 0)
+			slot = candidate;
+		else if (candidate->path == NULL)
+		{
+			if (room == NULL  ||  room->path != NULL)
+				room = candidate;
+		}
+		else if (! candidate->inUse  &&
+				 (room == NULL  ||
+				  (room->path != NULL  &&  candidate->stamp < room->stamp)))
+			room = candidate;
+	}
+	if (stat (filePath, &status) != 0)
+	{
+		/*  Whatever was cached describes a file which no longer exists. */
+		if (slot != NULL  &&  ! slot->inUse)
+			dropCachedFile (slot);
+		return tagsOpen (filePath, info);
+	}
+	if (slot != NULL)
+	{
+		if (slot->inUse)
+		{
+			/*  The cached handle, with its cursor and search state, is
+			 *  already lent out; a second client gets a private one.
+			 */
+			return tagsOpen (filePath, info);
+		}
+		if (slot->mtime == status.st_mtime  &&  slot->size == status.st_size)
+		{
+			slot->inUse = 1;
+			slot->stamp = ++HandleCacheClock;
+			describeCachedFile (slot->file, info);
+			return slot->file;
+		}
+		dropCachedFile (slot);
+		room = slot;
+	}
+	file = tagsOpen (filePath, info);
+	if (file != NULL  &&  room != NULL)
+	{
+		if (room->path != NULL)
+			dropCachedFile (room);
+		room->path = duplicate (filePath);
+		if (room->path != NULL)
+		{
+			room->file = file;
+			room->mtime = status.st_mtime;
+			room->size = status.st_size;
+			room->inUse = 1;
+			room->stamp = ++HandleCacheClock;
+		}
+	}
+	return file;
 }
 
-static tagResult findSequential (tagFile *const file)
+extern tagResult tagsCloseCached (tagFile *const file)
 {
-	tagResult result = TagFailure;
-	if (file->initialized)
-	{
-		while (result == TagFailure  &&  readTagLine (file))
+	int i;
+
+	if (file == NULL)
+		return TagFailure;
+	for (i = 0  ;  i < MAX_CACHED_HANDLES  ;  ++i)
+		if (HandleCache [i].file == file)
 		{
-			if (nameComparison (file) == 0)
-				result = TagSuccess;
+			HandleCache [i].inUse = 0;
+			return TagSuccess;
 		}
-	}
-	return result;
+	return tagsClose (file);
 }
 
-static tagResult find (tagFile *const file, tagEntry *const entry,
-					   const char *const name, const int options)
+extern void tagsFlushCache (void)
 {
-	tagResult result;
-	if (file->search.name != NULL)
-		free (file->search.name);
-	file->search.name = duplicate (name);
-	file->search.nameLength = strlen (name);
-	file->search.partial = (options & TAG_PARTIALMATCH) != 0;
-	file->search.ignorecase = (options & TAG_IGNORECASE) != 0;
-	fseek (file->fp, 0, SEEK_END);
-	file->size = ftell (file->fp);
-	rewind (file->fp);
-	if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
-		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
-	{
-#ifdef DEBUG
-		printf ("<performing binary search>\n");
-#endif
-		result = findBinary (file);
-	}
-	else
-	{
-#ifdef DEBUG
-		printf ("<performing sequential search>\n");
-#endif
-		result = findSequential (file);
-	}
+	int i;
 
-	if (result != TagSuccess)
-		file->search.pos = file->size;
+	for (i = 0  ;  i < MAX_CACHED_HANDLES  ;  ++i)
+		if (HandleCache [i].path != NULL  &&  ! HandleCache [i].inUse)
+			dropCachedFile (HandleCache + i);
+}
+
+static int compareIndexEntries (const void *const one, const void *const two)
+{
+	const tagIndexEntry *const a = (const tagIndexEntry*) one;
+	const tagIndexEntry *const b = (const tagIndexEntry*) two;
+	int result;
+	if (a->hash != b->hash)
+		result = (a->hash < b->hash) ? -1 : 1;
+	else if (a->offset != b->offset)
+		result = (a->offset < b->offset) ? -1 : 1;
 	else
-	{
-		file->search.pos = file->pos;
-		if (entry != NULL)
-			parseTagLine (file, entry);
-	}
+		result = 0;
 	return result;
 }
 
-static tagResult findNext (tagFile *const file, tagEntry *const entry)
+extern int tagsWriteIndex (const char *const tagFilePath)
 {
-	tagResult result;
-	if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
-		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
-	{
-		result = tagsNext (file, entry);
-		if (result == TagSuccess  && nameComparison (file) != 0)
-			result = TagFailure;
-	}
-	else
+	int result = 0;
+	tagFileInfo info;
+	tagFile *const file = initialize (tagFilePath, &info);
+	if (file != NULL)
 	{
-		result = findSequential (file);
-		if (result == TagSuccess  &&  entry != NULL)
-			parseTagLine (file, entry);
+		const size_t prefixLength = strlen (PseudoTagPrefix);
+		unsigned long allocated = 256;
+		unsigned long count = 0;
+		tagIndexEntry *table = (tagIndexEntry*) malloc (
+				allocated * sizeof (tagIndexEntry));
+		if (table == NULL)
+			perror ("cannot allocate tag index");
+		else
+		{
+			char *indexPath;
+			off_t offset;
+			seekTagFile (file, (off_t) 0);
+			while (offset = tellTagFile (file), readTagLineRaw (file))
+			{
+				copyName (file);
+				if (file->name.buffer [0] == '\0'  ||
+					strncmp (file->line.buffer, PseudoTagPrefix,
+							 prefixLength) == 0)
+					continue;
+				if (count == allocated)
+				{
+					tagIndexEntry *const newTable = (tagIndexEntry*) realloc (
+							table, 2 * allocated * sizeof (tagIndexEntry));
+					if (newTable == NULL)
+					{
+						perror ("cannot allocate tag index");
+						break;
+					}
+					table = newTable;
+					allocated *= 2;
+				}
+				table [count].hash = tagsHashName (file->name.buffer);
+				table [count].offset = (unsigned long) offset;
+				++count;
+			}
+			qsort (table, (size_t) count, sizeof (tagIndexEntry),
+				   compareIndexEntries);
+			indexPath = indexFilePath (tagFilePath);
+			if (indexPath != NULL)
+			{
+				FILE *const fp = fopen (indexPath, "wb");
+				if (fp != NULL)
+				{
+					unsigned long header [3];
+					header [0] = (unsigned long) TAG_INDEX_VERSION;
+					header [1] = (unsigned long) file->size;
+					header [2] = count;
+					if (fwrite (TAG_INDEX_MAGIC, sizeof TAG_INDEX_MAGIC - 1,
+								(size_t) 1, fp) == 1  &&
+						fwrite (header, sizeof header [0], (size_t) 3,
+								fp) == 3  &&
+						fwrite (table, sizeof (tagIndexEntry), (size_t) count,
+								fp) == (size_t) count)
+						result = 1;
+					fclose (fp);
+					if (! result)
+						remove (indexPath);
+				}
+				free (indexPath);
+			}
+			free (table);
+		}
+		tagsClose (file);
 	}
 	return result;
 }
 
-/*
-*  EXTERNAL INTERFACE
-*/
-
-extern tagFile *tagsOpen (const char *const filePath, tagFileInfo *const info)
+extern void tagsRemoveIndex (const char *const tagFilePath)
 {
-	return initialize (filePath, info);
+	char *const indexPath = indexFilePath (tagFilePath);
+	if (indexPath != NULL)
+	{
+		remove (indexPath);
+		free (indexPath);
+	}
 }
 
-extern tagResult tagsSetSortType (tagFile *const file, const sortType type)
+static int compareTrigramEntries (const void *const one, const void *const two)
 {
-	tagResult result = TagFailure;
-	if (file != NULL  &&  file->initialized)
-	{
-		file->sortMethod = type;
-		result = TagSuccess;
-	}
+	const tagTrigramEntry *const a = (const tagTrigramEntry*) one;
+	const tagTrigramEntry *const b = (const tagTrigramEntry*) two;
+	int result;
+	if (a->trigram != b->trigram)
+		result = (a->trigram < b->trigram) ? -1 : 1;
+	else if (a->offset != b->offset)
+		result = (a->offset < b->offset) ? -1 : 1;
+	else
+		result = 0;
 	return result;
 }
 
-extern tagResult tagsFirst (tagFile *const file, tagEntry *const entry)
+extern int tagsWriteTrigramIndex (const char *const tagFilePath)
 {
-	tagResult result = TagFailure;
-	if (file != NULL  &&  file->initialized)
+	int result = 0;
+	tagFileInfo info;
+	tagFile *const file = initialize (tagFilePath, &info);
+	if (file != NULL)
 	{
-		gotoFirstLogicalTag (file);
-		result = readNext (file, entry);
+		const size_t prefixLength = strlen (PseudoTagPrefix);
+		unsigned long allocated = 256;
+		unsigned long count = 0;
+		tagTrigramEntry *table = (tagTrigramEntry*) malloc (
+				allocated * sizeof (tagTrigramEntry));
+		if (table == NULL)
+			perror ("cannot allocate trigram index");
+		else
+		{
+			char *indexPath;
+			off_t offset;
+			int failed = 0;
+			seekTagFile (file, (off_t) 0);
+			while (offset = tellTagFile (file),
+				   ! failed  &&  readTagLineRaw (file))
+			{
+				const unsigned long recordStart = count;
+				const char *name;
+				copyName (file);
+				if (file->name.buffer [0] == '\0'  ||
+					strncmp (file->line.buffer, PseudoTagPrefix,
+							 prefixLength) == 0)
+					continue;
+				for (name = file->name.buffer  ;  name [0] != '\0'  &&
+						name [1] != '\0'  &&  name [2] != '\0'  ;  ++name)
+				{
+					const unsigned long trigram = packTrigram (name);
+					unsigned long i;
+					for (i = recordStart  ;  i < count  ;  ++i)
+						if (table [i].trigram == trigram)
+							break;
+					if (i < count)
+						continue;  /* already recorded for this name */
+					if (count == allocated)
+					{
+						tagTrigramEntry *const newTable =
+								(tagTrigramEntry*) realloc (table,
+									2 * allocated * sizeof (tagTrigramEntry));
+						if (newTable == NULL)
+						{
+							perror ("cannot allocate trigram index");
+							failed = 1;
+							break;
+						}
+						table = newTable;
+						allocated *= 2;
+					}
+					table [count].trigram = trigram;
+					table [count].offset = (unsigned long) offset;
+					++count;
+				}
+			}
+			qsort (table, (size_t) count, sizeof (tagTrigramEntry),
+				   compareTrigramEntries);
+			indexPath = trigramFilePath (tagFilePath);
+			if (indexPath != NULL  &&  ! failed)
+			{
+				FILE *const fp = fopen (indexPath, "wb");
+				if (fp != NULL)
+				{
+					unsigned long header [3];
+					header [0] = (unsigned long) TAG_TRIGRAM_VERSION;
+					header [1] = (unsigned long) file->size;
+					header [2] = count;
+					if (fwrite (TAG_TRIGRAM_MAGIC,
+								sizeof TAG_TRIGRAM_MAGIC - 1,
+								(size_t) 1, fp) == 1  &&
+						fwrite (header, sizeof header [0], (size_t) 3,
+								fp) == 3  &&
+						fwrite (table, sizeof (tagTrigramEntry),
+								(size_t) count, fp) == (size_t) count)
+						result = 1;
+					fclose (fp);
+					if (! result)
+						remove (indexPath);
+				}
+			}
+			if (indexPath != NULL)
+				free (indexPath);
+			free (table);
+		}
+		tagsClose (file);
 	}
 	return result;
 }
 
-extern tagResult tagsNext (tagFile *const file, tagEntry *const entry)
+extern void tagsRemoveTrigramIndex (const char *const tagFilePath)
 {
-	tagResult result = TagFailure;
-	if (file != NULL  &&  file->initialized)
-		result = readNext (file, entry);
-	return result;
+	char *const indexPath = trigramFilePath (tagFilePath);
+	if (indexPath != NULL)
+	{
+		remove (indexPath);
+		free (indexPath);
+	}
 }
 
-extern const char *tagsField (const tagEntry *const entry, const char *const key)
-{
-	const char *result = NULL;
-	if (entry != NULL)
-		result = readFieldValue (entry, key);
-	return result;
-}
+/*  One source file and the offsets of its tag records, collected while the
+ *  tag file is read and written out sorted by name.
+ */
+typedef struct {
+	char *name;
+	unsigned long *offsets;
+	unsigned long count;
+	unsigned long allocated;
+} fileMapRecord;
 
-extern tagResult tagsFind (tagFile *const file, tagEntry *const entry,
-						   const char *const name, const int options)
+static int compareFileMapRecords (const void *const one, const void *const two)
 {
-	tagResult result = TagFailure;
-	if (file != NULL  &&  file->initialized)
-		result = find (file, entry, name, options);
-	return result;
+	return strcmp (((const fileMapRecord*) one)->name,
+				   ((const fileMapRecord*) two)->name);
 }
 
-extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry)
+extern int tagsWriteFileMap (const char *const tagFilePath)
 {
-	tagResult result = TagFailure;
-	if (file != NULL  &&  file->initialized)
-		result = findNext (file, entry);
+	int result = 0;
+	tagFileInfo info;
+	tagFile *const file = initialize (tagFilePath, &info);
+	if (file != NULL)
+	{
+		const size_t prefixLength = strlen (PseudoTagPrefix);
+		unsigned long allocated = 64;
+		unsigned long count = 0;
+		unsigned long current = 0;  /* record last used; files arrive in runs */
+		fileMapRecord *records = (fileMapRecord*) malloc (
+				allocated * sizeof (fileMapRecord));
+		if (records == NULL)
+			perror ("cannot allocate file map");
+		else
+		{
+			char *mapPath;
+			off_t offset;
+			int failed = 0;
+			seekTagFile (file, (off_t) 0);
+			while (offset = tellTagFile (file),
+				   ! failed  &&  readTagLineRaw (file))
+			{
+				const char *field, *end;
+				size_t length;
+				unsigned long i;
+				fileMapRecord *record;
+				if (file->line.buffer [0] == '\0'  ||
+					file->line.buffer [0] == TAB  ||
+					strncmp (file->line.buffer, PseudoTagPrefix,
+							 prefixLength) == 0)
+					continue;
+				field = strchr (file->line.buffer, TAB);
+				if (field == NULL)
+					continue;
+				++field;
+				end = strchr (field, TAB);
+				length = (end != NULL) ? (size_t) (end - field)
+									   : strlen (field);
+
+				/*  Find the file's record, checking the last one used
+				 *  first: in unsorted tag files each file's records are
+				 *  adjacent, and even sorted ones repeat files often.
+				 */
+				i = current;
+				if (i >= count  ||
+					strlen (records [i].name) != length  ||
+					strncmp (records [i].name, field, length) != 0)
+				{
+					for (i = 0  ;  i < count  ;  ++i)
+						if (strlen (records [i].name) == length  &&
+							strncmp (records [i].name, field, length) == 0)
+							break;
+				}
+				if (i == count)
+				{
+					if (count == allocated)
+					{
+						fileMapRecord *const newRecords = (fileMapRecord*)
+								realloc (records, 2 * allocated *
+										 sizeof (fileMapRecord));
+						if (newRecords == NULL)
+						{
+							perror ("cannot allocate file map");
+							failed = 1;
+							continue;
+						}
+						records = newRecords;
+						allocated *= 2;
+					}
+					records [count].name = (char*) malloc (length + 1);
+					records [count].offsets = (unsigned long*) malloc (
+							8 * sizeof (unsigned long));
+					if (records [count].name == NULL  ||
+						records [count].offsets == NULL)
+					{
+						perror ("cannot allocate file map");
+						failed = 1;
+						continue;
+					}
+					memcpy (records [count].name, field, length);
+					records [count].name [length] = '\0';
+					records [count].count = 0;
+					records [count].allocated = 8;
+					++count;
+				}
+				record = records + i;
+				current = i;
+				if (record->count == record->allocated)
+				{
+					unsigned long *const newOffsets = (unsigned long*)
+							realloc (record->offsets, 2 * record->allocated *
+									 sizeof (unsigned long));
+					if (newOffsets == NULL)
+					{
+						perror ("cannot allocate file map");
+						failed = 1;
+						continue;
+					}
+					record->offsets = newOffsets;
+					record->allocated *= 2;
+				}
+				record->offsets [record->count++] = (unsigned long) offset;
+			}
+			qsort (records, (size_t) count, sizeof (fileMapRecord),
+				   compareFileMapRecords);
+			mapPath = fileMapPath (tagFilePath);
+			if (mapPath != NULL  &&  ! failed)
+			{
+				FILE *const fp = fopen (mapPath, "wb");
+				if (fp != NULL)
+				{
+					unsigned long header [3];
+					unsigned long i;
+					int ok;
+					header [0] = (unsigned long) TAG_FILEMAP_VERSION;
+					header [1] = (unsigned long) file->size;
+					header [2] = count;
+					ok = (fwrite (TAG_FILEMAP_MAGIC,
+								  sizeof TAG_FILEMAP_MAGIC - 1,
+								  (size_t) 1, fp) == 1  &&
+						  fwrite (header, sizeof header [0], (size_t) 3,
+								  fp) == 3);
+					for (i = 0  ;  ok  &&  i < count  ;  ++i)
+					{
+						const size_t nameSize =
+								strlen (records [i].name) + 1;
+						ok = (fwrite (records [i].name, nameSize,
+									  (size_t) 1, fp) == 1  &&
+							  fwrite (&records [i].count,
+									  sizeof records [i].count,
+									  (size_t) 1, fp) == 1  &&
+							  fwrite (records [i].offsets,
+									  sizeof (unsigned long),
+									  (size_t) records [i].count,
+									  fp) == (size_t) records [i].count);
+					}
+					result = ok;
+					fclose (fp);
+					if (! result)
+						remove (mapPath);
+				}
+			}
+			if (mapPath != NULL)
+				free (mapPath);
+			{
+				unsigned long i;
+				for (i = 0  ;  i < count  ;  ++i)
+				{
+					free (records [i].name);
+					free (records [i].offsets);
+				}
+			}
+			free (records);
+		}
+		tagsClose (file);
+	}
 	return result;
 }
 
-extern tagResult tagsClose (tagFile *const file)
+extern void tagsRemoveFileMap (const char *const tagFilePath)
 {
-	tagResult result = TagFailure;
-	if (file != NULL  &&  file->initialized)
+	char *const mapPath = fileMapPath (tagFilePath);
+	if (mapPath != NULL)
 	{
-		terminate (file);
-		result = TagSuccess;
+		remove (mapPath);
+		free (mapPath);
 	}
-	return result;
 }
 
 /*
@@ -791,6 +2862,7 @@ static const char *ProgramName;
 static int extensionFields;
 static int SortOverride;
 static sortType SortMethod;
+static int PrefixMode;
 
 static void printTag (const tagEntry *entry)
 {
@@ -846,6 +2918,124 @@ static void findTag (const char *const name, const int options)
 	}
 }
 
+static void findPrefixTags (const char *const name, const int options)
+{
+	tagFileInfo info;
+	tagEntry entries [64];
+	char buffer [16384];
+	tagArena arena;
+	tagFile *const file = tagsOpen (TagFileName, &info);
+	if (file == NULL)
+	{
+		fprintf (stderr, "%s: cannot open tag file: %s: %s\n",
+				ProgramName, strerror (info.status.error_number), name);
+		exit (1);
+	}
+	else
+	{
+		arena.entries = entries;
+		arena.maxEntries = sizeof entries / sizeof entries [0];
+		arena.buffer = buffer;
+		arena.size = sizeof buffer;
+		if (SortOverride)
+			tagsSetSortType (file, SortMethod);
+		if (tagsFindPrefix (file, name, options, &arena) == TagSuccess)
+		{
+			unsigned long i;
+			printf ("%lu matches, %lu stored\n", arena.matches, arena.stored);
+			for (i = 0  ;  i < arena.stored  ;  ++i)
+				printTag (arena.entries + i);
+		}
+		tagsClose (file);
+	}
+}
+
+/*  Answers tag name queries read from standard input, one per line, over a
+ *  single open of the tag file, so that scripts issuing many lookups pay
+ *  for the open and header parsing once instead of spawning a process per
+ *  query. A query is a tag name, optionally preceded by a '-', flag
+ *  letters ('i' and 'p' as on the command line) and a blank; such flags
+ *  replace the command-line matching options for that query only.
+ */
+static void batchQueries (const int defaultOptions)
+{
+	tagFileInfo info;
+	tagEntry entry;
+	char line [8192];
+	tagFile *const file = tagsOpen (TagFileName, &info);
+	if (file == NULL)
+	{
+		fprintf (stderr, "%s: cannot open tag file: %s: %s\n",
+				ProgramName, strerror (info.status.error_number), TagFileName);
+		exit (1);
+	}
+	if (SortOverride)
+		tagsSetSortType (file, SortMethod);
+	while (fgets (line, sizeof line, stdin) != NULL)
+	{
+		int options = defaultOptions;
+		char *name = line;
+		char *const newline = strchr (line, '\n');
+		if (newline != NULL)
+			*newline = '\0';
+		if (name [0] == '-')
+		{
+			options = 0;
+			for (++name  ;  *name != '\0' && *name != ' ' && *name != '\t'  ;
+					++name)
+			{
+				switch (*name)
+				{
+					case 'c': options |= TAG_SUBSTRINGMATCH; break;
+					case 'i': options |= TAG_IGNORECASE;   break;
+					case 'p': options |= TAG_PARTIALMATCH; break;
+					default:
+						fprintf (stderr, "%s: unknown query flag: %c\n",
+								ProgramName, *name);
+						break;
+				}
+			}
+			while (*name == ' '  ||  *name == '\t')
+				++name;
+		}
+		if (*name == '\0')
+			continue;
+		if (tagsFind (file, &entry, name, options) == TagSuccess)
+		{
+			do
+			{
+				printTag (&entry);
+			} while (tagsFindNext (file, &entry) == TagSuccess);
+		}
+		fflush (stdout);
+	}
+	tagsClose (file);
+}
+
+static void findFileTags (const char *const fileName)
+{
+	tagFileInfo info;
+	tagEntry entry;
+	tagFile *const file = tagsOpen (TagFileName, &info);
+	if (file == NULL)
+	{
+		fprintf (stderr, "%s: cannot open tag file: %s: %s\n",
+				ProgramName, strerror (info.status.error_number), TagFileName);
+		exit (1);
+	}
+	else
+	{
+		if (tagsFindByFile (file, &entry, fileName) == TagSuccess)
+		{
+			do
+			{
+				printTag (&entry);
+			} while (tagsFindNext (file, &entry) == TagSuccess);
+		}
+		tagsClose (file);
+	}
+}
+
 static void listTags (void)
 {
 	tagFileInfo info;
@@ -867,12 +3057,20 @@ static void listTags (void)
 
 const char *const Usage =
 	"Find tag file entries matching specified names.\n\n"
-	"Usage: %s [-ilp] [-s[0|1]] [-t file] [name(s)]\n\n"
+	"Usage: %s [-bcilp] [-F file] [-s[0|1]] [-t file] [name(s)]\n\n"
 	"Options:\n"
+	"    -b           Read queries from standard input, one per line, over a\n"
+	"                 single open of the tag file. A query is a tag name,\n"
+	"                 optionally preceded by '-', flags ('c', 'i', 'p') and a\n"
+	"                 blank which replace the command-line options for that\n"
+	"                 query.\n"
+	"    -c           Perform substring (contains) matching.\n"
 	"    -e           Include extension fields in output.\n"
+	"    -F file      List the tags of the named source file.\n"
 	"    -i           Perform case-insensitive matching.\n"
 	"    -l           List all tags.\n"
 	"    -p           Perform partial matching.\n"
+	"    -P           Find tags by prefix in bulk, via tagsFindPrefix().\n"
 	"    -s[0|1|2]    Override sort detection of tag file.\n"
 	"    -t file      Use specified tag file (default: \"tags\").\n"
 	"Note that options are acted upon as encountered, so order is significant.\n";
@@ -893,7 +3091,10 @@ extern int main (int argc, char **argv)
 		const char *const arg = argv [i];
 		if (arg [0] != '-')
 		{
-			findTag (arg, options);
+			if (PrefixMode)
+				findPrefixTags (arg, options);
+			else
+				findTag (arg, options);
 			actionSupplied = 1;
 		}
 		else
@@ -903,11 +3104,29 @@ extern int main (int argc, char **argv)
 			{
 				switch (arg [j])
 				{
+					case 'b': batchQueries (options); actionSupplied = 1; break;
+					case 'c': options |= TAG_SUBSTRINGMATCH; break;
 					case 'e': extensionFields = 1;         break;
 					case 'i': options |= TAG_IGNORECASE;   break;
 					case 'p': options |= TAG_PARTIALMATCH; break;
+					case 'P': PrefixMode = 1;              break;
 					case 'l': listTags (); actionSupplied = 1; break;
-			
+
+					case 'F':
+						if (arg [j+1] != '\0')
+						{
+							findFileTags (arg + j + 1);
+							j += strlen (arg + j + 1);
+						}
+						else if (i + 1 < argc)
+							findFileTags (argv [++i]);
+						else
+						{
+							fprintf (stderr, Usage, ProgramName);
+							exit (1);
+						}
+						actionSupplied = 1;
+						break;
 					case 't':
 						if (arg [j+1] != '\0')
 						{
@@ -21,6 +21,8 @@
 #ifndef READTAGS_H
 #define READTAGS_H
 
+#include <stddef.h>  /* to declare size_t */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +43,38 @@ typedef enum {
 #define TAG_OBSERVECASE   0x0
 #define TAG_IGNORECASE    0x2
 
+#define TAG_SUBSTRINGMATCH 0x4
+
+/* The name of the optional binary index which may accompany a tag file is
+ * the name of the tag file with this suffix appended. */
+#define TAG_INDEX_SUFFIX  ".idx"
+
+/* Identifying string written at the start of an index file. */
+#define TAG_INDEX_MAGIC   "CTAGSIDX"
+
+/* Format version of the index file. */
+#define TAG_INDEX_VERSION 1L
+
+/* The name of the optional trigram index which may accompany a tag file is
+ * the name of the tag file with this suffix appended. */
+#define TAG_TRIGRAM_SUFFIX  ".tgi"
+
+/* Identifying string written at the start of a trigram index file. */
+#define TAG_TRIGRAM_MAGIC   "CTAGSTGM"
+
+/* Format version of the trigram index file. */
+#define TAG_TRIGRAM_VERSION 1L
+
+/* The name of the optional per-file section map which may accompany a tag
+ * file is the name of the tag file with this suffix appended. */
+#define TAG_FILEMAP_SUFFIX  ".fmp"
+
+/* Identifying string written at the start of a file map. */
+#define TAG_FILEMAP_MAGIC   "CTAGSFMP"
+
+/* Format version of the file map. */
+#define TAG_FILEMAP_VERSION 1L
+
 /*
 *  DATA DECLARATIONS
 */
@@ -89,6 +123,59 @@ typedef struct {
 
 } tagFileInfo;
 
+/* This structure describes one record of the optional binary index which may
+ * accompany a tag file. The index file consists of the identifying string
+ * TAG_INDEX_MAGIC, three unsigned long values (the format version, the size
+ * in bytes of the tag file indexed, and the number of records), followed by
+ * the records sorted by hash with ties in tag file order. All values are in
+ * host representation; the index is a cache local to the machine on which it
+ * was generated and is ignored whenever its header does not match the tag
+ * file beside it.
+ */
+typedef struct {
+
+		/* case-folded hash of the tag name, as computed by tagsHashName() */
+	unsigned long hash;
+
+		/* byte offset of the start of the tag line within the tag file */
+	unsigned long offset;
+
+} tagIndexEntry;
+
+/* This structure describes one record of the optional trigram index which
+ * may accompany a tag file and accelerates substring searches. The index
+ * file consists of the identifying string TAG_TRIGRAM_MAGIC, three unsigned
+ * long values (the format version, the size in bytes of the tag file
+ * indexed, and the number of records), followed by one record per distinct
+ * trigram of each tag name, sorted by trigram with ties in tag file order.
+ * As with the binary index, all values are in host representation and the
+ * index is ignored whenever its header does not match the tag file.
+ */
+typedef struct {
+
+		/* three consecutive case-folded bytes of the tag name, packed as
+		 * (first << 16 | second << 8 | third) */
+	unsigned long trigram;
+
+		/* byte offset of the start of the tag line within the tag file */
+	unsigned long offset;
+
+} tagTrigramEntry;
+
+/* The optional per-file section map which may accompany a tag file maps each
+ * source file to the records its tags occupy, so that the tags of one source
+ * file can be visited without scanning the whole tag file (the records of a
+ * file are contiguous in unsorted output but interleaved once sorted). The
+ * map file consists of the identifying string TAG_FILEMAP_MAGIC, three
+ * unsigned long values (the format version, the size in bytes of the tag
+ * file mapped, and the number of source files), followed by one variable
+ * length entry per source file in strcmp() order of name: the
+ * null-terminated file name, an unsigned long record count, and that many
+ * unsigned long record offsets in tag file order. As with the other
+ * indexes, all values are in host representation and the map is ignored
+ * whenever its header does not match the tag file.
+ */
+
 /* This structure contains information about an extension field for a tag.
  * These exist at the end of the tag in the form "key:value").
  */
@@ -139,6 +226,38 @@ typedef struct {
 
 } tagEntry;
 
+/* This structure describes a caller-provided arena for tagsFindPrefix() and
+ * receives the result of the scan. The caller supplies the entry array and
+ * the byte buffer; the strings and extension field lists of every stored
+ * entry are packed into the buffer, so the entries remain valid - with no
+ * further allocation - until the caller reuses the arena, even after more
+ * tags are read or the tag file is closed.
+ */
+typedef struct {
+
+		/* caller-provided array to be filled with matching entries */
+	tagEntry *entries;
+
+		/* number of elements in `entries' */
+	unsigned long maxEntries;
+
+		/* caller-provided buffer backing the strings and field lists */
+	char *buffer;
+
+		/* number of bytes in `buffer' */
+	size_t size;
+
+		/* output: total number of matches found in the tag file */
+	unsigned long matches;
+
+		/* output: number of entries stored before space was exhausted */
+	unsigned long stored;
+
+		/* internal: number of bytes of `buffer' consumed */
+	size_t used;
+
+} tagArena;
+
 
 /*
 *  FUNCTION PROTOTYPES
@@ -211,6 +330,13 @@ extern const char *tagsField (const tagEntry *const entry, const char *const key
 *    TAG_PARTIALMATCH
 *        Tags whose leading characters match `name' will qualify.
 *
+*    TAG_SUBSTRINGMATCH
+*        Tags containing `name' anywhere within them will qualify. Such
+*        searches scan the whole tag file unless a trigram index (see
+*        tagsWriteTrigramIndex()) accompanies it and `name' is at least
+*        three characters long, in which case only candidate records
+*        bearing a trigram of `name' are examined.
+*
 *    TAG_FULLMATCH
 *        Only tags whose full lengths match `name' will qualify.
 *
@@ -236,6 +362,34 @@ extern tagResult tagsFind (tagFile *const file, tagEntry *const entry, const cha
 */
 extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry);
 
+/*
+*  Find the first tag of the source file named `fileName', as recorded in the
+*  file field of each tag line; further tags of the same source file are then
+*  delivered by tagsFindNext(). The name must match the file field exactly,
+*  so it should be spelled as it was when the tag file was generated. When a
+*  per-file section map (see tagsWriteFileMap()) accompanies the tag file,
+*  only the records of that source file are visited; otherwise the whole tag
+*  file is scanned. The structure pointed to by `entry' will be populated
+*  with information about the tag file entry. The function will return
+*  TagSuccess if the source file has at least one tag, or TagFailure if not.
+*/
+extern tagResult tagsFindByFile (tagFile *const file, tagEntry *const entry, const char *const fileName);
+
+/*
+*  Find every tag whose name begins with `prefix' in a single pass, intended
+*  for completion engines which would otherwise call tagsFind() with
+*  TAG_PARTIALMATCH and re-parse each entry delivered by tagsFindNext(). The
+*  matching range is walked once; each matching entry is copied into the
+*  caller-provided arena, so the results do not share the tag file's line
+*  buffer and all remain valid simultaneously. Of the tagsFind() options only
+*  TAG_IGNORECASE is meaningful. Upon return, arena->matches holds the total
+*  number of matches in the tag file and arena->stored the number of entries
+*  actually copied, which is smaller when the entry array or the buffer fills
+*  up. The function will return TagSuccess if at least one tag matched the
+*  prefix, or TagFailure if none did.
+*/
+extern tagResult tagsFindPrefix (tagFile *const file, const char *const prefix, const int options, tagArena *const arena);
+
 /*
 *  Call tagsTerminate() at completion of reading the tag file, which will
 *  close the file and free any internal memory allocated. The function will
@@ -243,6 +397,91 @@ extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry);
 */
 extern tagResult tagsClose (tagFile *const file);
 
+/*
+*  Like tagsOpen(), but keeps a small cache of open handles so that clients
+*  which open the same tag file for every query (language servers, editor
+*  integrations) skip the open and header parsing work in the steady state.
+*  The cached handle is revalidated against the file's current modification
+*  time and size on every call and reopened transparently when the file has
+*  been rewritten. A handle obtained from this function must be released
+*  with tagsCloseCached(), not tagsClose(), and remains owned by the cache:
+*  while it is held, further tagsOpenCached() calls for the same path return
+*  a private uncached handle so that cursor and search state are never
+*  shared.
+*/
+extern tagFile *tagsOpenCached (const char *const filePath, tagFileInfo *const info);
+
+/*
+*  Releases a handle obtained from tagsOpenCached(), leaving it open in the
+*  cache for the next query. Handles which were not (or could no longer be)
+*  cached are closed for real. The function will return TagFailure if no
+*  file is currently open, TagSuccess otherwise.
+*/
+extern tagResult tagsCloseCached (tagFile *const file);
+
+/*
+*  Closes every handle resting in the cache maintained by tagsOpenCached().
+*  Handles currently held by callers are not affected; they are closed when
+*  released. Useful before process shutdown or when the client knows the
+*  tag files will not be queried again soon.
+*/
+extern void tagsFlushCache (void);
+
+/*
+*  Computes the case-folded hash of a tag name as recorded in the optional
+*  binary index accompanying a tag file. Hashing stops at the first tab or
+*  null character, so a complete tag file line hashes the same as the name it
+*  begins with. Case is folded so that a single table serves both
+*  case-sensitive and case-insensitive lookups.
+*/
+extern unsigned long tagsHashName (const char *const name);
+
+/*
+*  Writes (or rewrites) the binary index for the tag file at `tagFilePath'.
+*  The index is written beside the tag file, under the tag file name with
+*  TAG_INDEX_SUFFIX appended. Intended for use by tag file generators after
+*  the tag file is complete. Returns 1 upon success, 0 upon failure.
+*/
+extern int tagsWriteIndex (const char *const tagFilePath);
+
+/*
+*  Removes any binary index accompanying the tag file at `tagFilePath'. A tag
+*  file generator should call this when rewriting a tag file without also
+*  rewriting its index, lest a stale index whose header coincidentally
+*  matches the new tag file mislead readers.
+*/
+extern void tagsRemoveIndex (const char *const tagFilePath);
+
+/*
+*  Writes (or rewrites) the trigram index for the tag file at `tagFilePath',
+*  which accelerates TAG_SUBSTRINGMATCH searches. The index is written
+*  beside the tag file, under the tag file name with TAG_TRIGRAM_SUFFIX
+*  appended. Intended for use by tag file generators after the tag file is
+*  complete. Returns 1 upon success, 0 upon failure.
+*/
+extern int tagsWriteTrigramIndex (const char *const tagFilePath);
+
+/*
+*  Removes any trigram index accompanying the tag file at `tagFilePath', for
+*  the same reason as tagsRemoveIndex().
+*/
+extern void tagsRemoveTrigramIndex (const char *const tagFilePath);
+
+/*
+*  Writes (or rewrites) the per-file section map for the tag file at
+*  `tagFilePath', which accelerates tagsFindByFile(). The map is written
+*  beside the tag file, under the tag file name with TAG_FILEMAP_SUFFIX
+*  appended. Intended for use by tag file generators after the tag file is
+*  complete. Returns 1 upon success, 0 upon failure.
+*/
+extern int tagsWriteFileMap (const char *const tagFilePath);
+
+/*
+*  Removes any per-file section map accompanying the tag file at
+*  `tagFilePath', for the same reason as tagsRemoveIndex().
+*/
+extern void tagsRemoveFileMap (const char *const tagFilePath);
+
 #ifdef __cplusplus
 };
 #endif
@@ -14,16 +14,55 @@
 *   INCLUDE FILES
 */
 #include "general.h"  /* always include first */
+
+#include <string.h>
+
 #include "parse.h"    /* always include */
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_SUBROUTINE
+} rexxKind;
+
+static kindOption RexxKinds [] = {
+	{ TRUE, 's', "subroutine", "subroutines"}
+};
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static void installRexxRegex (const langType language)
+static boolean isIdentChar (const int c)
 {
-	addTagRegex (language, "^([A-Za-z0-9@#$\\.!?_]+)[ \t]*:",
-		"\\1", "s,subroutine,subroutines", NULL);
+	return (boolean) (c != '\0'  &&
+					  (isalnum (c)  ||  strchr ("@#$.!?_", c) != NULL));
+}
+
+static void findRexxTags (void)
+{
+	vString *name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		const char *const cp = (const char *) line;
+		const char *p;
+
+		for (p = cp  ;  isIdentChar ((unsigned char) *p)  ;  ++p)
+			;
+		if (p == cp)
+			continue;
+		vStringNCopyS (name, cp, (size_t) (p - cp));
+		while (*p == ' '  ||  *p == '\t')
+			++p;
+		if (*p == ':')
+			makeSimpleTag (name, RexxKinds, K_SUBROUTINE);
+	}
+	vStringDelete (name);
 }
 
 extern parserDefinition* RexxParser (void)
@@ -31,8 +70,9 @@ extern parserDefinition* RexxParser (void)
 	static const char *const extensions [] = { "cmd", "rexx", "rx", NULL };
 	parserDefinition* const def = parserNew ("REXX");
 	def->extensions = extensions;
-	def->initialize = installRexxRegex;
-	def->regex      = TRUE;
+	def->kinds      = RexxKinds;
+	def->kindCount  = KIND_COUNT (RexxKinds);
+	def->parser     = findRexxTags;
 	return def;
 }
 
@@ -158,6 +158,10 @@ const char *const PathDelimiters = ":]>";
 
 char *CurrentDirectory;
 
+/*  Indexed by character value plus one; see routines.h.
+ */
+unsigned char CharacterClass [257];
+
 static const char *ExecutableProgram;
 static const char *ExecutableName;
 
@@ -178,10 +182,55 @@ extern int lstat (const char *, struct stat *);
 *   FUNCTION DEFINITIONS
 */
 
+static void flushRelativePrefixes (void);
+
 extern void freeRoutineResources (void)
 {
 	if (CurrentDirectory != NULL)
 		eFree (CurrentDirectory);
+	flushRelativePrefixes ();
+}
+
+static void addCharacterClass (
+		const char *const characters, const unsigned char mask)
+{
+	const char *p;
+
+	for (p = characters  ;  *p != '\0'  ;  ++p)
+		CharacterClass [(unsigned char) *p + 1] |= mask;
+}
+
+/*  Builds the character classification table. The table is deliberately
+ *  independent of the locale; tag files describe program text, not prose.
+ */
+extern void initCharacterClass (void)
+{
+	const char *const lower = "abcdefghijklmnopqrstuvwxyz";
+	const char *const upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+	const char *const digits = "0123456789";
+
+	addCharacterClass (lower, CHAR_ALPHA);
+	addCharacterClass (upper, CHAR_ALPHA);
+	addCharacterClass (digits, CHAR_DIGIT);
+	addCharacterClass (" \t\v\f\r\n", CHAR_SPACE);
+
+	addCharacterClass (lower, CHAR_IDENTIFIER1 | CHAR_IDENTIFIER);
+	addCharacterClass (upper, CHAR_IDENTIFIER1 | CHAR_IDENTIFIER);
+	addCharacterClass (digits, CHAR_IDENTIFIER);
+	addCharacterClass ("_", CHAR_IDENTIFIER1 | CHAR_IDENTIFIER);
+
+	/*  C++ allows '~' in destructors; VMS allows '$' in identifiers. */
+	addCharacterClass (lower, CHAR_C_IDENTIFIER1 | CHAR_C_IDENTIFIER);
+	addCharacterClass (upper, CHAR_C_IDENTIFIER1 | CHAR_C_IDENTIFIER);
+	addCharacterClass (digits, CHAR_C_IDENTIFIER);
+	addCharacterClass ("_$", CHAR_C_IDENTIFIER1 | CHAR_C_IDENTIFIER);
+	addCharacterClass ("~", CHAR_C_IDENTIFIER1);
+
+	/*  SQL, JavaScript and Flex identifiers admit a few extra characters. */
+	addCharacterClass (lower, CHAR_AT_IDENTIFIER);
+	addCharacterClass (upper, CHAR_AT_IDENTIFIER);
+	addCharacterClass (digits, CHAR_AT_IDENTIFIER);
+	addCharacterClass ("_$@#", CHAR_AT_IDENTIFIER);
 }
 
 extern void setExecutableName (const char *const path)
@@ -233,6 +282,107 @@ extern void error (
  *  Memory allocation functions
  */
 
+static unsigned long AllocationCount = 0L;
+
+/*  Number of heap allocations made so far; --stats samples this around
+ *  each parse to charge allocations to the parser which made them.
+ */
+extern unsigned long eAllocationCount (void)
+{
+	return AllocationCount;
+}
+
+#ifdef DEBUG
+
+/*  In debug builds every block carries its size, so that live and peak
+ *  heap byte counts can be maintained and a runaway allocation traced to
+ *  its moment. The union pads the header enough to keep the caller's
+ *  block aligned for any object type.
+ */
+typedef union uMemoryHeader {
+	size_t size;
+	double alignment;
+} memoryHeader;
+
+static struct sMemoryCounters {
+	unsigned long liveBlocks;   /* blocks allocated and not yet freed */
+	unsigned long liveBytes;    /* bytes in live blocks */
+	unsigned long peakBytes;    /* high-water mark of liveBytes */
+	unsigned long totalBytes;   /* bytes ever requested, including growth */
+} MemoryCounters;
+
+static void accountAllocation (const size_t size)
+{
+	++MemoryCounters.liveBlocks;
+	MemoryCounters.liveBytes += (unsigned long) size;
+	MemoryCounters.totalBytes += (unsigned long) size;
+	if (MemoryCounters.liveBytes > MemoryCounters.peakBytes)
+		MemoryCounters.peakBytes = MemoryCounters.liveBytes;
+}
+
+extern void eMemoryReport (FILE *const fp)
+{
+	fprintf (fp, "heap: %lu allocations, %lu live blocks (%lu kB), "
+			"peak %lu kB, total %lu kB\n",
+			AllocationCount,
+			MemoryCounters.liveBlocks,
+			MemoryCounters.liveBytes / 1024L,
+			MemoryCounters.peakBytes / 1024L,
+			MemoryCounters.totalBytes / 1024L);
+}
+
+extern void *eMalloc (const size_t size)
+{
+	memoryHeader *const header = malloc (sizeof (memoryHeader) + size);
+
+	if (header == NULL)
+		error (FATAL, "out of memory");
+
+	header->size = size;
+	accountAllocation (size);
+	++AllocationCount;
+	return header + 1;
+}
+
+extern void *eCalloc (const size_t count, const size_t size)
+{
+	void *const buffer = eMalloc (count * size);
+
+	memset (buffer, 0, count * size);
+	return buffer;
+}
+
+extern void *eRealloc (void *const ptr, const size_t size)
+{
+	memoryHeader *header;
+	if (ptr == NULL)
+		return eMalloc (size);
+	header = (memoryHeader *) ptr - 1;
+	MemoryCounters.liveBytes -= (unsigned long) header->size;
+	header = realloc (header, sizeof (memoryHeader) + size);
+	if (header == NULL)
+		error (FATAL, "out of memory");
+	header->size = size;
+	MemoryCounters.liveBytes += (unsigned long) size;
+	MemoryCounters.totalBytes += (unsigned long) size;
+	if (MemoryCounters.liveBytes > MemoryCounters.peakBytes)
+		MemoryCounters.peakBytes = MemoryCounters.liveBytes;
+	++AllocationCount;
+	return header + 1;
+}
+
+extern void eFree (void *const ptr)
+{
+	memoryHeader *header;
+	Assert (ptr != NULL);
+	header = (memoryHeader *) ptr - 1;
+	--MemoryCounters.liveBlocks;
+	MemoryCounters.liveBytes -= (unsigned long) header->size;
+	free (header);
+}
+
+#else
+
 extern void *eMalloc (const size_t size)
 {
 	void *buffer = malloc (size);
@@ -240,6 +390,7 @@ extern void *eMalloc (const size_t size)
 	if (buffer == NULL)
 		error (FATAL, "out of memory");
 
+	++AllocationCount;
 	return buffer;
 }
 
@@ -250,6 +401,7 @@ extern void *eCalloc (const size_t count, const size_t size)
 	if (buffer == NULL)
 		error (FATAL, "out of memory");
 
+	++AllocationCount;
 	return buffer;
 }
 
@@ -263,6 +415,7 @@ extern void *eRealloc (void *const ptr, const size_t size)
 		buffer = realloc (ptr, size);
 		if (buffer == NULL)
 			error (FATAL, "out of memory");
+		++AllocationCount;
 	}
 	return buffer;
 }
@@ -273,6 +426,8 @@ extern void eFree (void *const ptr)
 	free (ptr);
 }
 
+#endif  /* DEBUG */
+
 /*
  *  String manipulation functions
  */
@@ -443,6 +598,14 @@ extern fileStatus *eStat (const char *const fileName)
 					(S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
 				file.isSetuid = (boolean) ((status.st_mode & S_ISUID) != 0);
 				file.size = status.st_size;
+				file.mtime = status.st_mtime;
+#ifdef HAVE_STAT_ST_INO
+				file.device = (unsigned long) status.st_dev;
+				file.inode = (unsigned long) status.st_ino;
+#else
+				file.device = 0;
+				file.inode = 0;
+#endif
 			}
 		}
 	}
@@ -526,7 +689,7 @@ static boolean isPathSeparator (const int c)
 
 #if ! defined (HAVE_STAT_ST_INO)
 
-static void canonicalizePath (char *const path __unused__)
+static void canonicalizePath (char *const path __ctags_unused__)
 {
 #if defined (MSDOS_STYLE_PATH)
 	char *p;
@@ -617,6 +780,33 @@ extern const char *fileExtension (const char *const fileName)
 	return extension;
 }
 
+/*  Returns a pointer to the compression suffix of `fileName' (including the
+ *  leading period), or NULL if the file name does not carry a suffix for
+ *  which decompressing input support is compiled in. The file name less the
+ *  suffix determines the language of the compressed contents.
+ */
+extern const char *fileCompressionSuffix (const char *const fileName)
+{
+	static const char *const suffixes [] = {
+#ifdef HAVE_ZLIB_H
+		".gz",
+#endif
+		NULL
+	};
+	const char *const base = baseFilename (fileName);
+	const size_t length = strlen (base);
+	const char *const *suffix;
+
+	for (suffix = suffixes  ;  *suffix != NULL  ;  ++suffix)
+	{
+		const size_t suffixLength = strlen (*suffix);
+		if (length > suffixLength  &&
+			strcmp (base + length - suffixLength, *suffix) == 0)
+			return fileName + strlen (fileName) - suffixLength;
+	}
+	return NULL;
+}
+
 extern boolean isAbsolutePath (const char *const path)
 {
 	boolean result = FALSE;
@@ -809,7 +999,7 @@ extern char* absoluteDirname (char *file)
  * to the absolute directory DIR (which should end with a slash).
  * Routine adapted from Gnu etags.
  */
-extern char* relativeFilename (const char *file, const char *dir)
+static char* computeRelativeFilename (const char *file, const char *dir)
 {
 	const char *fp, *dp;
 	char *absdir, *res;
@@ -848,6 +1038,117 @@ extern char* relativeFilename (const char *file, const char *dir)
 	return res;
 }
 
+/*  Cache of relative prefixes already computed for source directories.
+ *  Thousands of files typically share a directory, and the componentwise
+ *  comparison performed by computeRelativeFilename () need only be done
+ *  once for each; later files in the same directory cost one hash probe
+ *  and a concatenation. The cache is keyed by the directory part of the
+ *  file name and holds the relative path of that directory, complete
+ *  with trailing separator (or empty for the base directory itself).
+ */
+#define RELATIVE_HASH_SIZE 64  /* buckets; chains absorb collisions */
+
+typedef struct sRelativePrefix {
+	struct sRelativePrefix *next;
+	char *directory;  /* directory part of the file name (no separator) */
+	char *prefix;     /* relative path of the directory */
+} relativePrefix;
+
+static relativePrefix *RelativePrefixes [RELATIVE_HASH_SIZE];
+static char *RelativeBaseDir = NULL;  /* dir the cache was built against */
+
+static unsigned int relativePrefixHash (
+		const char *const string, const size_t length)
+{
+	unsigned long result = 5381;
+	size_t i;
+	for (i = 0  ;  i < length  ;  ++i)
+		result = result * 33 + (unsigned char) string [i];
+	return (unsigned int) (result % RELATIVE_HASH_SIZE);
+}
+
+static void flushRelativePrefixes (void)
+{
+	unsigned int i;
+	for (i = 0  ;  i < RELATIVE_HASH_SIZE  ;  ++i)
+	{
+		while (RelativePrefixes [i] != NULL)
+		{
+			relativePrefix *const entry = RelativePrefixes [i];
+			RelativePrefixes [i] = entry->next;
+			eFree (entry->directory);
+			eFree (entry->prefix);
+			eFree (entry);
+		}
+	}
+	if (RelativeBaseDir != NULL)
+	{
+		eFree (RelativeBaseDir);
+		RelativeBaseDir = NULL;
+	}
+}
+
+/*  Looks up the relative prefix of the given directory part of a file
+ *  name, computing and caching it on first sight. The prefix is obtained
+ *  by making a probe file name in the directory relative and dropping
+ *  the probe's base name, which leaves either an empty string or a
+ *  relative directory path ending with a separator.
+ */
+static const char* relativePrefixFor (
+		const char *const file, const size_t dirLength, const char *const dir)
+{
+	const unsigned int bucket = relativePrefixHash (file, dirLength);
+	relativePrefix *entry;
+
+	for (entry = RelativePrefixes [bucket]  ;  entry != NULL  ;
+		 entry = entry->next)
+	{
+		if (strlen (entry->directory) == dirLength  &&
+			strncmp (entry->directory, file, dirLength) == 0)
+			return entry->prefix;
+	}
+
+	entry = xMalloc (1, relativePrefix);
+	entry->directory = xMalloc (dirLength + 1, char);
+	memcpy (entry->directory, file, dirLength);
+	entry->directory [dirLength] = '\0';
+	{
+		char *const probe = xMalloc (dirLength + 3, char);
+		memcpy (probe, file, dirLength);
+		probe [dirLength] = PATH_SEPARATOR;
+		probe [dirLength + 1] = 'x';
+		probe [dirLength + 2] = '\0';
+		entry->prefix = computeRelativeFilename (probe, dir);
+		entry->prefix [strlen (entry->prefix) - 1] = '\0';
+		eFree (probe);
+	}
+	entry->next = RelativePrefixes [bucket];
+	RelativePrefixes [bucket] = entry;
+	return entry->prefix;
+}
+
+extern char* relativeFilename (const char *file, const char *dir)
+{
+	const char *const sep = strrchr (file, PATH_SEPARATOR);
+	const char *prefix;
+	char *result;
+
+	/*  Root-level and bare file names are rare enough to compute directly.
+	 */
+	if (sep == NULL  ||  sep == file)
+		return computeRelativeFilename (file, dir);
+
+	if (RelativeBaseDir == NULL  ||  strcmp (RelativeBaseDir, dir) != 0)
+	{
+		flushRelativePrefixes ();
+		RelativeBaseDir = eStrdup (dir);
+	}
+	prefix = relativePrefixFor (file, (size_t) (sep - file), dir);
+	result = xMalloc (strlen (prefix) + strlen (sep + 1) + 1, char);
+	sprintf (result, "%s%s", prefix, sep + 1);
+	return result;
+}
+
 extern FILE *tempFile (const char *const mode, char **const pName)
 {
 	char *name;
@@ -42,6 +42,30 @@
 # define OUTPUT_PATH_SEPARATOR	PATH_SEPARATOR
 #endif
 
+/*
+ *  Character classification macros
+ *
+ *  One indexed load classifies a character for the parsers' innermost
+ *  tokenizing loops, replacing locale-sensitive ctype calls. The table is
+ *  indexed by the character plus one so that EOF selects a valid, always
+ *  empty entry; other arguments must be unsigned character values.
+ */
+#define CHAR_SPACE          0x01  /* white space */
+#define CHAR_DIGIT          0x02  /* decimal digit */
+#define CHAR_ALPHA          0x04  /* letter */
+#define CHAR_IDENTIFIER1    0x08  /* letter or '_' */
+#define CHAR_IDENTIFIER     0x10  /* letter, digit or '_' */
+#define CHAR_C_IDENTIFIER1  0x20  /* CHAR_IDENTIFIER1 plus '~' and '$' */
+#define CHAR_C_IDENTIFIER   0x40  /* CHAR_IDENTIFIER plus '$' */
+#define CHAR_AT_IDENTIFIER  0x80  /* CHAR_IDENTIFIER plus '$', '@' and '#' */
+
+#define charTest(c,mask)    (CharacterClass [(c) + 1] & (mask))
+#define charIsSpace(c)          charTest (c, CHAR_SPACE)
+#define charIsDigit(c)          charTest (c, CHAR_DIGIT)
+#define charIsAlpha(c)          charTest (c, CHAR_ALPHA)
+#define charIsIdentifier1(c)    charTest (c, CHAR_IDENTIFIER1)
+#define charIsIdentifier(c)     charTest (c, CHAR_IDENTIFIER)
+
 /*
 *   DATA DECLARATIONS
 */
@@ -49,6 +73,7 @@
 extern const char *const PathDelimiters;
 #endif
 extern char *CurrentDirectory;
+extern unsigned char CharacterClass [257];
 typedef int errorSelection;
 enum eErrorTypes { FATAL = 1, WARNING = 2, PERROR = 4 };
 
@@ -76,12 +101,21 @@ typedef struct {
 
 		/* Size of file (pointed to) */
 	unsigned long size;
-} fileStatus; 
+
+		/* Last modification time of file (pointed to) */
+	unsigned long mtime;
+
+		/* Device and inode of file (pointed to); both zero when the
+		 * system does not report inode numbers. */
+	unsigned long device;
+	unsigned long inode;
+} fileStatus;
 
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void freeRoutineResources (void);
+extern void initCharacterClass (void);
 extern void setExecutableName (const char *const path);
 extern const char *getExecutableName (void);
 extern const char *getExecutablePath (void);
@@ -92,6 +126,10 @@ extern void error (const errorSelection selection, const char *const format, ...
 extern void *malloc (size_t);
 extern void *realloc (void *ptr, size_t);
 #endif
+extern unsigned long eAllocationCount (void);
+#ifdef DEBUG
+extern void eMemoryReport (FILE *const fp);
+#endif
 extern void *eMalloc (const size_t size);
 extern void *eCalloc (const size_t count, const size_t size);
 extern void *eRealloc (void *const ptr, const size_t size);
@@ -122,6 +160,7 @@ extern int fsetpos  (FILE *stream, fpos_t *pos);
 #endif
 extern const char *baseFilename (const char *const filePath);
 extern const char *fileExtension (const char *const fileName);
+extern const char *fileCompressionSuffix (const char *const fileName);
 extern boolean isAbsolutePath (const char *const path);
 extern vString *combinePathAndFile (const char *const path, const char *const file);
 extern char* absoluteFilename (const char *file);
@@ -304,15 +304,18 @@ static void findRubyTags (void)
 	{
 		const unsigned char *cp = line;
 
-		if (canMatch (&cp, "=begin"))
+		if (*cp == '=')
 		{
-			inMultiLineComment = TRUE;
-			continue;
-		}
-		if (canMatch (&cp, "=end"))
-		{
-			inMultiLineComment = FALSE;
-			continue;
+			if (canMatch (&cp, "=begin"))
+			{
+				inMultiLineComment = TRUE;
+				continue;
+			}
+			if (canMatch (&cp, "=end"))
+			{
+				inMultiLineComment = FALSE;
+				continue;
+			}
 		}
 
 		skipWhitespace (&cp);
@@ -334,37 +337,73 @@ static void findRubyTags (void)
 		*   puts("hello") \
 		*       unless <exp>
 		*/
-		if (canMatch (&cp, "case") || canMatch (&cp, "for") ||
-			canMatch (&cp, "if") || canMatch (&cp, "unless") ||
-			canMatch (&cp, "while"))
-		{
-			enterUnnamedScope ();
-		}
-
 		/*
 		* "module M", "class C" and "def m" should only be at the beginning
-		* of a line.
+		* of a line. Dispatching on the first character of the line's first
+		* token spares most lines every literal comparison.
 		*/
-		if (canMatch (&cp, "module"))
-		{
-			readAndEmitTag (&cp, K_MODULE);
-		}
-		else if (canMatch (&cp, "class"))
+		switch (*cp)
 		{
-			readAndEmitTag (&cp, K_CLASS);
-		}
-		else if (canMatch (&cp, "def"))
-		{
-			readAndEmitTag (&cp, K_METHOD);
-		}
-		else if (canMatch (&cp, "describe"))
-		{
-			readAndEmitTag (&cp, K_DESCRIBE);
-		}
-		else if (canMatch (&cp, "context"))
-		{
-			readAndEmitTag (&cp, K_CONTEXT);
+		case 'c':
+			if (canMatch (&cp, "case"))
+			{
+				enterUnnamedScope ();
+			}
+			else if (canMatch (&cp, "class"))
+			{
+				readAndEmitTag (&cp, K_CLASS);
+			}
+			else if (canMatch (&cp, "context"))
+			{
+				readAndEmitTag (&cp, K_CONTEXT);
+			}
+			break;
+		case 'd':
+			if (canMatch (&cp, "def"))
+			{
+				readAndEmitTag (&cp, K_METHOD);
+			}
+			else if (canMatch (&cp, "describe"))
+			{
+				readAndEmitTag (&cp, K_DESCRIBE);
+			}
+			break;
+		case 'f':
+			if (canMatch (&cp, "for"))
+			{
+				enterUnnamedScope ();
+			}
+			break;
+		case 'i':
+			if (canMatch (&cp, "if"))
+			{
+				enterUnnamedScope ();
+			}
+			break;
+		case 'm':
+			if (canMatch (&cp, "module"))
+			{
+				readAndEmitTag (&cp, K_MODULE);
+			}
+			break;
+		case 'u':
+			if (canMatch (&cp, "unless"))
+			{
+				enterUnnamedScope ();
+			}
+			break;
+		case 'w':
+			if (canMatch (&cp, "while"))
+			{
+				enterUnnamedScope ();
+			}
+			break;
+		default:
+			break;
 		}
+
+		if (inMultiLineComment)
+			continue;  /* the rest of the line is commentary */
 		while (*cp != '\0')
 		{
 			/* FIXME: we don't cope with here documents,
@@ -373,7 +412,7 @@ static void findRubyTags (void)
 			* definitions at the starts of lines should keep us out of
 			* mischief.
 			*/
-			if (inMultiLineComment || isspace (*cp))
+			if (isspace (*cp))
 			{
 				++cp;
 			}
@@ -385,11 +424,13 @@ static void findRubyTags (void)
 				*/
 				break;
 			}
-			else if (canMatch (&cp, "begin") || canMatch (&cp, "do"))
+			else if ((*cp == 'b' || *cp == 'd')  &&
+					 (canMatch (&cp, "begin") || canMatch (&cp, "do")))
 			{
 				enterUnnamedScope ();
 			}
-			else if (canMatch (&cp, "end") && stringListCount (nesting) > 0)
+			else if (*cp == 'e'  &&
+					 canMatch (&cp, "end") && stringListCount (nesting) > 0)
 			{
 				/* Leave the most recent scope. */
 				vStringDelete (stringListLast (nesting));
@@ -397,12 +438,12 @@ static void findRubyTags (void)
 			}
 			else if (*cp == '"')
 			{
-				/* Skip string literals.
+				/* Skip string literals in one stride.
 				 * FIXME: should cope with escapes and interpolation.
 				 */
-				do {
-					++cp;
-				} while (*cp != 0 && *cp != '"');
+				const char *const close = strchr ((const char*) cp + 1, '"');
+				cp = (close != NULL) ? (const unsigned char*) close :
+						cp + strlen ((const char*) cp);
 			}
 			else if (*cp != '\0')
 			{
@@ -19,6 +19,7 @@
 
 #include "parse.h"
 #include "read.h"
+#include "sexp.h"
 #include "vstring.h"
 
 /*
@@ -33,6 +34,8 @@ static kindOption SchemeKinds [] = {
 	{ TRUE, 's', "set",      "sets" }
 };
 
+static vString *Name;
+
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -44,55 +47,44 @@ static kindOption SchemeKinds [] = {
  * look for (def ... ((... (xyzzy ....
  * look for (set! xyzzy
  */
-static void readIdentifier (vString *const name, const unsigned char *cp)
+static void processSchemeForm (const unsigned char *const line)
 {
-	const unsigned char *p;
-	vStringClear (name);
-	/* Go till you get to white space or a syntactic break */
-	for (p = cp; *p != '\0' && *p != '(' && *p != ')' && !isspace (*p); p++)
-		vStringPut (name, (int) *p);
-	vStringTerminate (name);
+	const unsigned char *cp = line;
+
+	if ((cp [1] == 'D' || cp [1] == 'd') &&
+		(cp [2] == 'E' || cp [2] == 'e') &&
+		(cp [3] == 'F' || cp [3] == 'f'))
+	{
+		while (*cp != '\0' && !isspace (*cp))
+			cp++;
+		/* Skip over open parens and white space */
+		while (*cp != '\0' && (isspace (*cp) || *cp == '('))
+			cp++;
+		readSexpSymbol (Name, cp);
+		makeSimpleTag (Name, SchemeKinds, K_FUNCTION);
+	}
+	else if ((cp [1] == 'S' || cp [1] == 's') &&
+			 (cp [2] == 'E' || cp [2] == 'e') &&
+			 (cp [3] == 'T' || cp [3] == 't') &&
+			 cp [4] == '!' &&
+			 (isspace (cp [5])))
+	{
+		while (*cp != '\0'  &&  !isspace (*cp))
+			cp++;
+		/* Skip over white space */
+		while (isspace (*cp))
+			cp++;
+		readSexpSymbol (Name, cp);
+		makeSimpleTag (Name, SchemeKinds, K_SET);
+	}
 }
 
 static void findSchemeTags (void)
 {
-	vString *name = vStringNew ();
-	const unsigned char *line;
-
-	while ((line = fileReadLine ()) != NULL)
-	{
-		const unsigned char *cp = line;
-
-		if (cp [0] == '(' &&
-			(cp [1] == 'D' || cp [1] == 'd') &&
-			(cp [2] == 'E' || cp [2] == 'e') &&
-			(cp [3] == 'F' || cp [3] == 'f'))
-		{
-			while (!isspace (*cp))
-				cp++;
-			/* Skip over open parens and white space */
-			while (*cp != '\0' && (isspace (*cp) || *cp == '('))
-				cp++;
-			readIdentifier (name, cp);
-			makeSimpleTag (name, SchemeKinds, K_FUNCTION);
-		}
-		if (cp [0] == '(' &&
-			(cp [1] == 'S' || cp [1] == 's') &&
-			(cp [2] == 'E' || cp [2] == 'e') &&
-			(cp [3] == 'T' || cp [3] == 't') &&
-			(cp [4] == '!' || cp [4] == '!') &&
-			(isspace (cp [5])))
-		{
-			while (*cp != '\0'  &&  !isspace (*cp))
-				cp++;
-			/* Skip over white space */
-			while (isspace (*cp))
-				cp++;
-			readIdentifier (name, cp);
-			makeSimpleTag (name, SchemeKinds, K_SET);
-		}
-	}
-	vStringDelete (name);
+	Name = vStringNew ();
+	findTopLevelForms (processSchemeForm);
+	vStringDelete (Name);
+	Name = NULL;
 }
 
 extern parserDefinition* SchemeParser (void)
@@ -0,0 +1,58 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2000-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains a scanner for the top-level forms of S-expression
+*   languages, shared by the Lisp and Scheme parsers.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "read.h"
+#include "sexp.h"
+#include "vstring.h"
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/*  Hands each top-level form of the input to "callback", given as the text
+ *  of its opening line. Forms are recognized by the convention the
+ *  per-language scanners have always relied on -- a top-level form opens
+ *  with a parenthesis in the first column -- which lets the reader stride
+ *  the input buffer from one form to the next instead of inspecting every
+ *  character; the lines making up a form's body are never scanned.
+ */
+extern void findTopLevelForms (const sexpFormCallback callback)
+{
+	const unsigned char *line;
+
+	while ((line = fileSkipLinesUntilPrefix ("(")) != NULL)
+		callback (line);
+}
+
+/*  Reads the symbol beginning at "cp" into "name": everything up to the
+ *  first white space, parenthesis or end of line.
+ */
+extern void readSexpSymbol (vString *const name, const unsigned char *cp)
+{
+	vStringClear (name);
+	while (*cp != '\0'  &&  *cp != '('  &&  *cp != ')'  &&
+		   ! isspace ((int) *cp))
+	{
+		vStringPut (name, (int) *cp);
+		++cp;
+	}
+	vStringTerminate (name);
+}
+
+/* vi:set tabstop=4 shiftwidth=4: */
@@ -0,0 +1,34 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2000-2002, Darren Hiebert
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to sexp.c
+*/
+#ifndef _SEXP_H
+#define _SEXP_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef void (*sexpFormCallback) (const unsigned char *const line);
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void findTopLevelForms (const sexpFormCallback callback);
+extern void readSexpSymbol (vString *const name, const unsigned char *cp);
+
+#endif  /* _SEXP_H */
+
+/* vi:set tabstop=4 shiftwidth=4: */
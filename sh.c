@@ -20,6 +20,7 @@
 #include "parse.h"
 #include "read.h"
 #include "routines.h"
+#include "strlist.h"
 #include "vstring.h"
 
 /*
@@ -50,52 +51,175 @@ static boolean hackReject (const vString* const tagName)
 	return result;
 }
 
-static void findShTags (void)
+/*  Looks for here-document redirections on the line, remembering the
+ *  delimiter of each so that its body can be skipped wholesale. The stored
+ *  delimiter carries a one-character prefix: '-' when the redirection was
+ *  "<<-" (the terminator may then be indented with tabs), '<' otherwise.
+ *  Quoted spans and arithmetic expansions are jumped over since "<<"
+ *  inside them does not open a here-document.
+ */
+static void collectHereDocDelimiters (
+		const unsigned char *cp, stringList *const delimiters)
 {
-	vString *name = vStringNew ();
-	const unsigned char *line;
-
-	while ((line = fileReadLine ()) != NULL)
+	while (*cp != '\0')
 	{
-		const unsigned char* cp = line;
-		boolean functionFound = FALSE;
-
-		if (line [0] == '#')
-			continue;
-
-		while (isspace (*cp))
-			cp++;
-		if (strncmp ((const char*) cp, "function", (size_t) 8) == 0  &&
-			isspace ((int) cp [8]))
+		if (*cp == '\\'  &&  cp [1] != '\0')
+			cp += 2;
+		else if (*cp == '\''  ||  *cp == '"')
 		{
-			functionFound = TRUE;
-			cp += 8;
-			if (! isspace ((int) *cp))
-				continue;
+			const char *const close =
+				strchr ((const char *) cp + 1, (int) *cp);
+			if (close == NULL)
+				return;  /* quote spans lines; nothing more can open here */
+			cp = (const unsigned char *) close + 1;
+		}
+		else if (cp [0] == '('  &&  cp [1] == '(')
+		{
+			const char *const close = strstr ((const char *) cp + 2, "))");
+			if (close == NULL)
+				return;
+			cp = (const unsigned char *) close + 2;
+		}
+		else if (*cp == '#')
+			return;
+		else if (cp [0] == '<'  &&  cp [1] == '<'  &&  cp [2] != '<')
+		{
+			vString *const delimiter = vStringNew ();
+
+			cp += 2;
+			if (*cp == '-')
+			{
+				vStringPut (delimiter, '-');
+				++cp;
+			}
+			else
+				vStringPut (delimiter, '<');
 			while (isspace ((int) *cp))
 				++cp;
+			if (*cp == '\\')
+				++cp;
+			else if (*cp == '\''  ||  *cp == '"')
+			{
+				const int quote = *cp++;
+				while (*cp != '\0'  &&  *cp != quote)
+				{
+					vStringPut (delimiter, (int) *cp);
+					++cp;
+				}
+				if (*cp == quote)
+					++cp;
+				goto collected;
+			}
+			while (*cp != '\0'  &&  ! isspace ((int) *cp)  &&
+				   strchr (";&|<>()'\"`", (int) *cp) == NULL)
+			{
+				vStringPut (delimiter, (int) *cp);
+				++cp;
+			}
+		collected:
+			if (vStringLength (delimiter) > 1  &&
+				! isdigit ((int) vStringValue (delimiter) [1]))
+				stringListAdd (delimiters, delimiter);
+			else
+				vStringDelete (delimiter);  /* arithmetic operand or stray */
 		}
-		if (! (isalnum ((int) *cp) || *cp == '_'))
-			continue;
-		while (isalnum ((int) *cp)  ||  *cp == '_')
-		{
-			vStringPut (name, (int) *cp);
+		else
 			++cp;
+	}
+}
+
+/*  Skips to the line terminating the here-document whose stored delimiter
+ *  (with its '-'/'<' prefix) is passed in; an unterminated body runs to
+ *  end of file, as it does in the shell.
+ */
+static void skipHereDocument (const char *const delimiter)
+{
+	const char *const terminator = delimiter + 1;
+	const unsigned char *line;
+
+	if (delimiter [0] == '-')
+	{
+		while ((line = fileReadLine ()) != NULL)
+		{
+			while (*line == '\t')
+				++line;
+			if (strcmp ((const char *) line, terminator) == 0)
+				break;
 		}
-		vStringTerminate (name);
+	}
+	else
+	{
+		const size_t length = strlen (terminator);
+
+		while ((line = fileSkipLinesUntilPrefix (terminator)) != NULL)
+			if (line [length] == '\0')
+				break;
+	}
+}
+
+static void checkLineForFunction (const unsigned char *cp, vString *const name)
+{
+	boolean functionFound = FALSE;
+
+	while (isspace (*cp))
+		cp++;
+	if (strncmp ((const char*) cp, "function", (size_t) 8) == 0  &&
+		isspace ((int) cp [8]))
+	{
+		functionFound = TRUE;
+		cp += 8;
 		while (isspace ((int) *cp))
 			++cp;
-		if (*cp++ == '(')
+	}
+	if (! (isalnum ((int) *cp) || *cp == '_'))
+		return;
+	while (isalnum ((int) *cp)  ||  *cp == '_')
+	{
+		vStringPut (name, (int) *cp);
+		++cp;
+	}
+	vStringTerminate (name);
+	while (isspace ((int) *cp))
+		++cp;
+	if (*cp++ == '(')
+	{
+		while (isspace ((int) *cp))
+			++cp;
+		if (*cp == ')'  && ! hackReject (name))
+			functionFound = TRUE;
+	}
+	if (functionFound)
+		makeSimpleTag (name, ShKinds, K_FUNCTION);
+	vStringClear (name);
+}
+
+static void findShTags (void)
+{
+	vString *name = vStringNew ();
+	stringList *delimiters = stringListNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		if (line [0] == '#')
+			continue;
+
+		collectHereDocDelimiters (line, delimiters);
+		checkLineForFunction (line, name);
+
+		/*  Any here-document bodies follow this line; they cannot define
+		 *  functions, so stride over each in turn.
+		 */
+		if (stringListCount (delimiters) > 0)
 		{
-			while (isspace ((int) *cp))
-				++cp;
-			if (*cp == ')'  && ! hackReject (name))
-				functionFound = TRUE;
+			unsigned int i;
+			for (i = 0  ;  i < stringListCount (delimiters)  ;  ++i)
+				skipHereDocument (
+						vStringValue (stringListItem (delimiters, i)));
+			stringListClear (delimiters);
 		}
-		if (functionFound)
-			makeSimpleTag (name, ShKinds, K_FUNCTION);
-		vStringClear (name);
 	}
+	stringListDelete (delimiters);
 	vStringDelete (name);
 }
 
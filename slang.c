@@ -15,19 +15,125 @@
  *   INCLUDE FILES
  */
 #include "general.h"  /* must always come first */
+
+#include <string.h>
+
 #include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+ *   DATA DEFINITIONS
+ */
+typedef enum {
+	K_FUNCTION, K_NAMESPACE
+} slangKind;
+
+static kindOption SlangKinds [] = {
+	{ TRUE, 'f', "function",  "functions"},
+	{ TRUE, 'n', "namespace", "namespaces"}
+};
 
 /*
  *   FUNCTION DEFINITIONS
  */
-static void installSlangRegex (const langType language)
+
+static boolean isIdentChar (const int c)
+{
+	return (boolean) (isalnum (c)  ||  c == '_');
+}
+
+/*  Tags the identifier following the last "define" on the line (matched
+ *  without regard to case, even inside a longer word) whose remainder up
+ *  to the end of the line is free of semicolons, as the greedy pattern
+ *  "^.*define[ \t]+([A-Z_][A-Z0-9_]*)[^;]*$" this replaces did.
+ */
+static void checkLineForDefine (const char *const line, vString *const name)
 {
-	addTagRegex (language,
-		"^.*define[ \t]+([A-Z_][A-Z0-9_]*)[^;]*$",
-		"\\1", "f,function,functions", "i");
-	addTagRegex (language,
-		"^[ \t]*implements[ \t]+\\([ \t]*\"([^\"]*)\"[ \t]*\\)[ \t]*;",
-		"\\1", "n,namespace,namespaces", NULL);
+	const char *start = NULL;
+	const char *end = NULL;
+	const char *p;
+
+	for (p = line  ;  *p != '\0'  ;  ++p)
+	{
+		const char *candidate;
+		const char *candidateEnd;
+
+		if (strncasecmp (p, "define", (size_t) 6) != 0)
+			continue;
+		candidate = p + 6;
+		if (*candidate != ' '  &&  *candidate != '\t')
+			continue;
+		while (*candidate == ' '  ||  *candidate == '\t')
+			++candidate;
+		if (! isalpha ((unsigned char) *candidate)  &&  *candidate != '_')
+			continue;
+		for (candidateEnd = candidate + 1  ;
+			 isIdentChar ((unsigned char) *candidateEnd)  ;  ++candidateEnd)
+			;
+		if (strchr (candidateEnd, ';') != NULL)
+			continue;
+		start = candidate;
+		end = candidateEnd;
+	}
+	if (start != NULL)
+	{
+		vStringNCopyS (name, start, (size_t) (end - start));
+		makeSimpleTag (name, SlangKinds, K_FUNCTION);
+	}
+}
+
+/*  Matches '^[ \t]*implements[ \t]+\([ \t]*"([^"]*)"[ \t]*\)[ \t]*;'.
+ */
+static void checkLineForImplements (const char *const line, vString *const name)
+{
+	const char *cp = line;
+	const char *close;
+
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	if (strncmp (cp, "implements", (size_t) 10) != 0)
+		return;
+	cp += 10;
+	if (*cp != ' '  &&  *cp != '\t')
+		return;
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	if (*cp != '(')
+		return;
+	++cp;
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	if (*cp != '"')
+		return;
+	++cp;
+	close = strchr (cp, '"');
+	if (close == NULL)
+		return;
+	vStringNCopyS (name, cp, (size_t) (close - cp));
+	cp = close + 1;
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	if (*cp != ')')
+		return;
+	++cp;
+	while (*cp == ' '  ||  *cp == '\t')
+		++cp;
+	if (*cp == ';')
+		makeSimpleTag (name, SlangKinds, K_NAMESPACE);
+}
+
+static void findSlangTags (void)
+{
+	vString *name = vStringNew ();
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		checkLineForDefine ((const char *) line, name);
+		checkLineForImplements ((const char *) line, name);
+	}
+	vStringDelete (name);
 }
 
 extern parserDefinition* SlangParser (void)
@@ -35,7 +141,8 @@ extern parserDefinition* SlangParser (void)
 	static const char *const extensions [] = { "sl", NULL };
 	parserDefinition* const def = parserNew ("SLang");
 	def->extensions = extensions;
-	def->initialize = installSlangRegex;
-	def->regex      = TRUE;
+	def->kinds      = SlangKinds;
+	def->kindCount  = KIND_COUNT (SlangKinds);
+	def->parser     = findSlangTags;
 	return def;
 }
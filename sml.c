@@ -51,18 +51,19 @@ static kindOption SmlKinds[] = {
 
 static struct {
 	const char *keyword;
+	size_t length;
 	smlKind kind;
 } SmlKeywordTypes [] = {
-	{ "abstype",   K_TYPE      },
-	{ "and",       K_AND       },
-	{ "datatype",  K_TYPE      },
-	{ "exception", K_EXCEPTION },
-	{ "functor",   K_FUNCTOR   },
-	{ "fun",       K_FUNCTION  },
-	{ "signature", K_SIGNATURE },
-	{ "structure", K_STRUCTURE },
-	{ "type",      K_TYPE      },
-	{ "val",       K_VAL       }
+	{ "abstype",   7, K_TYPE      },
+	{ "and",       3, K_AND       },
+	{ "datatype",  8, K_TYPE      },
+	{ "exception", 9, K_EXCEPTION },
+	{ "functor",   7, K_FUNCTOR   },
+	{ "fun",       3, K_FUNCTION  },
+	{ "signature", 9, K_SIGNATURE },
+	{ "structure", 9, K_STRUCTURE },
+	{ "type",      4, K_TYPE      },
+	{ "val",       3, K_VAL       }
 };
 
 static unsigned int CommentLevel = 0;
@@ -99,11 +100,17 @@ static boolean isIdentifier (int c)
 	return result;
 }
 
+/*  Advances past the next identifier, returning it as the span between
+ *  "*word" and the returned position; "*length" is zero when the end of
+ *  the line is reached without finding one.
+ */
 static const unsigned char *parseIdentifier (
-		const unsigned char *cp, vString *const identifier)
+		const unsigned char *cp, const unsigned char **const word,
+		size_t *const length)
 {
 	boolean stringLit = FALSE;
-	vStringClear (identifier);
+	*word = cp;
+	*length = 0;
 	while (*cp != '\0'  &&  (!isIdentifier ((int) *cp) || stringLit))
 	{
 		int oneback = *cp;
@@ -121,33 +128,43 @@ static const unsigned char *parseIdentifier (
 		if (stringLit && *cp == '"' && oneback != '\\')
 			stringLit = FALSE;
 	}
-	if (strcmp ((const char *) cp, "") == 0 || cp == NULL)
+	if (*cp == '\0')
 		return cp;
 
+	*word = cp;
 	while (isIdentifier ((int) *cp))
-	{
-		vStringPut (identifier, (int) *cp);
 		cp++;
-	}
-	vStringTerminate (identifier);
+	*length = cp - *word;
 	return cp;
 }
 
-static smlKind findNextIdentifier (const unsigned char **cp)
+/*  Classifies "word" against the keyword table with cheap probes: the
+ *  length and first byte dismiss a non-keyword before any of its other
+ *  bytes are compared.
+ */
+static smlKind classifyWord (const unsigned char *const word, const size_t length)
 {
-	smlKind result = K_NONE;
-	vString *const identifier = vStringNew ();
 	unsigned int count = sizeof (SmlKeywordTypes) / sizeof (SmlKeywordTypes [0]);
 	unsigned int i;
-	*cp = parseIdentifier (*cp, identifier);
-	for (i = 0  ;  i < count  &&  result == K_NONE ;  ++i)
+	for (i = 0  ;  i < count  ;  ++i)
 	{
-		const char *id = vStringValue (identifier);
-		if (strcmp (id, SmlKeywordTypes [i].keyword) == 0)
-			result = SmlKeywordTypes [i].kind;
+		if (SmlKeywordTypes [i].length == length  &&
+			SmlKeywordTypes [i].keyword [0] == (char) word [0]  &&
+			strncmp ((const char *) word, SmlKeywordTypes [i].keyword,
+					 length) == 0)
+			return SmlKeywordTypes [i].kind;
 	}
-	vStringDelete (identifier);
-	return result;
+	return K_NONE;
+}
+
+static smlKind findNextIdentifier (const unsigned char **cp)
+{
+	const unsigned char *word;
+	size_t length;
+	*cp = parseIdentifier (*cp, &word, &length);
+	if (length == 0)
+		return K_NONE;
+	return classifyWord (word, length);
 }
 
 static void findSmlTags (void)
@@ -176,8 +193,12 @@ static void findSmlTags (void)
 			foundTag = findNextIdentifier (&cp);
 			if (foundTag != K_NONE)
 			{
+				const unsigned char *word;
+				size_t length;
 				cp = skipSpace (cp);
-				cp = parseIdentifier (cp, identifier);
+				cp = parseIdentifier (cp, &word, &length);
+				vStringClear (identifier);
+				vStringNCatS (identifier, (const char *) word, length);
 				if (foundTag == K_AND)
 					makeSmlTag (lastTag, identifier);
 				else
@@ -193,7 +214,7 @@ static void findSmlTags (void)
 				if (cp == NULL)
 					++CommentLevel;
 			}
-		} while (cp != NULL  &&  strcmp ((const char *) cp, "") != 0);
+		} while (cp != NULL  &&  *cp != '\0');
 	}
 	vStringDelete (identifier);
 }
@@ -19,6 +19,18 @@
 #endif
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>   /* to declare toupper() */
+#include <limits.h>  /* to declare CHAR_MIN */
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>  /* to declare fork() */
+#endif
+#if defined (HAVE_FORK) && defined (HAVE_WAITPID)
+# define PARALLEL_SORT_SUPPORTED
+#endif
+#ifdef PARALLEL_SORT_SUPPORTED
+# include <sys/wait.h>  /* to declare waitpid() */
+# include <signal.h>    /* to ignore SIGPIPE while feeding the sort */
+#endif
 
 #include "debug.h"
 #include "entry.h"
@@ -26,6 +38,7 @@
 #include "read.h"
 #include "routines.h"
 #include "sort.h"
+#include "strlist.h"
 
 /*
 *   FUNCTION DEFINITIONS
@@ -33,18 +46,291 @@
 
 extern void catFile (const char *const name)
 {
-	FILE *const fp = fopen (name, "r");
+	FILE *const fp = fopen (name, "rb");
 
 	if (fp != NULL)
 	{
-		int c;
-		while ((c = getc (fp)) != EOF)
-			putchar (c);
+		char buffer [BUFSIZ * 8];
+		size_t size;
+
+		while ((size = fread (buffer, 1, sizeof buffer, fp)) > 0)
+			fwrite (buffer, 1, size, stdout);
 		fflush (stdout);
 		fclose (fp);
 	}
 }
 
+/*
+ *  Merging appended tags
+ */
+
+/*  Compares two tag lines in the requested sort order.
+ */
+extern int compareTagLine (const char *const line1, const char *const line2)
+{
+	return (Option.sorted == SO_FOLDSORTED) ?
+			struppercmp (line1, line2) : strcmp (line1, line2);
+}
+
+static int compareTagLinePointers (const void *const one, const void *const two)
+{
+	return compareTagLine (*(const char *const *) one,
+						   *(const char *const *) two);
+}
+
+static int compareStringPointers (const void *const one, const void *const two)
+{
+	return strcmp (*(const char *const *) one, *(const char *const *) two);
+}
+
+/*  Tests whether the file field of a tag line names one of the source files
+ *  tagged again during this run. The field is compared in place, since it is
+ *  not NUL terminated; the names arrive sorted so that each test is a binary
+ *  search even when a large file is being scanned.
+ */
+extern boolean fileFieldMatches (
+		const char *const line,
+		const char *const *const files, const size_t count)
+{
+	const char *const tab1 = strchr (line, '\t');
+	boolean result = FALSE;
+
+	if (tab1 != NULL)
+	{
+		const char *const field = tab1 + 1;
+		const char *const tab2 = strchr (field, '\t');
+		size_t length;
+		size_t lower = 0, upper = count;
+
+		if (tab2 != NULL)
+			length = tab2 - field;
+		else
+		{
+			length = strlen (field);
+			if (length > 0  &&  field [length - 1] == '\n')
+				--length;
+		}
+		while (lower < upper)
+		{
+			const size_t middle = (lower + upper) / 2;
+			const char *const name = files [middle];
+			int comparison = strncmp (field, name, length);
+
+			if (comparison == 0  &&  name [length] != '\0')
+				comparison = -1;  /* field is a proper prefix of name */
+			if (comparison == 0)
+			{
+				result = TRUE;
+				break;
+			}
+			else if (comparison < 0)
+				upper = middle;
+			else
+				lower = middle + 1;
+		}
+	}
+	return result;
+}
+
+/*  Writes one line of merge output, filtering out identical tag lines just
+ *  as the sort paths do. Returns the updated "havePrevious" state.
+ */
+extern boolean putMergedLine (
+		FILE *const dest, const char *const line,
+		vString *const previous, const boolean havePrevious)
+{
+	if (! havePrevious  ||  strcmp (line, vStringValue (previous)) != 0)
+	{
+		if (fputs (line, dest) == EOF)
+			error (FATAL | PERROR, "cannot write tag file");
+		vStringCopyS (previous, line);
+	}
+	return TRUE;
+}
+
+/*  Merges the tags appended by this run into the already sorted body of the
+ *  existing tag file in one linear pass, instead of re-sorting the entire
+ *  file. The appended region (everything past appendOffset) is sorted in
+ *  memory, then interleaved with the old records streamed in their existing
+ *  order; old records belonging to files tagged again during this run are
+ *  dropped along the way, so updated files do not accumulate stale entries.
+ *  Returns FALSE, leaving the file untouched, when the merge cannot proceed;
+ *  the caller then sorts the whole file as before.
+ */
+extern boolean mergeAppendedTags (
+		const long appendOffset, const stringList *const replacedFiles)
+{
+	FILE *const fp = fopen (tagFileName (), "r");
+	boolean result = FALSE;
+
+	if (fp != NULL  &&  fseek (fp, appendOffset, SEEK_SET) == 0)
+	{
+		vString *const vLine = vStringNew ();
+		vString *const previous = vStringNew ();
+		boolean havePrevious = FALSE;
+		FILE *dest;
+		char *tempName = NULL;
+		const char *line;
+		char **added = NULL;
+		size_t addedCount = 0, addedSlots = 0;
+		const char **replaced = NULL;
+		size_t replacedCount = 0;
+		size_t i;
+
+		verbose ("merging appended tags into sorted tag file\n");
+
+		/*  Read the appended region into a sortable table of lines.
+		 */
+		while ((line = readLine (vLine, fp)) != NULL)
+		{
+			if (*line == '\0'  ||  strcmp (line, "\n") == 0)
+				continue;  /* ignore blank lines */
+			if (addedCount == addedSlots)
+			{
+				addedSlots = (addedSlots == 0) ? 256 : 2 * addedSlots;
+				added = xRealloc (added, addedSlots, char*);
+			}
+			added [addedCount++] = eStrdup (line);
+		}
+		qsort (added, addedCount, sizeof (*added), compareTagLinePointers);
+
+		/*  Sort the replaced file names once, since they are searched for
+		 *  every old record.
+		 */
+		if (replacedFiles != NULL  &&  stringListCount (replacedFiles) > 0)
+		{
+			replacedCount = stringListCount (replacedFiles);
+			replaced = xMalloc (replacedCount, const char*);
+			for (i = 0  ;  i < replacedCount  ;  ++i)
+				replaced [i] = vStringValue (stringListItem (replacedFiles, i));
+			qsort (replaced, replacedCount, sizeof (*replaced),
+				   compareStringPointers);
+		}
+
+		/*  Stream the old region, interleaving the sorted new lines.
+		 */
+		rewind (fp);
+		dest = tempFile ("w", &tempName);
+		i = 0;
+		while (ftell (fp) < appendOffset  &&
+			   (line = readLine (vLine, fp)) != NULL)
+		{
+			if (replacedCount > 0  &&
+				fileFieldMatches (line, replaced, replacedCount))
+				continue;  /* this run replaces the file's old records */
+			while (i < addedCount  &&  compareTagLine (added [i], line) <= 0)
+				havePrevious = putMergedLine (
+									dest, added [i++], previous, havePrevious);
+			havePrevious = putMergedLine (dest, line, previous, havePrevious);
+		}
+		while (i < addedCount)
+			havePrevious = putMergedLine (
+								dest, added [i++], previous, havePrevious);
+		fclose (dest);
+
+		for (i = 0  ;  i < addedCount  ;  ++i)
+			eFree (added [i]);
+		if (added != NULL)
+			eFree (added);
+		if (replaced != NULL)
+			eFree ((char **) replaced);
+		vStringDelete (previous);
+		vStringDelete (vLine);
+
+		copyFile (tempName, tagFileName (), WHOLE_FILE);
+		remove (tempName);
+		eFree (tempName);
+		result = TRUE;
+	}
+	if (fp != NULL)
+		fclose (fp);
+	return result;
+}
+
+/*
+ *  Merging shard tag files
+ */
+
+typedef struct sShardSource {
+	FILE *fp;         /* open shard file, NULL once exhausted */
+	vString *line;    /* current line, including its newline */
+} shardSource;
+
+/*  Advances a shard to its next line, closing it at end of file.
+ */
+static void advanceShard (shardSource *const shard)
+{
+	if (readLine (shard->line, shard->fp) == NULL)
+	{
+		fclose (shard->fp);
+		shard->fp = NULL;
+	}
+}
+
+/*  Merges the already sorted tag files produced by the shards of a
+ *  distributed run (see --shard) into a single sorted tag file, in one
+ *  linear pass over the shards. Identical adjacent lines are written once,
+ *  which also collapses the pseudo-tag headers repeated by every shard.
+ *  The shard files are left in place so they can be reused.
+ */
+extern void mergeTagFiles (
+		const stringList *const names, const boolean toStdout)
+{
+	const unsigned int count = stringListCount (names);
+	shardSource *const shards = xMalloc (count, shardSource);
+	vString *const previous = vStringNew ();
+	boolean havePrevious = FALSE;
+	FILE *dest;
+	unsigned int i;
+
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		const char *const name = vStringValue (stringListItem (names, i));
+
+		shards [i].fp = fopen (name, "r");
+		if (shards [i].fp == NULL)
+			error (FATAL | PERROR, "cannot open shard tag file \"%s\"", name);
+		shards [i].line = vStringNew ();
+		advanceShard (&shards [i]);
+	}
+	if (toStdout)
+		dest = stdout;
+	else
+	{
+		dest = fopen (Option.tagFileName, "w");
+		if (dest == NULL)
+			error (FATAL | PERROR, "cannot open tag file \"%s\"",
+				   Option.tagFileName);
+	}
+	do
+	{
+		shardSource *smallest = NULL;
+
+		for (i = 0  ;  i < count  ;  ++i)
+		{
+			if (shards [i].fp != NULL  &&
+				(smallest == NULL  ||
+				 compareTagLine (vStringValue (shards [i].line),
+								 vStringValue (smallest->line)) < 0))
+				smallest = &shards [i];
+		}
+		if (smallest == NULL)
+			break;
+		havePrevious = putMergedLine (
+				dest, vStringValue (smallest->line), previous, havePrevious);
+		advanceShard (smallest);
+	} while (TRUE);
+	if (toStdout)
+		fflush (dest);
+	else
+		fclose (dest);
+
+	for (i = 0  ;  i < count  ;  ++i)
+		vStringDelete (shards [i].line);
+	eFree (shards);
+	vStringDelete (previous);
+}
+
 #ifdef EXTERNAL_SORT
 
 #ifdef NON_CONST_PUTENV_PROTOTYPE
@@ -53,7 +339,99 @@ extern void catFile (const char *const name)
 # define PE_CONST const
 #endif
 
-extern void externalSortTags (const boolean toStdout)
+#ifdef PIPED_SORT_SUPPORTED
+
+static pid_t SortPid = -1;
+
+/*  Spawns the external sort with its input on a pipe and its output
+ *  directed at the tag file, so that records can be streamed to it while
+ *  parsing continues and the unsorted output never has to be written to
+ *  disk and read back. Returns NULL when the process cannot be created;
+ *  the caller then writes the tag file and sorts it in place as before.
+ */
+extern FILE *openSortPipe (const char *const outputName)
+{
+	int pipefd [2];
+	FILE *result = NULL;
+
+	if (pipe (pipefd) == 0)
+	{
+		SortPid = fork ();
+		if (SortPid == -1)
+		{
+			close (pipefd [0]);
+			close (pipefd [1]);
+		}
+		else if (SortPid == 0)
+		{
+			close (pipefd [1]);
+			if (dup2 (pipefd [0], 0) == -1)
+				_exit (1);
+			close (pipefd [0]);
+
+			/*  Ensure ASCII value sort order.
+			 */
+#ifdef HAVE_SETENV
+			setenv ("LC_COLLATE", "C", 1);
+			setenv ("LC_ALL", "C", 1);
+#else
+			putenv ("LC_COLLATE=C");
+			putenv ("LC_ALL=C");
+#endif
+			if (Option.sorted == SO_FOLDSORTED)
+				execlp ("sort", "sort", "-u", "-f", "-o", outputName,
+						(char *) NULL);
+			else
+				execlp ("sort", "sort", "-u", "-o", outputName,
+						(char *) NULL);
+			_exit (1);
+		}
+		else
+		{
+			close (pipefd [0]);
+			result = fdopen (pipefd [1], "w");
+			if (result == NULL)
+			{
+				close (pipefd [1]);
+				closeSortPipe (NULL);
+			}
+			else
+			{
+#ifdef SIGPIPE
+				/*  A failed sort process is reported through the write
+				 *  error, not by killing this process.
+				 */
+				signal (SIGPIPE, SIG_IGN);
+#endif
+				verbose ("streaming tags into \"sort -u\"\n");
+			}
+		}
+	}
+	return result;
+}
+
+/*  Closes the stream feeding the sort process and waits for it to finish
+ *  writing the sorted tag file. Returns FALSE when the sort failed.
+ */
+extern boolean closeSortPipe (FILE *const fp)
+{
+	int status;
+	boolean succeeded = TRUE;
+
+	if (fp != NULL  &&  fclose (fp) != 0)
+		succeeded = FALSE;
+	if (waitpid (SortPid, &status, 0) == -1  ||
+		! WIFEXITED (status)  ||  WEXITSTATUS (status) != 0)
+		succeeded = FALSE;
+	SortPid = -1;
+	return succeeded;
+}
+
+#endif
+
+/*  Sorts the named tag file in place with the external sort program.
+ */
+extern void sortTagsInFile (const char *const name)
 {
 	const char *const sortNormalCommand = "sort -u -o";
 	const char *const sortFoldedCommand = "sort -u -f -o";
@@ -62,7 +440,7 @@ extern void externalSortTags (const boolean toStdout)
 	PE_CONST char *const sortOrder1 = "LC_COLLATE=C";
 	PE_CONST char *const sortOrder2 = "LC_ALL=C";
 	const size_t length = 4 + strlen (sortOrder1) + strlen (sortOrder2) +
-			strlen (sortCommand) + (2 * strlen (tagFileName ()));
+			strlen (sortCommand) + (2 * strlen (name));
 	char *const cmd = (char *) malloc (length + 1);
 	int ret = -1;
 
@@ -73,15 +451,15 @@ extern void externalSortTags (const boolean toStdout)
 #ifdef HAVE_SETENV
 		setenv ("LC_COLLATE", "C", 1);
 		setenv ("LC_ALL", "C", 1);
-		sprintf (cmd, "%s %s %s", sortCommand, tagFileName (), tagFileName ());
+		sprintf (cmd, "%s %s %s", sortCommand, name, name);
 #else
 # ifdef HAVE_PUTENV
 		putenv (sortOrder1);
 		putenv (sortOrder2);
-		sprintf (cmd, "%s %s %s", sortCommand, tagFileName (), tagFileName ());
+		sprintf (cmd, "%s %s %s", sortCommand, name, name);
 # else
 		sprintf (cmd, "%s %s %s %s %s", sortOrder1, sortOrder2, sortCommand,
-				tagFileName (), tagFileName ());
+				name, name);
 # endif
 #endif
 		verbose ("system (\"%s\")\n", cmd);
@@ -91,7 +469,12 @@ extern void externalSortTags (const boolean toStdout)
 	}
 	if (ret != 0)
 		error (FATAL | PERROR, "cannot sort tag file");
-	else if (toStdout)
+}
+
+extern void externalSortTags (const boolean toStdout)
+{
+	sortTagsInFile (tagFileName ());
+	if (toStdout)
 		catFile (tagFileName ());
 }
 
@@ -103,6 +486,150 @@ extern void externalSortTags (const boolean toStdout)
  *  so have lots of memory if you have large tag files.
  */
 
+/*  Tag lines remembered as they are written, so that the sort can work
+ *  on the in-memory copies instead of re-reading the tag file. To bound
+ *  memory use on huge tag files, the remembered lines are spilled to
+ *  sorted runs in temporary files whenever their number reaches
+ *  SORT_RUN_LIMIT; the runs are merged when the sort is performed.
+ */
+#define SORT_RUN_LIMIT  (1024 * 1024)  /* lines held in memory per run */
+
+/*  A sort is divided among forked workers only when each would receive at
+ *  least this many lines; below that the fork and merge overhead exceeds
+ *  the sorting time saved.
+ */
+#define PARALLEL_SORT_MIN  0x20000  /* minimum lines per sort worker */
+
+/*  For case-folded sorts a key of this many folded bytes is computed once
+ *  per line and compared with memcmp (), so that the comparator does not
+ *  have to upper-case both lines on every comparison.
+ */
+#define FOLD_KEY_SIZE  16  /* folded bytes preceding each stored line */
+
+static char **TagLines = NULL;
+static size_t TagLineCount = 0;
+static size_t TagLineAllocated = 0;
+
+typedef struct sTagRun {
+	char *name;     /* temporary file holding one sorted run */
+	FILE *fp;       /* open stream while merging, NULL otherwise */
+	vString *line;  /* current line while merging, NULL when exhausted */
+} tagRun;
+
+static tagRun *Runs = NULL;
+static unsigned int RunCount = 0;
+static unsigned int RunAllocated = 0;
+
+/*  Returns the number of bytes reserved in front of each stored line for
+ *  a precomputed sort key; zero when the sort needs none.
+ */
+static size_t lineKeySize (void)
+{
+	return (Option.sorted == SO_FOLDSORTED) ? FOLD_KEY_SIZE : 0;
+}
+
+/*  Copies a tag line into an allocated buffer, preceded by any sort key,
+ *  and returns a pointer to the line text within the buffer. The key holds
+ *  the first FOLD_KEY_SIZE bytes of the line upper-cased as struppercmp ()
+ *  would see them, biased by -CHAR_MIN so that comparing the key bytes
+ *  unsigned (as memcmp () does) matches the char comparison performed by
+ *  struppercmp () whether or not char is signed; bytes beyond the end of
+ *  a short line fold as the NUL terminator does.
+ */
+static char *storeTagLine (const char *const line)
+{
+	const size_t keySize = lineKeySize ();
+	const size_t stringSize = strlen (line) + 1;
+	char *const buffer = xMalloc (keySize + stringSize, char);
+	char *const stored = buffer + keySize;
+	size_t i;
+
+	for (i = 0  ;  i < keySize  ;  ++i)
+	{
+		const int c = (i < stringSize - 1) ? (int) line [i] : 0;
+		buffer [i] = (char) (toupper (c) - CHAR_MIN);
+	}
+	memcpy (stored, line, stringSize);
+	return stored;
+}
+
+static void releaseTagLine (char *const line)
+{
+	eFree (line - lineKeySize ());
+}
+
+static int compareTagsFolded(const void *const one, const void *const two)
+{
+	const char *const line1 = *(const char* const*) one;
+	const char *const line2 = *(const char* const*) two;
+	const int diff = memcmp (line1 - FOLD_KEY_SIZE, line2 - FOLD_KEY_SIZE,
+							 FOLD_KEY_SIZE);
+
+	return (diff != 0) ? diff : struppercmp (line1, line2);
+}
+
+static int compareTags (const void *const one, const void *const two)
+{
+	const char *const line1 = *(const char* const*) one;
+	const char *const line2 = *(const char* const*) two;
+
+	return strcmp (line1, line2);
+}
+
+static void forgetTagLines (void);
+
+/*  Sorts the in-memory lines and writes them out as one run.
+ */
+static void spillCurrentRun (void)
+{
+	tagRun *run;
+	size_t i;
+
+	if (TagLineCount == 0)
+		return;
+	qsort (TagLines, TagLineCount, sizeof (*TagLines),
+		   Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags);
+	if (RunCount == RunAllocated)
+	{
+		RunAllocated = (RunAllocated == 0) ? 8 : 2 * RunAllocated;
+		Runs = xRealloc (Runs, RunAllocated, tagRun);
+	}
+	run = &Runs [RunCount++];
+	run->fp = tempFile ("w", &run->name);
+	run->line = NULL;
+	for (i = 0  ;  i < TagLineCount  ;  ++i)
+		if (fputs (TagLines [i], run->fp) == EOF)
+			error (FATAL | PERROR, "cannot write sort run");
+	fclose (run->fp);
+	run->fp = NULL;
+	forgetTagLines ();
+}
+
+extern void rememberTagLine (const char *const line)
+{
+	if (TagLineCount == SORT_RUN_LIMIT)
+		spillCurrentRun ();
+	if (TagLineCount == TagLineAllocated)
+	{
+		TagLineAllocated = (TagLineAllocated == 0) ?
+								256 : 2 * TagLineAllocated;
+		TagLines = xRealloc (TagLines, TagLineAllocated, char*);
+	}
+	TagLines [TagLineCount++] = storeTagLine (line);
+}
+
+static void forgetTagLines (void)
+{
+	size_t i;
+	for (i = 0  ;  i < TagLineCount  ;  ++i)
+		releaseTagLine (TagLines [i]);
+	if (TagLines != NULL)
+		eFree (TagLines);
+	TagLines = NULL;
+	TagLineCount = 0;
+	TagLineAllocated = 0;
+}
+
 static void failedSort (FILE *const fp, const char* msg)
 {
 	const char* const cannotSort = "cannot sort tag file";
@@ -114,22 +641,235 @@ static void failedSort (FILE *const fp, const char* msg)
 		error (FATAL, "%s: %s", msg, cannotSort);
 }
 
-static int compareTagsFolded(const void *const one, const void *const two)
+/*  Reads the next line of a run, closing and removing the run file when
+ *  it is exhausted.
+ */
+static void advanceRun (tagRun *const run)
 {
-	const char *const line1 = *(const char* const*) one;
-	const char *const line2 = *(const char* const*) two;
+	if (readLine (run->line, run->fp) == NULL)
+	{
+		fclose (run->fp);
+		run->fp = NULL;
+		remove (run->name);
+		eFree (run->name);
+		vStringDelete (run->line);
+		run->line = NULL;
+	}
+}
+
+/*  Merges the sorted runs into the destination with bounded memory: only
+ *  one line per run is held at any time.
+ */
+static void mergeRunsInto (FILE *const dest)
+{
+	unsigned int i;
+	vString *const previous = vStringNew ();
+	boolean havePrevious = FALSE;
+
+	verbose ("merging %u sorted runs\n", RunCount);
+	for (i = 0  ;  i < RunCount  ;  ++i)
+	{
+		Runs [i].fp = fopen (Runs [i].name, "r");
+		if (Runs [i].fp == NULL)
+			failedSort (dest == stdout ? NULL : dest, NULL);
+		Runs [i].line = vStringNew ();
+		advanceRun (&Runs [i]);
+	}
+	for (;;)
+	{
+		tagRun *next = NULL;
+		for (i = 0  ;  i < RunCount  ;  ++i)
+		{
+			if (Runs [i].line == NULL)
+				continue;
+			if (next == NULL  ||
+				compareTagLine (vStringValue (Runs [i].line),
+								vStringValue (next->line)) < 0)
+				next = &Runs [i];
+		}
+		if (next == NULL)
+			break;
 
-	return struppercmp (line1, line2);
+		/*  Identical tag lines are filtered out here, just as in
+		 *  writeSortedTags ().
+		 */
+		if (Option.xref  ||  ! havePrevious  ||
+			strcmp (vStringValue (next->line), vStringValue (previous)) != 0)
+		{
+			if (fputs (vStringValue (next->line), dest) == EOF)
+				failedSort (dest == stdout ? NULL : dest, NULL);
+			vStringCopy (previous, next->line);
+			havePrevious = TRUE;
+		}
+		advanceRun (next);
+	}
+	vStringDelete (previous);
+	eFree (Runs);
+	Runs = NULL;
+	RunCount = 0;
+	RunAllocated = 0;
 }
 
-static int compareTags (const void *const one, const void *const two)
+static void mergeSortedRuns (const boolean toStdout)
 {
-	const char *const line1 = *(const char* const*) one;
-	const char *const line2 = *(const char* const*) two;
+	FILE *dest;
 
-	return strcmp (line1, line2);
+	spillCurrentRun ();  /* the in-memory remainder becomes the last run */
+	if (toStdout)
+		dest = stdout;
+	else
+	{
+		dest = fopen (tagFileName (), "w");
+		if (dest == NULL)
+			failedSort (dest, NULL);
+	}
+	mergeRunsInto (dest);
+	if (toStdout)
+		fflush (dest);
+	else
+		fclose (dest);
 }
 
+/*  Registers an externally produced sorted file as a run to be merged into
+ *  the tag file when it is sorted. Ownership of the (allocated) name passes
+ *  to the run, which removes the file once it is exhausted.
+ */
+extern void adoptSortedRun (char *const name)
+{
+	tagRun *run;
+
+	if (RunCount == RunAllocated)
+	{
+		RunAllocated = (RunAllocated == 0) ? 8 : 2 * RunAllocated;
+		Runs = xRealloc (Runs, RunAllocated, tagRun);
+	}
+	run = &Runs [RunCount++];
+	run->name = name;
+	run->fp = NULL;
+	run->line = NULL;
+}
+
+/*  Discards the lines remembered so far; a freshly forked worker process
+ *  calls this so that lines inherited from the parent stay out of its shard.
+ */
+extern void forgetRememberedTagLines (void)
+{
+	forgetTagLines ();
+}
+
+/*  Sorts the lines remembered by this process and writes them to the given
+ *  stream. Worker processes use this to deliver their shards already
+ *  sorted, so that the parent can merge the shards directly rather than
+ *  re-sorting the combined file.
+ */
+extern void writeSortedShard (FILE *const fp)
+{
+	if (RunCount == 0)
+	{
+		size_t i;
+
+		qsort (TagLines, TagLineCount, sizeof (*TagLines),
+			   Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags);
+		for (i = 0  ;  i < TagLineCount  ;  ++i)
+			if (fputs (TagLines [i], fp) == EOF)
+				error (FATAL | PERROR, "cannot write sorted shard");
+	}
+	else
+	{
+		spillCurrentRun ();
+		mergeRunsInto (fp);
+	}
+	forgetTagLines ();
+}
+
+#ifdef PARALLEL_SORT_SUPPORTED
+
+/*  Sorts the line-pointer table with a pool of forked workers, each one
+ *  sorting an equal chunk of the table and writing it out as a sorted run
+ *  for mergeSortedRuns () to combine. The comparisons themselves thereby
+ *  scale with the number of jobs requested. Returns FALSE when the table
+ *  is too small for forking to pay off, or when a worker fails, in which
+ *  case the caller should sort the table itself.
+ */
+static boolean parallelSortToRuns (
+		char **const table, const size_t numTags,
+		int (*cmpFunc)(const void *, const void *))
+{
+	unsigned int workers = Option.jobs;
+	unsigned int i;
+	pid_t *pids;
+	boolean result = TRUE;
+
+	if (workers > numTags / PARALLEL_SORT_MIN)
+		workers = (unsigned int) (numTags / PARALLEL_SORT_MIN);
+	if (workers < 2)
+		return FALSE;
+	Assert (RunCount == 0);
+
+	verbose ("sorting %lu tag lines with %u workers\n",
+			(unsigned long) numTags, workers);
+	pids = xMalloc (workers, pid_t);
+	Runs = xRealloc (Runs, workers, tagRun);
+	RunAllocated = workers;
+	RunCount = workers;
+	for (i = 0  ;  i < workers  ;  ++i)
+	{
+		Runs [i].fp = NULL;
+		Runs [i].line = NULL;
+		fclose (tempFile ("w", &Runs [i].name));
+	}
+	for (i = 0  ;  i < workers  ;  ++i)
+	{
+		const size_t begin = i * (numTags / workers);
+		const size_t end = (i == workers - 1) ?
+								numTags : begin + numTags / workers;
+		pids [i] = fork ();
+		if (pids [i] == -1)
+			error (FATAL | PERROR, "cannot fork sort process");
+		else if (pids [i] == 0)
+		{
+			FILE *const fp = fopen (Runs [i].name, "w");
+			size_t j;
+			if (fp == NULL)
+				error (FATAL | PERROR, "cannot open sort run file");
+			qsort (table + begin, end - begin, sizeof (*table), cmpFunc);
+			for (j = begin  ;  j < end  ;  ++j)
+				if (fputs (table [j], fp) == EOF)
+					error (FATAL | PERROR, "cannot write sort run");
+			fclose (fp);
+			_exit (0);
+		}
+	}
+	for (i = 0  ;  i < workers  ;  ++i)
+	{
+		int status;
+		if (waitpid (pids [i], &status, 0) == -1  ||
+			! WIFEXITED (status)  ||  WEXITSTATUS (status) != 0)
+		{
+			error (WARNING, "sort process failed; sorting sequentially");
+			result = FALSE;
+		}
+	}
+	eFree (pids);
+	if (! result)
+	{
+		/*  Discard the runs and leave the table for the caller to sort.
+		 */
+		for (i = 0  ;  i < RunCount  ;  ++i)
+		{
+			remove (Runs [i].name);
+			eFree (Runs [i].name);
+		}
+		eFree (Runs);
+		Runs = NULL;
+		RunCount = 0;
+		RunAllocated = 0;
+	}
+	return result;
+}
+
+#endif
+
 static void writeSortedTags (
 		char **const table, const size_t numTags, const boolean toStdout)
 {
@@ -161,23 +901,23 @@ static void writeSortedTags (
 		fclose (fp);
 }
 
-extern void internalSortTags (const boolean toStdout)
+static void sortTagsFromFile (
+		const boolean toStdout, const size_t expectedTags,
+		int (*cmpFunc)(const void *, const void *))
 {
 	vString *vLine = vStringNew ();
 	FILE *fp = NULL;
 	const char *line;
 	size_t i;
-	int (*cmpFunc)(const void *, const void *);
 
 	/*  Allocate a table of line pointers to be sorted.
 	 */
-	size_t numTags = TagFile.numTags.added + TagFile.numTags.prev;
+	size_t numTags = expectedTags;
 	const size_t tableSize = numTags * sizeof (char *);
 	char **const table = (char **) malloc (tableSize);  /* line pointers */
 	DebugStatement ( size_t mallocSize = tableSize; )  /* cumulative total */
 
 
-	cmpFunc = Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags;
 	if (table == NULL)
 		failedSort (fp, "out of memory");
 
@@ -199,13 +939,8 @@ extern void internalSortTags (const boolean toStdout)
 			;  /* ignore blank lines */
 		else
 		{
-			const size_t stringSize = strlen (line) + 1;
-
-			table [i] = (char *) malloc (stringSize);
-			if (table [i] == NULL)
-				failedSort (fp, "out of memory");
-			DebugStatement ( mallocSize += stringSize; )
-			strcpy (table [i], line);
+			table [i] = storeTagLine (line);
+			DebugStatement ( mallocSize += lineKeySize () + strlen (line) + 1; )
 			++i;
 		}
 	}
@@ -215,16 +950,252 @@ extern void internalSortTags (const boolean toStdout)
 
 	/*  Sort the lines.
 	 */
-	qsort (table, numTags, sizeof (*table), cmpFunc);
-
-	writeSortedTags (table, numTags, toStdout);
+#ifdef PARALLEL_SORT_SUPPORTED
+	if (parallelSortToRuns (table, numTags, cmpFunc))
+	{
+		forgetTagLines ();  /* the runs carry everything to be written */
+		mergeSortedRuns (toStdout);
+	}
+	else
+#endif
+	{
+		qsort (table, numTags, sizeof (*table), cmpFunc);
+		writeSortedTags (table, numTags, toStdout);
+	}
 
 	PrintStatus (("sort memory: %ld bytes\n", (long) mallocSize));
 	for (i = 0 ; i < numTags ; ++i)
-		free (table [i]);
+		releaseTagLine (table [i]);
 	free (table);
 }
 
+extern void internalSortTags (const boolean toStdout)
+{
+	const size_t numTags = TagFile.numTags.added + TagFile.numTags.prev;
+	int (*cmpFunc)(const void *, const void *);
+
+	cmpFunc = Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags;
+
+	/*  If every line of the tag file was remembered as it was written,
+	 *  sort the in-memory copies directly, merging any runs spilled to
+	 *  bound memory use; otherwise (e.g. appending to an existing file)
+	 *  fall back to re-reading the tag file.
+	 */
+	if (RunCount > 0)
+		mergeSortedRuns (toStdout);
+	else if (TagFile.numTags.prev == 0  &&  TagLineCount == numTags)
+	{
+#ifdef PARALLEL_SORT_SUPPORTED
+		if (parallelSortToRuns (TagLines, TagLineCount, cmpFunc))
+		{
+			forgetTagLines ();  /* the runs carry everything to be written */
+			mergeSortedRuns (toStdout);
+		}
+		else
 #endif
+		{
+			qsort (TagLines, TagLineCount, sizeof (*TagLines), cmpFunc);
+			writeSortedTags (TagLines, TagLineCount, toStdout);
+		}
+	}
+	else
+		sortTagsFromFile (toStdout, numTags, cmpFunc);
+	forgetTagLines ();
+}
+
+/*  Sorts the named tag file in place. Unlike the main tag file, whose
+ *  lines are remembered as they are written, the file is re-read here.
+ */
+extern void sortTagsInFile (const char *const name)
+{
+	vString *const vLine = vStringNew ();
+	FILE *fp = fopen (name, "r");
+	const char *line;
+	char **table = NULL;
+	size_t numTags = 0, allocated = 0;
+	size_t i;
+	int (*cmpFunc)(const void *, const void *);
+
+	cmpFunc = Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags;
+	if (fp == NULL)
+		error (FATAL | PERROR, "cannot open tag file \"%s\"", name);
+	while ((line = readLine (vLine, fp)) != NULL)
+	{
+		if (*line == '\0'  ||  strcmp (line, "\n") == 0)
+			continue;  /* ignore blank lines */
+		if (numTags == allocated)
+		{
+			allocated = (allocated == 0) ? 1024 : 2 * allocated;
+			table = xRealloc (table, allocated, char *);
+		}
+		table [numTags++] = storeTagLine (line);
+	}
+	fclose (fp);
+	vStringDelete (vLine);
+	qsort (table, numTags, sizeof (*table), cmpFunc);
+	fp = fopen (name, "w");
+	if (fp == NULL)
+		error (FATAL | PERROR, "cannot rewrite tag file \"%s\"", name);
+	for (i = 0  ;  i < numTags  ;  ++i)
+	{
+		if (i == 0  ||  strcmp (table [i], table [i-1]) != 0)
+			if (fputs (table [i], fp) == EOF)
+				error (FATAL | PERROR, "cannot write tag file \"%s\"", name);
+		releaseTagLine (table [i]);
+	}
+	fclose (fp);
+	if (table != NULL)
+		eFree (table);
+}
+
+#endif
+
+/*  Sorts each of the named tag files in place, running the sorts as
+ *  concurrent child processes where the platform allows so that the
+ *  per-language files of --split-output do not serialize the sort phase.
+ */
+extern void sortTagFilesInParallel (
+		const char *const *const names, const unsigned int count)
+{
+	unsigned int i;
+#ifdef PIPED_SORT_SUPPORTED
+	pid_t *const pids = xMalloc (count, pid_t);
+
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		pids [i] = fork ();
+		if (pids [i] == 0)
+		{
+			/*  Ensure ASCII value sort order.
+			 */
+#ifdef HAVE_SETENV
+			setenv ("LC_COLLATE", "C", 1);
+			setenv ("LC_ALL", "C", 1);
+#else
+			putenv ("LC_COLLATE=C");
+			putenv ("LC_ALL=C");
+#endif
+			if (Option.sorted == SO_FOLDSORTED)
+				execlp ("sort", "sort", "-u", "-f", "-o", names [i],
+						names [i], (char *) NULL);
+			else
+				execlp ("sort", "sort", "-u", "-o", names [i],
+						names [i], (char *) NULL);
+			_exit (1);
+		}
+	}
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+		if (pids [i] == -1)
+			sortTagsInFile (names [i]);  /* fork failed; sort it here */
+		else
+		{
+			int status;
+
+			if (waitpid (pids [i], &status, 0) == -1  ||
+				! WIFEXITED (status)  ||  WEXITSTATUS (status) != 0)
+				error (FATAL, "cannot sort tag file \"%s\"", names [i]);
+		}
+	}
+	eFree (pids);
+#else
+	for (i = 0  ;  i < count  ;  ++i)
+		sortTagsInFile (names [i]);
+#endif
+}
+
+/*  Reads the next tag line of a delta operand, skipping pseudo tags: the
+ *  "!_TAG_..." headers describe the runs which wrote the files, not the
+ *  symbols, and would otherwise show up in every delta.
+ */
+static const char *readDeltaLine (FILE *const fp, vString *const line)
+{
+	const char *result;
+
+	do
+		result = readLine (line, fp);
+	while (result != NULL  &&  strncmp (result, "!_", 2) == 0);
+	return result;
+}
+
+/*  Diffs the tag file just written against an older version in one linear
+ *  merge pass, writing lines present only in the old file prefixed "-" and
+ *  lines present only in the new one prefixed "+" to deltaName.  Both
+ *  operands are sorted, so the pass holds one line of each and the delta
+ *  comes out in sorted order; a consumer tracking changed symbols reads it
+ *  instead of diffing two complete tag files.
+ */
+extern void writeTagsDelta (
+		const char *const oldName, const char *const newName,
+		const char *const deltaName)
+{
+	FILE *const oldFp = fopen (oldName, "r");
+	FILE *const newFp = fopen (newName, "r");
+	FILE *const deltaFp = fopen (deltaName, "w");
+
+	if (oldFp == NULL  ||  newFp == NULL)
+		error (WARNING | PERROR, "cannot read tag files; no delta written");
+	else if (deltaFp == NULL)
+		error (WARNING | PERROR, "cannot open delta file \"%s\"", deltaName);
+	else
+	{
+		vString *const oldLine = vStringNew ();
+		vString *const newLine = vStringNew ();
+		const char *a = readDeltaLine (oldFp, oldLine);
+		const char *b = readDeltaLine (newFp, newLine);
+		unsigned long added = 0, removed = 0;
+
+		while (a != NULL  ||  b != NULL)
+		{
+			int comparison;
+
+			if (a == NULL)
+				comparison = 1;
+			else if (b == NULL)
+				comparison = -1;
+			else
+			{
+				comparison = compareTagLine (a, b);
+				if (comparison == 0)
+				{
+					/*  Folded sorting may order two lines equal although
+					 *  they differ; such a pair is a removal and an
+					 *  addition.
+					 */
+					comparison = strcmp (a, b);
+				}
+			}
+			if (comparison < 0)
+			{
+				fputc ('-', deltaFp);
+				fputs (a, deltaFp);
+				++removed;
+				a = readDeltaLine (oldFp, oldLine);
+			}
+			else if (comparison > 0)
+			{
+				fputc ('+', deltaFp);
+				fputs (b, deltaFp);
+				++added;
+				b = readDeltaLine (newFp, newLine);
+			}
+			else
+			{
+				a = readDeltaLine (oldFp, oldLine);
+				b = readDeltaLine (newFp, newLine);
+			}
+		}
+		vStringDelete (oldLine);
+		vStringDelete (newLine);
+		verbose ("delta \"%s\": %lu added, %lu removed tag lines\n",
+				 deltaName, added, removed);
+	}
+	if (oldFp != NULL)
+		fclose (oldFp);
+	if (newFp != NULL)
+		fclose (newFp);
+	if (deltaFp != NULL)
+		fclose (deltaFp);
+}
 
 /* vi:set tabstop=4 shiftwidth=4: */
@@ -16,15 +16,42 @@
 */
 #include "general.h"  /* must always come first */
 
+#include <stdio.h>
+
+#include "strlist.h"
+
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void catFile (const char *const name);
+extern void sortTagsInFile (const char *const name);
+extern void sortTagFilesInParallel (const char *const *const names, const unsigned int count);
+extern boolean mergeAppendedTags (const long appendOffset, const stringList *const replacedFiles);
+extern void mergeTagFiles (const stringList *const names, const boolean toStdout);
+extern int compareTagLine (const char *const line1, const char *const line2);
+extern boolean fileFieldMatches (const char *const line, const char *const *const files, const size_t count);
+extern boolean putMergedLine (FILE *const dest, const char *const line, vString *const previous, const boolean havePrevious);
+extern void writeTagsDelta (const char *const oldName, const char *const newName, const char *const deltaName);
+
+#if defined (EXTERNAL_SORT) && defined (HAVE_FORK) && \
+	defined (HAVE_WAITPID) && \
+	(defined (HAVE_SETENV) || defined (HAVE_PUTENV))
+# define PIPED_SORT_SUPPORTED
+#endif
+
+#ifdef PIPED_SORT_SUPPORTED
+extern FILE *openSortPipe (const char *const outputName);
+extern boolean closeSortPipe (FILE *const fp);
+#endif
 
 #ifdef EXTERNAL_SORT
 extern void externalSortTags (const boolean toStdout);
 #else
+extern void rememberTagLine (const char *const line);
 extern void internalSortTags (const boolean toStdout);
+extern void adoptSortedRun (char *const name);
+extern void forgetRememberedTagLines (void);
+extern void writeSortedShard (FILE *const fp);
 #endif
 
 #endif  /* _SORT_H */
@@ -3,8 +3,9 @@
 # Shared macros
 
 HEADERS = \
-	args.h ctags.h debug.h entry.h general.h get.h keyword.h \
-	main.h options.h parse.h parsers.h read.h routines.h sort.h \
+	args.h cache.h context.h ctags.h debug.h entry.h general.h get.h intern.h journal.h \
+	keyword.h \
+	main.h options.h parse.h parsers.h prefetch.h read.h routines.h sexp.h sort.h \
 	strlist.h vstring.h
 
 SOURCES = \
@@ -16,8 +17,11 @@ SOURCES = \
 	basic.c \
 	beta.c \
 	c.c \
+	cache.c \
 	css.c \
 	cobol.c \
+	context.c \
+	debug.c \
 	dosbatch.c \
 	eiffel.c \
 	entry.c \
@@ -28,6 +32,8 @@ SOURCES = \
 	get.c \
 	go.c \
 	html.c \
+	intern.c \
+	journal.c \
 	jscript.c \
 	keyword.c \
 	lisp.c \
@@ -35,6 +41,7 @@ SOURCES = \
 	lua.c \
 	main.c \
 	make.c \
+	matlab.c \
 	objc.c \
 	ocaml.c \
 	options.c \
@@ -42,12 +49,15 @@ SOURCES = \
 	pascal.c \
 	perl.c \
 	php.c \
+	prefetch.c \
 	python.c \
 	read.c \
+	readtags.c \
 	rexx.c \
 	routines.c \
 	ruby.c \
 	scheme.c \
+	sexp.c \
 	sh.c \
 	slang.c \
 	sml.c \
@@ -72,7 +82,10 @@ REGEX_SOURCES = gnu_regex/regex.c
 
 REGEX_HEADERS = gnu_regex/regex.h
 
-OBJECTS = \
+# Every object except main, so that stand-alone drivers (the "bench"
+# microbenchmark harness) can link the program's modules under their
+# own main function.
+LIB_OBJECTS = \
 	args.$(OBJEXT) \
 	ant.$(OBJEXT) \
 	asm.$(OBJEXT) \
@@ -81,8 +94,11 @@ OBJECTS = \
 	basic.$(OBJEXT) \
 	beta.$(OBJEXT) \
 	c.$(OBJEXT) \
+	cache.$(OBJEXT) \
 	css.$(OBJEXT) \
 	cobol.$(OBJEXT) \
+	context.$(OBJEXT) \
+	debug.$(OBJEXT) \
 	dosbatch.$(OBJEXT) \
 	eiffel.$(OBJEXT) \
 	entry.$(OBJEXT) \
@@ -93,13 +109,15 @@ OBJECTS = \
 	get.$(OBJEXT) \
 	go.$(OBJEXT) \
 	html.$(OBJEXT) \
+	intern.$(OBJEXT) \
+	journal.$(OBJEXT) \
 	jscript.$(OBJEXT) \
 	keyword.$(OBJEXT) \
 	lisp.$(OBJEXT) \
 	lregex.$(OBJEXT) \
 	lua.$(OBJEXT) \
-	main.$(OBJEXT) \
 	make.$(OBJEXT) \
+	matlab.$(OBJEXT) \
 	objc.$(OBJEXT) \
 	ocaml.$(OBJEXT) \
 	options.$(OBJEXT) \
@@ -107,12 +125,15 @@ OBJECTS = \
 	pascal.$(OBJEXT) \
 	perl.$(OBJEXT) \
 	php.$(OBJEXT) \
+	prefetch.$(OBJEXT) \
 	python.$(OBJEXT) \
 	read.$(OBJEXT) \
+	readtags.$(OBJEXT) \
 	rexx.$(OBJEXT) \
 	routines.$(OBJEXT) \
 	ruby.$(OBJEXT) \
 	scheme.$(OBJEXT) \
+	sexp.$(OBJEXT) \
 	sh.$(OBJEXT) \
 	slang.$(OBJEXT) \
 	sml.$(OBJEXT) \
@@ -126,3 +147,5 @@ OBJECTS = \
 	vim.$(OBJEXT) \
 	yacc.$(OBJEXT) \
 	vstring.$(OBJEXT)
+
+OBJECTS = $(LIB_OBJECTS) main.$(OBJEXT)
@@ -172,7 +172,7 @@ typedef struct sTokenInfoSQL {
 	vString *	scope;
 	int         begin_end_nest_lvl;
 	unsigned long lineNumber;
-	fpos_t filePosition;
+	filePos filePosition;
 } tokenInfo;
 
 /*
@@ -336,14 +336,12 @@ static boolean isIdentChar1 (const int c)
 	 * identifier, so we are removing some restrictions.
 	 */
 	return (boolean)
-		(isalpha (c) || c == '@' || c == '_' );
+		(charIsIdentifier1 (c) || c == '@');
 }
 
 static boolean isIdentChar (const int c)
 {
-	return (boolean)
-		(isalpha (c) || isdigit (c) || c == '$' || 
-		 c == '@' || c == '_' || c == '#');
+	return (boolean) (charTest (c, CHAR_AT_IDENTIFIER) != 0);
 }
 
 static boolean isCmdTerm (tokenInfo *const token)
@@ -410,6 +408,7 @@ static void buildSqlKeywordHash (void)
 	const size_t count = sizeof (SqlKeywordTable) /
 		sizeof (SqlKeywordTable [0]);
 	size_t i;
+	setKeywordCaseFolding (Lang_sql);
 	for (i = 0	;  i < count  ;  ++i)
 	{
 		const keywordDesc* const p = &SqlKeywordTable [i];
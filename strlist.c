@@ -14,6 +14,7 @@
 */
 #include "general.h"  /* must always come first */
 
+#include <stdlib.h>
 #include <string.h>
 #ifdef HAVE_FNMATCH_H
 # include <fnmatch.h>
@@ -37,22 +38,29 @@ extern stringList *stringListNew (void)
 	return result;
 }
 
-extern void stringListAdd (stringList *const current, vString *string)
+/* Grow the pointer array to hold at least `max' strings, in one step.
+ * Callers which know how many strings are coming can avoid the repeated
+ * incremental reallocations of stringListAdd.
+ */
+extern void stringListReserve (stringList *const current, unsigned int max)
 {
-	enum { incrementalIncrease = 10 };
 	Assert (current != NULL);
-	if (current->list == NULL)
+	if (max > current->max)
 	{
-		Assert (current->max == 0);
-		current->count = 0;
-		current->max   = incrementalIncrease;
-		current->list  = xMalloc (current->max, vString*);
-	}
-	else if (current->count == current->max)
-	{
-		current->max += incrementalIncrease;
-		current->list = xRealloc (current->list, current->max, vString*);
+		if (current->list == NULL)
+			current->list = xMalloc (max, vString*);
+		else
+			current->list = xRealloc (current->list, max, vString*);
+		current->max = max;
 	}
+}
+
+extern void stringListAdd (stringList *const current, vString *string)
+{
+	enum { incrementalIncrease = 10 };
+	Assert (current != NULL);
+	if (current->count == current->max)
+		stringListReserve (current, current->max + incrementalIncrease);
 	current->list [current->count++] = string;
 }
 
@@ -68,13 +76,18 @@ extern void stringListRemoveLast (stringList *const current)
 extern void stringListCombine (
 		stringList *const current, stringList *const from)
 {
-	unsigned int i;
 	Assert (current != NULL);
 	Assert (from != NULL);
-	for (i = 0  ;  i < from->count  ;  ++i)
+	if (from->count > 0)
 	{
-		stringListAdd (current, from->list [i]);
-		from->list [i] = NULL;
+		/*  Transfer ownership of the strings wholesale; `from' is left
+		 *  empty so deleting it does not touch them.
+		 */
+		stringListReserve (current, current->count + from->count);
+		memcpy (current->list + current->count, from->list,
+				from->count * sizeof (*from->list));
+		current->count += from->count;
+		from->count = 0;
 	}
 	stringListDelete (from);
 }
@@ -83,7 +96,11 @@ extern stringList* stringListNewFromArgv (const char* const* const argv)
 {
 	stringList* const result = stringListNew ();
 	const char *const *p;
+	unsigned int count = 0;
 	Assert (argv != NULL);
+	for (p = argv  ;  *p != NULL  ;  ++p)
+		++count;
+	stringListReserve (result, count);
 	for (p = argv  ;  *p != NULL  ;  ++p)
 		stringListAdd (result, vStringNewInit (*p));
 	return result;
@@ -205,6 +222,42 @@ extern boolean stringListHasInsensitive (
 	return result;
 }
 
+static int compareItems (const void *const a, const void *const b)
+{
+	return strcmp (vStringValue (*(vString *const *) a),
+				   vStringValue (*(vString *const *) b));
+}
+
+extern void stringListSort (stringList *const current)
+{
+	Assert (current != NULL);
+	qsort (current->list, (size_t) current->count, sizeof (*current->list),
+		   compareItems);
+}
+
+extern boolean stringListHasSorted (
+		const stringList *const current, const char *const string)
+{
+	unsigned int low, high;
+	Assert (current != NULL);
+	Assert (string != NULL);
+	low  = 0;
+	high = current->count;
+	while (low < high)
+	{
+		const unsigned int mid = (low + high) / 2;
+		const int comparison =
+				strcmp (string, vStringValue (current->list [mid]));
+		if (comparison == 0)
+			return TRUE;
+		else if (comparison < 0)
+			high = mid;
+		else
+			low = mid + 1;
+	}
+	return FALSE;
+}
+
 extern boolean stringListHasTest (
 		const stringList *const current, boolean (*test)(const char *s))
 {
@@ -31,6 +31,7 @@ typedef struct sStringList {
 *   FUNCTION PROTOTYPES
 */
 extern stringList *stringListNew (void);
+extern void stringListReserve (stringList *const current, unsigned int max);
 extern void stringListAdd (stringList *const current, vString *string);
 extern void stringListRemoveLast (stringList *const current);
 extern void stringListCombine (stringList *const current, stringList *const from);
@@ -43,6 +44,8 @@ extern vString* stringListLast (const stringList *const current);
 extern void stringListDelete (stringList *const current);
 extern boolean stringListHasInsensitive (const stringList *const current, const char *const string);
 extern boolean stringListHas (const stringList *const current, const char *const string);
+extern void stringListSort (stringList *const current);
+extern boolean stringListHasSorted (const stringList *const current, const char *const string);
 extern boolean stringListHasTest (const stringList *const current, boolean (*test)(const char *s));
 extern boolean stringListRemoveExtension (stringList* const current, const char* const extension);
 extern boolean stringListExtensionMatched (const stringList* const list, const char* const extension);
@@ -18,86 +18,198 @@
 
 #include "parse.h"
 #include "read.h"
+#include "routines.h"
 #include "vstring.h"
 
 /*
 *   DATA DEFINITIONS
 */
 typedef enum {
-	K_CLASS, K_METHOD, K_PROCEDURE
+	K_CLASS, K_METHOD, K_NAMESPACE, K_PROCEDURE
 } tclKind;
 
 static kindOption TclKinds [] = {
 	{ TRUE, 'c', "class",     "classes" },
 	{ TRUE, 'm', "method",    "methods" },
+	{ TRUE, 'n', "namespace", "namespaces" },
 	{ TRUE, 'p', "procedure", "procedures" }
 };
 
+/*  One entry of the namespace nesting in effect at the current line. The
+ *  name strings are reused from one push to the next, so a deeply nested
+ *  file allocates each level only once.
+ */
+typedef struct sNamespaceLevel {
+	vString *name;
+	int openDepth;  /* brace depth outside the namespace body */
+} namespaceLevel;
+
+static namespaceLevel *NamespaceStack;
+static unsigned int NamespaceDepth;   /* open namespaces */
+static unsigned int NamespaceSlots;   /* allocated stack entries */
+
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static const unsigned char *makeTclTag (
-		const unsigned char *cp,
-		vString *const name,
-		const tclKind kind)
+static const unsigned char *skipSpace (const unsigned char *cp)
 {
-	vStringClear (name);
-	while ((int) *cp != '\0'  &&  ! isspace ((int) *cp))
+	while (isspace ((int) *cp))
+		++cp;
+	return cp;
+}
+
+/*  Returns the end of the word beginning at "cp": the first white space
+ *  character or the terminating NUL.
+ */
+static const unsigned char *skipWord (const unsigned char *cp)
+{
+	while (*cp != '\0'  &&  ! isspace ((int) *cp))
+		++cp;
+	return cp;
+}
+
+static boolean wordMatch (
+		const unsigned char *const word, const unsigned char *const end,
+		const char *const key)
+{
+	return (boolean) (strlen (key) == (size_t) (end - word)  &&
+					  strncmp ((const char *) word, key, (size_t) (end - word)) == 0);
+}
+
+/*  The number of brace levels the line opens (or, negative, closes),
+ *  skipping backslash-escaped characters.
+ */
+static int braceDelta (const unsigned char *cp)
+{
+	int delta = 0;
+
+	while (*cp != '\0')
 	{
-		vStringPut (name, (int) *cp);
+		if (*cp == '\\'  &&  cp [1] != '\0')
+			++cp;
+		else if (*cp == '{')
+			++delta;
+		else if (*cp == '}')
+			--delta;
 		++cp;
 	}
-	vStringTerminate (name);
-	makeSimpleTag (name, TclKinds, kind);
-	return cp;
+	return delta;
 }
 
-static boolean match (const unsigned char *line, const char *word)
+static void pushNamespace (
+		const unsigned char *const word, const unsigned char *const end,
+		const int depth)
 {
-	return (boolean) (strncmp ((const char*) line, word, strlen (word)) == 0);
+	namespaceLevel *level;
+
+	if (NamespaceDepth == NamespaceSlots)
+	{
+		unsigned int i;
+
+		NamespaceSlots = (NamespaceSlots == 0) ? 8 : 2 * NamespaceSlots;
+		NamespaceStack = xRealloc (NamespaceStack, NamespaceSlots,
+				namespaceLevel);
+		for (i = NamespaceDepth  ;  i < NamespaceSlots  ;  ++i)
+			NamespaceStack [i].name = NULL;
+	}
+	if (NamespaceStack [NamespaceDepth].name == NULL)
+		NamespaceStack [NamespaceDepth].name = vStringNew ();
+	level = &NamespaceStack [NamespaceDepth++];
+	vStringClear (level->name);
+	vStringNCatS (level->name, (const char *) word, (size_t) (end - word));
+	level->openDepth = depth;
+}
+
+/*  Makes a tag for the word spanning [word, end), prefixed by the open
+ *  namespaces when "qualified" is set.
+ */
+static void makeTclTag (
+		const unsigned char *const word, const unsigned char *const end,
+		vString *const name, const boolean qualified, const tclKind kind)
+{
+	unsigned int i;
+
+	if (end == word)
+		return;
+	vStringClear (name);
+	if (qualified)
+		for (i = 0  ;  i < NamespaceDepth  ;  ++i)
+		{
+			vStringCat (name, NamespaceStack [i].name);
+			vStringCatS (name, "::");
+		}
+	vStringNCatS (name, (const char *) word, (size_t) (end - word));
+	makeSimpleTag (name, TclKinds, kind);
 }
 
 static void findTclTags (void)
 {
-	vString *name = vStringNew ();
+	vString *const name = vStringNew ();
 	const unsigned char *line;
+	int depth = 0;
 
+	NamespaceDepth = 0;
 	while ((line = fileReadLine ()) != NULL)
 	{
-		const unsigned char *cp;
+		const unsigned char *const word = skipSpace (line);
+		const unsigned char *const end = skipWord (word);
+		const unsigned char *arg, *argEnd;
 
-		while (isspace (line [0])) 
-			++line;
-		
-		if (line [0] == '\0'  ||  line [0] == '#')
+		if (*word == '\0'  ||  *word == '#')
 			continue;
+		arg = skipSpace (end);
+		argEnd = skipWord (arg);
 
-		/* read first word */
-		for (cp = line ; *cp != '\0'  &&  ! isspace ((int) *cp) ; ++cp)
-			;
-		if (! isspace ((int) *cp))
-			continue;
-		while (isspace ((int) *cp))
-			++cp;
-		/* Now `line' points at first word and `cp' points at next word */
-
-		if (match (line, "proc"))
-			cp = makeTclTag (cp, name, K_PROCEDURE);
-		else if (match (line, "class") || match (line, "itcl::class"))
-			cp = makeTclTag (cp, name, K_CLASS);
-		else if (match (line, "public") ||
-				match (line, "protected") ||
-				match (line, "private"))
+		/*  Classify the line by its first word alone; each word is
+		 *  extracted as a span, so nothing is rescanned.
+		 */
+		switch (*word)
 		{
-			if (match (cp, "method"))
-			{
-				cp += 6;
-				while (isspace ((int) *cp))
-					++cp;
-				cp = makeTclTag (cp, name, K_METHOD);
-			}
+			case 'p':
+				if (wordMatch (word, end, "proc"))
+					makeTclTag (arg, argEnd, name, TRUE, K_PROCEDURE);
+				else if (wordMatch (word, end, "public")  ||
+						 wordMatch (word, end, "protected")  ||
+						 wordMatch (word, end, "private"))
+				{
+					if (wordMatch (arg, argEnd, "method"))
+					{
+						arg = skipSpace (argEnd);
+						makeTclTag (arg, skipWord (arg), name,
+								FALSE, K_METHOD);
+					}
+				}
+				break;
+
+			case 'c':
+				if (wordMatch (word, end, "class"))
+					makeTclTag (arg, argEnd, name, FALSE, K_CLASS);
+				break;
+
+			case 'i':
+				if (wordMatch (word, end, "itcl::class"))
+					makeTclTag (arg, argEnd, name, FALSE, K_CLASS);
+				break;
+
+			case 'n':
+				if (wordMatch (word, end, "namespace")  &&
+					wordMatch (arg, argEnd, "eval"))
+				{
+					arg = skipSpace (argEnd);
+					argEnd = skipWord (arg);
+					makeTclTag (arg, argEnd, name, TRUE, K_NAMESPACE);
+					pushNamespace (arg, argEnd, depth);
+				}
+				break;
+
+			default:
+				break;
 		}
+		depth += braceDelta (line);
+		while (NamespaceDepth > 0  &&
+			   depth <= NamespaceStack [NamespaceDepth - 1].openDepth)
+			--NamespaceDepth;
 	}
 	vStringDelete (name);
 }
@@ -93,7 +93,95 @@ test.linux: $(CTAGS_TEST) $(CTAGS_REF)
 	@- $(DIFF)
 endif
 
-TEST_ARTIFACTS = test.*.diff tags.ref tags.test
+#
+#	Benchmarking
+#
+#	Replays a corpus through each parser in turn and reports throughput
+#	and peak resident set size. The Test directory is used by default;
+#	point BENCH_DIRECTORY at a larger tree for meaningful numbers. Record
+#	a baseline with "make bench.save"; subsequent "make bench" runs fail
+#	if any parser has slowed by more than BENCH_THRESHOLD percent against
+#	it. Requires GNU date; peak RSS is reported only if /usr/bin/time is
+#	available.
+
+CTAGS_BENCH = $(CTAGS_TEST)
+BENCH_DIRECTORY = Test
+BENCH_REPEATS = 3
+BENCH_THRESHOLD = 25
+BENCH_BASELINE = bench.baseline
+BENCH_CURRENT = bench.current
+BENCH_TIME := $(shell test -x /usr/bin/time && echo /usr/bin/time -f %M -o bench.rss)
+
+.PHONY: bench bench.save
+
+bench: $(CTAGS_TEST)
+	@ echo "Replaying $(BENCH_DIRECTORY) through each parser ($(BENCH_REPEATS) runs each)..."
+	@ rm -f $(BENCH_CURRENT)
+	@ for lang in `$(CTAGS_BENCH) --list-languages` ; do \
+		best= ; i=0 ; \
+		while [ $$i -lt $(BENCH_REPEATS) ] ; do \
+			start=`date +%s%N` ; \
+			$(BENCH_TIME) $(CTAGS_BENCH) -R --languages=$$lang --totals \
+				-o /dev/null $(BENCH_DIRECTORY) > /dev/null 2> bench.totals ; \
+			elapsed=$$((`date +%s%N` - start)) ; \
+			if [ -z "$$best" ] || [ $$elapsed -lt $$best ] ; then \
+				best=$$elapsed ; \
+			fi ; \
+			i=$$((i + 1)) ; \
+		done ; \
+		files=`sed -n 's/^\([0-9][0-9]*\) files*,.*/\1/p' bench.totals` ; \
+		kb=`sed -n 's/.*(\([0-9][0-9]*\) kB) scanned.*/\1/p' bench.totals` ; \
+		tags=`sed -n 's/^\([0-9][0-9]*\) tags* added.*/\1/p' bench.totals` ; \
+		rss=`cat bench.rss 2>/dev/null || echo 0` ; \
+		if [ -n "$$files" ] && [ "$$files" -gt 0 ] ; then \
+			echo "$$lang $$files $$kb $$tags $$best $$rss" >> $(BENCH_CURRENT) ; \
+		fi ; \
+	done ; \
+	rm -f bench.totals bench.rss
+	@ if [ -f $(BENCH_BASELINE) ] ; then \
+		base=$(BENCH_BASELINE) ; \
+	  else \
+		base=/dev/null ; \
+		echo "No baseline; run \"make bench.save\" to record one" ; \
+	  fi ; \
+	awk -v threshold=$(BENCH_THRESHOLD) -v basefile=$$base ' \
+		BEGIN { \
+			while ((getline line < basefile) > 0) { \
+				split (line, f) ; \
+				if (f [5] > 0) \
+					baseline [f [1]] = f [3] * 1.0e9 / f [5] ; \
+			} \
+		} \
+		{ \
+			kbs = ($$5 > 0) ? $$3 * 1.0e9 / $$5 : 0 ; \
+			tps = ($$5 > 0) ? $$4 * 1.0e9 / $$5 : 0 ; \
+			printf "%-12s %5d files %9.0f kB/s %9.0f tags/s %7d kB peak", \
+				$$1, $$2, kbs, tps, $$6 ; \
+			if ($$1 in baseline  &&  baseline [$$1] > 0) { \
+				change = 100 * (kbs - baseline [$$1]) / baseline [$$1] ; \
+				printf " %+6.1f%%", change ; \
+				if (change < -threshold) { \
+					printf "  REGRESSION" ; \
+					failed++ ; \
+				} \
+			} \
+			print "" ; \
+		} \
+		END { \
+			if (failed) { \
+				printf "FAILED: %d parser(s) slowed by more than %d%%\n", \
+					failed, threshold ; \
+				exit 1 ; \
+			} \
+		}' $(BENCH_CURRENT)
+
+bench.save:
+	@ test -f $(BENCH_CURRENT) || \
+		{ echo 'Run "make bench" first' ; exit 1 ; }
+	@ cp $(BENCH_CURRENT) $(BENCH_BASELINE)
+	@ echo "Baseline saved in $(BENCH_BASELINE)"
+
+TEST_ARTIFACTS = test.*.diff tags.ref tags.test bench.current bench.totals bench.rss
 
 clean-test:
 	rm -f $(TEST_ARTIFACTS)
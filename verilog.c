@@ -139,11 +139,7 @@ static int vGetc (void)
 		if (c2 == EOF)
 			longjmp (Exception, (int) ExceptionEOF);
 		else if (c2 == '/')  /* strip comment until end-of-line */
-		{
-			do
-				c = fileGetc ();
-			while (c != '\n'  &&  c != EOF);
-		}
+			c = fileSkipToCharacter ('\n');
 		else if (c2 == '*')  /* strip block comment */
 		{
 			c = skipOverCComment();
@@ -155,10 +151,7 @@ static int vGetc (void)
 	}
 	else if (c == '"')  /* strip string contents */
 	{
-		int c2;
-		do
-			c2 = fileGetc ();
-		while (c2 != '"'  &&  c2 != EOF);
+		fileSkipToCharacter ('"');
 		c = '@';
 	}
 	if (c == EOF)
@@ -254,6 +247,58 @@ static void tagNameList (const verilogKind kind, int c)
 	vUngetc (c);
 }
 
+/*  Once a statement's leading keyword has been processed (or rejected),
+ *  nothing before the next ';' or newline can start a declaration, so the
+ *  rest is crossed in strides with fileSkipToCharacters() instead of
+ *  per-character reads. Strings and comments still have to be recognized
+ *  so that boundary characters inside them are not mistaken for real ones.
+ *  Returns the terminating ';' or newline.
+ */
+static int skipToNewStatement (void)
+{
+	int c;
+	for (;;)
+	{
+		if (Ungetc != '\0')
+		{
+			c = Ungetc;
+			Ungetc = '\0';
+		}
+		else
+			c = fileSkipToCharacters (";\n\"/");
+		if (c == EOF)
+			longjmp (Exception, (int) ExceptionEOF);
+		else if (c == ';'  ||  c == '\n')
+			break;
+		else if (c == '"')  /* strip string contents */
+		{
+			if (fileSkipToCharacter ('"') == EOF)
+				longjmp (Exception, (int) ExceptionEOF);
+		}
+		else if (c == '/')
+		{
+			int c2 = fileGetc ();
+			if (c2 == EOF)
+				longjmp (Exception, (int) ExceptionEOF);
+			else if (c2 == '/')  /* line comment ends the statement too */
+			{
+				c = fileSkipToCharacter ('\n');
+				if (c == EOF)
+					longjmp (Exception, (int) ExceptionEOF);
+				break;
+			}
+			else if (c2 == '*')
+			{
+				if (skipOverCComment () == EOF)
+					longjmp (Exception, (int) ExceptionEOF);
+			}
+			else
+				fileUngetc (c2);
+		}
+	}
+	return c;
+}
+
 static void findTag (vString *const name)
 {
 	const verilogKind kind = (verilogKind) lookupKeyword (vStringValue (name), Lang_verilog);
@@ -319,7 +364,8 @@ static void findVerilogTags (void)
 			default:
 				if (newStatement && readIdentifier (name, c))
 					findTag (name);
-				newStatement = FALSE;
+				c = skipToNewStatement ();
+				newStatement = TRUE;
 				break;
 		}
 	}
@@ -166,7 +166,7 @@ typedef struct sTokenInfo {
 	vString *string;		/* the name of the token */
 	vString *scope;
 	unsigned long lineNumber;	/* line number of tag */
-	fpos_t filePosition;		/* file position of line containing name */
+	filePos filePosition;		/* file position of line containing name */
 } tokenInfo;
 
 /*
@@ -478,12 +478,64 @@ static void readToken (tokenInfo * const token)
 	}
 }
 
+/*  Skips ahead to the next occurrence of "keyword" without paying for a
+ *  token and a keyword probe per word on the way: the input is strided to
+ *  the next string, comment or candidate first letter, and only the
+ *  identifiers actually starting with that letter are spelled out.
+ */
 static void skipToKeyword (const keywordId keyword)
 {
 	tokenInfo *const token = newToken ();
+	const size_t count =
+		sizeof (VhdlKeywordTable) / sizeof (VhdlKeywordTable[0]);
+	char set [5];
+	size_t i;
+
+	set [0] = '"';
+	set [1] = '-';
+	set [2] = set [3] = '\0';
+	for (i = 0; i < count; ++i)
+	{
+		if (VhdlKeywordTable[i].id == keyword)
+		{
+			set [2] = VhdlKeywordTable[i].name [0];
+			set [3] = toupper (set [2]);
+			break;
+		}
+	}
+	set [4] = '\0';
+	Assert (set [2] != '\0');
+
 	do
 	{
-		readToken (token);
+		int c = fileSkipToWordStart (set);
+		token->keyword = KEYWORD_NONE;
+		if (c == EOF)
+			longjmp (Exception, (int) ExceptionEOF);
+		else if (c == '"')
+		{
+			while ((c = fileSkipToCharacters ("\\\"")) == '\\')
+			{
+				if (fileGetc () == EOF)
+					break;
+			}
+			if (c == EOF)
+				longjmp (Exception, (int) ExceptionEOF);
+		}
+		else if (c == '-')
+		{
+			c = fileGetc ();
+			if (c == '-')	/* start of a comment */
+				fileSkipToCharacter ('\n');
+			else if (!isspace (c))
+				fileUngetc (c);
+		}
+		else
+		{
+			vStringClear (token->string);
+			parseIdentifier (token->string, c);
+			token->keyword = analyzeToken (token->string, Lang_vhdl);
+		}
 	}
 	while (!isKeyword (token, keyword));
 	deleteToken (token);
@@ -575,6 +627,7 @@ static void initialize (const langType language)
 	const size_t count =
 		sizeof (VhdlKeywordTable) / sizeof (VhdlKeywordTable[0]);
 	Lang_vhdl = language;
+	setKeywordCaseFolding (language);
 	for (i = 0; i < count; ++i)
 	{
 		const keywordDesc *const p = &VhdlKeywordTable[i];
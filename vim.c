@@ -35,7 +35,7 @@ typedef struct sLineInfo {
 	vString *	string;
 	vString *	scope;
 	unsigned long lineNumber;
-	fpos_t filePosition;
+	filePos filePosition;
 } lineInfo;
 #endif
 
@@ -137,77 +137,36 @@ static const unsigned char* skipPrefix (const unsigned char* name, int *scope)
 static boolean isMap (const unsigned char* line)
 {
 	/*
-	 * There are many different short cuts for specifying a map.
-	 * This routine should capture all the permutations.
+	 * There are many different short cuts for specifying a map, but every
+	 * abbreviation reduces to one of a few prefixes: "map" itself, or one
+	 * of the mode letters [nvoilc] followed by "m" (:nmap and friends) or
+	 * "no" (:nnoremap and friends), with "no"/"nno" for the bare
+	 * :noremap forms. Anything longer in the permutation list contains
+	 * one of these, so testing the short prefixes captures them all.
 	 */
-	if (
-			strncmp ((const char*) line, "map",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "nm",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "nma",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "nmap",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "vm",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "vma",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "vmap",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "om",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "oma",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "omap",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "im",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "ima",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "imap",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "lm",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "lma",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "lmap",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "cm",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "cma",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "cmap",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "no",       (size_t) 2) == 0 ||
-			strncmp ((const char*) line, "nor",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "nore",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "norem",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "norema",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "noremap",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "nno",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "nnor",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "nnore",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "nnorem",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "nnorema",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "nnoremap", (size_t) 8) == 0 ||
-			strncmp ((const char*) line, "vno",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "vnor",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "vnore",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "vnorem",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "vnorema",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "vnoremap", (size_t) 8) == 0 ||
-			strncmp ((const char*) line, "ono",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "onor",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "onore",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "onorem",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "onorema",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "onoremap", (size_t) 8) == 0 ||
-			strncmp ((const char*) line, "ino",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "inor",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "inore",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "inorem",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "inorema",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "inoremap", (size_t) 8) == 0 ||
-			strncmp ((const char*) line, "lno",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "lnor",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "lnore",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "lnorem",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "lnorema",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "lnoremap", (size_t) 8) == 0 ||
-			strncmp ((const char*) line, "cno",      (size_t) 3) == 0 ||
-			strncmp ((const char*) line, "cnor",     (size_t) 4) == 0 ||
-			strncmp ((const char*) line, "cnore",    (size_t) 5) == 0 ||
-			strncmp ((const char*) line, "cnorem",   (size_t) 6) == 0 ||
-			strncmp ((const char*) line, "cnorema",  (size_t) 7) == 0 ||
-			strncmp ((const char*) line, "cnoremap", (size_t) 8) == 0 
-			)
-			return TRUE;
-
-	return FALSE;
+	switch ((int) line [0])
+	{
+		case 'm':
+			return (boolean) (strncmp ((const char*) line, "map", (size_t) 3) == 0);
+
+		case 'n':
+			return (boolean) (line [1] == 'm'  ||  line [1] == 'o'  ||
+							  (line [1] == 'n'  &&  line [2] == 'o'));
+
+		case 'v':
+		case 'o':
+		case 'i':
+		case 'l':
+		case 'c':
+			return (boolean) (line [1] == 'm'  ||
+							  (line [1] == 'n'  &&  line [2] == 'o'));
+
+		default:
+			return FALSE;
+	}
 }
 
+
 static const unsigned char * readVimLine (void)
 {
 	const unsigned char *line;
@@ -577,32 +536,68 @@ static boolean parseVimLine (const unsigned char *line)
 {
 	boolean readNextLine = TRUE;
 
-	if ( (!strncmp ((const char*) line, "comp", (size_t) 4) == 0) && 
-			(!strncmp ((const char*) line, "comc", (size_t) 4) == 0) && 
-			(strncmp ((const char*) line, "com", (size_t) 3) == 0) )
+	/*
+	 * Dispatch on the first character of the line so that most lines are
+	 * classified with a single switch; only commands starting with the
+	 * same letter still need prefix comparisons. The prefix sets are
+	 * disjoint, so at most one of the parsers runs for any line.
+	 */
+	switch ((int) line [0])
 	{
-		readNextLine = parseCommand(line);
-		/* TODO - Handle parseCommand returning FALSE */
-	}
+		case 'c':  /* :com[mand] or a :cmap variant */
+			if (strncmp ((const char*) line, "com", (size_t) 3) == 0)
+			{
+				if ( (!strncmp ((const char*) line, "comp", (size_t) 4) == 0) &&
+						(!strncmp ((const char*) line, "comc", (size_t) 4) == 0) )
+				{
+					readNextLine = parseCommand(line);
+					/* TODO - Handle parseCommand returning FALSE */
+				}
+			}
+			else if (isMap(line))
+			{
+				parseMap(line);
+			}
+			break;
 
-	if (isMap(line))
-	{
-		parseMap(line);
-	}
+		case 'f':
+			if (strncmp ((const char*) line, "fu", (size_t) 2) == 0)
+			{
+				parseFunction(line);
+			}
+			break;
 
-	if (strncmp ((const char*) line, "fu", (size_t) 2) == 0)
-	{
-		parseFunction(line);
-	}
+		case 'a':
+			if	(strncmp ((const char*) line, "aug", (size_t) 3) == 0)
+			{
+				parseAutogroup(line);
+			}
+			break;
 
-	if	(strncmp ((const char*) line, "aug", (size_t) 3) == 0)
-	{
-		parseAutogroup(line);
-	}
+		case 'l':  /* :let or an :lmap variant */
+			if ( strncmp ((const char*) line, "let", (size_t) 3) == 0 )
+			{
+				parseLet(line);
+			}
+			else if (isMap(line))
+			{
+				parseMap(line);
+			}
+			break;
 
-	if ( strncmp ((const char*) line, "let", (size_t) 3) == 0 )
-	{
-		parseLet(line);
+		case 'm':
+		case 'n':
+		case 'v':
+		case 'o':
+		case 'i':
+			if (isMap(line))
+			{
+				parseMap(line);
+			}
+			break;
+
+		default:
+			break;
 	}
 
 	return readNextLine;
@@ -25,7 +25,17 @@
 /*
 *   DATA DEFINITIONS
 */
-static const size_t vStringInitialSize = 32;
+
+/*  Deleted strings are pooled, buffer and all, for reuse by vStringNew,
+ *  since the parsers create and destroy token strings at a very high
+ *  rate. Strings that have grown unusually large are freed rather than
+ *  pooled so the pool does not hoard memory.
+ */
+#define VSTRING_POOL_LIMIT     64
+#define VSTRING_POOL_MAX_SIZE  1024
+
+static vString *StringPool [VSTRING_POOL_LIMIT];
+static unsigned int StringPoolCount = 0;
 
 /*
 *   FUNCTION DEFINITIONS
@@ -33,10 +43,17 @@ static const size_t vStringInitialSize = 32;
 
 static void vStringResize (vString *const string, const size_t newSize)
 {
-	char *const newBuffer = xRealloc (string->buffer, newSize, char);
+	if (string->buffer == string->inlineBuffer)
+	{
+		/*  Spill from the embedded buffer to the heap. */
+		char *const newBuffer = xMalloc (newSize, char);
 
+		memcpy (newBuffer, string->inlineBuffer, string->size);
+		string->buffer = newBuffer;
+	}
+	else
+		string->buffer = xRealloc (string->buffer, newSize, char);
 	string->size = newSize;
-	string->buffer = newBuffer;
 }
 
 /*
@@ -67,19 +84,31 @@ extern void vStringDelete (vString *const string)
 {
 	if (string != NULL)
 	{
-		if (string->buffer != NULL)
-			eFree (string->buffer);
-		eFree (string);
+		if (string->size <= VSTRING_POOL_MAX_SIZE  &&
+			StringPoolCount < VSTRING_POOL_LIMIT)
+			StringPool [StringPoolCount++] = string;
+		else
+		{
+			if (string->buffer != string->inlineBuffer)
+				eFree (string->buffer);
+			eFree (string);
+		}
 	}
 }
 
 extern vString *vStringNew (void)
 {
-	vString *const string = xMalloc (1, vString);
+	vString *string;
 
+	if (StringPoolCount > 0)
+		string = StringPool [--StringPoolCount];
+	else
+	{
+		string = xMalloc (1, vString);
+		string->size   = VSTRING_INLINE_SIZE;
+		string->buffer = string->inlineBuffer;
+	}
 	string->length = 0;
-	string->size   = vStringInitialSize;
-	string->buffer = xMalloc (string->size, char);
 
 	vStringClear (string);
 
@@ -131,18 +160,62 @@ extern vString *vStringNewInit (const char *const s)
 extern void vStringNCatS (
 		vString *const string, const char *const s, const size_t length)
 {
-	const char *p = s;
-	size_t remain = length;
+	const char *const terminator = (const char *) memchr (s, '\0', length);
+	const size_t toCopy = (terminator != NULL) ? (size_t) (terminator - s)
+											   : length;
 
-	while (*p != '\0'  &&  remain > 0)
-	{
-		vStringPut (string, *p);
-		--remain;
-		++p;
-	}
+	while (string->length + toCopy + 1 >= string->size)  /*  check for buffer overflow */
+		vStringAutoResize (string);
+	memcpy (string->buffer + string->length, s, toCopy);
+	string->length += toCopy;
 	vStringTerminate (string);
 }
 
+/*  Appends a span of known length: one capacity check and one memcpy.
+ *  Unlike vStringNCatS () the span is taken as given, without scanning
+ *  for an embedded terminator, so this is the cheapest append for
+ *  lengths that come out of a scan the caller has already done.
+ */
+extern void vStringCatSpan (
+		vString *const string, const char *const span, const size_t length)
+{
+	while (string->length + length + 1 >= string->size)
+		vStringAutoResize (string);
+	memcpy (string->buffer + string->length, span, length);
+	string->length += length;
+	string->buffer [string->length] = '\0';
+}
+
+extern void vStringCopySpan (
+		vString *const string, const char *const span, const size_t length)
+{
+	vStringClear (string);
+	vStringCatSpan (string, span, length);
+}
+
+/*  Guarantees room for length more characters plus a terminator and
+ *  returns the position at which they should be written, so that a
+ *  caller filling the string directly (an fgets, a decoder) need not
+ *  copy through a staging buffer. The characters written are accounted
+ *  for afterwards with vStringAdvance (); until then the string still
+ *  reports its old contents.
+ */
+extern char *vStringReserve (vString *const string, const size_t length)
+{
+	while (string->length + length + 1 >= string->size)
+		vStringAutoResize (string);
+	return string->buffer + string->length;
+}
+
+/*  Accounts for length characters written at the position returned by
+ *  vStringReserve () and restores the terminator.
+ */
+extern void vStringAdvance (vString *const string, const size_t length)
+{
+	string->length += length;
+	string->buffer [string->length] = '\0';
+}
+
 /*  Strip trailing newline from string.
  */
 extern void vStringStripNewline (vString *const string)
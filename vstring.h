@@ -51,10 +51,17 @@
 *   DATA DECLARATIONS
 */
 
+/*  Most parser tokens are short, so storage for them is embedded in the
+ *  string header itself; the buffer spills to the heap only once a string
+ *  outgrows the embedded space.
+ */
+#define VSTRING_INLINE_SIZE 32
+
 typedef struct sVString {
 	size_t  length;  /* size of buffer used */
 	size_t  size;    /* allocated size of buffer */
-	char   *buffer;  /* location of buffer */
+	char   *buffer;  /* inlineBuffer until the string grows */
+	char    inlineBuffer [VSTRING_INLINE_SIZE];
 } vString;
 
 /*
@@ -73,6 +80,10 @@ extern void vStringChop (vString *const string);
 extern void vStringStripTrailing (vString *const string);
 extern void vStringCatS (vString *const string, const char *const s);
 extern void vStringNCatS (vString *const string, const char *const s, const size_t length);
+extern void vStringCatSpan (vString *const string, const char *const span, const size_t length);
+extern void vStringCopySpan (vString *const string, const char *const span, const size_t length);
+extern char *vStringReserve (vString *const string, const size_t length);
+extern void vStringAdvance (vString *const string, const size_t length);
 extern vString *vStringNewCopy (const vString *const string);
 extern vString *vStringNewInit (const char *const s);
 extern void vStringCopyS (vString *const string, const char *const s);
@@ -15,25 +15,156 @@
 #include "general.h"  /* must always come first */
 
 #include <string.h>
+#include <ctype.h>
+
 #include "parse.h"
+#include "read.h"
+#include "vstring.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+typedef enum {
+	K_LABEL
+} yaccKind;
+
+static kindOption YaccKinds [] = {
+	{ TRUE, 'l', "label", "labels" }
+};
+
+/*  The three sections of a yacc grammar, separated by "%%" lines. Only the
+ *  rules section can contain rule names; the epilogue is pure C.
+ */
+typedef enum {
+	SECTION_DECLARATIONS,
+	SECTION_RULES,
+	SECTION_EPILOGUE
+} yaccSection;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static void installYaccRegex (const langType language)
+/*  Advances over the line updating the brace depth, so that C code in
+ *  "%{ ... %}" blocks, "%union" declarations and rule actions is passed
+ *  over without being offered for rule matching. Comments, string and
+ *  character constants are skipped so that braces within them do not
+ *  disturb the depth count.
+ */
+static void trackBraceDepth (
+		const unsigned char *cp, int *const depth, boolean *const inComment)
 {
-	addTagRegex (language,
-		"^([A-Za-z][A-Za-z_0-9]+)[ \t]*:", "\\1", "l,label,labels", NULL);
+	for ( ; *cp != '\0' ; ++cp)
+	{
+		if (*inComment)
+		{
+			if (cp [0] == '*'  &&  cp [1] == '/')
+			{
+				*inComment = FALSE;
+				++cp;
+			}
+		}
+		else switch (*cp)
+		{
+			case '/':
+				if (cp [1] == '*')
+				{
+					*inComment = TRUE;
+					++cp;
+				}
+				else if (cp [1] == '/')
+					return;
+				break;
+
+			case '"':
+			case '\'':
+			{
+				const unsigned char quote = *cp;
+				++cp;
+				while (*cp != '\0'  &&  *cp != quote)
+				{
+					if (cp [0] == '\\'  &&  cp [1] != '\0')
+						++cp;
+					++cp;
+				}
+				if (*cp == '\0')
+					return;
+				break;
+			}
+
+			case '%':
+				if (cp [1] == '{')
+				{
+					++*depth;
+					++cp;
+				}
+				else if (cp [1] == '}')
+				{
+					--*depth;
+					++cp;
+				}
+				break;
+
+			case '{':  ++*depth;  break;
+			case '}':  --*depth;  break;
+
+			default:  break;
+		}
+	}
+}
+
+static void findYaccTags (void)
+{
+	vString *const name = vStringNew ();
+	yaccSection section = SECTION_DECLARATIONS;
+	int braceDepth = 0;
+	boolean inComment = FALSE;
+	const unsigned char *line;
+
+	while ((line = fileReadLine ()) != NULL)
+	{
+		if (! inComment  &&  braceDepth == 0  &&
+			line [0] == '%'  &&  line [1] == '%')
+		{
+			if (section == SECTION_DECLARATIONS)
+				section = SECTION_RULES;
+			else
+				break;  /* the epilogue is C code; nothing can match */
+			continue;
+		}
+
+		if (section == SECTION_RULES  &&  braceDepth == 0  &&
+			! inComment  &&  isalpha ((int) line [0]))
+		{
+			const unsigned char *cp = line + 1;
+			const unsigned char *end;
+
+			while (isalnum ((int) *cp)  ||  *cp == '_')
+				++cp;
+			end = cp;
+			while (*cp == ' '  ||  *cp == '\t')
+				++cp;
+			if (end > line + 1  &&  *cp == ':')
+			{	/* like the old pattern, require at least two characters */
+				vStringNCopyS (name, (const char *) line,
+							   (size_t) (end - line));
+				makeSimpleTag (name, YaccKinds, K_LABEL);
+			}
+		}
+
+		trackBraceDepth (line, &braceDepth, &inComment);
+	}
+	vStringDelete (name);
 }
 
-extern parserDefinition* YaccParser ()
+extern parserDefinition* YaccParser (void)
 {
 	static const char *const extensions [] = { "y", NULL };
 	parserDefinition* const def = parserNew ("YACC");
+	def->kinds      = YaccKinds;
+	def->kindCount  = KIND_COUNT (YaccKinds);
 	def->extensions = extensions;
-	def->initialize = installYaccRegex;
-	def->regex      = TRUE;
+	def->parser     = findYaccTags;
 	return def;
 }
 